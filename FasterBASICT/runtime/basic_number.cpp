@@ -0,0 +1,334 @@
+//
+// basic_number.cpp
+// FasterBASIC - Native Number/Text Conversion
+//
+// See basic_number.h for the output conventions and parsing rules.
+//
+
+#include "basic_number.h"
+
+#include <charconv>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// =============================================================================
+// Formatting
+// =============================================================================
+
+// Significant digits in BASIC output (LuaJIT's "%.14g")
+static const int PRINT_PRECISION = 14;
+
+// Integers below this print without an exponent
+static const double INTEGER_LIMIT = 1e14;
+
+// Powers of ten that are exact in a double
+static const double EXACT_POWERS[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int MAX_EXACT_POWER = 22;
+
+static const char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static size_t writeUnsigned(uint64_t value, char* out) {
+    char digits[20];
+    char* p = digits + sizeof(digits);
+    while (value >= 100) {
+        unsigned pair = static_cast<unsigned>(value % 100);
+        value /= 100;
+        p -= 2;
+        std::memcpy(p, DIGIT_PAIRS + pair * 2, 2);
+    }
+    if (value >= 10) {
+        p -= 2;
+        std::memcpy(p, DIGIT_PAIRS + value * 2, 2);
+    } else {
+        *--p = static_cast<char>('0' + value);
+    }
+    size_t length = digits + sizeof(digits) - p;
+    std::memcpy(out, p, length);
+    return length;
+}
+
+// Lay out significant digits (no leading/trailing zeros) with decimal
+// exponent exp10 of the first digit as %.14g does
+static size_t writeGeneral(const char* digits, int count, int exp10, char* out) {
+    char* p = out;
+    if (exp10 < -4 || exp10 >= PRINT_PRECISION) {
+        *p++ = digits[0];
+        if (count > 1) {
+            *p++ = '.';
+            std::memcpy(p, digits + 1, count - 1);
+            p += count - 1;
+        }
+        *p++ = 'e';
+        *p++ = exp10 < 0 ? '-' : '+';
+        unsigned magnitude = static_cast<unsigned>(exp10 < 0 ? -exp10 : exp10);
+        if (magnitude < 10) {
+            *p++ = '0';
+        }
+        p += writeUnsigned(magnitude, p);
+    } else if (exp10 < 0) {
+        *p++ = '0';
+        *p++ = '.';
+        for (int i = -1; i > exp10; i--) {
+            *p++ = '0';
+        }
+        std::memcpy(p, digits, count);
+        p += count;
+    } else if (count <= exp10 + 1) {
+        std::memcpy(p, digits, count);
+        p += count;
+        for (int i = count; i <= exp10; i++) {
+            *p++ = '0';
+        }
+    } else {
+        std::memcpy(p, digits, exp10 + 1);
+        p += exp10 + 1;
+        *p++ = '.';
+        std::memcpy(p, digits + exp10 + 1, count - exp10 - 1);
+        p += count - exp10 - 1;
+    }
+    return p - out;
+}
+
+size_t fb_num_format(double value, char* out) {
+    if (std::isnan(value)) {
+        std::memcpy(out, "nan", 3);
+        return 3;
+    }
+
+    size_t length = 0;
+    if (std::signbit(value)) {
+        out[length++] = '-';
+        value = -value;
+    }
+    if (std::isinf(value)) {
+        std::memcpy(out + length, "inf", 3);
+        return length + 3;
+    }
+
+    // Integer fast path
+    if (value < INTEGER_LIMIT) {
+        uint64_t integer = static_cast<uint64_t>(value);
+        if (static_cast<double>(integer) == value) {
+            return length + writeUnsigned(integer, out + length);
+        }
+    }
+
+    // Short decimals (prices, measurements): a candidate of at most 14 digits
+    // that divides back to exactly this double is within half an ulp of it,
+    // so it is the %.14g rounding. The division is exact-operand and
+    // correctly rounded, as in Clinger's fast path; values needing more
+    // digits fail the check and go on to Ryu
+    int binaryExponent;
+    std::frexp(value, &binaryExponent);
+    int scale = 13 - static_cast<int>(std::floor((binaryExponent - 1) * 0.30102999566398120));
+    if (scale > 0 && scale <= MAX_EXACT_POWER) {
+        double scaled = value * EXACT_POWERS[scale];
+        if (scaled >= INTEGER_LIMIT && scale > 1) {
+            scaled = value * EXACT_POWERS[--scale];
+        }
+        if (scaled < INTEGER_LIMIT) {
+            uint64_t candidate = static_cast<uint64_t>(scaled + 0.5);
+            if (static_cast<double>(candidate) / EXACT_POWERS[scale] == value) {
+                char digits[20];
+                int count = static_cast<int>(writeUnsigned(candidate, digits));
+                int exp10 = count - 1 - scale;
+                while (digits[count - 1] == '0') {
+                    count--;
+                }
+                return length + writeGeneral(digits, count, exp10, out + length);
+            }
+        }
+    }
+
+    // Subnormals carry too few bits for their shortest digits to be the
+    // 14-digit rounding: Ryu printf
+    if (value < DBL_MIN) {
+        auto result = std::to_chars(out + length, out + FB_NUM_BUFFER_SIZE, value,
+                                    std::chars_format::general, PRINT_PRECISION);
+        return result.ptr - out;
+    }
+
+    // Shortest round-trip digits (Ryu), as d.ddde+XX
+    char shortest[FB_NUM_BUFFER_SIZE];
+    auto result = std::to_chars(shortest, shortest + sizeof(shortest), value,
+                                std::chars_format::scientific);
+    char digits[20];
+    int count = 0;
+    const char* p = shortest;
+    for (; p < result.ptr && *p != 'e'; p++) {
+        if (*p != '.') {
+            digits[count++] = *p;
+        }
+    }
+    int exp10 = 0;
+    std::from_chars(p + (p[1] == '+' ? 2 : 1), result.ptr, exp10);
+
+    if (count > PRINT_PRECISION) {
+        // More digits than BASIC prints. No 15-digit rounding boundary can lie
+        // between the value and its shortest digits (the boundary would be a
+        // shorter round-trip representation), so rounding the shortest digits
+        // is exact, except for a tie (15th and last digit 5): Ryu printf
+        if (count == PRINT_PRECISION + 1 && digits[PRINT_PRECISION] == '5') {
+            result = std::to_chars(out + length, out + FB_NUM_BUFFER_SIZE, value,
+                                   std::chars_format::general, PRINT_PRECISION);
+            return result.ptr - out;
+        }
+        bool roundUp = digits[PRINT_PRECISION] >= '5';
+        count = PRINT_PRECISION;
+        if (roundUp) {
+            while (count > 0 && digits[count - 1] == '9') {
+                count--;
+            }
+            if (count == 0) {
+                digits[0] = '1';
+                count = 1;
+                exp10++;
+            } else {
+                digits[count - 1]++;
+            }
+        }
+        while (digits[count - 1] == '0') {
+            count--;
+        }
+    }
+    return length + writeGeneral(digits, count, exp10, out + length);
+}
+
+// =============================================================================
+// Parsing
+// =============================================================================
+
+// Mantissas up to 19 digits fit in 64 bits
+static const int MAX_MANTISSA_DIGITS = 19;
+
+static const uint64_t MAX_EXACT_MANTISSA = uint64_t(1) << 53;
+
+static inline bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+// Value of eight ASCII digits at p, converted in one 64-bit register
+static inline bool eightDigits(const char* p, uint64_t& value) {
+    uint64_t chunk;
+    std::memcpy(&chunk, p, 8);
+    if (((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+         (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) != 0x3333333333333333ULL) {
+        return false;
+    }
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    value = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return true;
+}
+#else
+static inline bool eightDigits(const char*, uint64_t&) {
+    return false;
+}
+#endif
+
+// Consume a run of digits into mantissa; count tracks every digit seen so
+// that a count above MAX_MANTISSA_DIGITS means the mantissa is incomplete
+static const char* scanDigits(const char* p, const char* end, uint64_t& mantissa, int& count) {
+    uint64_t chunk;
+    while (end - p >= 8 && eightDigits(p, chunk)) {
+        if (count + 8 <= MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 100000000 + chunk;
+        }
+        count += 8;
+        p += 8;
+    }
+    while (p < end && isDigit(*p)) {
+        if (count < MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 10 + (*p - '0');
+        }
+        count++;
+        p++;
+    }
+    return p;
+}
+
+int fb_num_parse(const char* text, size_t length, double* out) {
+    const char* p = text;
+    const char* end = text + length;
+    while (p < end && isSpace(*p)) p++;
+    while (end > p && isSpace(end[-1])) end--;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    const char* number = p;
+
+    uint64_t mantissa = 0;
+    int count = 0;
+    p = scanDigits(p, end, mantissa, count);
+    bool hasDigits = (p != number);
+    int exponent = 0;
+    if (p < end && *p == '.') {
+        const char* fraction = ++p;
+        p = scanDigits(p, end, mantissa, count);
+        exponent = -static_cast<int>(p - fraction);
+        hasDigits = hasDigits || (p != fraction);
+    }
+    if (!hasDigits) {
+        return 0;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = (*p == '-');
+            p++;
+        }
+        if (p == end || !isDigit(*p)) {
+            return 0;
+        }
+        int value = 0;
+        for (; p < end && isDigit(*p); p++) {
+            if (value < 100000) {
+                value = value * 10 + (*p - '0');
+            }
+        }
+        exponent += negativeExponent ? -value : value;
+    }
+    if (p != end) {
+        return 0;
+    }
+
+    double value;
+    if (count <= MAX_MANTISSA_DIGITS && mantissa <= MAX_EXACT_MANTISSA &&
+        exponent >= -MAX_EXACT_POWER && exponent <= MAX_EXACT_POWER) {
+        // Clinger's fast path: both operands exact, one correctly rounded operation
+        value = static_cast<double>(mantissa);
+        value = exponent < 0 ? value / EXACT_POWERS[-exponent] : value * EXACT_POWERS[exponent];
+    } else {
+        auto result = std::from_chars(number, end, value);
+        if (result.ec != std::errc() || result.ptr != end) {
+            return 0;
+        }
+    }
+    *out = negative ? -value : value;
+    return 1;
+}
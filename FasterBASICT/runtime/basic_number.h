@@ -0,0 +1,61 @@
+//
+// basic_number.h
+// FasterBASIC - Native Number/Text Conversion
+//
+// C ABI for the number conversions behind PRINT, STR$ and VAL, bound through
+// the LuaJIT FFI by number_format.lua (built as libbasic_number.so /
+// libbasic_number.dylib by build_number_lib.sh).
+//
+// Output matches LuaJIT's tostring() for numbers ("%.14g": integers without a
+// decimal point, "nan", "inf", "-inf", "-0"), so switching between the native
+// and the Lua path never changes what a program prints:
+// - Integers below 1e14 take a digit-pair fast path
+// - Everything else gets its shortest round-trip digits from Ryu (C++17
+//   std::to_chars); those are the %.14g digits whenever there are 14 or
+//   fewer, otherwise the value is rounded to 14 digits (Ryu printf)
+//
+// Parsing accepts exactly the plain decimals tonumber() accepts (optional
+// surrounding whitespace, sign, digits, '.', exponent). Digits are consumed
+// eight at a time with SWAR (SIMD within a register) arithmetic; values whose
+// mantissa and power of ten are exact in a double are finished with a single
+// multiply or divide (Clinger's fast path), the rest with std::from_chars.
+// Anything else (hex, inf, nan, garbage) is reported back so the caller can
+// fall back to tonumber().
+//
+
+#ifndef BASIC_NUMBER_H
+#define BASIC_NUMBER_H
+
+#include <cstddef>
+
+// Longest output of fb_num_format ("-1.2345678901234e-308" plus slack)
+#define FB_NUM_BUFFER_SIZE 32
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Format a number the way BASIC prints it
+ *
+ * @param value Number to format
+ * @param out Buffer of at least FB_NUM_BUFFER_SIZE bytes (not NUL-terminated)
+ * @return Number of characters written
+ */
+size_t fb_num_format(double value, char* out);
+
+/**
+ * Parse a plain decimal number
+ *
+ * @param text Characters to parse (need not be NUL-terminated)
+ * @param length Number of characters
+ * @param out Receives the value on success
+ * @return 1 if text is a plain decimal, 0 if the caller should fall back
+ */
+int fb_num_parse(const char* text, size_t length, double* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BASIC_NUMBER_H
@@ -0,0 +1,37 @@
+#!/bin/bash
+#
+# build_number_lib.sh
+# Build the number conversion library (libbasic_number) as a shared
+# library loaded via LuaJIT FFI by number_format.lua for PRINT, STR$ and VAL
+#
+
+set -e
+
+echo "=== Building Number Conversion Library ==="
+echo ""
+
+# Get script directory
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+cd "$SCRIPT_DIR"
+
+# Pick the shared library flavour for this platform
+if [ "$(uname -s)" = "Darwin" ]; then
+    LIB_NAME="libbasic_number.dylib"
+    SHARED_FLAGS="-dynamiclib -install_name @rpath/$LIB_NAME"
+else
+    LIB_NAME="libbasic_number.so"
+    SHARED_FLAGS="-shared"
+fi
+
+# Compile and link basic_number.cpp (needs floating-point std::to_chars/from_chars)
+echo "Compiling basic_number.cpp..."
+g++ -std=c++17 -O3 -fPIC $SHARED_FLAGS \
+    -Wall -Wextra \
+    basic_number.cpp -o "$LIB_NAME"
+
+echo ""
+echo "=== Build Complete ==="
+echo "Library: $SCRIPT_DIR/$LIB_NAME"
+echo ""
+echo "Loaded at runtime by number_format.lua from runtime/$LIB_NAME"
+echo ""
@@ -0,0 +1,53 @@
+#!/bin/bash
+#
+# build_unicode_lib.sh
+# Build the pooled Unicode string library (libunicode_string) as a shared
+# library loaded via LuaJIT FFI by unicode_unified.lua for OPTION UNICODE
+#
+
+set -e
+
+echo "=== Building Unicode String Library ==="
+echo ""
+
+# Get script directory
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+cd "$SCRIPT_DIR"
+
+# Pick the shared library flavour for this platform
+if [ "$(uname -s)" = "Darwin" ]; then
+    LIB_NAME="libunicode_string.dylib"
+    SHARED_FLAGS="-dynamiclib -install_name @rpath/$LIB_NAME"
+else
+    LIB_NAME="libunicode_string.so"
+    SHARED_FLAGS="-shared"
+fi
+
+# Compile unicode_runtime.cpp (UTF-8 conversion and case mapping)
+echo "Compiling unicode_runtime.cpp..."
+g++ -std=c++17 -O3 -c -fPIC \
+    -Wall -Wextra \
+    unicode_runtime.cpp -o unicode_runtime_pic.o
+
+# Compile unicode_string.cpp (pooled, refcounted UString ABI)
+echo "Compiling unicode_string.cpp..."
+g++ -std=c++17 -O3 -c -fPIC \
+    -Wall -Wextra \
+    unicode_string.cpp -o unicode_string.o
+
+# Link shared library
+echo "Linking $LIB_NAME..."
+g++ -std=c++17 -O3 $SHARED_FLAGS \
+    unicode_runtime_pic.o unicode_string.o \
+    -o "$LIB_NAME"
+
+# Clean up object files
+echo "Cleaning up object files..."
+rm -f unicode_runtime_pic.o unicode_string.o
+
+echo ""
+echo "=== Build Complete ==="
+echo "Library: $SCRIPT_DIR/$LIB_NAME"
+echo ""
+echo "Loaded at runtime by unicode_unified.lua from runtime/$LIB_NAME"
+echo ""
@@ -0,0 +1,100 @@
+//
+// embed_runtime_bytecode.cpp
+// FasterBASIC - Build-time tool: compile the runtime Lua modules to bytecode
+//
+// Writes a C++ source defining fb_runtime_modules (see runtime_bytecode.h)
+// with each module's LuaJIT bytecode as a byte array. Debug info is kept so
+// runtime errors still report module line numbers.
+//
+// Usage: embed_runtime_bytecode <runtime_dir> <output.cpp>
+//
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+// Modules loaded by generated code: require() name and source file
+static const struct {
+    const char* name;
+    const char* file;
+} RUNTIME_MODULES[] = {
+    {"runtime.string_functions", "string_functions.lua"},
+    {"runtime.math_functions", "math_functions.lua"},
+    {"runtime.unicode_unified", "unicode_unified.lua"},
+    {"runtime.simd_ffi_bindings", "simd_ffi_bindings.lua"},
+    {"number_format", "number_format.lua"},
+};
+
+static int writeBytecode(lua_State*, const void* data, size_t size, void* out) {
+    static_cast<std::string*>(out)->append(static_cast<const char*>(data), size);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <runtime_dir> <output.cpp>\n";
+        return 1;
+    }
+    std::string runtimeDir = argv[1];
+
+    lua_State* L = luaL_newstate();
+    if (!L) {
+        std::cerr << "Error: Cannot create Lua state\n";
+        return 1;
+    }
+
+    std::string arrays;
+    std::string table;
+    size_t index = 0;
+    for (const auto& module : RUNTIME_MODULES) {
+        std::string path = runtimeDir + "/" + module.file;
+        std::string chunkName = std::string("@runtime/") + module.file;
+        std::ifstream in(path, std::ios::binary);
+        std::string source((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (!in || luaL_loadbuffer(L, source.data(), source.size(), chunkName.c_str()) != 0) {
+            std::cerr << "Error: Cannot compile " << path;
+            if (lua_isstring(L, -1)) {
+                std::cerr << ": " << lua_tostring(L, -1);
+            }
+            std::cerr << "\n";
+            lua_close(L);
+            return 1;
+        }
+        std::string bytecode;
+        lua_dump(L, writeBytecode, &bytecode);
+        lua_pop(L, 1);
+
+        std::string array = "module_" + std::to_string(index++);
+        arrays += "// " + std::string(module.file) + "\n";
+        arrays += "static const unsigned char " + array + "[] = {";
+        for (size_t i = 0; i < bytecode.size(); i++) {
+            char byte[16];
+            std::snprintf(byte, sizeof(byte), "%s%u,", (i % 20 == 0) ? "\n    " : "",
+                          static_cast<unsigned char>(bytecode[i]));
+            arrays += byte;
+        }
+        arrays += "\n};\n\n";
+        table += "    {\"" + std::string(module.name) + "\", " + array + ", sizeof(" + array + ")},\n";
+    }
+    lua_close(L);
+
+    std::ofstream out(argv[2]);
+    out << "// Generated by embed_runtime_bytecode - do not edit\n\n"
+        << "#include \"runtime_bytecode.h\"\n\n"
+        << arrays
+        << "const RuntimeModule fb_runtime_modules[] = {\n" << table << "};\n\n"
+        << "const size_t fb_runtime_module_count = sizeof(fb_runtime_modules) / sizeof(fb_runtime_modules[0]);\n";
+    if (!out) {
+        std::cerr << "Error: Cannot write " << argv[2] << "\n";
+        return 1;
+    }
+    return 0;
+}
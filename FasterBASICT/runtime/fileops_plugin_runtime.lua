@@ -54,6 +54,341 @@ local function execute_command(cmd)
     return result, success
 end
 
+-- =============================================================================
+-- Native File System Access (FFI)
+-- =============================================================================
+-- On POSIX systems the operations below call libc directly instead of
+-- spawning a shell per call. Declarations use private names bound to the libc
+-- symbols with __asm__ so they cannot clash with other runtime cdefs. When FFI
+-- or the symbols are unavailable (Windows, 32-bit ABIs) `native` stays nil and
+-- the shell / io based fallbacks are used.
+
+local ffi_ok, ffi = pcall(require, "ffi")
+local bit_ok, bit = pcall(require, "bit")
+local native = nil
+
+local S_IFMT = 0xF000
+local S_IFDIR = 0x4000
+local S_IFREG = 0x8000
+local DT_UNKNOWN = 0
+local DT_DIR = 4
+local COPY_CHUNK = 1024 * 1024
+
+local function load_native()
+    if not (ffi_ok and bit_ok) or is_windows or not ffi.abi("64bit") then
+        return nil
+    end
+
+    local is_osx = ffi.os == "OSX"
+    -- x86_64 macOS exports the 64-bit inode variants under suffixed names
+    local inode64 = (is_osx and ffi.arch == "x64") and "$INODE64" or ""
+
+    local decls = [[
+        typedef struct fb_fileops_dir fb_fileops_dir;
+        fb_fileops_dir* fb_fileops_opendir(const char* path) __asm__("opendir%s");
+        struct fb_fileops_dirent* fb_fileops_readdir(fb_fileops_dir* dir) __asm__("readdir%s");
+        int fb_fileops_closedir(fb_fileops_dir* dir) __asm__("closedir");
+        int fb_fileops_mkdir(const char* path, unsigned int mode) __asm__("mkdir");
+        int fb_fileops_rmdir(const char* path) __asm__("rmdir");
+        int fb_fileops_chdir(const char* path) __asm__("chdir");
+        char* fb_fileops_getcwd(char* buf, size_t size) __asm__("getcwd");
+        int fb_fileops_access(const char* path, int mode) __asm__("access");
+        int fb_fileops_utimes(const char* path, const void* times) __asm__("utimes");
+        int fb_fileops_open(const char* path, int flags, ...) __asm__("open");
+        int fb_fileops_close(int fd) __asm__("close");
+        ptrdiff_t fb_fileops_read(int fd, void* buf, size_t count) __asm__("read");
+        ptrdiff_t fb_fileops_write(int fd, const void* buf, size_t count) __asm__("write");
+        char* fb_fileops_strerror(int errnum) __asm__("strerror");
+    ]]
+
+    if is_osx then
+        decls = decls .. [[
+            struct fb_fileops_timespec { int64_t tv_sec; int64_t tv_nsec; };
+            struct fb_fileops_dirent {
+                uint64_t d_ino; uint64_t d_seekoff; uint16_t d_reclen;
+                uint16_t d_namlen; uint8_t d_type; char d_name[1024];
+            };
+            struct fb_fileops_stat {
+                int32_t st_dev; uint16_t st_mode; uint16_t st_nlink; uint64_t st_ino;
+                uint32_t st_uid; uint32_t st_gid; int32_t st_rdev;
+                struct fb_fileops_timespec st_atim, st_mtim, st_ctim, st_birthtim;
+                int64_t st_size; int64_t st_blocks; int32_t st_blksize;
+                uint32_t st_flags; uint32_t st_gen; int32_t st_lspare; int64_t st_qspare[2];
+            };
+            int fb_fileops_stat(const char* path, struct fb_fileops_stat* buf) __asm__("stat%s");
+            int fb_fileops_lstat(const char* path, struct fb_fileops_stat* buf) __asm__("lstat%s");
+            int fb_fileops_copyfile(const char* from, const char* to, void* state, uint32_t flags) __asm__("copyfile");
+        ]]
+    else
+        -- statx has the same layout on every Linux architecture, unlike struct stat
+        decls = decls .. [[
+            struct fb_fileops_dirent {
+                uint64_t d_ino; int64_t d_off; uint16_t d_reclen;
+                uint8_t d_type; char d_name[256];
+            };
+            struct fb_fileops_statx_timestamp { int64_t tv_sec; uint32_t tv_nsec; int32_t reserved; };
+            struct fb_fileops_statx {
+                uint32_t stx_mask; uint32_t stx_blksize; uint64_t stx_attributes;
+                uint32_t stx_nlink; uint32_t stx_uid; uint32_t stx_gid;
+                uint16_t stx_mode; uint16_t spare0;
+                uint64_t stx_ino; uint64_t stx_size; uint64_t stx_blocks; uint64_t stx_attributes_mask;
+                struct fb_fileops_statx_timestamp stx_atime, stx_btime, stx_ctime, stx_mtime;
+                uint32_t stx_rdev_major, stx_rdev_minor, stx_dev_major, stx_dev_minor;
+                uint64_t spare2[14];
+            };
+            int fb_fileops_statx(int dirfd, const char* path, int flags, unsigned int mask,
+                                 struct fb_fileops_statx* buf) __asm__("statx");
+            ptrdiff_t fb_fileops_copy_file_range(int fd_in, int64_t* off_in, int fd_out, int64_t* off_out,
+                                                 size_t len, unsigned int flags) __asm__("copy_file_range");
+            ptrdiff_t fb_fileops_sendfile(int out_fd, int in_fd, int64_t* offset, size_t count) __asm__("sendfile");
+        ]]
+    end
+
+    if not pcall(ffi.cdef, (decls:gsub("%%s", inode64))) then
+        return nil
+    end
+
+    local C = ffi.C
+    local function has(symbol)
+        return (pcall(function() return C[symbol] end))
+    end
+
+    if not (has("fb_fileops_opendir") and has("fb_fileops_readdir") and
+            has(is_osx and "fb_fileops_stat" or "fb_fileops_statx")) then
+        return nil
+    end
+
+    local n = {}
+    local has_copy_file_range = has("fb_fileops_copy_file_range")
+    local has_sendfile = has("fb_fileops_sendfile")
+    local has_copyfile = has("fb_fileops_copyfile")
+    local O_RDONLY = 0
+    local O_WRONLY_CREAT_TRUNC = is_osx and (0x1 + 0x200 + 0x400) or (0x1 + 0x40 + 0x200)
+    local AT_FDCWD = -100
+    local AT_SYMLINK_NOFOLLOW = 0x100
+    local STATX_BASIC = 0x1 + 0x2 + 0x40 + 0x200 -- type, mode, mtime, size
+
+    function n.last_error()
+        return ffi.string(C.fb_fileops_strerror(ffi.errno()))
+    end
+
+    -- Returns mode, size, mtime seconds, mtime nanoseconds or nil
+    if is_osx then
+        local st = ffi.new("struct fb_fileops_stat")
+        function n.stat(path, nofollow)
+            local rc = nofollow and C.fb_fileops_lstat(path, st) or C.fb_fileops_stat(path, st)
+            if rc ~= 0 then
+                return nil
+            end
+            return st.st_mode, tonumber(st.st_size), tonumber(st.st_mtim.tv_sec), tonumber(st.st_mtim.tv_nsec)
+        end
+    else
+        local stx = ffi.new("struct fb_fileops_statx")
+        function n.stat(path, nofollow)
+            if C.fb_fileops_statx(AT_FDCWD, path, nofollow and AT_SYMLINK_NOFOLLOW or 0, STATX_BASIC, stx) ~= 0 then
+                return nil
+            end
+            return stx.stx_mode, tonumber(stx.stx_size), tonumber(stx.stx_mtime.tv_sec), stx.stx_mtime.tv_nsec
+        end
+    end
+
+    -- Calls fn(name_ptr, d_type) for every entry except "." and ".."; the
+    -- name pointer is only valid during the call
+    function n.each_entry(path, fn)
+        local dir = C.fb_fileops_opendir(path)
+        if dir == nil then
+            return false
+        end
+        while true do
+            local entry = C.fb_fileops_readdir(dir)
+            if entry == nil then
+                break
+            end
+            local name = entry.d_name
+            if not (name[0] == 46 and (name[1] == 0 or (name[1] == 46 and name[2] == 0))) then
+                fn(name, entry.d_type)
+            end
+        end
+        C.fb_fileops_closedir(dir)
+        return true
+    end
+
+    function n.mkdir(path)
+        return C.fb_fileops_mkdir(path, tonumber("777", 8)) == 0
+    end
+
+    function n.rmdir(path)
+        return C.fb_fileops_rmdir(path) == 0
+    end
+
+    function n.chdir(path)
+        return C.fb_fileops_chdir(path) == 0
+    end
+
+    local cwd_buf = ffi.new("char[?]", 4096)
+    function n.getcwd()
+        if C.fb_fileops_getcwd(cwd_buf, 4096) == nil then
+            return nil
+        end
+        return ffi.string(cwd_buf)
+    end
+
+    function n.readable(path)
+        return C.fb_fileops_access(path, 4) == 0 -- R_OK
+    end
+
+    function n.touch(path)
+        return C.fb_fileops_utimes(path, nil) == 0
+    end
+
+    -- Kernel-side copy where available, read/write loop otherwise
+    local copy_buf = nil
+    local function copy_fds(fd_in, fd_out, size)
+        local remaining = size
+        if has_copy_file_range then
+            while remaining > 0 do
+                local copied = C.fb_fileops_copy_file_range(fd_in, nil, fd_out, nil, remaining, 0)
+                if copied <= 0 then
+                    break
+                end
+                remaining = remaining - tonumber(copied)
+            end
+        end
+        if remaining > 0 and has_sendfile then
+            while remaining > 0 do
+                local copied = C.fb_fileops_sendfile(fd_out, fd_in, nil, math.min(remaining, 0x7ffff000))
+                if copied <= 0 then
+                    break
+                end
+                remaining = remaining - tonumber(copied)
+            end
+        end
+        if remaining > 0 or size == 0 then
+            -- Finish with plain reads from the current file offset (also for
+            -- files that report size 0, such as those under /proc)
+            copy_buf = copy_buf or ffi.new("uint8_t[?]", COPY_CHUNK)
+            while true do
+                local got = C.fb_fileops_read(fd_in, copy_buf, COPY_CHUNK)
+                if got < 0 then
+                    return false
+                elseif got == 0 then
+                    break
+                end
+                local offset = 0
+                while offset < got do
+                    local put = C.fb_fileops_write(fd_out, copy_buf + offset, got - offset)
+                    if put <= 0 then
+                        return false
+                    end
+                    offset = offset + put
+                end
+            end
+        end
+        return true
+    end
+
+    -- Returns true, or false plus 1 (source) / 2 (destination) on failure
+    function n.copy(source, dest)
+        if has_copyfile then
+            if not n.readable(source) then
+                return false, 1
+            end
+            return C.fb_fileops_copyfile(source, dest, nil, 8) == 0, 2 -- COPYFILE_DATA
+        end
+
+        local _, size = n.stat(source)
+        local fd_in = C.fb_fileops_open(source, O_RDONLY)
+        if fd_in < 0 then
+            return false, 1
+        end
+        local fd_out = C.fb_fileops_open(dest, O_WRONLY_CREAT_TRUNC, ffi.cast("int", tonumber("666", 8)))
+        if fd_out < 0 then
+            C.fb_fileops_close(fd_in)
+            return false, 2
+        end
+        local ok = copy_fds(fd_in, fd_out, size or 0)
+        C.fb_fileops_close(fd_in)
+        ok = (C.fb_fileops_close(fd_out) == 0) and ok
+        return ok, 2
+    end
+
+    return n
+end
+
+native = load_native()
+
+local function is_dir_mode(mode)
+    return mode ~= nil and bit.band(mode, S_IFMT) == S_IFDIR
+end
+
+-- Glob patterns are converted to Lua patterns once and reused
+local glob_cache = {}
+
+local function glob_to_lua(pattern)
+    local lua_pattern = glob_cache[pattern]
+    if not lua_pattern then
+        lua_pattern = "^" .. pattern:gsub("[%(%)%.%%%+%-%[%]%^%$]", "%%%1")
+        lua_pattern = lua_pattern:gsub("%*", ".*")
+        lua_pattern = lua_pattern:gsub("%?", ".")
+        lua_pattern = lua_pattern .. "$"
+        glob_cache[pattern] = lua_pattern
+    end
+    return lua_pattern
+end
+
+-- Sorted, visible entries of a directory matching a glob (like `ls -1`).
+-- The last listing is reused while the directory's mtime is unchanged, so
+-- DIRLISTITEM loops read the directory once. A directory modified within the
+-- last two seconds is always re-read: file system timestamps are coarse
+-- enough that two changes in quick succession can share one mtime.
+local listing_cache = { path = nil, pattern = nil, mtime = nil, mtime_nsec = nil, items = nil }
+
+local function native_list(path, pattern)
+    local mode, _, mtime, mtime_nsec = native.stat(path)
+    if not is_dir_mode(mode) then
+        return nil
+    end
+
+    local cache = listing_cache
+    if cache.path == path and cache.pattern == pattern and cache.mtime == mtime and
+        cache.mtime_nsec == mtime_nsec and os.time() - mtime >= 2 then
+        return cache.items
+    end
+
+    local items = {}
+    local lua_pattern = pattern ~= "*" and glob_to_lua(pattern) or nil
+    local ffi_string = ffi.string
+    native.each_entry(path, function(name_ptr)
+        if name_ptr[0] ~= 46 then -- hidden entries are skipped, as ls does
+            local name = ffi_string(name_ptr)
+            if not lua_pattern or name:match(lua_pattern) then
+                items[#items + 1] = name
+            end
+        end
+    end)
+    table.sort(items)
+
+    cache.path, cache.pattern, cache.items = path, pattern, items
+    cache.mtime, cache.mtime_nsec = mtime, mtime_nsec
+    return items
+end
+
+-- mkdir -p: create every missing component of path
+local function native_mkdirs(path)
+    if is_dir_mode((native.stat(path))) then
+        return true
+    end
+    for pos in path:gmatch("()/") do
+        if pos > 1 then
+            local prefix = path:sub(1, pos - 1)
+            if not native.mkdir(prefix) and not is_dir_mode((native.stat(prefix))) then
+                return false
+            end
+        end
+    end
+    return native.mkdir(path) or is_dir_mode((native.stat(path)))
+end
+
 -- =============================================================================
 -- Directory Operations
 -- =============================================================================
@@ -61,6 +396,10 @@ end
 function fileops_direxists(path)
     clear_error()
 
+    if native then
+        return is_dir_mode((native.stat(path)))
+    end
+
     -- Try to change to directory and back (portable way)
     local current_dir = fileops_workdir()
     local success = fileops_changedir(path)
@@ -76,6 +415,14 @@ end
 function fileops_dircreate(path)
     clear_error()
 
+    if native then
+        if native_mkdirs(path) then
+            return true
+        end
+        set_error(1, "Failed to create directory: " .. path .. " (" .. native.last_error() .. ")")
+        return false
+    end
+
     local cmd
     if is_windows then
         cmd = 'mkdir "' .. path:gsub('/', '\\') .. '" 2>nul'
@@ -96,6 +443,14 @@ end
 function fileops_dirdelete(path)
     clear_error()
 
+    if native then
+        if native.rmdir(path) then
+            return true
+        end
+        set_error(1, "Failed to delete directory: " .. path .. " (" .. native.last_error() .. ")")
+        return false
+    end
+
     local cmd
     if is_windows then
         cmd = 'rmdir "' .. path:gsub('/', '\\') .. '" 2>nul'
@@ -113,10 +468,28 @@ function fileops_dirdelete(path)
     return true
 end
 
+-- Encode a list of names as a JSON array
+local function json_list(items)
+    local quoted = {}
+    for i, item in ipairs(items) do
+        quoted[i] = '"' .. item:gsub('"', '\\"') .. '"'
+    end
+    return "[" .. table.concat(quoted, ",") .. "]"
+end
+
 function fileops_dirlist(path, pattern)
     clear_error()
     pattern = pattern or "*"
 
+    if native then
+        local items = native_list(path, pattern)
+        if not items then
+            set_error(1, "Failed to list directory: " .. path)
+            return "[]"
+        end
+        return json_list(items)
+    end
+
     local items = {}
     local cmd
 
@@ -142,20 +515,22 @@ function fileops_dirlist(path, pattern)
     handle:close()
 
     -- Return as JSON array
-    local json = "["
-    for i, item in ipairs(items) do
-        if i > 1 then json = json .. "," end
-        json = json .. '"' .. item:gsub('"', '\\"') .. '"'
-    end
-    json = json .. "]"
-
-    return json
+    return json_list(items)
 end
 
 function fileops_dirlistcount(path, pattern)
     clear_error()
     pattern = pattern or "*"
 
+    if native then
+        local items = native_list(path, pattern)
+        if not items then
+            set_error(1, "Failed to list directory: " .. path)
+            return 0
+        end
+        return #items
+    end
+
     local count = 0
     local cmd
 
@@ -185,6 +560,20 @@ function fileops_dirlistitem(path, index, pattern)
     clear_error()
     pattern = pattern or "*"
 
+    if native then
+        local items = native_list(path, pattern)
+        if not items then
+            set_error(1, "Failed to list directory: " .. path)
+            return ""
+        end
+        local item = items[index + 1]
+        if not item then
+            set_error(2, "Index out of range: " .. index)
+            return ""
+        end
+        return item
+    end
+
     local current = 0
     local cmd
 
@@ -221,6 +610,9 @@ end
 
 function fileops_fileexists(path)
     clear_error()
+    if native then
+        return native.readable(path)
+    end
     local file = io.open(path, "r")
     if file then
         file:close()
@@ -232,6 +624,18 @@ end
 function fileops_filecopy(source, dest)
     clear_error()
 
+    if native then
+        local ok, failed = native.copy(source, dest)
+        if ok then
+            return true
+        elseif failed == 1 then
+            set_error(1, "Cannot open source file: " .. source)
+        else
+            set_error(2, "Cannot create destination file: " .. dest)
+        end
+        return false
+    end
+
     -- Read source file
     local src_file = io.open(source, "rb")
     if not src_file then
@@ -296,6 +700,14 @@ function fileops_filetouch(path)
         -- File exists, close and update modification time
         file:close()
 
+        if native then
+            if native.touch(path) then
+                return true
+            end
+            set_error(1, "Failed to update file timestamp: " .. path)
+            return false
+        end
+
         -- Use platform-specific touch command to update timestamp
         local cmd
         if is_windows then
@@ -327,6 +739,15 @@ end
 function fileops_filesize(path)
     clear_error()
 
+    if native then
+        local mode, size = native.stat(path)
+        if not mode then
+            set_error(1, "Cannot open file: " .. path)
+            return -1
+        end
+        return size
+    end
+
     local file = io.open(path, "rb")
     if not file then
         set_error(1, "Cannot open file: " .. path)
@@ -342,6 +763,15 @@ end
 function fileops_filemodtime(path)
     clear_error()
 
+    if native then
+        local mode, _, mtime = native.stat(path)
+        if not mode then
+            set_error(1, "Cannot get modification time: " .. path)
+            return -1
+        end
+        return mtime
+    end
+
     local cmd
     if is_windows then
         -- Windows: use forfiles or stat-like commands
@@ -491,13 +921,108 @@ end
 function fileops_patternmatch(filename, pattern)
     clear_error()
 
-    -- Convert glob pattern to Lua pattern
-    local lua_pattern = "^" .. pattern:gsub("[%(%)%.%%%+%-%[%]%^%$]", "%%%1")
-    lua_pattern = lua_pattern:gsub("%*", ".*")
-    lua_pattern = lua_pattern:gsub("%?", ".")
-    lua_pattern = lua_pattern .. "$"
+    return filename:match(glob_to_lua(pattern)) ~= nil
+end
 
-    return filename:match(lua_pattern) ~= nil
+-- =============================================================================
+-- Recursive Directory Walk
+-- =============================================================================
+-- fileops_dirwalk(path, array, pattern) appends the path of every file below
+-- `path` whose name matches `pattern` to `array`, starting at its first
+-- element, and returns the number of files found. A BASIC string array is a
+-- Lua table, so entries are written straight into it; without an array the
+-- results are kept for DIRWALKITEM$. Hidden entries are skipped and symbolic
+-- links to directories are not followed. Entries are produced in directory
+-- order, depth first.
+
+fileops.walk_results = {}
+
+local function native_walk(root, array, pattern)
+    local lua_pattern = pattern ~= "*" and glob_to_lua(pattern) or nil
+    local ffi_string = ffi.string
+    local count = 0
+    local pending = { (root:gsub("(.)/+$", "%1")) }
+    local dir
+
+    local function visit(name_ptr, d_type)
+        if name_ptr[0] == 46 then
+            return
+        end
+        local name = ffi_string(name_ptr)
+        local full = dir == "/" and ("/" .. name) or (dir .. "/" .. name)
+        local is_dir = d_type == DT_DIR
+        if d_type == DT_UNKNOWN then
+            is_dir = is_dir_mode((native.stat(full, true)))
+        end
+        if is_dir then
+            pending[#pending + 1] = full
+        elseif not lua_pattern or name:match(lua_pattern) then
+            count = count + 1
+            array[count] = full
+        end
+    end
+
+    while #pending > 0 do
+        dir = pending[#pending]
+        pending[#pending] = nil
+        native.each_entry(dir, visit)
+    end
+    return count
+end
+
+local function shell_walk(root, array, pattern)
+    local cmd
+    if is_windows then
+        cmd = 'dir /s /b /a-d "' .. root:gsub('/', '\\') .. '" 2>nul'
+    else
+        cmd = 'find "' .. root .. '" -type f ! -path "*/.*" 2>/dev/null'
+    end
+
+    local handle = io.popen(cmd)
+    if not handle then
+        return 0
+    end
+
+    local count = 0
+    for line in handle:lines() do
+        if pattern == "*" or fileops_patternmatch(fileops_pathbasename(line), pattern) then
+            count = count + 1
+            array[count] = line
+        end
+    end
+    handle:close()
+    return count
+end
+
+function fileops_dirwalk(path, array, pattern)
+    clear_error()
+    pattern = pattern or "*"
+
+    if not fileops_direxists(path) then
+        set_error(1, "Directory not found: " .. path)
+        return 0
+    end
+
+    if type(array) ~= "table" then
+        array = {}
+        fileops.walk_results = array
+    end
+
+    if native then
+        return native_walk(path, array, pattern)
+    end
+    return shell_walk(path, array, pattern)
+end
+
+function fileops_dirwalkitem(index)
+    clear_error()
+
+    local item = fileops.walk_results[index + 1]
+    if not item then
+        set_error(2, "Index out of range: " .. index)
+        return ""
+    end
+    return item
 end
 
 -- =============================================================================
@@ -536,6 +1061,15 @@ end
 function fileops_workdir()
     clear_error()
 
+    if native then
+        local cwd = native.getcwd()
+        if not cwd then
+            set_error(1, "Cannot get current directory")
+            return ""
+        end
+        return cwd
+    end
+
     local cmd
     if is_windows then
         cmd = "cd"
@@ -558,6 +1092,14 @@ end
 function fileops_changedir(path)
     clear_error()
 
+    if native then
+        if native.chdir(path) then
+            return true
+        end
+        set_error(1, "Cannot change directory: " .. path)
+        return false
+    end
+
     local cmd
     if is_windows then
         cmd = 'cd /d "' .. path:gsub('/', '\\') .. '" 2>nul && cd'
@@ -579,9 +1121,8 @@ function fileops_changedir(path)
         return false
     end
 
-    -- Actually change the Lua process directory
-    -- Note: This doesn't actually change the process directory in Lua 5.1
-    -- It only verifies the directory exists
+    -- Without FFI the process directory cannot be changed from Lua;
+    -- this only verifies the directory exists
     return true
 end
 
@@ -598,6 +1139,10 @@ function DIRLISTITEM_STRING(path, index, pattern)
     return fileops_dirlistitem(path, index, pattern)
 end
 
+function DIRWALKITEM_STRING(index)
+    return fileops_dirwalkitem(index)
+end
+
 function PATHBASENAME_STRING(path)
     return fileops_pathbasename(path)
 end
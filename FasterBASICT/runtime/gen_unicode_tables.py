@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+#
+# gen_unicode_tables.py
+# FasterBASIC - Generator for unicode_tables.h
+#
+# Builds the two-level property table used by unicode_runtime.cpp for case
+# mapping and character classification. Every codepoint maps, through a
+# deduplicated block table, to a small record holding its simple uppercase
+# and lowercase deltas, simplified category and flags.
+#
+# Usage:
+#   python3 gen_unicode_tables.py [UnicodeData.txt] > unicode_tables.h
+#
+# With UnicodeData.txt (from https://www.unicode.org/Public/UCD/latest/ucd/)
+# the simple case mappings come straight from fields 12 and 13. Without it,
+# the script falls back to Python's bundled unicodedata database.
+#
+
+import sys
+import unicodedata
+
+MAX_CODEPOINT = 0x110000
+SHIFT = 7
+BLOCK_SIZE = 1 << SHIFT
+
+# Simplified categories (must match unicode_category() in unicode_runtime.h)
+CAT_OTHER, CAT_LETTER, CAT_NUMBER, CAT_SPACE, CAT_PUNCT, CAT_SYMBOL = range(6)
+
+# Record flags
+FLAG_DIGIT = 0x01   # Nd: decimal digit
+FLAG_UPPER = 0x02   # Has a lowercase mapping (or is Lu)
+FLAG_LOWER = 0x04   # Has an uppercase mapping (or is Ll)
+
+# White_Space property (PropList.txt)
+WHITE_SPACE = set(range(0x09, 0x0E)) | {
+    0x20, 0x85, 0xA0, 0x1680, 0x2028, 0x2029, 0x202F, 0x205F, 0x3000,
+} | set(range(0x2000, 0x200B))
+
+
+def simplify_category(gc):
+    major = gc[0]
+    if major == 'L':
+        return CAT_LETTER
+    if major == 'N':
+        return CAT_NUMBER
+    if major == 'P':
+        return CAT_PUNCT
+    if major == 'S':
+        return CAT_SYMBOL
+    if gc in ('Zs', 'Zl', 'Zp'):
+        return CAT_SPACE
+    return CAT_OTHER
+
+
+def load_unicode_data(path):
+    """Return (version, {cp: (gc, upper, lower)}) from UnicodeData.txt."""
+    props = {}
+    range_start = None
+    with open(path, encoding='utf-8') as f:
+        for line in f:
+            fields = line.rstrip('\n').split(';')
+            cp = int(fields[0], 16)
+            name, gc = fields[1], fields[2]
+            upper = int(fields[12], 16) if fields[12] else cp
+            lower = int(fields[13], 16) if fields[13] else cp
+            if name.endswith(', First>'):
+                range_start = cp
+                continue
+            if name.endswith(', Last>'):
+                for c in range(range_start, cp + 1):
+                    props[c] = (gc, c, c)
+                range_start = None
+                continue
+            props[cp] = (gc, upper, lower)
+    return 'UnicodeData.txt', props
+
+
+def single_mapping(ch, full, fallback):
+    """Simple mapping from Python's full mapping: keep one-codepoint results."""
+    if len(full) == 1:
+        return ord(full)
+    # Characters like U+1F80 have a multi-codepoint full uppercase but a
+    # simple uppercase equal to their titlecase form
+    if fallback is not None and len(fallback) == 1 and fallback != ch:
+        return ord(fallback)
+    return ord(ch)
+
+
+def load_python_data():
+    props = {}
+    for cp in range(MAX_CODEPOINT):
+        ch = chr(cp)
+        gc = unicodedata.category(ch)
+        if gc == 'Cn':
+            continue
+        if 0xD800 <= cp <= 0xDFFF:
+            props[cp] = (gc, cp, cp)
+            continue
+        upper = single_mapping(ch, ch.upper(), ch.title())
+        lower = single_mapping(ch, ch.lower(), None)
+        props[cp] = (gc, upper, lower)
+    return unicodedata.unidata_version, props
+
+
+def build_records(props):
+    records = [(0, 0, CAT_OTHER, 0)]
+    record_index = {records[0]: 0}
+    values = []
+    for cp in range(MAX_CODEPOINT):
+        gc, upper, lower = props.get(cp, ('Cn', cp, cp))
+        category = CAT_SPACE if cp in WHITE_SPACE else simplify_category(gc)
+        flags = 0
+        if gc == 'Nd':
+            flags |= FLAG_DIGIT
+        if gc == 'Lu' or lower != cp:
+            flags |= FLAG_UPPER
+        if gc == 'Ll' or upper != cp:
+            flags |= FLAG_LOWER
+        record = (upper - cp, lower - cp, category, flags)
+        if record not in record_index:
+            record_index[record] = len(records)
+            records.append(record)
+        values.append(record_index[record])
+    return records, values
+
+
+def build_blocks(values):
+    stage1 = []
+    blocks = []
+    block_index = {}
+    for start in range(0, MAX_CODEPOINT, BLOCK_SIZE):
+        block = tuple(values[start:start + BLOCK_SIZE])
+        if block not in block_index:
+            block_index[block] = len(blocks)
+            blocks.append(block)
+        stage1.append(block_index[block])
+    return stage1, blocks
+
+
+def emit_array(out, ctype, name, items, per_line=16):
+    out.append('static const %s %s[%d] = {' % (ctype, name, len(items)))
+    for i in range(0, len(items), per_line):
+        chunk = ', '.join(str(v) for v in items[i:i + per_line])
+        out.append('    %s,' % chunk)
+    out.append('};')
+    out.append('')
+
+
+def main():
+    if len(sys.argv) > 1:
+        version, props = load_unicode_data(sys.argv[1])
+    else:
+        version, props = load_python_data()
+
+    records, values = build_records(props)
+    stage1, blocks = build_blocks(values)
+    record_type = 'uint8_t' if len(records) <= 256 else 'uint16_t'
+    block_type = 'uint8_t' if len(blocks) <= 256 else 'uint16_t'
+
+    out = []
+    out.append('//')
+    out.append('// unicode_tables.h')
+    out.append('// FasterBASIC - Unicode property tables')
+    out.append('//')
+    out.append('// GENERATED by gen_unicode_tables.py from Unicode %s - do not edit.' % version)
+    out.append('// Included only by unicode_runtime.cpp.')
+    out.append('//')
+    out.append('// Lookup: record = unicode_property_records[')
+    out.append('//     unicode_property_stage2[(unicode_property_stage1[cp >> %d] << %d) | (cp & %d)]]' %
+               (SHIFT, SHIFT, BLOCK_SIZE - 1))
+    out.append('//')
+    out.append('// %d records, %d distinct blocks of %d codepoints' %
+               (len(records), len(blocks), BLOCK_SIZE))
+    out.append('//')
+    out.append('')
+    out.append('#ifndef UNICODE_TABLES_H')
+    out.append('#define UNICODE_TABLES_H')
+    out.append('')
+    out.append('#include <cstdint>')
+    out.append('')
+    out.append('#define UNICODE_TABLES_VERSION "%s"' % version)
+    out.append('#define UNICODE_TABLE_SHIFT %d' % SHIFT)
+    out.append('#define UNICODE_TABLE_BLOCK_MASK %d' % (BLOCK_SIZE - 1))
+    out.append('')
+    out.append('#define UNICODE_FLAG_DIGIT 0x%02X' % FLAG_DIGIT)
+    out.append('#define UNICODE_FLAG_UPPER 0x%02X' % FLAG_UPPER)
+    out.append('#define UNICODE_FLAG_LOWER 0x%02X' % FLAG_LOWER)
+    out.append('')
+    out.append('struct UnicodePropertyRecord {')
+    out.append('    int32_t upper_delta;   // Simple uppercase mapping minus codepoint')
+    out.append('    int32_t lower_delta;   // Simple lowercase mapping minus codepoint')
+    out.append('    uint8_t category;      // Simplified category (see unicode_category)')
+    out.append('    uint8_t flags;         // UNICODE_FLAG_*')
+    out.append('};')
+    out.append('')
+    out.append('static const UnicodePropertyRecord unicode_property_records[%d] = {' % len(records))
+    for upper, lower, category, flags in records:
+        out.append('    {%d, %d, %d, 0x%02X},' % (upper, lower, category, flags))
+    out.append('};')
+    out.append('')
+    emit_array(out, block_type, 'unicode_property_stage1', stage1, per_line=32)
+    flat = [v for block in blocks for v in block]
+    emit_array(out, record_type, 'unicode_property_stage2', flat, per_line=32)
+    out.append('#endif // UNICODE_TABLES_H')
+
+    sys.stdout.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,92 @@
+-- number_format.lua
+-- Number/text conversion for PRINT, STR$, VAL and numeric INPUT
+-- Binds libbasic_number (basic_number.cpp) through the FFI: shortest
+-- round-trip formatting that prints exactly what tostring() prints, and a
+-- SWAR decimal parser for VAL. Without the library (or without the FFI)
+-- every function falls back to tostring/tonumber, so results never differ.
+
+local M = {}
+package.loaded['number_format'] = M
+
+local ffi_ok, ffi = pcall(require, 'ffi')
+
+local lib, load_error
+if ffi_ok then
+    ffi.cdef [[
+        size_t fb_num_format(double value, char* out);
+        int fb_num_parse(const char* text, size_t length, double* out);
+    ]]
+
+    -- Directories next to the fbc/fbsh executable come first (registered
+    -- by register_runtime_preload), then the current directory
+    local ext = ffi.os == "OSX" and ".dylib" or ".so"
+    local paths = {}
+    local dirs_ok, native_dirs = pcall(require, "runtime.native_dirs")
+    if dirs_ok and type(native_dirs) == "table" then
+        for _, dir in ipairs(native_dirs) do
+            paths[#paths + 1] = dir .. "libbasic_number" .. ext
+        end
+    end
+    paths[#paths + 1] = "./runtime/libbasic_number" .. ext
+    paths[#paths + 1] = "./libbasic_number" .. ext
+    paths[#paths + 1] = "libbasic_number" .. ext
+
+    -- The first failure that is not a missing file names the real problem
+    local missing_error
+    for _, path in ipairs(paths) do
+        local ok, loaded = pcall(ffi.load, path)
+        if ok then
+            lib = loaded
+            break
+        end
+        local message = tostring(loaded)
+        if message:find("No such file", 1, true) or message:find("not found", 1, true) then
+            missing_error = missing_error or message
+        else
+            load_error = load_error or message
+        end
+    end
+    load_error = load_error or missing_error
+end
+
+M.available = (lib ~= nil)
+
+local tostring, tonumber, type = tostring, tonumber, type
+
+if not M.available then
+    M.error = ffi_ok and ("Could not load libbasic_number library: " .. tostring(load_error)) or "FFI not available"
+
+    -- STR$ and PRINT text for a value
+    function M.str(value)
+        return tostring(value)
+    end
+
+    -- VAL: 0 for anything that is not a number
+    function M.val(text)
+        return tonumber(text) or 0
+    end
+
+    return M
+end
+
+-- FB_NUM_BUFFER_SIZE in basic_number.h
+local format_buffer = ffi.new('char[32]')
+local parse_result = ffi.new('double[1]')
+local ffi_string = ffi.string
+
+function M.str(value)
+    if type(value) ~= 'number' then
+        return tostring(value)
+    end
+    return ffi_string(format_buffer, lib.fb_num_format(value, format_buffer))
+end
+
+function M.val(text)
+    if type(text) == 'string' and lib.fb_num_parse(text, #text, parse_result) == 1 then
+        return parse_result[0]
+    end
+    -- Hex, inf/nan and non-numbers: tonumber decides
+    return tonumber(text) or 0
+end
+
+return M
@@ -0,0 +1,90 @@
+--
+-- number_format_bench.lua
+-- FasterBASIC - Throughput benchmark for number/text conversion
+--
+-- Times STR$, PRINT and VAL over integers, short decimals (the contents of
+-- typical numeric text files) and full-precision doubles, first through
+-- tostring/tonumber as generated code used to, then through libbasic_number.
+--
+-- Usage (from the directory containing runtime/):
+--   luajit runtime/number_format_bench.lua [conversions]
+--
+
+local nf = dofile('runtime/number_format.lua')
+if not nf.available then
+    error(nf.error or 'libbasic_number not available (run runtime/build_number_lib.sh)')
+end
+
+local conversions = tonumber(arg and arg[1]) or 5000000
+
+local SAMPLES = 4096
+math.randomseed(42)
+
+local sets = {}
+local function add_set(name, make)
+    local values, texts = {}, {}
+    for i = 1, SAMPLES do
+        values[i] = make(i)
+        texts[i] = tostring(values[i])
+    end
+    sets[#sets + 1] = { name = name, values = values, texts = texts }
+end
+add_set('integers', function() return math.random(-1000000, 1000000) end)
+add_set('decimals', function() return math.random(0, 9999999) / 100 end)
+add_set('doubles', function() return math.random() * 10 ^ math.random(-12, 12) end)
+
+local function time(fn, input)
+    collectgarbage()
+    local start = os.clock()
+    fn(input)
+    return os.clock() - start
+end
+
+local function str_loop(str)
+    return function(values)
+        local bytes = 0
+        for i = 1, conversions do
+            bytes = bytes + #str(values[i % SAMPLES + 1])
+        end
+        return bytes
+    end
+end
+
+local function print_loop(str)
+    return function(values)
+        local out = io.open('/dev/null', 'w')
+        for i = 1, conversions do
+            out:write(str(values[i % SAMPLES + 1]))
+        end
+        out:close()
+    end
+end
+
+local function val_loop(val)
+    return function(texts)
+        local sum = 0
+        for i = 1, conversions do
+            sum = sum + val(texts[i % SAMPLES + 1])
+        end
+        return sum
+    end
+end
+
+local function lua_val(text)
+    return tonumber(text) or 0
+end
+
+local function report(label, before, after)
+    print(string.format('  %-22s %8.3f s  %8.3f s   %6.1f M/s   %5.2fx',
+        label, before, after, conversions / after / 1e6, before / after))
+end
+
+print('Number Conversion Benchmark')
+print(string.format('  %d conversions per row; tostring/tonumber vs libbasic_number', conversions))
+print('')
+print(string.format('  %-22s %10s  %10s   %10s   %6s', '', 'Lua', 'native', 'native', 'speedup'))
+for _, set in ipairs(sets) do
+    report('STR$ ' .. set.name, time(str_loop(tostring), set.values), time(str_loop(nf.str), set.values))
+    report('PRINT ' .. set.name, time(print_loop(tostring), set.values), time(print_loop(nf.str), set.values))
+    report('VAL ' .. set.name, time(val_loop(lua_val), set.texts), time(val_loop(nf.val), set.texts))
+end
@@ -0,0 +1,169 @@
+--
+-- number_format_conformance.lua
+-- FasterBASIC - Conformance suite for the native number conversions
+--
+-- Checks libbasic_number against the output format BASIC programs have
+-- always had: STR$/PRINT must produce exactly tostring(x) ("%.14g") and VAL
+-- exactly tonumber(s) or 0, over special values, boundaries, rounding ties
+-- and a few million random bit patterns and decimal strings.
+--
+-- Usage (from the directory containing runtime/):
+--   luajit runtime/number_format_conformance.lua [random_cases]
+--
+
+local nf = dofile('runtime/number_format.lua')
+if not nf.available then
+    error(nf.error or 'libbasic_number not available (run runtime/build_number_lib.sh)')
+end
+
+local ffi = require('ffi')
+local bit = require('bit')
+
+local random_cases = tonumber(arg and arg[1]) or 1000000
+
+local failures = 0
+local checked = 0
+
+local function fail(kind, input, expected, actual)
+    failures = failures + 1
+    if failures <= 20 then
+        print(string.format('  FAIL %s %q: expected %q, got %q', kind, tostring(input),
+            tostring(expected), tostring(actual)))
+    end
+end
+
+-- LuaJIT's own %.14g misrounds the last digit of some values with very large
+-- or small exponents (never within 1e-20..1e20); the native output may differ
+-- there only by being the correctly rounded one, i.e. strictly closer to x
+local misrounded = 0
+
+local function check_str(x)
+    checked = checked + 1
+    local expected, actual = tostring(x), nf.str(x)
+    if actual ~= expected then
+        local a, e = tonumber(actual), tonumber(expected)
+        if a and e and math.abs(a - x) < math.abs(e - x) then
+            misrounded = misrounded + 1
+        else
+            fail('STR$', string.format('%.17g', x), expected, actual)
+        end
+    end
+end
+
+local function same_number(a, b)
+    if a ~= a then
+        return b ~= b
+    end
+    -- Distinguish -0 from 0
+    return a == b and (a ~= 0 or 1 / a == 1 / b)
+end
+
+local function check_val(s)
+    checked = checked + 1
+    local expected, actual = tonumber(s) or 0, nf.val(s)
+    if not same_number(expected, actual) then
+        fail('VAL', s, expected, actual)
+    end
+end
+
+local bits = ffi.new('union { double d; uint64_t u; int32_t w[2]; }')
+
+local function from_words(hi, lo)
+    bits.w[0], bits.w[1] = lo, hi
+    return bits.d
+end
+
+-- Special values and boundaries
+print('Special values and boundaries')
+local specials = {
+    0, -0.0, 1, -1, 0.1, 0.5, 1 / 3, 2 / 3, 0.3, 100, 1e14 - 1, 1e14, 1e14 + 1,
+    1e15, 2 ^ 53, 2 ^ 53 + 2, 2 ^ 63, 2 ^ 64, 1e21, 1e22, 1e23, 1e-4, 1e-5,
+    0.0001234, 0.00001234, 123456789012345, 12345678901234.5, 99999999999999.5,
+    9.9999999999999e-5, 0.99999999999999, 0.999999999999999, 9.99999999999995,
+    1.00000000000005, 5e-324, 2.2250738585072014e-308, 1.7976931348623157e308,
+    math.huge, -math.huge, 0 / 0, math.pi, -math.pi, math.exp(1), 1e300, 1e-300,
+}
+for _, x in ipairs(specials) do
+    check_str(x)
+    check_str(-x)
+    check_val(tostring(x))
+    check_val(string.format('%.17g', x))
+end
+
+-- Powers of ten and their neighbours
+print('Powers of ten')
+for e = -320, 308 do
+    local x = tonumber('1e' .. e)
+    check_str(x)
+    check_str(x * 3)
+    check_str(x * 0.7)
+    check_val('1e' .. e)
+    check_val('4.94e' .. e)
+end
+
+-- Integers around the fast path limit and digit-carry cases
+print('Integers and carries')
+for i = -1000, 1000 do
+    check_str(i)
+    check_str(1e14 + i)
+    check_str(2 ^ 53 + i * 2)
+    check_val(tostring(i))
+end
+for digits = 1, 17 do
+    local nines = string.rep('9', digits)
+    for _, s in ipairs({ nines, '0.' .. nines, nines .. '.5', '1.' .. nines .. '5' }) do
+        check_str(tonumber(s))
+        check_val(s)
+    end
+end
+
+-- Random bit patterns: every exponent, full mantissas. Exponent 0x7FF (NaN
+-- payloads) is skipped: LuaJIT would read those bits as tagged values
+print(string.format('Random doubles (%d)', random_cases))
+math.randomseed(20261017)
+for _ = 1, random_cases do
+    local hi = bit.tobit(math.random(0, 0x7FFFFFFF) * 2 + math.random(0, 1))
+    local lo = bit.tobit(math.random(0, 0x7FFFFFFF) * 2 + math.random(0, 1))
+    if bit.band(hi, 0x7FF00000) == 0x7FF00000 then
+        hi = bit.bxor(hi, 0x00100000)
+    end
+    local x = from_words(hi, lo)
+    check_str(x)
+    check_val(tostring(x))
+    check_val(string.format('%.17g', x))
+end
+
+-- Random short decimals, the usual contents of numeric text files
+print(string.format('Random decimals (%d)', random_cases))
+for _ = 1, random_cases do
+    local whole = math.random(0, 999999)
+    local frac = math.random(0, 99999)
+    local s = string.format('%d.%05d', whole, frac)
+    check_val(s)
+    check_val('-' .. s)
+    check_str(tonumber(s))
+    check_str(whole / 100)
+end
+
+-- VAL syntax: whitespace, signs, exponents and everything that is not a
+-- plain decimal (tonumber must decide those)
+print('VAL syntax')
+local texts = {
+    '', ' ', '.', '-', '+', '+5', '-5', ' 42 ', '\t7\n', '1.', '.5', '-.5', '1e5',
+    '1E5', '1e+5', '1e-5', '1e', '1e+', 'e5', '1.2.3', '12abc', 'abc', '0x10',
+    '0X1f', '-0x10', 'inf', '-inf', 'nan', 'infinity', '1_000', '1,000', '١',
+    '00000000000000000000000000001', '123456789012345678901234567890',
+    '0.000000000000000000000000000001', '1e400', '-1e400', '1e-400', '1e99999999',
+    '12345678', '123456789', '1234567890123456789', '12345678901234567890',
+    '9007199254740993', '0.1e1', '3.14159265358979323846', '1\0002',
+}
+for _, s in ipairs(texts) do
+    check_val(s)
+end
+
+print('')
+print(string.format('%d checks, %d failures', checked, failures))
+print(string.format('%d values correctly rounded where tostring() is not', misrounded))
+if failures > 0 then
+    os.exit(1)
+end
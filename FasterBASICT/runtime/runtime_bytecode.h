@@ -0,0 +1,33 @@
+//
+// runtime_bytecode.h
+// FasterBASIC - Runtime Lua modules embedded as LuaJIT bytecode
+//
+// The runtime modules that generated code require()s are compiled to
+// bytecode at build time by embed_runtime_bytecode and linked into fbc and
+// fbsh. register_runtime_preload() installs them as package.preload entries,
+// so require() never searches package.path or parses Lua source, whatever
+// the current directory.
+//
+
+#ifndef RUNTIME_BYTECODE_H
+#define RUNTIME_BYTECODE_H
+
+#include <cstddef>
+
+struct lua_State;
+
+struct RuntimeModule {
+    const char* name;               // require() name, e.g. "runtime.string_functions"
+    const unsigned char* bytecode;  // lua_dump() output
+    size_t size;
+};
+
+// Defined in the generated runtime_bytecode.cpp
+extern const RuntimeModule fb_runtime_modules[];
+extern const size_t fb_runtime_module_count;
+
+// Install every embedded module in package.preload, and record the
+// executable's directories in package.loaded["runtime.native_dirs"]
+extern "C" void register_runtime_preload(lua_State* L);
+
+#endif // RUNTIME_BYTECODE_H
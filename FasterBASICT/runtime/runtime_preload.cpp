@@ -0,0 +1,85 @@
+//
+// runtime_preload.cpp
+// FasterBASIC - package.preload loaders for the embedded runtime modules
+//
+// See runtime_bytecode.h. Each loader loads its module's bytecode from the
+// executable image and runs it like require() would run the source file.
+//
+
+#include "runtime_bytecode.h"
+
+#include <string>
+#include <climits>
+#include <cstdlib>
+#include <cstdint>
+
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#else
+#include <unistd.h>
+#endif
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+// Directory holding the running fbc/fbsh binary, or "" if unknown
+static std::string executable_dir() {
+    char path[PATH_MAX];
+#ifdef __APPLE__
+    uint32_t size = sizeof(path);
+    if (_NSGetExecutablePath(path, &size) != 0) return "";
+    char resolved[PATH_MAX];
+    std::string exe = realpath(path, resolved) ? resolved : path;
+#else
+    ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (len <= 0) return "";
+    std::string exe(path, static_cast<size_t>(len));
+#endif
+    size_t slash = exe.rfind('/');
+    return slash == std::string::npos ? "" : exe.substr(0, slash);
+}
+
+// package.preload loader: upvalue 1 is the RuntimeModule to load
+static int lua_load_runtime_module(lua_State* L) {
+    const RuntimeModule* module =
+        static_cast<const RuntimeModule*>(lua_touserdata(L, lua_upvalueindex(1)));
+    if (luaL_loadbuffer(L, reinterpret_cast<const char*>(module->bytecode), module->size,
+                        module->name) != 0) {
+        return lua_error(L);
+    }
+    lua_pushstring(L, module->name);
+    lua_call(L, 1, 1);
+    return 1;
+}
+
+extern "C" void register_runtime_preload(lua_State* L) {
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "preload");
+    for (size_t i = 0; i < fb_runtime_module_count; i++) {
+        const RuntimeModule* module = &fb_runtime_modules[i];
+        lua_pushlightuserdata(L, const_cast<RuntimeModule*>(module));
+        lua_pushcclosure(L, lua_load_runtime_module, 1);
+        lua_setfield(L, -2, module->name);
+    }
+    lua_pop(L, 1);
+
+    // package.loaded["runtime.native_dirs"]: where the modules that bind a
+    // native library (libunicode_string, libbasic_number) look before the
+    // current directory, so programs run from anywhere find the libraries
+    // the build put beside the executable
+    lua_getfield(L, -1, "loaded");
+    lua_newtable(L);
+    std::string dir = executable_dir();
+    if (!dir.empty()) {
+        const char* subdirs[] = {"/runtime/", "/FasterBASICT/runtime/", "/"};
+        for (int i = 0; i < 3; i++) {
+            std::string entry = dir + subdirs[i];
+            lua_pushstring(L, entry.c_str());
+            lua_rawseti(L, -2, i + 1);
+        }
+    }
+    lua_setfield(L, -2, "runtime.native_dirs");
+    lua_pop(L, 2);
+}
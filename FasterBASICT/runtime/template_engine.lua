@@ -324,27 +324,325 @@ function M.execute_node(ctx, node, output)
     end
 end
 
--- Execute a template string against a context
-function M.execute(ctx, template_str)
-    -- Parse template
+-- =============================================================================
+-- Template Compilation
+-- =============================================================================
+--
+-- Templates are compiled once into Lua functions and cached by content, so
+-- rendering the same template again costs one table lookup instead of a
+-- tokenize + parse + AST walk. The generated function:
+--   * resolves every referenced variable once per render into a local
+--     (records and scalars do not change while a template is rendering),
+--   * keeps FOR / FOR EACH loop variables in Lua locals instead of writing
+--     them into ctx.vars (unless the loop body INCLUDEs another template,
+--     which can only see the loop variable through the context),
+--   * appends every piece to a single output buffer.
+-- The behaviour matches execute_node exactly, including its condition rules.
+
+-- Maximum number of variables hoisted into locals (Lua allows 200 per function)
+local MAX_HOISTED = 120
+
+-- Compiled templates keyed by template text (LuaJIT interns strings, so the
+-- lookup hashes the content once and compares by pointer)
+local compiled_cache = {}
+local compiled_count = 0
+local COMPILED_CACHE_MAX = 256
+
+-- Runtime helpers shared by all compiled templates
+local function unquote(str)
+    return str:match('^"(.-)"$') or str:match("^'(.-)'$") or str
+end
+
+local function truthy(value)
+    return not (value == "" or value == "0" or value == "false" or value == "nil")
+end
+
+local function compare_numbers(op, left, right)
+    left, right = tonumber(left), tonumber(right)
+    if not (left and right) then
+        return left and right
+    end
+    if op == "<" then
+        return left < right
+    elseif op == ">" then
+        return left > right
+    elseif op == "<=" then
+        return left <= right
+    end
+    return left >= right
+end
+
+local function render_include(ctx, filename)
+    local success, included_content = pcall(function()
+        local file = io.open(filename, "r")
+        if not file then
+            return "<!-- Error: Could not open " .. filename .. " -->"
+        end
+        local content = file:read("*all")
+        file:close()
+
+        local render, err = M.compile(content)
+        if not render then
+            return "<!-- Error parsing " .. filename .. ": " .. err .. " -->"
+        end
+        return render(ctx)
+    end)
+
+    if success then
+        return included_content
+    end
+    return "<!-- Error including " .. filename .. " -->"
+end
+
+-- Does any node in a block INCLUDE another template?
+local function block_includes(block)
+    for _, node in ipairs(block) do
+        if node.type == "INCLUDE" then
+            return true
+        elseif node.type == "IF" then
+            if block_includes(node.then_block) or (node.else_block and block_includes(node.else_block)) then
+                return true
+            end
+        elseif node.type == "FOR_EACH" or node.type == "FOR" then
+            if block_includes(node.body) then
+                return true
+            end
+        end
+    end
+    return false
+end
+
+-- Generate Lua source for a parsed template
+function M.generate(ast)
+    local body = {}
+    local hoisted = {}    -- variable name -> local name
+    local hoist_lines = {}
+    local hoist_count = 0
+    local scopes = {}     -- loop variable scopes, innermost last
+    local temp_count = 0
+    local indent = "    "
+
+    local function emit(line)
+        body[#body + 1] = indent .. line
+    end
+
+    local function temp(prefix)
+        temp_count = temp_count + 1
+        return prefix .. temp_count
+    end
+
+    -- Lua expression yielding the resolved string value of a template name
+    local function resolve(name)
+        if not name:find(".", 1, true) then
+            for i = #scopes, 1, -1 do
+                if scopes[i].name == name then
+                    return scopes[i].slot
+                end
+            end
+        end
+
+        if hoisted[name] then
+            return hoisted[name]
+        end
+
+        local expr
+        if name:find(".", 1, true) then
+            expr = string.format("resolve_variable(ctx, %q)", name)
+        else
+            expr = string.format("tostring(vars[%q] or \"\")", name)
+        end
+
+        if hoist_count >= MAX_HOISTED then
+            return expr
+        end
+
+        hoist_count = hoist_count + 1
+        local slot = "v" .. hoist_count
+        hoisted[name] = slot
+        hoist_lines[#hoist_lines + 1] = "    local " .. slot .. " = " .. expr
+        return slot
+    end
+
+    -- Lua expression for an IF condition, following evaluate_condition
+    local function condition(cond)
+        cond = cond:match("^%s*(.-)%s*$")
+
+        if cond:match("==") or cond:match("!=") or cond:match("<=") or
+            cond:match(">=") or cond:match("<") or cond:match(">") then
+            local left, op, right = cond:match("^(.-)%s*([=!<>]+)%s*(.-)$")
+            if left and op and right then
+                local left_expr = resolve(left)
+                local right_expr = "unquote(" .. resolve(right) .. ")"
+                if op == "==" or op == "=" then
+                    return left_expr .. " == " .. right_expr
+                elseif op == "!=" or op == "<>" then
+                    return left_expr .. " ~= " .. right_expr
+                elseif op == "<" or op == ">" or op == "<=" or op == ">=" then
+                    return string.format("compare_numbers(%q, %s, %s)", op, left_expr, right_expr)
+                end
+            end
+        end
+
+        return "truthy(" .. resolve(cond) .. ")"
+    end
+
+    local gen_block
+
+    -- Loop body with the loop variable bound to a local; the context copy is
+    -- only kept up to date when an INCLUDE inside the body can observe it
+    local function gen_loop(node, header, value_expr)
+        local publish = block_includes(node.body)
+        local old = temp("o")
+        if publish then
+            emit(string.format("local %s = vars[%q]", old, node.var))
+        end
+        emit(header)
+        indent = indent .. "    "
+        local slot = temp("l")
+        emit("local " .. slot .. " = " .. value_expr)
+        if publish then
+            emit(string.format("vars[%q] = %s", node.var, slot))
+        end
+        indent = indent:sub(5)
+        scopes[#scopes + 1] = { name = node.var, slot = slot }
+        gen_block(node.body)
+        scopes[#scopes] = nil
+        emit("end")
+        if publish then
+            emit(string.format("vars[%q] = %s", node.var, old))
+        end
+    end
+
+    local function gen_node(node)
+        if node.type == "TEXT" then
+            emit(string.format("n = n + 1; buf[n] = %q", node.value))
+        elseif node.type == "VAR" then
+            emit("n = n + 1; buf[n] = " .. resolve(node.name))
+        elseif node.type == "IF" then
+            emit("if " .. condition(node.condition) .. " then")
+            gen_block(node.then_block)
+            if node.else_block then
+                emit("else")
+                gen_block(node.else_block)
+            end
+            emit("end")
+        elseif node.type == "FOR_EACH" then
+            local array, i = temp("a"), temp("i")
+            emit(string.format("local %s = arrays[%q]", array, node.array))
+            emit("if " .. array .. " then")
+            indent = indent .. "    "
+            gen_loop(node, string.format("for %s = 1, #%s do", i, array),
+                string.format("tostring(%s[%s])", array, i))
+            indent = indent:sub(5)
+            emit("end")
+        elseif node.type == "FOR" then
+            local i = temp("i")
+            gen_loop(node, string.format("for %s = tonumber(%s) or tonumber(%q) or 1, tonumber(%s) or tonumber(%q) or 10 do",
+                    i, resolve(node.start), node.start, resolve(node.finish), node.finish),
+                "tostring(" .. i .. ")")
+        elseif node.type == "INCLUDE" then
+            emit(string.format("n = n + 1; buf[n] = render_include(ctx, %q)", node.filename))
+        end
+    end
+
+    -- Each block is its own Lua scope so loop temporaries do not accumulate
+    gen_block = function(block)
+        indent = indent .. "    "
+        local i = 1
+        while i <= #block do
+            local node = block[i]
+            if node.type == "TEXT" and block[i + 1] and block[i + 1].type == "TEXT" then
+                -- Merge adjacent text (e.g. around REM directives) into one piece
+                local pieces = { node.value }
+                while block[i + 1] and block[i + 1].type == "TEXT" do
+                    i = i + 1
+                    pieces[#pieces + 1] = block[i].value
+                end
+                gen_node({ type = "TEXT", value = table.concat(pieces) })
+            elseif node.type == "FOR_EACH" or node.type == "FOR" then
+                emit("do")
+                indent = indent .. "    "
+                gen_node(node)
+                indent = indent:sub(5)
+                emit("end")
+            else
+                gen_node(node)
+            end
+            i = i + 1
+        end
+        indent = indent:sub(5)
+    end
+
+    indent = ""
+    gen_block(ast.children)
+
+    local source = {
+        "local tostring, tonumber, resolve_variable, unquote, truthy, compare_numbers, render_include = ...",
+        "local concat = table.concat",
+        "return function(ctx)",
+        "    local vars, arrays = ctx.vars, ctx.arrays",
+    }
+    for _, line in ipairs(hoist_lines) do
+        source[#source + 1] = line
+    end
+    source[#source + 1] = "    local buf, n = {}, 0"
+    for _, line in ipairs(body) do
+        source[#source + 1] = line
+    end
+    source[#source + 1] = "    return concat(buf, \"\", 1, n)"
+    source[#source + 1] = "end"
+    return table.concat(source, "\n")
+end
+
+-- Compile a template string into a render function (ctx -> string), cached by content
+function M.compile(template_str)
+    local render = compiled_cache[template_str]
+    if render then
+        return render
+    end
+
     local p = get_parser()
     local tokens = p.tokenize(template_str)
     local ast, err = p.parse(tokens)
-
     if not ast then
+        return nil, err
+    end
+
+    local chunk, load_err = load(M.generate(ast), "=template")
+    if not chunk then
+        return nil, "Template compilation failed: " .. tostring(load_err)
+    end
+    render = chunk(tostring, tonumber, M.resolve_variable, unquote, truthy, compare_numbers, render_include)
+
+    if compiled_count >= COMPILED_CACHE_MAX then
+        compiled_cache = {}
+        compiled_count = 0
+    end
+    compiled_cache[template_str] = render
+    compiled_count = compiled_count + 1
+    return render
+end
+
+-- Drop all compiled templates
+function M.clear_cache()
+    compiled_cache = {}
+    compiled_count = 0
+end
+
+-- Execute a template string against a context
+function M.execute(ctx, template_str)
+    local render, err = M.compile(template_str)
+
+    if not render then
         ctx.error_msg = err
         ctx.error_code = 2
         return nil, err
     end
 
-    -- Execute AST
-    local output = {}
-    local success, exec_err = pcall(function()
-        M.execute_node(ctx, ast, output)
-    end)
+    local success, result = pcall(render, ctx)
 
     if not success then
-        ctx.error_msg = "Runtime error: " .. tostring(exec_err)
+        ctx.error_msg = "Runtime error: " .. tostring(result)
         ctx.error_code = 3
         return nil, ctx.error_msg
     end
@@ -352,7 +650,7 @@ function M.execute(ctx, template_str)
     ctx.error_code = 0
     ctx.error_msg = nil
 
-    return table.concat(output)
+    return result
 end
 
 -- =============================================================================
@@ -26,21 +26,33 @@ function M.tokenize(template)
     local len = #template
 
     while pos <= len do
-        -- Check for variable substitution {{...}}
-        local var_start, var_end = template:find("{{", pos, true)
-        if var_start then
-            -- Add any text before the variable
-            if var_start > pos then
-                table.insert(tokens, {
-                    type = TOKEN_TEXT,
-                    value = template:sub(pos, var_start - 1)
-                })
-            end
+        -- Find the next special sequence: {{variable}} or <%directive%>
+        local var_start = template:find("{{", pos, true)
+        local dir_start = template:find("<%", pos, true)
+        local next_pos = len + 1
+
+        if var_start and (not dir_start or var_start < dir_start) then
+            next_pos = var_start
+        elseif dir_start then
+            next_pos = dir_start
+        end
+
+        -- Add any text before it
+        if next_pos > pos then
+            table.insert(tokens, {
+                type = TOKEN_TEXT,
+                value = template:sub(pos, next_pos - 1)
+            })
+            pos = next_pos
+        end
 
+        if pos > len then
+            break
+        elseif next_pos == var_start then
             -- Find the closing }}
-            local close_start, close_end = template:find("}}", var_end + 1, true)
+            local close_start, close_end = template:find("}}", pos + 2, true)
             if close_start then
-                local var_name = template:sub(var_end + 1, close_start - 1)
+                local var_name = template:sub(pos + 2, close_start - 1)
                 -- Trim whitespace
                 var_name = var_name:match("^%s*(.-)%s*$")
                 table.insert(tokens, {
@@ -52,12 +64,11 @@ function M.tokenize(template)
                 -- No closing }}, treat as text
                 table.insert(tokens, {
                     type = TOKEN_TEXT,
-                    value = template:sub(var_start, var_start + 1)
+                    value = "{{"
                 })
-                pos = var_end + 1
+                pos = pos + 2
             end
-            -- Check for directive <%...%>
-        elseif template:sub(pos, pos + 1) == "<%" then
+        else
             -- Find the closing %>
             local close_start, close_end = template:find("%>", pos + 2, true)
             if close_start then
@@ -78,23 +89,6 @@ function M.tokenize(template)
                 })
                 pos = pos + 2
             end
-        else
-            -- Regular text - find next special sequence or end
-            local next_var = template:find("{{", pos, true)
-            local next_dir = template:find("<%", pos, true)
-            local next_pos = len + 1
-
-            if next_var and (not next_dir or next_var < next_dir) then
-                next_pos = next_var
-            elseif next_dir then
-                next_pos = next_dir
-            end
-
-            table.insert(tokens, {
-                type = TOKEN_TEXT,
-                value = template:sub(pos, next_pos - 1)
-            })
-            pos = next_pos
         end
     end
 
@@ -123,8 +117,9 @@ function M.parse(tokens)
         children = {}
     }
 
+    -- Open blocks: each frame collects children for the innermost block
     local pos = 1
-    local stack = { ast }
+    local stack = { { kind = "ROOT", children = ast.children } }
 
     while pos <= #tokens do
         local token = tokens[pos]
@@ -160,32 +155,27 @@ function M.parse(tokens)
                     line = token.line
                 }
                 table.insert(current.children, if_node)
-                table.insert(stack, if_node.then_block)
+                table.insert(stack, { kind = "IF", node = if_node, children = if_node.then_block })
                 pos = pos + 1
 
                 -- Parse ELSE directive
             elseif directive == "ELSE" then
-                -- Pop current block (should be then_block)
-                table.remove(stack)
-                -- Current should now be the IF node's parent
-                local parent = stack[#stack]
-                if #parent.children > 0 and parent.children[#parent.children].type == "IF" then
-                    local if_node = parent.children[#parent.children]
-                    if_node.else_block = {}
-                    table.insert(stack, if_node.else_block)
-                else
+                -- Current block must be the THEN branch of an IF
+                if current.kind ~= "IF" then
                     return nil, "ELSE without matching IF at line " .. (token.line or "?")
                 end
+                local if_node = current.node
+                if_node.else_block = {}
+                stack[#stack] = { kind = "ELSE", node = if_node, children = if_node.else_block }
                 pos = pos + 1
 
                 -- Parse END IF directive
             elseif directive == "END IF" or directive == "ENDIF" then
-                -- Pop current block
-                table.remove(stack)
-                -- If we were in else_block, we're done; if in then_block without else, also done
-                if #stack == 0 then
+                -- Pop the THEN or ELSE branch
+                if current.kind ~= "IF" and current.kind ~= "ELSE" then
                     return nil, "END IF without matching IF at line " .. (token.line or "?")
                 end
+                table.remove(stack)
                 pos = pos + 1
 
                 -- Parse FOR EACH directive
@@ -203,7 +193,7 @@ function M.parse(tokens)
                     line = token.line
                 }
                 table.insert(current.children, for_node)
-                table.insert(stack, for_node.body)
+                table.insert(stack, { kind = "FOR", node = for_node, children = for_node.body })
                 pos = pos + 1
 
                 -- Parse numeric FOR directive
@@ -222,16 +212,16 @@ function M.parse(tokens)
                     line = token.line
                 }
                 table.insert(current.children, for_node)
-                table.insert(stack, for_node.body)
+                table.insert(stack, { kind = "FOR", node = for_node, children = for_node.body })
                 pos = pos + 1
 
                 -- Parse NEXT directive
             elseif directive:match("^NEXT") then
                 -- Pop the FOR/FOR EACH body
-                table.remove(stack)
-                if #stack == 0 then
+                if current.kind ~= "FOR" then
                     return nil, "NEXT without matching FOR at line " .. (token.line or "?")
                 end
+                table.remove(stack)
                 pos = pos + 1
 
                 -- Parse REM (comment) directive
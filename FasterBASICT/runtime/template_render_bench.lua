@@ -0,0 +1,102 @@
+--
+-- template_render_bench.lua
+-- FasterBASIC - Render throughput benchmark for the template plugin
+--
+-- Renders the same report template many times, first through the AST
+-- interpreter (tokenize + parse + execute_node on every render, as the
+-- engine used to do) and then through the compiled, cached render function
+-- behind template_engine.execute. Both outputs are compared before timing.
+--
+-- Usage (from the directory containing runtime/):
+--   luajit runtime/template_render_bench.lua [renders] [rows]
+--
+
+dofile('runtime/template_parser.lua')
+local engine = dofile('runtime/template_engine.lua')
+local parser = package.loaded['template_parser']
+
+local renders = tonumber(arg and arg[1]) or 20000
+local rows = tonumber(arg and arg[2]) or 20
+
+local template = [[
+<html><head><title>{{TITLE}}</title></head>
+<body>
+<%REM report header%>
+<h1>{{TITLE}}</h1>
+<p>Prepared by {{AUTHOR.NAME}} ({{AUTHOR.EMAIL}}) on {{DATE}}</p>
+<%IF SHOWSUMMARY%>
+<p class="summary">{{SUMMARY}}</p>
+<%ELSE%>
+<p>No summary.</p>
+<%END IF%>
+<%IF STATUS == "ok"%><p>Status: {{STATUS}}</p><%END IF%>
+<%IF COUNT > 10%><p>Large report: {{COUNT}} rows</p><%END IF%>
+<table>
+<%FOR EACH ROW IN ROWS%>
+<tr><td>{{ROW}}</td><td>{{CURRENCY}}</td><%IF ROW == HIGHLIGHT%><td>*</td><%END IF%></tr>
+<%NEXT%>
+</table>
+<ol>
+<%FOR I = 1 TO COUNT%><li>{{I}}</li><%NEXT%>
+</ol>
+</body></html>
+]]
+
+local function make_context()
+    local ctx = engine.create_context()
+    engine.set_variable(ctx, "TITLE", "Quarterly <Sales> & Returns")
+    engine.set_variable(ctx, "DATE", "2026-10-17")
+    engine.set_variable(ctx, "SHOWSUMMARY", "1")
+    engine.set_variable(ctx, "SUMMARY", "Revenue up 4% on last quarter")
+    engine.set_variable(ctx, "STATUS", "ok")
+    engine.set_variable(ctx, "COUNT", tostring(rows))
+    engine.set_variable(ctx, "CURRENCY", "EUR")
+    engine.set_variable(ctx, "HIGHLIGHT", "item 3")
+    engine.begin_record(ctx, "AUTHOR")
+    engine.add_record_field(ctx, "NAME", "Ada")
+    engine.add_record_field(ctx, "EMAIL", "ada@example.com")
+    engine.end_record(ctx)
+    local list = {}
+    for i = 1, rows do
+        list[i] = "item " .. i
+    end
+    engine.set_array(ctx, "ROWS", list)
+    return ctx
+end
+
+-- The pre-compilation engine: re-tokenize, re-parse and walk the AST
+local function interpret(ctx, str)
+    local ast, err = parser.parse(parser.tokenize(str))
+    if not ast then
+        return nil, err
+    end
+    local output = {}
+    engine.execute_node(ctx, ast, output)
+    return table.concat(output)
+end
+
+local function bench(label, render, ctx)
+    collectgarbage()
+    local bytes = 0
+    local start = os.clock()
+    for _ = 1, renders do
+        bytes = bytes + #render(ctx, template)
+    end
+    local elapsed = os.clock() - start
+    print(string.format('  %-26s %8.3f s   %9.0f renders/s   %7.1f MB/s',
+        label, elapsed, renders / elapsed, bytes / elapsed / (1024 * 1024)))
+    return elapsed
+end
+
+local ctx = make_context()
+local expected = assert(interpret(ctx, template))
+local actual = assert(engine.execute(ctx, template))
+assert(actual == expected, 'compiled template output differs from interpreter')
+
+print('Template Render Benchmark')
+print(string.format('  %d renders, %d rows, %d bytes per render', renders, rows, #expected))
+print('')
+
+local interpreted = bench('interpret (parse each time)', interpret, ctx)
+local compiled = bench('compiled + cached', engine.execute, ctx)
+print(string.format('  speedup %.1fx', interpreted / compiled))
@@ -5,354 +5,292 @@
 // Provides Lua C API wrappers for Unicode functions
 // These can be injected directly into the Lua state without FFI
 //
+// Unicode strings are contiguous codepoint buffers held in full userdata:
+// an int32_t length header followed by the UTF-32 codepoints. Every
+// operation is a single allocation plus memcpy (or a vectorized scan for
+// searches), and LuaJIT FFI code can view the same memory directly:
+//
+//   ffi.cdef "typedef struct { int32_t length; int32_t data[?]; } UnicodeBuffer;"
+//   local buf = ffi.cast("UnicodeBuffer*", s)
+//
+// Lua strings are accepted anywhere a Unicode string is expected and are
+// decoded from UTF-8 on the fly.
+//
 
 #include "unicode_runtime.h"
 #include <cstring>
 #include <cstdlib>
+#include <cstddef>
 
 extern "C" {
 #include <lua.h>
 #include <lauxlib.h>
 }
 
+// =============================================================================
+// Codepoint Buffers
+// =============================================================================
+
+#define UNICODE_BUFFER_MT "FasterBASIC.UnicodeBuffer"
+
+struct UnicodeBuffer {
+    int32_t length;
+    int32_t data[1];  // Flexible: length codepoints follow the header
+};
+
+static inline size_t buffer_size(int32_t len) {
+    return offsetof(UnicodeBuffer, data) + (size_t)(len > 0 ? len : 0) * sizeof(int32_t);
+}
+
+// Push a new uninitialized buffer of len codepoints
+static UnicodeBuffer* push_buffer(lua_State* L, int32_t len) {
+    if (len < 0) len = 0;
+    UnicodeBuffer* buf = (UnicodeBuffer*)lua_newuserdata(L, buffer_size(len));
+    buf->length = len;
+    luaL_getmetatable(L, UNICODE_BUFFER_MT);
+    lua_setmetatable(L, -2);
+    return buf;
+}
+
+// Push a buffer holding a copy of len codepoints
+static UnicodeBuffer* push_copy(lua_State* L, const int32_t* codepoints, int32_t len) {
+    UnicodeBuffer* buf = push_buffer(L, len);
+    if (buf->length > 0) {
+        memcpy(buf->data, codepoints, (size_t)buf->length * sizeof(int32_t));
+    }
+    return buf;
+}
+
+// Push a buffer decoded from UTF-8
+static UnicodeBuffer* push_utf8(lua_State* L, const char* utf8, size_t byte_len) {
+    size_t count = unicode_utf8_count(utf8, byte_len);
+    UnicodeBuffer* buf = push_buffer(L, (int32_t)count);
+    unicode_utf8_decode_into(utf8, byte_len, buf->data);
+    return buf;
+}
+
+// Get the buffer at idx, decoding a Lua string in place if necessary
+static UnicodeBuffer* check_buffer(lua_State* L, int idx) {
+    UnicodeBuffer* buf = (UnicodeBuffer*)lua_touserdata(L, idx);
+    if (buf && lua_getmetatable(L, idx)) {
+        luaL_getmetatable(L, UNICODE_BUFFER_MT);
+        int same = lua_rawequal(L, -1, -2);
+        lua_pop(L, 2);
+        if (same) {
+            return buf;
+        }
+    }
+
+    if (lua_type(L, idx) == LUA_TSTRING || lua_type(L, idx) == LUA_TNUMBER) {
+        if (idx < 0) idx = lua_gettop(L) + idx + 1;
+        size_t byte_len;
+        const char* utf8 = lua_tolstring(L, idx, &byte_len);
+        buf = push_utf8(L, utf8, byte_len);
+        lua_replace(L, idx);  // Keep the decoded buffer anchored on the stack
+        return buf;
+    }
+
+    luaL_typerror(L, idx, "unicode string");
+    return nullptr;
+}
+
+// Clamp a Lua count argument to [0, max]
+static inline int32_t clamp_count(lua_Integer n, int32_t max) {
+    if (n <= 0) return 0;
+    return n > max ? max : (int32_t)n;
+}
+
 // =============================================================================
 // Lua C API Wrapper Functions
 // =============================================================================
 
-// unicode.from_utf8(utf8_string) -> table of codepoints
+// unicode.from_utf8(utf8_string) -> buffer
 static int lua_unicode_from_utf8(lua_State* L) {
-    // Get UTF-8 string argument
     size_t len;
     const char* utf8_str = luaL_checklstring(L, 1, &len);
-    
-    // Convert to codepoints
-    int32_t out_len;
-    int32_t* codepoints = unicode_from_utf8(utf8_str, &out_len);
-    
-    if (!codepoints) {
-        lua_pushnil(L);
-        lua_pushstring(L, "Failed to convert UTF-8 to codepoints");
-        return 2;
-    }
-    
-    // Create Lua table
-    lua_createtable(L, out_len, 0);
-    
-    for (int32_t i = 0; i < out_len; i++) {
-        lua_pushinteger(L, codepoints[i]);
-        lua_rawseti(L, -2, i + 1);  // Lua uses 1-based indexing
-    }
-    
-    // Free the C array
-    unicode_free(codepoints);
-    
-    return 1;  // Return the table
+    push_utf8(L, utf8_str, len);
+    return 1;
 }
 
-// unicode.to_utf8(codepoint_table) -> utf8_string
+// unicode.to_utf8(buffer) -> utf8_string
 static int lua_unicode_to_utf8(lua_State* L) {
-    // Check that argument is a table
-    luaL_checktype(L, 1, LUA_TTABLE);
-    
-    // Get table length
-    int32_t len = (int32_t)lua_objlen(L, 1);
-    
-    if (len == 0) {
-        lua_pushstring(L, "");
+    const UnicodeBuffer* buf = check_buffer(L, 1);
+
+    size_t size = unicode_utf8_encoded_size(buf->data, (size_t)buf->length);
+    if (size == 0) {
+        lua_pushliteral(L, "");
         return 1;
     }
-    
-    // Allocate array for codepoints
-    int32_t* codepoints = (int32_t*)malloc(len * sizeof(int32_t));
-    if (!codepoints) {
-        return luaL_error(L, "Memory allocation failed");
-    }
-    
-    // Extract codepoints from table
-    for (int32_t i = 0; i < len; i++) {
-        lua_rawgeti(L, 1, i + 1);  // Lua uses 1-based indexing
-        codepoints[i] = (int32_t)lua_tointeger(L, -1);
-        lua_pop(L, 1);
-    }
-    
-    // Convert to UTF-8
-    int32_t utf8_len;
-    char* utf8_str = unicode_to_utf8(codepoints, len, &utf8_len);
-    
-    free(codepoints);
-    
-    if (!utf8_str) {
-        return luaL_error(L, "Failed to convert codepoints to UTF-8");
-    }
-    
-    // Push UTF-8 string to Lua
-    lua_pushlstring(L, utf8_str, utf8_len);
-    
-    // Free the C string
-    unicode_free(utf8_str);
-    
+
+    // Encode straight into Lua-owned scratch memory, then intern
+    char* scratch = (char*)lua_newuserdata(L, size);
+    unicode_utf8_encode_into(buf->data, (size_t)buf->length, scratch);
+    lua_pushlstring(L, scratch, size);
     return 1;
 }
 
-// unicode.upper(codepoint_table) -> uppercase_table
-static int lua_unicode_upper(lua_State* L) {
+// unicode.from_table(codepoint_table) -> buffer
+static int lua_unicode_from_table(lua_State* L) {
     luaL_checktype(L, 1, LUA_TTABLE);
-    
     int32_t len = (int32_t)lua_objlen(L, 1);
-    
-    if (len == 0) {
-        lua_newtable(L);
-        return 1;
-    }
-    
-    // Allocate and extract codepoints
-    int32_t* codepoints = (int32_t*)malloc(len * sizeof(int32_t));
-    if (!codepoints) {
-        return luaL_error(L, "Memory allocation failed");
-    }
-    
+    UnicodeBuffer* buf = push_buffer(L, len);
     for (int32_t i = 0; i < len; i++) {
         lua_rawgeti(L, 1, i + 1);
-        codepoints[i] = (int32_t)lua_tointeger(L, -1);
+        buf->data[i] = (int32_t)lua_tointeger(L, -1);
         lua_pop(L, 1);
     }
-    
-    // Convert to uppercase
-    unicode_upper(codepoints, len);
-    
-    // Create result table
-    lua_createtable(L, len, 0);
-    for (int32_t i = 0; i < len; i++) {
-        lua_pushinteger(L, codepoints[i]);
+    return 1;
+}
+
+// unicode.to_table(buffer) -> codepoint_table
+static int lua_unicode_to_table(lua_State* L) {
+    const UnicodeBuffer* buf = check_buffer(L, 1);
+    lua_createtable(L, buf->length, 0);
+    for (int32_t i = 0; i < buf->length; i++) {
+        lua_pushinteger(L, buf->data[i]);
         lua_rawseti(L, -2, i + 1);
     }
-    
-    free(codepoints);
     return 1;
 }
 
-// unicode.lower(codepoint_table) -> lowercase_table
+// unicode.upper(buffer) -> uppercase buffer
+static int lua_unicode_upper(lua_State* L) {
+    const UnicodeBuffer* src = check_buffer(L, 1);
+    UnicodeBuffer* buf = push_copy(L, src->data, src->length);
+    unicode_upper(buf->data, buf->length);
+    return 1;
+}
+
+// unicode.lower(buffer) -> lowercase buffer
 static int lua_unicode_lower(lua_State* L) {
-    luaL_checktype(L, 1, LUA_TTABLE);
-    
-    int32_t len = (int32_t)lua_objlen(L, 1);
-    
-    if (len == 0) {
-        lua_newtable(L);
-        return 1;
-    }
-    
-    // Allocate and extract codepoints
-    int32_t* codepoints = (int32_t*)malloc(len * sizeof(int32_t));
-    if (!codepoints) {
-        return luaL_error(L, "Memory allocation failed");
-    }
-    
-    for (int32_t i = 0; i < len; i++) {
-        lua_rawgeti(L, 1, i + 1);
-        codepoints[i] = (int32_t)lua_tointeger(L, -1);
-        lua_pop(L, 1);
-    }
-    
-    // Convert to lowercase
-    unicode_lower(codepoints, len);
-    
-    // Create result table
-    lua_createtable(L, len, 0);
-    for (int32_t i = 0; i < len; i++) {
-        lua_pushinteger(L, codepoints[i]);
-        lua_rawseti(L, -2, i + 1);
-    }
-    
-    free(codepoints);
+    const UnicodeBuffer* src = check_buffer(L, 1);
+    UnicodeBuffer* buf = push_copy(L, src->data, src->length);
+    unicode_lower(buf->data, buf->length);
     return 1;
 }
 
-// unicode.len(codepoint_table) -> length
+// unicode.len(buffer) -> length
 static int lua_unicode_len(lua_State* L) {
-    luaL_checktype(L, 1, LUA_TTABLE);
-    lua_pushinteger(L, lua_objlen(L, 1));
+    lua_pushinteger(L, check_buffer(L, 1)->length);
     return 1;
 }
 
-// unicode.concat(table1, table2, ...) -> concatenated_table
+// unicode.concat(buffer1, buffer2, ...) -> concatenated buffer
 static int lua_unicode_concat(lua_State* L) {
     int nargs = lua_gettop(L);
-    
+
     // Calculate total length
-    int32_t total_len = 0;
+    int64_t total_len = 0;
     for (int i = 1; i <= nargs; i++) {
-        luaL_checktype(L, i, LUA_TTABLE);
-        total_len += (int32_t)lua_objlen(L, i);
+        total_len += check_buffer(L, i)->length;
+    }
+    if (total_len > INT32_MAX) {
+        return luaL_error(L, "Unicode string too long");
     }
-    
-    // Create result table
-    lua_createtable(L, total_len, 0);
-    
-    int32_t pos = 1;
+
+    UnicodeBuffer* result = push_buffer(L, (int32_t)total_len);
+    int32_t* out = result->data;
     for (int i = 1; i <= nargs; i++) {
-        int32_t len = (int32_t)lua_objlen(L, i);
-        for (int32_t j = 1; j <= len; j++) {
-            lua_rawgeti(L, i, j);
-            lua_rawseti(L, -2, pos++);
-        }
+        const UnicodeBuffer* part = (const UnicodeBuffer*)lua_touserdata(L, i);
+        memcpy(out, part->data, (size_t)part->length * sizeof(int32_t));
+        out += part->length;
     }
-    
     return 1;
 }
 
-// unicode.reverse(codepoint_table) -> reversed_table
+// unicode.reverse(buffer) -> reversed buffer
 static int lua_unicode_reverse(lua_State* L) {
-    luaL_checktype(L, 1, LUA_TTABLE);
-    
-    int32_t len = (int32_t)lua_objlen(L, 1);
-    
-    lua_createtable(L, len, 0);
-    
+    const UnicodeBuffer* src = check_buffer(L, 1);
+    int32_t len = src->length;
+    UnicodeBuffer* buf = push_buffer(L, len);
     for (int32_t i = 0; i < len; i++) {
-        lua_rawgeti(L, 1, len - i);
-        lua_rawseti(L, -2, i + 1);
+        buf->data[i] = src->data[len - 1 - i];
     }
-    
     return 1;
 }
 
-// unicode.chr(codepoint) -> single-character table
+// unicode.chr(codepoint) -> single-character buffer
 static int lua_unicode_chr(lua_State* L) {
     int32_t codepoint = (int32_t)luaL_checkinteger(L, 1);
-    
+
     if (!unicode_is_valid_codepoint(codepoint)) {
         return luaL_error(L, "Invalid Unicode codepoint: %d", codepoint);
     }
-    
-    lua_createtable(L, 1, 0);
-    lua_pushinteger(L, codepoint);
-    lua_rawseti(L, -2, 1);
-    
+
+    push_buffer(L, 1)->data[0] = codepoint;
     return 1;
 }
 
-// unicode.asc(codepoint_table) -> first_codepoint
+// unicode.asc(buffer [, pos]) -> codepoint at pos (1-based, default 1)
 static int lua_unicode_asc(lua_State* L) {
-    luaL_checktype(L, 1, LUA_TTABLE);
-    
-    if (lua_objlen(L, 1) == 0) {
+    const UnicodeBuffer* buf = check_buffer(L, 1);
+    lua_Integer pos = luaL_optinteger(L, 2, 1);
+
+    if (buf->length == 0) {
         return luaL_error(L, "Empty string in ASC");
     }
-    
-    lua_rawgeti(L, 1, 1);
+    if (pos < 1 || pos > buf->length) {
+        lua_pushinteger(L, 0);
+        return 1;
+    }
+
+    lua_pushinteger(L, buf->data[pos - 1]);
     return 1;
 }
 
-// unicode.left(codepoint_table, n) -> substring
+// unicode.left(buffer, n) -> substring
 static int lua_unicode_left(lua_State* L) {
-    luaL_checktype(L, 1, LUA_TTABLE);
-    int32_t n = (int32_t)luaL_checkinteger(L, 2);
-    int32_t len = (int32_t)lua_objlen(L, 1);
-    
-    if (n <= 0) {
-        lua_newtable(L);
-        return 1;
-    }
-    
-    if (n > len) n = len;
-    
-    lua_createtable(L, n, 0);
-    for (int32_t i = 1; i <= n; i++) {
-        lua_rawgeti(L, 1, i);
-        lua_rawseti(L, -2, i);
-    }
-    
+    const UnicodeBuffer* src = check_buffer(L, 1);
+    int32_t n = clamp_count(luaL_checkinteger(L, 2), src->length);
+    push_copy(L, src->data, n);
     return 1;
 }
 
-// unicode.right(codepoint_table, n) -> substring
+// unicode.right(buffer, n) -> substring
 static int lua_unicode_right(lua_State* L) {
-    luaL_checktype(L, 1, LUA_TTABLE);
-    int32_t n = (int32_t)luaL_checkinteger(L, 2);
-    int32_t len = (int32_t)lua_objlen(L, 1);
-    
-    if (n <= 0) {
-        lua_newtable(L);
-        return 1;
-    }
-    
-    if (n > len) n = len;
-    
-    int32_t start = len - n + 1;
-    lua_createtable(L, n, 0);
-    for (int32_t i = 0; i < n; i++) {
-        lua_rawgeti(L, 1, start + i);
-        lua_rawseti(L, -2, i + 1);
-    }
-    
+    const UnicodeBuffer* src = check_buffer(L, 1);
+    int32_t n = clamp_count(luaL_checkinteger(L, 2), src->length);
+    push_copy(L, src->data + (src->length - n), n);
     return 1;
 }
 
-// unicode.mid(codepoint_table, start [, length]) -> substring
+// unicode.mid(buffer, start [, length]) -> substring
 static int lua_unicode_mid(lua_State* L) {
-    luaL_checktype(L, 1, LUA_TTABLE);
-    int32_t start = (int32_t)luaL_checkinteger(L, 2);
-    int32_t len = (int32_t)lua_objlen(L, 1);
-    
-    int32_t length = len - start + 1;
-    if (lua_gettop(L) >= 3) {
-        length = (int32_t)luaL_checkinteger(L, 3);
-    }
-    
-    if (start < 1 || start > len || length <= 0) {
-        lua_newtable(L);
+    const UnicodeBuffer* src = check_buffer(L, 1);
+    lua_Integer start = luaL_checkinteger(L, 2);
+    int32_t len = src->length;
+
+    if (start < 1 || start > len) {
+        push_buffer(L, 0);
         return 1;
     }
-    
-    if (start + length - 1 > len) {
-        length = len - start + 1;
-    }
-    
-    lua_createtable(L, length, 0);
-    for (int32_t i = 0; i < length; i++) {
-        lua_rawgeti(L, 1, start + i);
-        lua_rawseti(L, -2, i + 1);
-    }
-    
+
+    int32_t available = len - (int32_t)start + 1;
+    int32_t length = lua_isnoneornil(L, 3) ? available
+                                           : clamp_count(luaL_checkinteger(L, 3), available);
+    push_copy(L, src->data + (start - 1), length);
     return 1;
 }
 
-// unicode.space(n) -> string of n spaces
+// unicode.space(n) -> buffer of n spaces
 static int lua_unicode_space(lua_State* L) {
-    int32_t n = (int32_t)luaL_checkinteger(L, 1);
-    
-    if (n <= 0) {
-        lua_newtable(L);
-        return 1;
-    }
-    
-    lua_createtable(L, n, 0);
-    for (int32_t i = 1; i <= n; i++) {
-        lua_pushinteger(L, 32);  // Space character
-        lua_rawseti(L, -2, i);
+    int32_t n = clamp_count(luaL_checkinteger(L, 1), INT32_MAX);
+    UnicodeBuffer* buf = push_buffer(L, n);
+    for (int32_t i = 0; i < n; i++) {
+        buf->data[i] = 32;
     }
-    
     return 1;
 }
 
-// unicode.string_repeat(count, codepoint) -> repeated string
+// unicode.string_repeat(count, codepoint) -> repeated buffer
 static int lua_unicode_string_repeat(lua_State* L) {
-    int32_t count = (int32_t)luaL_checkinteger(L, 1);
+    int32_t count = clamp_count(luaL_checkinteger(L, 1), INT32_MAX);
     int32_t codepoint = (int32_t)luaL_checkinteger(L, 2);
-    
-    if (count <= 0) {
-        lua_newtable(L);
-        return 1;
-    }
-    
-    lua_createtable(L, count, 0);
-    
-    for (int32_t i = 1; i <= count; i++) {
-        lua_pushinteger(L, codepoint);
-        lua_rawseti(L, -2, i);
+
+    UnicodeBuffer* buf = push_buffer(L, count);
+    for (int32_t i = 0; i < count; i++) {
+        buf->data[i] = codepoint;
     }
-    
     return 1;
 }
 
@@ -361,210 +299,98 @@ static bool is_space_codepoint(int32_t cp) {
     return cp == 32 || cp == 9 || cp == 10 || cp == 13;
 }
 
-// unicode.ltrim(codepoint_table) -> trimmed table
-static int lua_unicode_ltrim(lua_State* L) {
-    luaL_checktype(L, 1, LUA_TTABLE);
-    int32_t len = (int32_t)lua_objlen(L, 1);
-    
-    if (len == 0) {
-        lua_newtable(L);
+// Push the [first, last) slice of the buffer at index 1, reusing it when
+// nothing was trimmed
+static int push_slice(lua_State* L, const UnicodeBuffer* src, int32_t first, int32_t last) {
+    if (first == 0 && last == src->length) {
+        lua_pushvalue(L, 1);  // Buffers are immutable, so share it
         return 1;
     }
-    
-    // Find first non-space character
-    int32_t start = 1;
-    while (start <= len) {
-        lua_rawgeti(L, 1, start);
-        int32_t cp = (int32_t)lua_tointeger(L, -1);
-        lua_pop(L, 1);
-        if (!is_space_codepoint(cp)) {
-            break;
-        }
-        start++;
-    }
-    
-    if (start > len) {
-        lua_newtable(L);
-        return 1;
-    }
-    
-    // Create result table
-    lua_createtable(L, len - start + 1, 0);
-    int32_t pos = 1;
-    for (int32_t i = start; i <= len; i++) {
-        lua_rawgeti(L, 1, i);
-        lua_rawseti(L, -2, pos++);
-    }
-    
+    push_copy(L, src->data + first, last - first);
     return 1;
 }
 
-// unicode.rtrim(codepoint_table) -> trimmed table
+// unicode.ltrim(buffer) -> trimmed buffer
+static int lua_unicode_ltrim(lua_State* L) {
+    const UnicodeBuffer* src = check_buffer(L, 1);
+    int32_t first = 0;
+    while (first < src->length && is_space_codepoint(src->data[first])) first++;
+    return push_slice(L, src, first, src->length);
+}
+
+// unicode.rtrim(buffer) -> trimmed buffer
 static int lua_unicode_rtrim(lua_State* L) {
-    luaL_checktype(L, 1, LUA_TTABLE);
-    int32_t len = (int32_t)lua_objlen(L, 1);
-    
-    if (len == 0) {
-        lua_newtable(L);
-        return 1;
-    }
-    
-    // Find last non-space character
-    int32_t end = len;
-    while (end >= 1) {
-        lua_rawgeti(L, 1, end);
-        int32_t cp = (int32_t)lua_tointeger(L, -1);
-        lua_pop(L, 1);
-        if (!is_space_codepoint(cp)) {
-            break;
-        }
-        end--;
-    }
-    
-    if (end < 1) {
-        lua_newtable(L);
-        return 1;
-    }
-    
-    // Create result table
-    lua_createtable(L, end, 0);
-    for (int32_t i = 1; i <= end; i++) {
-        lua_rawgeti(L, 1, i);
-        lua_rawseti(L, -2, i);
-    }
-    
-    return 1;
+    const UnicodeBuffer* src = check_buffer(L, 1);
+    int32_t last = src->length;
+    while (last > 0 && is_space_codepoint(src->data[last - 1])) last--;
+    return push_slice(L, src, 0, last);
 }
 
-// unicode.trim(codepoint_table) -> trimmed table
+// unicode.trim(buffer) -> trimmed buffer
 static int lua_unicode_trim(lua_State* L) {
-    luaL_checktype(L, 1, LUA_TTABLE);
-    int32_t len = (int32_t)lua_objlen(L, 1);
-    
-    if (len == 0) {
-        lua_newtable(L);
-        return 1;
-    }
-    
-    // Find first non-space character
-    int32_t start = 1;
-    while (start <= len) {
-        lua_rawgeti(L, 1, start);
-        int32_t cp = (int32_t)lua_tointeger(L, -1);
-        lua_pop(L, 1);
-        if (!is_space_codepoint(cp)) {
-            break;
-        }
-        start++;
-    }
-    
-    if (start > len) {
-        lua_newtable(L);
-        return 1;
-    }
-    
-    // Find last non-space character
-    int32_t end = len;
-    while (end >= start) {
-        lua_rawgeti(L, 1, end);
-        int32_t cp = (int32_t)lua_tointeger(L, -1);
-        lua_pop(L, 1);
-        if (!is_space_codepoint(cp)) {
-            break;
-        }
-        end--;
-    }
-    
-    // Create result table
-    lua_createtable(L, end - start + 1, 0);
-    int32_t pos = 1;
-    for (int32_t i = start; i <= end; i++) {
-        lua_rawgeti(L, 1, i);
-        lua_rawseti(L, -2, pos++);
-    }
-    
-    return 1;
+    const UnicodeBuffer* src = check_buffer(L, 1);
+    int32_t first = 0;
+    while (first < src->length && is_space_codepoint(src->data[first])) first++;
+    int32_t last = src->length;
+    while (last > first && is_space_codepoint(src->data[last - 1])) last--;
+    return push_slice(L, src, first, last);
 }
 
-// unicode.instr(haystack_table, needle_table) -> position or 0
-static int lua_unicode_instr(lua_State* L) {
-    luaL_checktype(L, 1, LUA_TTABLE);
-    luaL_checktype(L, 2, LUA_TTABLE);
-    
-    int32_t haystack_len = (int32_t)lua_objlen(L, 1);
-    int32_t needle_len = (int32_t)lua_objlen(L, 2);
-    
-    if (needle_len == 0) {
+// Shared INSTR body: 1-based start, returns 1-based position or 0
+static int push_instr(lua_State* L, const UnicodeBuffer* haystack,
+                      const UnicodeBuffer* needle, lua_Integer start) {
+    if (start < 1) start = 1;
+    if (start > haystack->length) {
         lua_pushinteger(L, 0);
         return 1;
     }
-    
-    // Search for needle in haystack
-    for (int32_t i = 1; i <= haystack_len - needle_len + 1; i++) {
-        bool match = true;
-        for (int32_t j = 1; j <= needle_len; j++) {
-            lua_rawgeti(L, 1, i + j - 1);
-            int32_t h_cp = (int32_t)lua_tointeger(L, -1);
-            lua_pop(L, 1);
-            
-            lua_rawgeti(L, 2, j);
-            int32_t n_cp = (int32_t)lua_tointeger(L, -1);
-            lua_pop(L, 1);
-            
-            if (h_cp != n_cp) {
-                match = false;
-                break;
-            }
-        }
-        if (match) {
-            lua_pushinteger(L, i);
-            return 1;
-        }
-    }
-    
-    lua_pushinteger(L, 0);
+
+    size_t pos = unicode_find(haystack->data, (size_t)haystack->length,
+                              needle->data, (size_t)needle->length, (size_t)(start - 1));
+    lua_pushinteger(L, pos == (size_t)-1 ? 0 : (lua_Integer)pos + 1);
     return 1;
 }
 
-// unicode.instr_start(start, haystack_table, needle_table) -> position or 0
+// unicode.instr(haystack, needle [, start]) -> position or 0
+static int lua_unicode_instr(lua_State* L) {
+    const UnicodeBuffer* haystack = check_buffer(L, 1);
+    const UnicodeBuffer* needle = check_buffer(L, 2);
+    return push_instr(L, haystack, needle, luaL_optinteger(L, 3, 1));
+}
+
+// unicode.instr_start(start, haystack, needle) -> position or 0
 static int lua_unicode_instr_start(lua_State* L) {
-    int32_t start = (int32_t)luaL_checkinteger(L, 1);
-    luaL_checktype(L, 2, LUA_TTABLE);
-    luaL_checktype(L, 3, LUA_TTABLE);
-    
-    int32_t haystack_len = (int32_t)lua_objlen(L, 2);
-    int32_t needle_len = (int32_t)lua_objlen(L, 3);
-    
-    if (start < 1) start = 1;
-    if (needle_len == 0 || start > haystack_len) {
-        lua_pushinteger(L, 0);
-        return 1;
-    }
-    
-    // Search for needle in haystack starting from position start
-    for (int32_t i = start; i <= haystack_len - needle_len + 1; i++) {
-        bool match = true;
-        for (int32_t j = 1; j <= needle_len; j++) {
-            lua_rawgeti(L, 2, i + j - 1);
-            int32_t h_cp = (int32_t)lua_tointeger(L, -1);
-            lua_pop(L, 1);
-            
-            lua_rawgeti(L, 3, j);
-            int32_t n_cp = (int32_t)lua_tointeger(L, -1);
-            lua_pop(L, 1);
-            
-            if (h_cp != n_cp) {
-                match = false;
-                break;
-            }
-        }
-        if (match) {
-            lua_pushinteger(L, i);
-            return 1;
+    lua_Integer start = luaL_checkinteger(L, 1);
+    const UnicodeBuffer* haystack = check_buffer(L, 2);
+    const UnicodeBuffer* needle = check_buffer(L, 3);
+    return push_instr(L, haystack, needle, start);
+}
+
+// unicode.equals(a, b) -> boolean
+static int lua_unicode_equals(lua_State* L) {
+    const UnicodeBuffer* a = check_buffer(L, 1);
+    const UnicodeBuffer* b = check_buffer(L, 2);
+    lua_pushboolean(L, unicode_compare(a->data, a->length, b->data, b->length));
+    return 1;
+}
+
+// Codepoint-order comparison: -1, 0 or 1
+static int compare_buffers(const UnicodeBuffer* a, const UnicodeBuffer* b) {
+    int32_t common = a->length < b->length ? a->length : b->length;
+    for (int32_t i = 0; i < common; i++) {
+        if (a->data[i] != b->data[i]) {
+            return a->data[i] < b->data[i] ? -1 : 1;
         }
     }
-    
-    lua_pushinteger(L, 0);
+    if (a->length == b->length) return 0;
+    return a->length < b->length ? -1 : 1;
+}
+
+// unicode.compare(a, b) -> -1, 0 or 1
+static int lua_unicode_compare(lua_State* L) {
+    const UnicodeBuffer* a = check_buffer(L, 1);
+    const UnicodeBuffer* b = check_buffer(L, 2);
+    lua_pushinteger(L, compare_buffers(a, b));
     return 1;
 }
 
@@ -574,6 +400,30 @@ static int lua_unicode_version(lua_State* L) {
     return 1;
 }
 
+// =============================================================================
+// Buffer Metamethods
+// =============================================================================
+
+static int lua_unicode_mt_lt(lua_State* L) {
+    lua_pushboolean(L, compare_buffers(check_buffer(L, 1), check_buffer(L, 2)) < 0);
+    return 1;
+}
+
+static int lua_unicode_mt_le(lua_State* L) {
+    lua_pushboolean(L, compare_buffers(check_buffer(L, 1), check_buffer(L, 2)) <= 0);
+    return 1;
+}
+
+static const luaL_Reg unicode_buffer_methods[] = {
+    {"__len", lua_unicode_len},
+    {"__tostring", lua_unicode_to_utf8},
+    {"__concat", lua_unicode_concat},
+    {"__eq", lua_unicode_equals},
+    {"__lt", lua_unicode_mt_lt},
+    {"__le", lua_unicode_mt_le},
+    {NULL, NULL}
+};
+
 // =============================================================================
 // Module Registration
 // =============================================================================
@@ -581,6 +431,8 @@ static int lua_unicode_version(lua_State* L) {
 static const luaL_Reg unicode_functions[] = {
     {"from_utf8", lua_unicode_from_utf8},
     {"to_utf8", lua_unicode_to_utf8},
+    {"from_table", lua_unicode_from_table},
+    {"to_table", lua_unicode_to_table},
     {"upper", lua_unicode_upper},
     {"lower", lua_unicode_lower},
     {"len", lua_unicode_len},
@@ -598,32 +450,37 @@ static const luaL_Reg unicode_functions[] = {
     {"trim", lua_unicode_trim},
     {"instr", lua_unicode_instr},
     {"instr_start", lua_unicode_instr_start},
+    {"equals", lua_unicode_equals},
+    {"compare", lua_unicode_compare},
     {"version", lua_unicode_version},
     {NULL, NULL}
 };
 
-// Register unicode module in Lua state
-extern "C" int luaopen_unicode(lua_State* L) {
+// Create the buffer metatable and the module table (left on the stack)
+static void push_unicode_module(lua_State* L) {
+    if (luaL_newmetatable(L, UNICODE_BUFFER_MT)) {
+        luaL_register(L, NULL, unicode_buffer_methods);
+    }
+    lua_pop(L, 1);
+
     lua_newtable(L);
     luaL_register(L, NULL, unicode_functions);
-    
+
     // Set available flag
     lua_pushboolean(L, 1);
     lua_setfield(L, -2, "available");
-    
+}
+
+// Register unicode module in Lua state
+extern "C" int luaopen_unicode(lua_State* L) {
+    push_unicode_module(L);
     return 1;
 }
 
 // Inject unicode module into global namespace
 extern "C" void register_unicode_module(lua_State* L) {
-    // Create the module table
-    lua_newtable(L);
-    luaL_register(L, NULL, unicode_functions);
-    
-    // Set available flag
-    lua_pushboolean(L, 1);
-    lua_setfield(L, -2, "available");
-    
+    push_unicode_module(L);
+
     // Register as global "unicode"
     lua_setglobal(L, "unicode");
-}
\ No newline at end of file
+}
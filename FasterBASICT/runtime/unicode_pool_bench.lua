@@ -0,0 +1,110 @@
+--
+-- unicode_pool_bench.lua
+-- FasterBASIC - Stress benchmark for the pooled Unicode string library
+--
+-- Drives libunicode_string through unicode_unified.lua with the
+-- concat/substring churn typical of OPTION UNICODE string building, and
+-- reports throughput plus pool statistics.
+--
+-- Usage (from the directory containing runtime/):
+--   luajit runtime/unicode_pool_bench.lua [iterations]
+--
+
+local unicode = dofile('runtime/unicode_unified.lua')
+if not unicode.available then
+    error(unicode.error or 'libunicode_string not available (run runtime/build_unicode_lib.sh)')
+end
+
+local ffi = require('ffi')
+ffi.cdef [[
+    void ustring_global_stats(size_t* out_total_strings, size_t* out_total_memory);
+]]
+
+local iterations = tonumber(arg and arg[1]) or 200000
+
+local lib = ffi.load('runtime/libunicode_string' .. (ffi.os == 'OSX' and '.dylib' or '.so'))
+
+local function global_stats()
+    local strings = ffi.new('size_t[1]')
+    local memory = ffi.new('size_t[1]')
+    lib.ustring_global_stats(strings, memory)
+    return tonumber(strings[0]), tonumber(memory[0])
+end
+
+local function bench(name, fn)
+    collectgarbage()
+    local start = os.clock()
+    local ops = fn()
+    local elapsed = os.clock() - start
+    local strings, memory = global_stats()
+    print(string.format('%-34s %9.3f s  %12.0f ops/s  live=%d  held=%d bytes',
+        name, elapsed, ops / elapsed, strings, memory))
+end
+
+local word = unicode.from_utf8('Grüße ✓ ')
+local sentence = unicode.from_utf8('The quick brown fox jumps over the lazy dög — ünïcödé ')
+
+print('Pooled Unicode String Library Benchmark')
+print('  Library version: ' .. unicode.version())
+print('  Iterations:      ' .. iterations)
+print('')
+
+-- Short slices stay in the header's inline storage
+bench('short concat + substring', function()
+    for i = 1, iterations do
+        local joined = unicode.concat(word, word)
+        local part = unicode.substring(joined, 2, 6)
+        unicode.release(joined)
+        unicode.release(part)
+    end
+    return iterations * 2
+end)
+
+-- Medium strings exercise the small size classes
+bench('size-class concat + substring', function()
+    for i = 1, iterations do
+        local joined = unicode.concat(sentence, sentence)
+        local part = unicode.substring(joined, (i % 40) + 1, 48)
+        local upper = unicode.upper(part)
+        unicode.release(joined)
+        unicode.release(part)
+        unicode.release(upper)
+    end
+    return iterations * 3
+end)
+
+-- Growing accumulator: every size class from 16 to several thousand codepoints
+bench('accumulate + slice (mixed sizes)', function()
+    local ops = 0
+    local acc = unicode.empty()
+    for i = 1, iterations do
+        local grown = unicode.concat(acc, word)
+        unicode.release(acc)
+        acc = grown
+        local tail = unicode.right(acc, 32)
+        unicode.release(tail)
+        ops = ops + 2
+        if unicode.length(acc) > 4096 then
+            local reset = unicode.left(acc, 8)
+            unicode.release(acc)
+            acc = reset
+            ops = ops + 1
+        end
+    end
+    unicode.release(acc)
+    return ops
+end)
+
+-- Many-piece joins use a single allocation
+bench('concat_many (8 pieces)', function()
+    local pieces = { word, sentence, word, sentence, word, sentence, word, sentence }
+    local n = math.floor(iterations / 4)
+    for i = 1, n do
+        unicode.release(unicode.concat_many(pieces))
+    end
+    return n
+end)
+
+print('')
+print('Pool statistics after churn:')
+unicode.pool_stats()
@@ -391,7 +391,11 @@ function UString:find(needle, start_pos)
         return 0
     end
     start_pos = start_pos or 1
-    return tonumber(lib.ustring_find(self.handle, needle.handle, start_pos))
+    local pos = lib.ustring_find(self.handle, needle.handle, start_pos - 1) -- Convert to 0-based
+    if pos == ffi.cast("size_t", -1) then
+        return 0
+    end
+    return tonumber(pos) + 1 -- Convert back to 1-based
 end
 
 function UString:instr(needle, start_pos)
@@ -0,0 +1,108 @@
+--
+-- unicode_rope_bench.lua
+-- FasterBASIC - Rope concatenation benchmark for OPTION UNICODE strings
+--
+-- Builds a large document by repeated DOC$ = DOC$ + LINE$ concatenation and
+-- reports time and memory for the rope representation, then the cost of
+-- flattening it, indexing into it and streaming it out. The same loop over
+-- flat copies is measured on a smaller document for comparison (it is
+-- quadratic, so a full-size run would not finish in reasonable time).
+--
+-- Usage (from the directory containing runtime/):
+--   luajit runtime/unicode_rope_bench.lua [megabytes] [flat_megabytes]
+--
+
+local unicode = dofile('runtime/unicode_unified.lua')
+if not unicode.available then
+    error(unicode.error or 'libunicode_string not available (run runtime/build_unicode_lib.sh)')
+end
+
+local ffi = require('ffi')
+ffi.cdef [[
+    void ustring_global_stats(size_t* out_total_strings, size_t* out_total_memory);
+]]
+
+local lib = ffi.load('runtime/libunicode_string' .. (ffi.os == 'OSX' and '.dylib' or '.so'))
+
+local megabytes = tonumber(arg and arg[1]) or 100
+local flat_megabytes = tonumber(arg and arg[2]) or 1
+
+local line_utf8 = 'Zeile für Größenmessung — ünïcödé ✓ the quick brown fox 0123456789\n'
+local line = unicode.from_utf8(line_utf8)
+
+local function global_stats()
+    local strings = ffi.new('size_t[1]')
+    local memory = ffi.new('size_t[1]')
+    lib.ustring_global_stats(strings, memory)
+    return tonumber(strings[0]), tonumber(memory[0])
+end
+
+local function mb(bytes)
+    return bytes / (1024 * 1024)
+end
+
+local function report(label, elapsed)
+    collectgarbage()
+    local strings, memory = global_stats()
+    print(string.format('  %-22s %8.3f s   buffers %8.1f MB (%d live)   Lua heap %7.1f MB',
+        label, elapsed, mb(memory), strings, collectgarbage('count') / 1024))
+end
+
+local function build(concat, target_bytes)
+    local lines = math.ceil(target_bytes / #line_utf8)
+    local doc = unicode.empty()
+    local start = os.clock()
+    for _ = 1, lines do
+        doc = concat(doc, line)
+    end
+    return doc, lines, os.clock() - start
+end
+
+print('Unicode Rope Concatenation Benchmark')
+print(string.format('  Line: %d bytes UTF-8, %d codepoints', #line_utf8, unicode.length(line)))
+print('')
+
+-- Rope: DOC$ = DOC$ + LINE$ through the BASIC-facing concat
+print(string.format('Rope build, %d MB document:', megabytes))
+collectgarbage()
+local doc, lines, elapsed = build(unicode.unicode_concat, megabytes * 1024 * 1024)
+print(string.format('  %d concatenations, %d codepoints, rope height %d',
+    lines, unicode.length(doc), unicode.is_rope(doc) and doc.height or 0))
+report('build', elapsed)
+
+local null = io.open('/dev/null', 'wb')
+local start = os.clock()
+unicode.write(doc, null)
+report('stream to /dev/null', os.clock() - start)
+
+start = os.clock()
+local probe = unicode.unicode_asc(doc, unicode.length(doc) - 1)
+report('flatten + index', os.clock() - start)
+assert(probe == string.byte('9'))
+
+start = os.clock()
+local pos = unicode.unicode_instr(doc, unicode.from_utf8('fox 0123456789\nZeile'), 1)
+report('INSTR on flat buffer', os.clock() - start)
+assert(pos > 0)
+
+doc = nil
+null:close()
+collectgarbage()
+collectgarbage()
+print('')
+
+-- Flat copies: every concat allocates and copies the whole document
+print(string.format('Flat copy build, %d MB document:', flat_megabytes))
+-- Release the previous document at once, as a refcounted flat runtime would
+local flat_concat = function(a, b)
+    local result = ffi.gc(lib.ustring_concat(unicode.coerce(a), unicode.coerce(b), nil), lib.ustring_release)
+    unicode.release(a)
+    return result
+end
+local flat, flat_lines
+flat, flat_lines, elapsed = build(flat_concat, flat_megabytes * 1024 * 1024)
+print(string.format('  %d concatenations, %d codepoints', flat_lines, unicode.length(flat)))
+report('build', elapsed)
+flat = nil
+collectgarbage()
+collectgarbage()
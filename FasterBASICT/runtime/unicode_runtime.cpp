@@ -7,10 +7,24 @@
 //
 
 #include "unicode_runtime.h"
+#include "unicode_tables.h"
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// AVX2 paths are compiled with a target attribute and chosen at run time,
+// so the library still runs on baseline x86-64
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define UNICODE_AVX2_DISPATCH 1
+#endif
+
 // =============================================================================
 // UTF-8 Decoding/Encoding
 // =============================================================================
@@ -122,6 +136,147 @@ static int utf8_encode(int32_t codepoint, char* out) {
     }
 }
 
+// =============================================================================
+// Vectorized ASCII Runs
+// =============================================================================
+
+// Each helper converts the longest ASCII prefix it can cheaply prove, working
+// a full vector at a time, and returns how many bytes/codepoints it handled.
+// Zero means the next unit is non-ASCII (or too short for a vector) and the
+// caller should take the scalar path for it.
+
+#if defined(UNICODE_AVX2_DISPATCH)
+static bool cpu_has_avx2() {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+
+__attribute__((target("avx2")))
+static size_t decode_ascii_run_avx2(const unsigned char* s, size_t len, int32_t* out) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(s + i));
+        if (_mm256_movemask_epi8(block)) break;
+        if (out) {
+            for (int k = 0; k < 4; k++) {
+                __m128i bytes = _mm_loadl_epi64((const __m128i*)(s + i + 8 * k));
+                _mm256_storeu_si256((__m256i*)(out + i + 8 * k), _mm256_cvtepu8_epi32(bytes));
+            }
+        }
+    }
+    return i;
+}
+#endif
+
+// Widen an ASCII prefix to codepoints (out may be NULL to only measure it)
+static size_t decode_ascii_run(const unsigned char* s, size_t len, int32_t* out) {
+    size_t i = 0;
+#if defined(UNICODE_AVX2_DISPATCH)
+    if (len >= 32 && cpu_has_avx2()) {
+        i = decode_ascii_run_avx2(s, len, out);
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(s + i));
+        if (_mm_movemask_epi8(block)) break;
+        if (out) {
+            __m128i lo = _mm_unpacklo_epi8(block, zero);
+            __m128i hi = _mm_unpackhi_epi8(block, zero);
+            _mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128((__m128i*)(out + i + 4), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128((__m128i*)(out + i + 8), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128((__m128i*)(out + i + 12), _mm_unpackhi_epi16(hi, zero));
+        }
+    }
+#else
+    // Portable fallback: test eight bytes per step
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, s + i, sizeof(word));
+        if (word & 0x8080808080808080ULL) break;
+        if (out) {
+            for (int k = 0; k < 8; k++) out[i + k] = s[i + k];
+        }
+    }
+#endif
+    // Finish with single ASCII bytes up to the next multi-byte sequence
+    while (i < len && s[i] < 0x80) {
+        if (out) out[i] = s[i];
+        i++;
+    }
+    return i;
+}
+
+// Narrow an ASCII prefix of codepoints to bytes
+static size_t encode_ascii_run(const int32_t* cps, size_t len, char* out) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i limit = _mm_set1_epi32(0x80);
+    for (; i + 16 <= len; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(cps + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(cps + i + 4));
+        __m128i c = _mm_loadu_si128((const __m128i*)(cps + i + 8));
+        __m128i d = _mm_loadu_si128((const __m128i*)(cps + i + 12));
+        // Unsigned "all below 0x80": OR the lanes, then compare once
+        __m128i any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+        if (_mm_movemask_epi8(_mm_cmplt_epi32(any, limit)) != 0xFFFF ||
+            _mm_movemask_epi8(any) & 0x8888) {
+            break;
+        }
+        __m128i ab = _mm_packs_epi32(a, b);
+        __m128i cd = _mm_packs_epi32(c, d);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(ab, cd));
+    }
+#endif
+    while (i < len && (uint32_t)cps[i] < 0x80) {
+        out[i] = (char)cps[i];
+        i++;
+    }
+    return i;
+}
+
+// UTF-8 length of every codepoint in the buffer (invalid ones count as the
+// three bytes of U+FFFD)
+static size_t encoded_size_range(const int32_t* cps, size_t len) {
+    size_t size = 0;
+    size_t i = 0;
+#if defined(__SSE2__)
+    // size = 1 + (cp > 0x7F) + (cp > 0x7FF) + (cp > 0xFFFF), four lanes at a
+    // time; blocks holding negative or out-of-range values go scalar
+    const __m128i c7f = _mm_set1_epi32(0x7F);
+    const __m128i c7ff = _mm_set1_epi32(0x7FF);
+    const __m128i cffff = _mm_set1_epi32(0xFFFF);
+    const __m128i cmax = _mm_set1_epi32(0x10FFFF);
+    __m128i extra = _mm_setzero_si128();
+    size_t vector_units = 0;
+    for (; i + 4 <= len; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(cps + i));
+        if (_mm_movemask_epi8(v) & 0x8888 ||
+            _mm_movemask_epi8(_mm_cmpgt_epi32(v, cmax))) {
+            for (size_t k = 0; k < 4; k++) {
+                int bytes = unicode_codepoint_to_utf8_bytes(cps[i + k]);
+                size += bytes ? bytes : 3;
+            }
+            continue;
+        }
+        extra = _mm_sub_epi32(extra, _mm_cmpgt_epi32(v, c7f));
+        extra = _mm_sub_epi32(extra, _mm_cmpgt_epi32(v, c7ff));
+        extra = _mm_sub_epi32(extra, _mm_cmpgt_epi32(v, cffff));
+        vector_units += 4;
+    }
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, extra);
+    size += vector_units + (size_t)lanes[0] + (size_t)lanes[1] + (size_t)lanes[2] + (size_t)lanes[3];
+#endif
+    for (; i < len; i++) {
+        int bytes = unicode_codepoint_to_utf8_bytes(cps[i]);
+        size += bytes ? bytes : 3;  // Invalid codepoints encode as U+FFFD
+    }
+    return size;
+}
+
 // =============================================================================
 // Public API: UTF-8 / UTF-32 Conversion
 // =============================================================================
@@ -131,31 +286,17 @@ int32_t* unicode_from_utf8(const char* utf8_str, int32_t* out_len) {
         return nullptr;
     }
     
-    // First pass: count codepoints
-    int32_t count = 0;
-    const char* p = utf8_str;
-    while (*p) {
-        int bytes_consumed = 0;
-        utf8_decode(p, &bytes_consumed);
-        p += bytes_consumed;
-        count++;
-    }
+    // First pass sizes the result exactly, second pass decodes into it
+    size_t byte_len = strlen(utf8_str);
+    size_t count = unicode_utf8_count(utf8_str, byte_len);
     
-    // Allocate array
-    int32_t* codepoints = (int32_t*)malloc(count * sizeof(int32_t));
+    int32_t* codepoints = (int32_t*)malloc((count ? count : 1) * sizeof(int32_t));
     if (!codepoints) {
         return nullptr;
     }
     
-    // Second pass: decode codepoints
-    p = utf8_str;
-    for (int32_t i = 0; i < count; i++) {
-        int bytes_consumed = 0;
-        codepoints[i] = utf8_decode(p, &bytes_consumed);
-        p += bytes_consumed;
-    }
-    
-    *out_len = count;
+    unicode_utf8_decode_into(utf8_str, byte_len, codepoints);
+    *out_len = (int32_t)count;
     return codepoints;
 }
 
@@ -164,22 +305,16 @@ char* unicode_to_utf8(const int32_t* codepoints, int32_t len, int32_t* out_len)
         return nullptr;
     }
     
-    // Calculate required buffer size (worst case: 4 bytes per codepoint + null terminator)
-    int32_t max_size = len * 4 + 1;
-    char* buffer = (char*)malloc(max_size);
+    // Exact size (vectorized) instead of the 4-bytes-per-codepoint worst case
+    size_t size = unicode_utf8_encoded_size(codepoints, (size_t)len);
+    char* buffer = (char*)malloc(size + 1);
     if (!buffer) {
         return nullptr;
     }
     
-    // Encode each codepoint
-    int32_t pos = 0;
-    for (int32_t i = 0; i < len; i++) {
-        int bytes_written = utf8_encode(codepoints[i], buffer + pos);
-        pos += bytes_written;
-    }
-    
+    size_t pos = unicode_utf8_encode_into(codepoints, (size_t)len, buffer);
     buffer[pos] = '\0';
-    *out_len = pos;
+    *out_len = (int32_t)pos;
     
     return buffer;
 }
@@ -188,91 +323,202 @@ void unicode_free(void* ptr) {
     free(ptr);
 }
 
-// =============================================================================
-// Unicode Case Conversion
-// =============================================================================
-
-// Simple case conversion for ASCII and Latin-1
-// For full Unicode support, would need comprehensive case mapping tables
-static int32_t simple_upper(int32_t cp) {
-    // ASCII lowercase to uppercase
-    if (cp >= 0x61 && cp <= 0x7A) {
-        return cp - 32;
-    }
-    // Latin-1 supplement lowercase to uppercase
-    if (cp >= 0xE0 && cp <= 0xFE && cp != 0xF7) {
-        return cp - 32;
+// Decode one sequence without reading past the end of the buffer
+static inline int32_t utf8_decode_bounded(const char* p, size_t remaining, int* bytes_consumed) {
+    int len = utf8_sequence_length((unsigned char)p[0]);
+    if (len == 0 || (size_t)len > remaining) {
+        *bytes_consumed = 1;
+        return 0xFFFD;
     }
-    // Greek lowercase to uppercase (basic range)
-    if (cp >= 0x3B1 && cp <= 0x3C9) {
-        return cp - 32;
+    return utf8_decode(p, bytes_consumed);
+}
+
+size_t unicode_utf8_count(const char* utf8, size_t byte_len) {
+    if (!utf8) return 0;
+
+    const unsigned char* s = (const unsigned char*)utf8;
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos < byte_len) {
+        size_t run = decode_ascii_run(s + pos, byte_len - pos, nullptr);
+        pos += run;
+        count += run;
+
+        // Multi-byte run: one sequence at a time until the next ASCII byte
+        while (pos < byte_len && s[pos] >= 0x80) {
+            int bytes_consumed = 0;
+            utf8_decode_bounded(utf8 + pos, byte_len - pos, &bytes_consumed);
+            pos += bytes_consumed;
+            count++;
+        }
     }
-    // Cyrillic lowercase to uppercase
-    if (cp >= 0x430 && cp <= 0x44F) {
-        return cp - 32;
+    return count;
+}
+
+size_t unicode_utf8_decode_into(const char* utf8, size_t byte_len, int32_t* out) {
+    if (!utf8 || !out) return 0;
+
+    const unsigned char* s = (const unsigned char*)utf8;
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos < byte_len) {
+        size_t run = decode_ascii_run(s + pos, byte_len - pos, out + count);
+        pos += run;
+        count += run;
+
+        while (pos < byte_len && s[pos] >= 0x80) {
+            int bytes_consumed = 0;
+            out[count++] = utf8_decode_bounded(utf8 + pos, byte_len - pos, &bytes_consumed);
+            pos += bytes_consumed;
+        }
     }
-    return cp;
+    return count;
+}
+
+size_t unicode_utf8_encoded_size(const int32_t* codepoints, size_t len) {
+    if (!codepoints) return 0;
+    return encoded_size_range(codepoints, len);
 }
 
-static int32_t simple_lower(int32_t cp) {
-    // ASCII uppercase to lowercase
-    if (cp >= 0x41 && cp <= 0x5A) {
-        return cp + 32;
+size_t unicode_utf8_encode_into(const int32_t* codepoints, size_t len, char* out) {
+    if (!codepoints || !out) return 0;
+
+    size_t pos = 0;
+    size_t i = 0;
+    while (i < len) {
+        size_t run = encode_ascii_run(codepoints + i, len - i, out + pos);
+        i += run;
+        pos += run;
+
+        while (i < len && (uint32_t)codepoints[i] >= 0x80) {
+            pos += utf8_encode(codepoints[i++], out + pos);
+        }
     }
-    // Latin-1 supplement uppercase to lowercase
-    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) {
-        return cp + 32;
+    return pos;
+}
+
+int unicode_utf8_validate(const char* utf8, size_t byte_len) {
+    if (!utf8) return 0;
+
+    const unsigned char* s = (const unsigned char*)utf8;
+    size_t pos = 0;
+    while (pos < byte_len) {
+        pos += decode_ascii_run(s + pos, byte_len - pos, nullptr);
+        if (pos >= byte_len) break;
+
+        // Strict check of one multi-byte sequence (no overlongs, surrogates
+        // or values past U+10FFFF)
+        unsigned char lead = s[pos];
+        size_t remaining = byte_len - pos;
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            if (remaining < 2 || (s[pos + 1] & 0xC0) != 0x80) return 0;
+            pos += 2;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            if (remaining < 3) return 0;
+            unsigned char b1 = s[pos + 1];
+            unsigned char lo = (lead == 0xE0) ? 0xA0 : 0x80;
+            unsigned char hi = (lead == 0xED) ? 0x9F : 0xBF;
+            if (b1 < lo || b1 > hi || (s[pos + 2] & 0xC0) != 0x80) return 0;
+            pos += 3;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            if (remaining < 4) return 0;
+            unsigned char b1 = s[pos + 1];
+            unsigned char lo = (lead == 0xF0) ? 0x90 : 0x80;
+            unsigned char hi = (lead == 0xF4) ? 0x8F : 0xBF;
+            if (b1 < lo || b1 > hi || (s[pos + 2] & 0xC0) != 0x80 ||
+                (s[pos + 3] & 0xC0) != 0x80) {
+                return 0;
+            }
+            pos += 4;
+        } else {
+            return 0;
+        }
     }
-    // Greek uppercase to lowercase (basic range)
-    if (cp >= 0x391 && cp <= 0x3A9) {
-        return cp + 32;
+    return 1;
+}
+
+// =============================================================================
+// Unicode Case Conversion
+// =============================================================================
+
+// Property record for a codepoint: two table loads, no branches on script.
+// Out-of-range values get record 0 (no mapping, category Other).
+static inline const UnicodePropertyRecord& property_record(int32_t cp) {
+    if ((uint32_t)cp >= 0x110000) {
+        return unicode_property_records[0];
     }
-    // Cyrillic uppercase to lowercase
-    if (cp >= 0x410 && cp <= 0x42F) {
-        return cp + 32;
+    uint32_t block = unicode_property_stage1[(uint32_t)cp >> UNICODE_TABLE_SHIFT];
+    uint32_t index = (block << UNICODE_TABLE_SHIFT) | ((uint32_t)cp & UNICODE_TABLE_BLOCK_MASK);
+    return unicode_property_records[unicode_property_stage2[index]];
+}
+
+static inline int32_t simple_upper(int32_t cp) {
+    return cp + property_record(cp).upper_delta;
+}
+
+static inline int32_t simple_lower(int32_t cp) {
+    return cp + property_record(cp).lower_delta;
+}
+
+// Map src to dst (may alias). ASCII blocks shift [first, last] by delta a
+// vector at a time; anything else goes through the property tables.
+static void case_map(const int32_t* src, int32_t* dst, int32_t len,
+                     int32_t first, int32_t last, int32_t delta, bool upper) {
+    int32_t i = 0;
+#if defined(__SSE2__)
+    const __m128i lo = _mm_set1_epi32(first - 1);
+    const __m128i hi = _mm_set1_epi32(last + 1);
+    const __m128i ascii_max = _mm_set1_epi32(0x7F);
+    const __m128i shift = _mm_set1_epi32(delta);
+    for (; i + 4 <= len; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        if (_mm_movemask_epi8(_mm_cmpgt_epi32(v, ascii_max)) | (_mm_movemask_epi8(v) & 0x8888)) {
+            for (int k = 0; k < 4; k++) {
+                dst[i + k] = upper ? simple_upper(src[i + k]) : simple_lower(src[i + k]);
+            }
+            continue;
+        }
+        __m128i in_range = _mm_and_si128(_mm_cmpgt_epi32(v, lo), _mm_cmplt_epi32(v, hi));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi32(v, _mm_and_si128(in_range, shift)));
+    }
+#endif
+    for (; i < len; i++) {
+        int32_t cp = src[i];
+        if ((uint32_t)cp < 0x80) {
+            dst[i] = (cp >= first && cp <= last) ? cp + delta : cp;
+        } else {
+            dst[i] = upper ? simple_upper(cp) : simple_lower(cp);
+        }
     }
-    return cp;
 }
 
 void unicode_upper(int32_t* codepoints, int32_t len) {
     if (!codepoints || len < 0) return;
-    
-    for (int32_t i = 0; i < len; i++) {
-        codepoints[i] = simple_upper(codepoints[i]);
-    }
+    case_map(codepoints, codepoints, len, 'a', 'z', -32, true);
 }
 
 void unicode_lower(int32_t* codepoints, int32_t len) {
     if (!codepoints || len < 0) return;
-    
-    for (int32_t i = 0; i < len; i++) {
-        codepoints[i] = simple_lower(codepoints[i]);
-    }
+    case_map(codepoints, codepoints, len, 'A', 'Z', 32, false);
 }
 
 int32_t* unicode_upper_new(const int32_t* codepoints, int32_t len) {
     if (!codepoints || len < 0) return nullptr;
     
-    int32_t* result = (int32_t*)malloc(len * sizeof(int32_t));
+    int32_t* result = (int32_t*)malloc((len ? len : 1) * sizeof(int32_t));
     if (!result) return nullptr;
     
-    for (int32_t i = 0; i < len; i++) {
-        result[i] = simple_upper(codepoints[i]);
-    }
-    
+    case_map(codepoints, result, len, 'a', 'z', -32, true);
     return result;
 }
 
 int32_t* unicode_lower_new(const int32_t* codepoints, int32_t len) {
     if (!codepoints || len < 0) return nullptr;
     
-    int32_t* result = (int32_t*)malloc(len * sizeof(int32_t));
+    int32_t* result = (int32_t*)malloc((len ? len : 1) * sizeof(int32_t));
     if (!result) return nullptr;
     
-    for (int32_t i = 0; i < len; i++) {
-        result[i] = simple_lower(codepoints[i]);
-    }
-    
+    case_map(codepoints, result, len, 'A', 'Z', 32, false);
     return result;
 }
 
@@ -296,66 +542,19 @@ int unicode_codepoint_to_utf8_bytes(int32_t codepoint) {
 }
 
 int unicode_category(int32_t codepoint) {
-    // Simplified Unicode categories
-    // 0 = Other, 1 = Letter, 2 = Number, 3 = Space, 4 = Punctuation, 5 = Symbol
-    
-    // Space
-    if (codepoint == 0x20 || codepoint == 0x09 || codepoint == 0x0A || 
-        codepoint == 0x0D || codepoint == 0x0B || codepoint == 0x0C ||
-        (codepoint >= 0x2000 && codepoint <= 0x200B)) {
-        return 3;
-    }
-    
-    // ASCII digits
-    if (codepoint >= 0x30 && codepoint <= 0x39) return 2;
-    
-    // ASCII letters
-    if ((codepoint >= 0x41 && codepoint <= 0x5A) || 
-        (codepoint >= 0x61 && codepoint <= 0x7A)) {
-        return 1;
-    }
-    
-    // Latin-1 letters
-    if (codepoint >= 0xC0 && codepoint <= 0xFF && 
-        codepoint != 0xD7 && codepoint != 0xF7) {
-        return 1;
-    }
-    
-    // Greek, Cyrillic, etc. (simplified)
-    if ((codepoint >= 0x370 && codepoint <= 0x3FF) ||  // Greek
-        (codepoint >= 0x400 && codepoint <= 0x4FF) ||  // Cyrillic
-        (codepoint >= 0x4E00 && codepoint <= 0x9FFF)) { // CJK Unified Ideographs
-        return 1;
-    }
-    
-    // ASCII punctuation
-    if ((codepoint >= 0x21 && codepoint <= 0x2F) ||
-        (codepoint >= 0x3A && codepoint <= 0x40) ||
-        (codepoint >= 0x5B && codepoint <= 0x60) ||
-        (codepoint >= 0x7B && codepoint <= 0x7E)) {
-        return 4;
-    }
-    
-    // Symbols
-    if ((codepoint >= 0x2000 && codepoint <= 0x206F) ||  // General Punctuation
-        (codepoint >= 0x2190 && codepoint <= 0x21FF) ||  // Arrows
-        (codepoint >= 0x2200 && codepoint <= 0x22FF)) {  // Mathematical Operators
-        return 5;
-    }
-    
-    return 0; // Other
+    return property_record(codepoint).category;
 }
 
 int unicode_is_space(int32_t codepoint) {
-    return unicode_category(codepoint) == 3;
+    return property_record(codepoint).category == 3;
 }
 
 int unicode_is_letter(int32_t codepoint) {
-    return unicode_category(codepoint) == 1;
+    return property_record(codepoint).category == 1;
 }
 
 int unicode_is_digit(int32_t codepoint) {
-    return unicode_category(codepoint) == 2;
+    return (property_record(codepoint).flags & UNICODE_FLAG_DIGIT) != 0;
 }
 
 // =============================================================================
@@ -367,7 +566,7 @@ const char* unicode_version() {
 }
 
 const char* unicode_standard_version() {
-    return "15.0 (simplified)";
+    return UNICODE_TABLES_VERSION;
 }
 
 // =============================================================================
@@ -468,32 +667,15 @@ int32_t unicode_instr(const int32_t* haystack, int32_t haystack_len,
         return 0;
     }
     
-    // Empty needle never found
-    if (needle_len == 0) {
-        return 0;
-    }
-    
     // Convert from 1-based to 0-based indexing
     int32_t start_idx = start_pos - 1;
     if (start_idx < 0) {
         start_idx = 0;
     }
     
-    // Needle longer than remaining haystack
-    if (start_idx + needle_len > haystack_len) {
-        return 0;
-    }
-    
-    // Search for needle in haystack
-    // Optimization: use memcmp for comparing blocks instead of element-by-element
-    for (int32_t i = start_idx; i <= haystack_len - needle_len; i++) {
-        if (memcmp(haystack + i, needle, needle_len * sizeof(int32_t)) == 0) {
-            // Found match, return 1-based position
-            return i + 1;
-        }
-    }
-    
-    return 0;
+    size_t pos = unicode_find(haystack, (size_t)haystack_len, needle, (size_t)needle_len,
+                              (size_t)start_idx);
+    return pos == (size_t)-1 ? 0 : (int32_t)pos + 1;
 }
 
 int32_t* unicode_left(const int32_t* codepoints, int32_t src_len, 
@@ -599,4 +781,202 @@ int32_t* unicode_repeat(int32_t codepoint, int32_t count, int32_t* out_len) {
     }
     
     return result;
-}
\ No newline at end of file
+}
+
+// =============================================================================
+// Substring Search
+// =============================================================================
+
+// Needles up to this length are matched with a first-codepoint filter plus
+// memcmp; the per-candidate verify is cheap enough that Two-Way's setup
+// does not pay for itself.
+static const size_t FIRST_CODEPOINT_FILTER_MAX = 8;
+
+size_t unicode_find_codepoint(const int32_t* haystack, size_t haystack_len,
+                              int32_t codepoint, size_t start) {
+    const size_t not_found = (size_t)-1;
+    if (!haystack || start >= haystack_len) {
+        return not_found;
+    }
+    
+    size_t i = start;
+#if defined(__SSE2__)
+    // Compare four codepoints per step
+    const __m128i target = _mm_set1_epi32(codepoint);
+    for (; i + 4 <= haystack_len; i += 4) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(haystack + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, target)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const int32x4_t target = vdupq_n_s32(codepoint);
+    for (; i + 4 <= haystack_len; i += 4) {
+        uint32x4_t eq = vceqq_s32(vld1q_s32(haystack + i), target);
+        if (vmaxvq_u32(eq)) {
+            break;  // The scalar tail pins down the lane
+        }
+    }
+#endif
+    for (; i < haystack_len; i++) {
+        if (haystack[i] == codepoint) {
+            return i;
+        }
+    }
+    return not_found;
+}
+
+// Critical factorization of the needle (Crochemore-Perrin): returns the split
+// position and stores the period of the right half in *period.
+static size_t critical_factorization(const int32_t* needle, size_t needle_len,
+                                     size_t* period) {
+    size_t max_suffix, max_suffix_rev, j, k, p;
+    
+    // Maximal suffix under the natural codepoint ordering
+    max_suffix = (size_t)-1;
+    j = 0;
+    k = p = 1;
+    while (j + k < needle_len) {
+        int32_t a = needle[j + k];
+        int32_t b = needle[max_suffix + k];
+        if (a < b) {
+            j += k;
+            k = 1;
+            p = j - max_suffix;
+        } else if (a == b) {
+            if (k != p) {
+                ++k;
+            } else {
+                j += p;
+                k = 1;
+            }
+        } else {
+            max_suffix = j++;
+            k = p = 1;
+        }
+    }
+    *period = p;
+    
+    // Maximal suffix under the reversed ordering
+    max_suffix_rev = (size_t)-1;
+    j = 0;
+    k = p = 1;
+    while (j + k < needle_len) {
+        int32_t a = needle[j + k];
+        int32_t b = needle[max_suffix_rev + k];
+        if (b < a) {
+            j += k;
+            k = 1;
+            p = j - max_suffix_rev;
+        } else if (a == b) {
+            if (k != p) {
+                ++k;
+            } else {
+                j += p;
+                k = 1;
+            }
+        } else {
+            max_suffix_rev = j++;
+            k = p = 1;
+        }
+    }
+    
+    // Choose the longer suffix
+    if (max_suffix_rev + 1 < max_suffix + 1) {
+        return max_suffix + 1;
+    }
+    *period = p;
+    return max_suffix_rev + 1;
+}
+
+static size_t two_way_find(const int32_t* haystack, size_t haystack_len,
+                           const int32_t* needle, size_t needle_len, size_t start) {
+    const size_t not_found = (size_t)-1;
+    size_t period;
+    size_t suffix = critical_factorization(needle, needle_len, &period);
+    size_t last = haystack_len - needle_len;
+    size_t j = start;
+    
+    if (memcmp(needle, needle + period, suffix * sizeof(int32_t)) == 0) {
+        // Periodic needle: remember how much of the left half already matched
+        size_t memory = 0;
+        while (j <= last) {
+            size_t i = std::max(suffix, memory);
+            while (i < needle_len && needle[i] == haystack[i + j]) {
+                ++i;
+            }
+            if (i >= needle_len) {
+                i = suffix - 1;
+                while (memory < i + 1 && needle[i] == haystack[i + j]) {
+                    --i;
+                }
+                if (i + 1 < memory + 1) {
+                    return j;
+                }
+                j += period;
+                memory = needle_len - period;
+            } else {
+                j += i - suffix + 1;
+                memory = 0;
+            }
+        }
+    } else {
+        // Non-periodic needle: a mismatch in the left half shifts past it
+        period = std::max(suffix, needle_len - suffix) + 1;
+        while (j <= last) {
+            size_t i = suffix;
+            while (i < needle_len && needle[i] == haystack[i + j]) {
+                ++i;
+            }
+            if (i >= needle_len) {
+                i = suffix - 1;
+                while (i != (size_t)-1 && needle[i] == haystack[i + j]) {
+                    --i;
+                }
+                if (i == (size_t)-1) {
+                    return j;
+                }
+                j += period;
+            } else {
+                j += i - suffix + 1;
+            }
+        }
+    }
+    return not_found;
+}
+
+size_t unicode_find(const int32_t* haystack, size_t haystack_len,
+                    const int32_t* needle, size_t needle_len, size_t start) {
+    const size_t not_found = (size_t)-1;
+    
+    // Empty needle never found
+    if (!haystack || !needle || needle_len == 0 || needle_len > haystack_len ||
+        start > haystack_len - needle_len) {
+        return not_found;
+    }
+    
+    if (needle_len == 1) {
+        return unicode_find_codepoint(haystack, haystack_len, needle[0], start);
+    }
+    
+    if (needle_len > FIRST_CODEPOINT_FILTER_MAX) {
+        return two_way_find(haystack, haystack_len, needle, needle_len, start);
+    }
+    
+    // Short needle: jump between candidate first codepoints, then verify
+    size_t last = haystack_len - needle_len;
+    size_t tail_bytes = (needle_len - 1) * sizeof(int32_t);
+    size_t i = start;
+    while (i <= last) {
+        i = unicode_find_codepoint(haystack, last + 1, needle[0], i);
+        if (i == not_found) {
+            return not_found;
+        }
+        if (memcmp(haystack + i + 1, needle + 1, tail_bytes) == 0) {
+            return i;
+        }
+        i++;
+    }
+    return not_found;
+}
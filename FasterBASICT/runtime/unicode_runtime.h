@@ -49,6 +49,56 @@ char* unicode_to_utf8(const int32_t* codepoints, int32_t len, int32_t* out_len);
  */
 void unicode_free(void* ptr);
 
+/**
+ * Count the codepoints in a UTF-8 byte sequence
+ * Invalid sequences count as one U+FFFD codepoint per offending byte,
+ * matching the decoding performed by unicode_utf8_decode_into()
+ *
+ * @param utf8 Input UTF-8 bytes (need not be null-terminated)
+ * @param byte_len Number of bytes to scan
+ * @return Number of codepoints the sequence decodes to
+ */
+size_t unicode_utf8_count(const char* utf8, size_t byte_len);
+
+/**
+ * Decode UTF-8 into a caller-provided codepoint buffer
+ *
+ * @param utf8 Input UTF-8 bytes (need not be null-terminated)
+ * @param byte_len Number of bytes to decode
+ * @param out Destination buffer, at least unicode_utf8_count() entries
+ * @return Number of codepoints written
+ */
+size_t unicode_utf8_decode_into(const char* utf8, size_t byte_len, int32_t* out);
+
+/**
+ * Get number of UTF-8 bytes needed to encode a codepoint array
+ *
+ * @param codepoints Array of UTF-32 codepoints
+ * @param len Number of codepoints
+ * @return Encoded size in bytes (excluding null terminator)
+ */
+size_t unicode_utf8_encoded_size(const int32_t* codepoints, size_t len);
+
+/**
+ * Encode codepoints as UTF-8 into a caller-provided buffer
+ *
+ * @param codepoints Array of UTF-32 codepoints
+ * @param len Number of codepoints
+ * @param out Destination buffer, at least unicode_utf8_encoded_size() bytes
+ * @return Number of bytes written (no null terminator is written)
+ */
+size_t unicode_utf8_encode_into(const int32_t* codepoints, size_t len, char* out);
+
+/**
+ * Strictly validate UTF-8 (rejects overlong forms, surrogates, values past
+ * U+10FFFF and truncated sequences). ASCII runs are checked a vector at a time.
+ *
+ * @param utf8 Input bytes
+ * @param byte_len Number of bytes
+ * @return 1 if the input is valid UTF-8, 0 otherwise
+ */
+int unicode_utf8_validate(const char* utf8, size_t byte_len);
+
 // =============================================================================
 // Unicode Case Conversion
 // =============================================================================
@@ -111,14 +161,15 @@ int unicode_codepoint_to_utf8_bytes(int32_t codepoint);
 
 /**
  * Get Unicode character category
- * Returns simplified category for basic classification
+ * Returns simplified category for basic classification, derived from the
+ * General Category in the generated tables (unicode_tables.h)
  * 
  * @param codepoint Unicode codepoint
  * @return Category code: 
  *         0 = Other
  *         1 = Letter
- *         2 = Number
- *         3 = Space
+ *         2 = Number (Nd, Nl, No)
+ *         3 = Space (White_Space property)
  *         4 = Punctuation
  *         5 = Symbol
  */
@@ -141,7 +192,7 @@ int unicode_is_space(int32_t codepoint);
 int unicode_is_letter(int32_t codepoint);
 
 /**
- * Check if codepoint is a digit
+ * Check if codepoint is a decimal digit (General Category Nd)
  * 
  * @param codepoint Unicode codepoint
  * @return 1 if digit, 0 otherwise
@@ -206,6 +257,35 @@ int32_t unicode_instr(const int32_t* haystack, int32_t haystack_len,
                       const int32_t* needle, int32_t needle_len,
                       int32_t start_pos);
 
+/**
+ * Find the first occurrence of a codepoint (vectorized scan)
+ *
+ * @param haystack Array to search in
+ * @param haystack_len Length of haystack
+ * @param codepoint Codepoint to search for
+ * @param start Starting index (0-based)
+ * @return 0-based index of the match, or (size_t)-1 if not found
+ */
+size_t unicode_find_codepoint(const int32_t* haystack, size_t haystack_len,
+                              int32_t codepoint, size_t start);
+
+/**
+ * Find needle in haystack in linear time
+ *
+ * Single-codepoint needles use the vectorized scan, short needles use a
+ * vectorized first-codepoint filter, and longer needles use the Two-Way
+ * algorithm (O(n + m) time, O(1) space).
+ *
+ * @param haystack Array to search in
+ * @param haystack_len Length of haystack
+ * @param needle Array to search for (an empty needle is never found)
+ * @param needle_len Length of needle
+ * @param start Starting index (0-based)
+ * @return 0-based index of the match, or (size_t)-1 if not found
+ */
+size_t unicode_find(const int32_t* haystack, size_t haystack_len,
+                    const int32_t* needle, size_t needle_len, size_t start);
+
 /**
  * Copy a portion of codepoint array (left substring, optimized)
  * 
@@ -0,0 +1,715 @@
+//
+// unicode_string.cpp
+// FasterBASIC - Pooled, Reference-Counted Unicode String Library Implementation
+//
+// See unicode_string.h for the memory strategy. UTF-8 conversion and case
+// mapping are shared with unicode_runtime.cpp.
+//
+
+#include "unicode_string.h"
+#include "unicode_runtime.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// =============================================================================
+// Internal Structures
+// =============================================================================
+
+// Storage kinds for a string's codepoint buffer
+static const int32_t STORAGE_INLINE = -1;     // Codepoints live in the header
+static const int32_t STORAGE_OVERSIZED = -2;  // Buffer too large for any size class
+
+// Cap on cached bytes per size class, so a burst of large strings does not
+// pin memory forever once it is released
+static const size_t MAX_CACHED_BYTES_PER_CLASS = 1024 * 1024;
+
+// Minimum number of recycled headers a pool keeps around
+static const size_t MIN_CACHED_HEADERS = 4096;
+
+struct UnicodeString {
+    int32_t refcount;
+    int32_t size_class;          // STORAGE_INLINE, STORAGE_OVERSIZED or class index
+    size_t length;               // Codepoints in use
+    size_t capacity;             // Codepoints available in data
+    int32_t* data;               // Points at inline_data or a pooled buffer
+    UnicodeStringPool* pool;     // Owning pool (receives header and buffer on release)
+    union {
+        int32_t inline_data[USTRING_INLINE_CAPACITY];
+        UnicodeString* next_free;  // Free-list link while the header is cached
+    };
+};
+
+// Cached buffers are linked through their first bytes
+struct FreeBuffer {
+    FreeBuffer* next;
+};
+
+struct UnicodeStringPool {
+    UnicodeString* free_headers;
+    size_t free_header_count;
+    size_t max_free_headers;
+
+    FreeBuffer* free_buffers[USTRING_SIZE_CLASSES];
+    size_t free_buffer_count[USTRING_SIZE_CLASSES];
+
+    size_t live_strings;
+    size_t live_builders;        // Open builders hold buffers from this pool too
+    size_t live_bytes;           // Headers and buffers of live strings
+    size_t cached_bytes;         // Headers and buffers sitting in free lists
+    bool destroyed;              // Destroy requested while strings or builders were still alive
+};
+
+struct UnicodeStringBuilder {
+    UnicodeStringPool* pool;
+    int32_t* data;
+    size_t length;
+    size_t capacity;
+    int32_t size_class;          // Class index or STORAGE_OVERSIZED
+};
+
+// Process-wide totals for ustring_global_stats()
+static std::atomic<size_t> g_total_strings(0);
+static std::atomic<size_t> g_total_memory(0);
+
+// =============================================================================
+// Size Classes
+// =============================================================================
+
+static inline size_t class_capacity(int32_t size_class) {
+    return (size_t)USTRING_MIN_CLASS_CAPACITY << size_class;
+}
+
+// Smallest class holding `length` codepoints, or STORAGE_OVERSIZED
+static inline int32_t size_class_for(size_t length) {
+    size_t capacity = USTRING_MIN_CLASS_CAPACITY;
+    for (int32_t cls = 0; cls < USTRING_SIZE_CLASSES; cls++) {
+        if (length <= capacity) return cls;
+        capacity <<= 1;
+    }
+    return STORAGE_OVERSIZED;
+}
+
+// =============================================================================
+// Pool Internals
+// =============================================================================
+
+static UnicodeStringPool* default_pool() {
+    static UnicodeStringPool* pool = ustring_pool_create(1000);
+    return pool;
+}
+
+static inline UnicodeStringPool* resolve_pool(UnicodeStringPool* pool, UString hint) {
+    if (pool && !pool->destroyed) return pool;
+    if (hint && hint->pool && !hint->pool->destroyed) return hint->pool;
+    return default_pool();
+}
+
+static UnicodeString* pool_take_header(UnicodeStringPool* pool) {
+    UnicodeString* header = pool->free_headers;
+    if (header) {
+        pool->free_headers = header->next_free;
+        pool->free_header_count--;
+        pool->cached_bytes -= sizeof(UnicodeString);
+        return header;
+    }
+    header = (UnicodeString*)malloc(sizeof(UnicodeString));
+    if (header) {
+        g_total_memory += sizeof(UnicodeString);
+    }
+    return header;
+}
+
+static void pool_give_header(UnicodeStringPool* pool, UnicodeString* header) {
+    if (!pool->destroyed && pool->free_header_count < pool->max_free_headers) {
+        header->next_free = pool->free_headers;
+        pool->free_headers = header;
+        pool->free_header_count++;
+        pool->cached_bytes += sizeof(UnicodeString);
+        return;
+    }
+    free(header);
+    g_total_memory -= sizeof(UnicodeString);
+}
+
+static int32_t* pool_take_buffer(UnicodeStringPool* pool, int32_t size_class, size_t length) {
+    if (size_class == STORAGE_OVERSIZED) {
+        int32_t* buffer = (int32_t*)malloc(length * sizeof(int32_t));
+        if (buffer) g_total_memory += length * sizeof(int32_t);
+        return buffer;
+    }
+
+    size_t bytes = class_capacity(size_class) * sizeof(int32_t);
+    FreeBuffer* cached = pool->free_buffers[size_class];
+    if (cached) {
+        pool->free_buffers[size_class] = cached->next;
+        pool->free_buffer_count[size_class]--;
+        pool->cached_bytes -= bytes;
+        return (int32_t*)cached;
+    }
+
+    int32_t* buffer = (int32_t*)malloc(bytes);
+    if (buffer) g_total_memory += bytes;
+    return buffer;
+}
+
+static void pool_give_buffer(UnicodeStringPool* pool, int32_t* buffer,
+                             int32_t size_class, size_t capacity) {
+    if (size_class == STORAGE_OVERSIZED) {
+        free(buffer);
+        g_total_memory -= capacity * sizeof(int32_t);
+        return;
+    }
+
+    size_t bytes = class_capacity(size_class) * sizeof(int32_t);
+    if (!pool->destroyed &&
+        (pool->free_buffer_count[size_class] + 1) * bytes <= MAX_CACHED_BYTES_PER_CLASS) {
+        FreeBuffer* node = (FreeBuffer*)buffer;
+        node->next = pool->free_buffers[size_class];
+        pool->free_buffers[size_class] = node;
+        pool->free_buffer_count[size_class]++;
+        pool->cached_bytes += bytes;
+        return;
+    }
+    free(buffer);
+    g_total_memory -= bytes;
+}
+
+// Free a destroyed pool once nothing refers to it any more
+static void pool_release_if_unused(UnicodeStringPool* pool) {
+    if (pool->destroyed && pool->live_strings == 0 && pool->live_builders == 0) {
+        free(pool);
+    }
+}
+
+static inline size_t storage_bytes(const UnicodeString* str) {
+    size_t bytes = sizeof(UnicodeString);
+    if (str->size_class != STORAGE_INLINE) {
+        bytes += str->capacity * sizeof(int32_t);
+    }
+    return bytes;
+}
+
+// Allocate an uninitialized string able to hold `length` codepoints
+static UnicodeString* alloc_string(UnicodeStringPool* pool, size_t length) {
+    UnicodeString* str = pool_take_header(pool);
+    if (!str) return nullptr;
+
+    if (length <= USTRING_INLINE_CAPACITY) {
+        str->size_class = STORAGE_INLINE;
+        str->capacity = USTRING_INLINE_CAPACITY;
+        str->data = str->inline_data;
+    } else {
+        int32_t size_class = size_class_for(length);
+        int32_t* buffer = pool_take_buffer(pool, size_class, length);
+        if (!buffer) {
+            pool_give_header(pool, str);
+            return nullptr;
+        }
+        str->size_class = size_class;
+        str->capacity = (size_class == STORAGE_OVERSIZED) ? length : class_capacity(size_class);
+        str->data = buffer;
+    }
+
+    str->refcount = 1;
+    str->length = length;
+    str->pool = pool;
+
+    pool->live_strings++;
+    pool->live_bytes += storage_bytes(str);
+    g_total_strings++;
+    return str;
+}
+
+static void pool_free_caches(UnicodeStringPool* pool) {
+    while (pool->free_headers) {
+        UnicodeString* next = pool->free_headers->next_free;
+        free(pool->free_headers);
+        g_total_memory -= sizeof(UnicodeString);
+        pool->free_headers = next;
+    }
+    pool->free_header_count = 0;
+
+    for (int32_t cls = 0; cls < USTRING_SIZE_CLASSES; cls++) {
+        size_t bytes = class_capacity(cls) * sizeof(int32_t);
+        while (pool->free_buffers[cls]) {
+            FreeBuffer* next = pool->free_buffers[cls]->next;
+            free(pool->free_buffers[cls]);
+            g_total_memory -= bytes;
+            pool->free_buffers[cls] = next;
+        }
+        pool->free_buffer_count[cls] = 0;
+    }
+    pool->cached_bytes = 0;
+}
+
+static void destroy_string(UnicodeString* str) {
+    UnicodeStringPool* pool = str->pool;
+
+    pool->live_strings--;
+    pool->live_bytes -= storage_bytes(str);
+    g_total_strings--;
+
+    if (str->size_class != STORAGE_INLINE) {
+        pool_give_buffer(pool, str->data, str->size_class, str->capacity);
+    }
+    pool_give_header(pool, str);
+
+    // Last string of a pool that was destroyed early
+    pool_release_if_unused(pool);
+}
+
+// New string holding a copy of `length` codepoints
+static UString make_string(UnicodeStringPool* pool, const int32_t* codepoints, size_t length) {
+    UnicodeString* str = alloc_string(pool, length);
+    if (str && length > 0) {
+        memcpy(str->data, codepoints, length * sizeof(int32_t));
+    }
+    return str;
+}
+
+// =============================================================================
+// Pool Management
+// =============================================================================
+
+UStringPool ustring_pool_create(size_t initial_capacity) {
+    UnicodeStringPool* pool = (UnicodeStringPool*)calloc(1, sizeof(UnicodeStringPool));
+    if (!pool) return nullptr;
+
+    pool->max_free_headers = initial_capacity > MIN_CACHED_HEADERS ? initial_capacity : MIN_CACHED_HEADERS;
+
+    // Warm the header free list so the first strings never hit malloc
+    for (size_t i = 0; i < initial_capacity; i++) {
+        UnicodeString* header = (UnicodeString*)malloc(sizeof(UnicodeString));
+        if (!header) break;
+        g_total_memory += sizeof(UnicodeString);
+        pool_give_header(pool, header);
+    }
+
+    return pool;
+}
+
+void ustring_pool_destroy(UStringPool pool) {
+    if (!pool || pool->destroyed) return;
+
+    pool->destroyed = true;
+    pool_free_caches(pool);
+    pool_release_if_unused(pool);
+}
+
+void ustring_pool_stats(UStringPool pool,
+                        size_t* out_allocated,
+                        size_t* out_pooled,
+                        size_t* out_total_memory) {
+    if (out_allocated) *out_allocated = pool ? pool->live_strings : 0;
+    if (out_pooled) *out_pooled = pool ? pool->free_header_count : 0;
+    if (out_total_memory) *out_total_memory = pool ? pool->live_bytes + pool->cached_bytes : 0;
+}
+
+// =============================================================================
+// String Creation
+// =============================================================================
+
+UString ustring_from_utf8(const char* utf8_str, UStringPool pool) {
+    pool = resolve_pool(pool, nullptr);
+    if (!utf8_str) return alloc_string(pool, 0);
+
+    size_t byte_len = strlen(utf8_str);
+    size_t length = unicode_utf8_count(utf8_str, byte_len);
+
+    UnicodeString* str = alloc_string(pool, length);
+    if (str) {
+        unicode_utf8_decode_into(utf8_str, byte_len, str->data);
+    }
+    return str;
+}
+
+UString ustring_from_codepoints(const int32_t* codepoints, size_t length, UStringPool pool) {
+    pool = resolve_pool(pool, nullptr);
+    if (!codepoints) length = 0;
+    return make_string(pool, codepoints, length);
+}
+
+UString ustring_empty(UStringPool pool) {
+    return alloc_string(resolve_pool(pool, nullptr), 0);
+}
+
+UString ustring_repeat(int32_t codepoint, size_t count, UStringPool pool) {
+    UnicodeString* str = alloc_string(resolve_pool(pool, nullptr), count);
+    if (str) {
+        for (size_t i = 0; i < count; i++) {
+            str->data[i] = codepoint;
+        }
+    }
+    return str;
+}
+
+// =============================================================================
+// Reference Counting
+// =============================================================================
+
+UString ustring_retain(UString str) {
+    if (str) str->refcount++;
+    return str;
+}
+
+void ustring_release(UString str) {
+    if (!str) return;
+    if (--str->refcount == 0) {
+        destroy_string(str);
+    }
+}
+
+int32_t ustring_refcount(UString str) {
+    return str ? str->refcount : 0;
+}
+
+// =============================================================================
+// Access
+// =============================================================================
+
+size_t ustring_length(UString str) {
+    return str ? str->length : 0;
+}
+
+const int32_t* ustring_codepoints(UString str) {
+    return str ? str->data : nullptr;
+}
+
+char* ustring_to_utf8(UString str, size_t* out_length) {
+    size_t length = str ? str->length : 0;
+    const int32_t* data = str ? str->data : nullptr;
+
+    size_t byte_len = unicode_utf8_encoded_size(data, length);
+    char* utf8 = (char*)malloc(byte_len + 1);
+    if (!utf8) return nullptr;
+
+    unicode_utf8_encode_into(data, length, utf8);
+    utf8[byte_len] = '\0';
+    if (out_length) *out_length = byte_len;
+    return utf8;
+}
+
+const char* ustring_to_utf8_lua(UString str) {
+    static thread_local std::vector<char> scratch;
+
+    size_t length = str ? str->length : 0;
+    const int32_t* data = str ? str->data : nullptr;
+
+    size_t byte_len = unicode_utf8_encoded_size(data, length);
+    scratch.resize(byte_len + 1);
+    unicode_utf8_encode_into(data, length, scratch.data());
+    scratch[byte_len] = '\0';
+    return scratch.data();
+}
+
+int32_t ustring_at(UString str, size_t index) {
+    if (!str || index >= str->length) return -1;
+    return str->data[index];
+}
+
+int ustring_is_empty(UString str) {
+    return (!str || str->length == 0) ? 1 : 0;
+}
+
+// =============================================================================
+// Operations
+// =============================================================================
+
+// Strings are immutable, so a result equal to an existing string can share it
+static inline UString share(UString str) {
+    return ustring_retain(str);
+}
+
+UString ustring_concat(UString str1, UString str2, UStringPool pool) {
+    pool = resolve_pool(pool, str1);
+    size_t len1 = str1 ? str1->length : 0;
+    size_t len2 = str2 ? str2->length : 0;
+
+    if (len2 == 0 && str1) return share(str1);
+    if (len1 == 0 && str2) return share(str2);
+
+    UnicodeString* result = alloc_string(pool, len1 + len2);
+    if (!result) return nullptr;
+
+    if (len1 > 0) memcpy(result->data, str1->data, len1 * sizeof(int32_t));
+    if (len2 > 0) memcpy(result->data + len1, str2->data, len2 * sizeof(int32_t));
+    return result;
+}
+
+UString ustring_substring(UString str, size_t start, size_t length, UStringPool pool) {
+    pool = resolve_pool(pool, str);
+    size_t src_len = str ? str->length : 0;
+
+    // Convert from 1-based BASIC indexing; MID$(s$, 0) behaves like MID$(s$, 1)
+    size_t start_idx = start > 0 ? start - 1 : 0;
+    if (start_idx >= src_len || length == 0) {
+        return alloc_string(pool, 0);
+    }
+
+    size_t actual_len = src_len - start_idx;
+    if (length < actual_len) actual_len = length;
+
+    if (actual_len == src_len) return share(str);
+    return make_string(pool, str->data + start_idx, actual_len);
+}
+
+UString ustring_left(UString str, size_t count, UStringPool pool) {
+    pool = resolve_pool(pool, str);
+    size_t src_len = str ? str->length : 0;
+
+    if (count >= src_len && str) return share(str);
+    return make_string(pool, str ? str->data : nullptr, count < src_len ? count : src_len);
+}
+
+UString ustring_right(UString str, size_t count, UStringPool pool) {
+    pool = resolve_pool(pool, str);
+    size_t src_len = str ? str->length : 0;
+
+    if (count >= src_len && str) return share(str);
+    return make_string(pool, str ? str->data + (src_len - count) : nullptr, str ? count : 0);
+}
+
+UString ustring_upper(UString str, UStringPool pool) {
+    pool = resolve_pool(pool, str);
+    size_t length = str ? str->length : 0;
+
+    UnicodeString* result = make_string(pool, str ? str->data : nullptr, length);
+    if (result) unicode_upper(result->data, (int32_t)length);
+    return result;
+}
+
+UString ustring_lower(UString str, UStringPool pool) {
+    pool = resolve_pool(pool, str);
+    size_t length = str ? str->length : 0;
+
+    UnicodeString* result = make_string(pool, str ? str->data : nullptr, length);
+    if (result) unicode_lower(result->data, (int32_t)length);
+    return result;
+}
+
+UString ustring_reverse(UString str, UStringPool pool) {
+    pool = resolve_pool(pool, str);
+    size_t length = str ? str->length : 0;
+
+    UnicodeString* result = alloc_string(pool, length);
+    if (result) {
+        for (size_t i = 0; i < length; i++) {
+            result->data[i] = str->data[length - 1 - i];
+        }
+    }
+    return result;
+}
+
+UString ustring_ltrim(UString str, UStringPool pool) {
+    pool = resolve_pool(pool, str);
+    size_t length = str ? str->length : 0;
+
+    size_t first = 0;
+    while (first < length && unicode_is_space(str->data[first])) first++;
+
+    if (first == 0 && str) return share(str);
+    return make_string(pool, str ? str->data + first : nullptr, length - first);
+}
+
+UString ustring_rtrim(UString str, UStringPool pool) {
+    pool = resolve_pool(pool, str);
+    size_t length = str ? str->length : 0;
+
+    size_t last = length;
+    while (last > 0 && unicode_is_space(str->data[last - 1])) last--;
+
+    if (last == length && str) return share(str);
+    return make_string(pool, str ? str->data : nullptr, last);
+}
+
+UString ustring_trim(UString str, UStringPool pool) {
+    pool = resolve_pool(pool, str);
+    size_t length = str ? str->length : 0;
+
+    size_t first = 0;
+    while (first < length && unicode_is_space(str->data[first])) first++;
+    size_t last = length;
+    while (last > first && unicode_is_space(str->data[last - 1])) last--;
+
+    if (first == 0 && last == length && str) return share(str);
+    return make_string(pool, str ? str->data + first : nullptr, last - first);
+}
+
+// =============================================================================
+// Comparison and Search
+// =============================================================================
+
+int ustring_equals(UString str1, UString str2) {
+    size_t len1 = str1 ? str1->length : 0;
+    size_t len2 = str2 ? str2->length : 0;
+
+    if (len1 != len2) return 0;
+    if (len1 == 0 || str1 == str2) return 1;
+    return memcmp(str1->data, str2->data, len1 * sizeof(int32_t)) == 0 ? 1 : 0;
+}
+
+int ustring_compare(UString str1, UString str2) {
+    size_t len1 = str1 ? str1->length : 0;
+    size_t len2 = str2 ? str2->length : 0;
+    size_t common = len1 < len2 ? len1 : len2;
+
+    for (size_t i = 0; i < common; i++) {
+        if (str1->data[i] != str2->data[i]) {
+            return str1->data[i] < str2->data[i] ? -1 : 1;
+        }
+    }
+    if (len1 == len2) return 0;
+    return len1 < len2 ? -1 : 1;
+}
+
+size_t ustring_find(UString haystack, UString needle, size_t start_pos) {
+    if (!haystack || !needle) {
+        return (size_t)-1;
+    }
+    // Vectorized scan for short needles, Two-Way for long ones
+    return unicode_find(haystack->data, haystack->length,
+                        needle->data, needle->length, start_pos);
+}
+
+// =============================================================================
+// Batch Operations
+// =============================================================================
+
+UString ustring_concat_many(UString* strings, size_t count, UStringPool pool) {
+    pool = resolve_pool(pool, count > 0 && strings ? strings[0] : nullptr);
+    if (!strings || count == 0) return alloc_string(pool, 0);
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (strings[i]) total += strings[i]->length;
+    }
+
+    UnicodeString* result = alloc_string(pool, total);
+    if (!result) return nullptr;
+
+    size_t pos = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (strings[i] && strings[i]->length > 0) {
+            memcpy(result->data + pos, strings[i]->data, strings[i]->length * sizeof(int32_t));
+            pos += strings[i]->length;
+        }
+    }
+    return result;
+}
+
+// =============================================================================
+// String Builder
+// =============================================================================
+
+static bool builder_reserve(UnicodeStringBuilder* builder, size_t needed) {
+    if (needed <= builder->capacity) return true;
+
+    size_t new_capacity = builder->capacity ? builder->capacity : USTRING_MIN_CLASS_CAPACITY;
+    while (new_capacity < needed) new_capacity <<= 1;
+
+    int32_t size_class = size_class_for(new_capacity);
+    int32_t* buffer = pool_take_buffer(builder->pool, size_class, new_capacity);
+    if (!buffer) return false;
+
+    if (builder->data) {
+        memcpy(buffer, builder->data, builder->length * sizeof(int32_t));
+        pool_give_buffer(builder->pool, builder->data, builder->size_class, builder->capacity);
+    }
+
+    builder->data = buffer;
+    builder->size_class = size_class;
+    builder->capacity = (size_class == STORAGE_OVERSIZED) ? new_capacity : class_capacity(size_class);
+    return true;
+}
+
+UStringBuilder ustring_builder_create(size_t initial_capacity, UStringPool pool) {
+    UnicodeStringBuilder* builder = (UnicodeStringBuilder*)calloc(1, sizeof(UnicodeStringBuilder));
+    if (!builder) return nullptr;
+
+    builder->pool = resolve_pool(pool, nullptr);
+    builder->size_class = STORAGE_OVERSIZED;
+    if (!builder_reserve(builder, initial_capacity > 0 ? initial_capacity : 1)) {
+        free(builder);
+        return nullptr;
+    }
+    builder->pool->live_builders++;
+    return builder;
+}
+
+int ustring_builder_append(UStringBuilder builder, UString str) {
+    if (!builder) return 0;
+    if (!str || str->length == 0) return 1;
+
+    if (!builder_reserve(builder, builder->length + str->length)) return 0;
+    memcpy(builder->data + builder->length, str->data, str->length * sizeof(int32_t));
+    builder->length += str->length;
+    return 1;
+}
+
+int ustring_builder_append_char(UStringBuilder builder, int32_t codepoint) {
+    if (!builder) return 0;
+    if (!builder_reserve(builder, builder->length + 1)) return 0;
+    builder->data[builder->length++] = codepoint;
+    return 1;
+}
+
+UString ustring_builder_build(UStringBuilder builder) {
+    if (!builder) return nullptr;
+
+    UnicodeStringPool* pool = builder->pool;
+    UnicodeString* result = nullptr;
+
+    if (builder->length <= USTRING_INLINE_CAPACITY) {
+        result = make_string(pool, builder->data, builder->length);
+        ustring_builder_destroy(builder);
+        return result;
+    }
+
+    // Hand the buffer over to a fresh header instead of copying it
+    result = pool_take_header(pool);
+    if (!result) {
+        ustring_builder_destroy(builder);
+        return nullptr;
+    }
+    result->refcount = 1;
+    result->size_class = builder->size_class;
+    result->length = builder->length;
+    result->capacity = builder->capacity;
+    result->data = builder->data;
+    result->pool = pool;
+
+    pool->live_strings++;
+    pool->live_bytes += storage_bytes(result);
+    g_total_strings++;
+
+    pool->live_builders--;
+    free(builder);
+    return result;
+}
+
+void ustring_builder_destroy(UStringBuilder builder) {
+    if (!builder) return;
+    UnicodeStringPool* pool = builder->pool;
+    if (builder->data) {
+        pool_give_buffer(pool, builder->data, builder->size_class, builder->capacity);
+    }
+    free(builder);
+
+    pool->live_builders--;
+    pool_release_if_unused(pool);
+}
+
+// =============================================================================
+// Utility
+// =============================================================================
+
+const char* ustring_version() {
+    return "1.0.0 (pooled)";
+}
+
+void ustring_global_stats(size_t* out_total_strings, size_t* out_total_memory) {
+    if (out_total_strings) *out_total_strings = g_total_strings.load();
+    if (out_total_memory) *out_total_memory = g_total_memory.load();
+}
@@ -0,0 +1,199 @@
+//
+// unicode_string.h
+// FasterBASIC - Pooled, Reference-Counted Unicode String Library
+//
+// Native backing store for OPTION UNICODE. Strings are immutable arrays of
+// UTF-32 codepoints owned by a UStringPool. This is the C ABI that
+// unicode_unified.lua and unicode_pooled.lua bind through the LuaJIT FFI
+// (built as libunicode_string.so / libunicode_string.dylib).
+//
+// Memory strategy:
+// - String headers are recycled through a per-pool free list
+// - Short strings (up to USTRING_INLINE_CAPACITY codepoints) live inside
+//   the header and need no separate buffer
+// - Longer strings use codepoint buffers drawn from power-of-two size-class
+//   free lists; very large buffers bypass the pool and go straight to malloc
+// - Every string carries a reference count; the last release returns the
+//   header and buffer to the pool that created them
+//
+// A pool is not thread-safe. Each Lua state should own its own pool.
+//
+
+#ifndef UNICODE_STRING_H
+#define UNICODE_STRING_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Codepoints stored directly inside the string header
+#define USTRING_INLINE_CAPACITY 8
+
+// Size classes: buffers of 16 << n codepoints for n in [0, USTRING_SIZE_CLASSES)
+#define USTRING_MIN_CLASS_CAPACITY 16
+#define USTRING_SIZE_CLASSES 13
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct UnicodeString* UString;
+typedef struct UnicodeStringPool* UStringPool;
+typedef struct UnicodeStringBuilder* UStringBuilder;
+
+// =============================================================================
+// Pool Management
+// =============================================================================
+
+/**
+ * Create a string pool
+ *
+ * @param initial_capacity Number of string headers to preallocate
+ * @return New pool, or NULL on allocation failure
+ */
+UStringPool ustring_pool_create(size_t initial_capacity);
+
+/**
+ * Destroy a pool and release its cached memory
+ * Strings and open builders keep the pool's bookkeeping alive until
+ * their last release, so destroying a pool early never invalidates a handle.
+ *
+ * @param pool Pool to destroy
+ */
+void ustring_pool_destroy(UStringPool pool);
+
+/**
+ * Report pool statistics (any output pointer may be NULL)
+ *
+ * @param pool Pool to inspect
+ * @param out_allocated Live strings owned by the pool
+ * @param out_pooled String headers cached for reuse
+ * @param out_total_memory Bytes held by the pool (live plus cached)
+ */
+void ustring_pool_stats(UStringPool pool,
+                        size_t* out_allocated,
+                        size_t* out_pooled,
+                        size_t* out_total_memory);
+
+// =============================================================================
+// String Creation (all return strings with refcount = 1)
+// =============================================================================
+
+UString ustring_from_utf8(const char* utf8_str, UStringPool pool);
+UString ustring_from_codepoints(const int32_t* codepoints, size_t length, UStringPool pool);
+UString ustring_empty(UStringPool pool);
+UString ustring_repeat(int32_t codepoint, size_t count, UStringPool pool);
+
+// =============================================================================
+// Reference Counting
+// =============================================================================
+
+UString ustring_retain(UString str);
+void ustring_release(UString str);
+int32_t ustring_refcount(UString str);
+
+// =============================================================================
+// Access
+// =============================================================================
+
+size_t ustring_length(UString str);
+const int32_t* ustring_codepoints(UString str);
+
+/**
+ * Encode as UTF-8 into a malloc'd buffer (caller must free)
+ *
+ * @param str String to encode
+ * @param out_length Optional: receives encoded length in bytes
+ * @return Null-terminated UTF-8 string
+ */
+char* ustring_to_utf8(UString str, size_t* out_length);
+
+/**
+ * Encode as UTF-8 into a per-thread scratch buffer
+ * The result is valid until the next call on the same thread; intended for
+ * FFI callers that immediately copy it with ffi.string().
+ */
+const char* ustring_to_utf8_lua(UString str);
+
+/**
+ * Codepoint at a 0-based index, or -1 when out of range
+ */
+int32_t ustring_at(UString str, size_t index);
+int ustring_is_empty(UString str);
+
+// =============================================================================
+// Operations (return new strings with refcount = 1)
+// =============================================================================
+
+UString ustring_concat(UString str1, UString str2, UStringPool pool);
+
+/**
+ * Extract a substring (BASIC MID$ semantics)
+ *
+ * @param start Starting position (1-based, BASIC convention)
+ * @param length Maximum number of codepoints to copy
+ */
+UString ustring_substring(UString str, size_t start, size_t length, UStringPool pool);
+UString ustring_left(UString str, size_t count, UStringPool pool);
+UString ustring_right(UString str, size_t count, UStringPool pool);
+UString ustring_upper(UString str, UStringPool pool);
+UString ustring_lower(UString str, UStringPool pool);
+UString ustring_reverse(UString str, UStringPool pool);
+UString ustring_ltrim(UString str, UStringPool pool);
+UString ustring_rtrim(UString str, UStringPool pool);
+UString ustring_trim(UString str, UStringPool pool);
+
+// =============================================================================
+// Comparison and Search
+// =============================================================================
+
+/** @return 1 if equal, 0 otherwise */
+int ustring_equals(UString str1, UString str2);
+
+/** @return -1, 0 or 1 (codepoint order) */
+int ustring_compare(UString str1, UString str2);
+
+/**
+ * Find needle in haystack (vectorized scan or Two-Way, see unicode_find)
+ *
+ * @param start_pos Position to start searching from (0-based)
+ * @return 0-based position of the match, or (size_t)-1 if not found
+ */
+size_t ustring_find(UString haystack, UString needle, size_t start_pos);
+
+// =============================================================================
+// Batch Operations
+// =============================================================================
+
+UString ustring_concat_many(UString* strings, size_t count, UStringPool pool);
+
+// =============================================================================
+// String Builder
+// =============================================================================
+
+UStringBuilder ustring_builder_create(size_t initial_capacity, UStringPool pool);
+int ustring_builder_append(UStringBuilder builder, UString str);
+int ustring_builder_append_char(UStringBuilder builder, int32_t codepoint);
+
+/**
+ * Produce the built string and destroy the builder
+ * The builder's buffer is handed to the new string without copying.
+ */
+UString ustring_builder_build(UStringBuilder builder);
+void ustring_builder_destroy(UStringBuilder builder);
+
+// =============================================================================
+// Utility
+// =============================================================================
+
+const char* ustring_version();
+
+/**
+ * Process-wide totals across every pool (any output pointer may be NULL)
+ */
+void ustring_global_stats(size_t* out_total_strings, size_t* out_total_memory);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UNICODE_STRING_H
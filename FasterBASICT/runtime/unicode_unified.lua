@@ -1,7 +1,8 @@
 -- unicode_unified.lua
--- Unified Unicode string library using memory addresses as handles
--- Zero overhead: pointer addresses are used directly as integer handles
--- No table lookups, no GC objects, just raw pointer manipulation
+-- Unified Unicode string library for OPTION UNICODE
+-- Strings are UString cdata pointing at contiguous, length-prefixed int32_t
+-- codepoint buffers in libunicode_string; every operation is one FFI call
+-- (memcpy or vectorized scan), and the GC drops each value's reference
 
 local ffi = require('ffi')
 
@@ -48,6 +49,8 @@ ffi.cdef [[
     UString ustring_upper(UString str, UStringPool pool);
     UString ustring_lower(UString str, UStringPool pool);
     UString ustring_reverse(UString str, UStringPool pool);
+    UString ustring_ltrim(UString str, UStringPool pool);
+    UString ustring_rtrim(UString str, UStringPool pool);
     UString ustring_trim(UString str, UStringPool pool);
 
     // Comparison
@@ -63,142 +66,337 @@ ffi.cdef [[
     // Utility
     const char* ustring_version();
 
-    // Memory functions
-    void free(void* ptr);
-
-    // For pointer arithmetic
-    typedef long intptr_t;
 ]]
 
 -- =============================================================================
 -- Library Loading
 -- =============================================================================
 
+-- Directories next to the fbc/fbsh executable come first (registered by
+-- register_runtime_preload), then the current directory as before
 local function try_load_library()
-    local paths = {
-        "./runtime/libunicode_string.dylib",
-        "./libunicode_string.dylib",
-        "runtime/libunicode_string.dylib",
-        "libunicode_string.dylib",
-        "./runtime/libunicode_string.so",
-        "./libunicode_string.so",
-        "libunicode_string.so",
-    }
+    local ext = ffi.os == "OSX" and ".dylib" or ".so"
+    local paths = {}
+    local dirs_ok, native_dirs = pcall(require, "runtime.native_dirs")
+    if dirs_ok and type(native_dirs) == "table" then
+        for _, dir in ipairs(native_dirs) do
+            paths[#paths + 1] = dir .. "libunicode_string" .. ext
+        end
+    end
+    paths[#paths + 1] = "./runtime/libunicode_string" .. ext
+    paths[#paths + 1] = "./libunicode_string" .. ext
+    paths[#paths + 1] = "libunicode_string" .. ext
 
+    -- Report the first failure that is not a missing file: it names the
+    -- real problem (wrong architecture, unresolved symbol, ...)
+    local load_error, missing_error
     for _, path in ipairs(paths) do
         local ok, lib = pcall(ffi.load, path)
         if ok then
             return lib
         end
+        local message = tostring(lib)
+        if message:find("No such file", 1, true) or message:find("not found", 1, true) then
+            missing_error = missing_error or message
+        else
+            load_error = load_error or message
+        end
     end
 
-    return nil
+    return nil, load_error or missing_error
 end
 
-local lib = try_load_library()
+local lib, load_error = try_load_library()
 local available = (lib ~= nil)
 
 if not available then
     return {
         available = false,
-        error = "Could not load libunicode_string library"
+        error = "Could not load libunicode_string library: " .. tostring(load_error)
     }
 end
 
 -- =============================================================================
--- Pointer ↔ Handle Conversion (Zero Overhead)
+-- String Values
 -- =============================================================================
 
--- Convert C pointer to integer handle (just the memory address)
-local function ptr_to_handle(ptr)
-    if ptr == nil or ptr == ffi.null then
-        return 0
-    end
-    return tonumber(ffi.cast("intptr_t", ptr))
+-- A Unicode string is a UString cdata: a pointer to the library's
+-- length-prefixed, contiguous int32_t codepoint buffer. Each cdata value owns
+-- one reference, dropped by the GC finalizer, so strings never need manual
+-- release and can never be confused with BASIC numbers.
+
+local UString_t = ffi.typeof("UString")
+local release_ref = lib.ustring_release
+local not_found = ffi.cast("size_t", -1)
+
+local g_pool = lib.ustring_pool_create(1000)
+
+-- Take ownership of a fresh reference returned by the library
+local function own(ptr)
+    return ffi.gc(ptr, release_ref)
 end
 
--- Convert integer handle back to C pointer
-local function handle_to_ptr(handle)
-    if handle == 0 then
-        return nil
-    end
-    return ffi.cast("UString", ffi.cast("intptr_t", handle))
+local EMPTY = own(lib.ustring_empty(g_pool))
+
+-- Create string from UTF-8
+local function from_utf8(utf8_str)
+    return own(lib.ustring_from_utf8(utf8_str or "", g_pool))
 end
 
 -- =============================================================================
--- Global Pool Management
+-- Ropes
 -- =============================================================================
 
-local g_pool = lib.ustring_pool_create(1000)
-local g_pool_handle = ptr_to_handle(ffi.cast("UStringPool", g_pool))
+-- Concatenation results longer than ROPE_LEAF_MAX codepoints are ropes:
+-- Lua tables whose children are UString leaves or other nodes, with the
+-- total length and tree height cached. Joins are height-balanced (AVL-style
+-- rotations down the spine), so no concatenation copies the whole string.
+--
+-- Appending short pieces (DOC$ = DOC$ + LINE$) is O(1): the rope keeps a
+-- pending group of pieces after its balanced body. Groups are shared
+-- append-only arrays, so a rope that owns the group's tip pushes into it in
+-- place and older ropes still see only their prefix. A full group is
+-- coalesced into one leaf buffer and joined into the body.
+--
+-- A rope is flattened into one UString only when a caller needs contiguous
+-- codepoints (indexing, search, slicing); the flat buffer then replaces its
+-- children. Output streams the leaves without flattening.
 
--- =============================================================================
--- Public API - All functions use integer handles (memory addresses)
--- =============================================================================
+local ROPE_LEAF_MAX = 8192
+local ROPE_GROUP_MAX = 256
 
--- Create string from UTF-8
-local function from_utf8(utf8_str)
-    local ustring = lib.ustring_from_utf8(utf8_str or "", g_pool)
-    return ptr_to_handle(ustring)
+local Rope = {}
+Rope.__index = Rope
+
+local function is_rope(value)
+    return getmetatable(value) == Rope
+end
+
+local function piece_length(piece)
+    if is_rope(piece) then
+        return piece.len
+    end
+    return tonumber(lib.ustring_length(piece))
+end
+
+local function piece_height(piece)
+    if is_rope(piece) then
+        return piece.height
+    end
+    return 0
+end
+
+local function make_node(left, right)
+    local lh, rh = piece_height(left), piece_height(right)
+    return setmetatable({
+        left = left,
+        right = right,
+        len = piece_length(left) + piece_length(right),
+        height = (lh > rh and lh or rh) + 1,
+    }, Rope)
+end
+
+-- Append a piece's leaves, left to right, to out (height is O(log n))
+local function collect_leaves(piece, out)
+    if not is_rope(piece) then
+        out[#out + 1] = piece
+    elseif piece.flat then
+        out[#out + 1] = piece.flat
+    elseif piece.group then
+        collect_leaves(piece.body, out)
+        local group = piece.group
+        for i = 1, piece.count do
+            out[#out + 1] = group[i]
+        end
+    else
+        collect_leaves(piece.left, out)
+        collect_leaves(piece.right, out)
+    end
+    return out
+end
+
+-- Copy a list of UStrings into one new buffer
+local function concat_leaves(leaves, first, last)
+    local n = last - first + 1
+    local ustrings = ffi.new("UString[?]", n)
+    for i = 0, n - 1 do
+        ustrings[i] = leaves[first + i]
+    end
+    return own(lib.ustring_concat_many(ustrings, n, g_pool))
+end
+
+-- Materialize a rope as one contiguous UString (cached on the rope)
+local function flatten(rope)
+    local flat = rope.flat
+    if flat then
+        return flat
+    end
+    local leaves = collect_leaves(rope, {})
+    flat = concat_leaves(leaves, 1, #leaves)
+    rope.flat = flat
+    rope.left, rope.right, rope.body, rope.group, rope.sealed = nil, nil, nil, nil, nil
+    rope.height = 0
+    return flat
+end
+
+local join
+
+-- Reduce a rope to a balanced tree or leaf usable as a join operand
+local function as_piece(piece)
+    if not is_rope(piece) then
+        return piece
+    elseif piece.flat then
+        return piece.flat
+    elseif piece.group then
+        local sealed = piece.sealed
+        if not sealed then
+            local group, count = piece.group, piece.count
+            local leaf = count == 1 and group[1] or concat_leaves(group, 1, count)
+            sealed = join(piece.body, leaf)
+            piece.sealed = sealed
+        end
+        return sealed
+    end
+    return piece
+end
+
+-- Height-balanced concatenation of two pieces
+join = function(a, b)
+    a, b = as_piece(a), as_piece(b)
+    local ha, hb = piece_height(a), piece_height(b)
+
+    if ha == 0 and hb == 0 then
+        -- Coalesce adjacent leaves while they fit one leaf buffer
+        if piece_length(a) + piece_length(b) <= ROPE_LEAF_MAX then
+            return own(lib.ustring_concat(a, b, g_pool))
+        end
+        return make_node(a, b)
+    end
+
+    if ha > hb + 1 then
+        local right = join(a.right, b)
+        if piece_height(right) > piece_height(a.left) + 1 then
+            return make_node(make_node(a.left, right.left), right.right)
+        end
+        return make_node(a.left, right)
+    elseif hb > ha + 1 then
+        local left = join(a, b.left)
+        if piece_height(left) > piece_height(b.right) + 1 then
+            return make_node(left.left, make_node(left.right, b.right))
+        end
+        return make_node(left, b.right)
+    end
+    return make_node(a, b)
+end
+
+-- Rope with a pending group of short pieces after body
+local function make_appendable(body, group, count, group_len)
+    return setmetatable({
+        body = body,
+        group = group,
+        count = count,
+        group_len = group_len,
+        len = piece_length(body) + group_len,
+        height = piece_height(body) + 1,
+    }, Rope)
+end
+
+-- Append a short leaf to a rope
+local function append(rope, leaf, leaf_len)
+    local group = rope.group
+    if group and not rope.flat then
+        local count = rope.count
+        if group.n == count and count < ROPE_GROUP_MAX
+                and rope.group_len + leaf_len <= ROPE_LEAF_MAX then
+            count = count + 1
+            group[count] = leaf
+            group.n = count
+            return make_appendable(rope.body, group, count, rope.group_len + leaf_len)
+        end
+    end
+    return make_appendable(as_piece(rope), { leaf, n = 1 }, 1, leaf_len)
+end
+
+-- Coerce any BASIC value (UString, rope, Lua string, number, nil) to a UString
+local function coerce(value)
+    if ffi.istype(UString_t, value) then
+        return value
+    elseif value == nil then
+        return EMPTY
+    elseif is_rope(value) then
+        return flatten(value)
+    end
+    return from_utf8(tostring(value))
+end
+
+local function is_ustring(value)
+    return ffi.istype(UString_t, value) or getmetatable(value) == Rope
+end
+
+-- Coerce to a string or rope without flattening
+local function coerce_piece(value)
+    if is_rope(value) then
+        return value
+    end
+    return coerce(value)
 end
 
 -- Create string from codepoint table
 local function from_table(codepoint_table)
-    if not codepoint_table or #codepoint_table == 0 then
-        local ustring = lib.ustring_empty(g_pool)
-        return ptr_to_handle(ustring)
+    local n = codepoint_table and #codepoint_table or 0
+    if n == 0 then
+        return EMPTY
     end
 
-    local array = ffi.new("int32_t[?]", #codepoint_table)
-    for i = 1, #codepoint_table do
+    local array = ffi.new("int32_t[?]", n)
+    for i = 1, n do
         array[i - 1] = codepoint_table[i]
     end
-
-    local ustring = lib.ustring_from_codepoints(array, #codepoint_table, g_pool)
-    return ptr_to_handle(ustring)
+    return own(lib.ustring_from_codepoints(array, n, g_pool))
 end
 
 -- Create empty string
 local function empty()
-    local ustring = lib.ustring_empty(g_pool)
-    return ptr_to_handle(ustring)
+    return EMPTY
 end
 
 -- Repeat a character
 local function repeat_char(codepoint, count)
-    local ustring = lib.ustring_repeat(codepoint, count, g_pool)
-    return ptr_to_handle(ustring)
-end
-
--- Convert handle to UTF-8 string (optimized: single FFI call)
-local function to_utf8(handle)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
-        return ""
-    end
-
-    -- Use optimized version that returns static buffer (no manual free needed)
-    local cstr = lib.ustring_to_utf8_lua(ustring)
-    if not cstr then
-        return ""
+    if count <= 0 then
+        return EMPTY
     end
-
-    return ffi.string(cstr)
+    return own(lib.ustring_repeat(codepoint, count, g_pool))
 end
 
--- Convert handle to codepoint table
-local function to_table(handle)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
-        return {}
+-- Convert to UTF-8 Lua string (single FFI call into a scratch buffer)
+local function to_utf8(str)
+    if is_rope(str) then
+        str = flatten(str)
+    elseif not ffi.istype(UString_t, str) then
+        return str == nil and "" or tostring(str)
     end
+    return ffi.string(lib.ustring_to_utf8_lua(str))
+end
 
-    local len = lib.ustring_length(ustring)
-    if len == 0 then
-        return {}
+-- Write as UTF-8 to a file (default io.stdout); ropes are streamed leaf by
+-- leaf rather than flattened
+local function write(str, file)
+    file = file or io.stdout
+    if is_rope(str) and not str.flat then
+        local leaves = collect_leaves(str, {})
+        for i = 1, #leaves do
+            file:write(ffi.string(lib.ustring_to_utf8_lua(leaves[i])))
+        end
+        return
     end
+    file:write(to_utf8(str))
+end
 
-    local codepoints_ptr = lib.ustring_codepoints(ustring)
+-- Convert to codepoint table
+local function to_table(str)
+    str = coerce(str)
+    local len = tonumber(lib.ustring_length(str))
+    local codepoints_ptr = lib.ustring_codepoints(str)
     local result = {}
     for i = 0, len - 1 do
         result[i + 1] = codepoints_ptr[i]
@@ -207,269 +405,203 @@ local function to_table(handle)
 end
 
 -- Get length
-local function length(handle)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
-        return 0
+local function length(str)
+    if is_rope(str) then
+        return str.len
     end
-    return tonumber(lib.ustring_length(ustring))
+    return tonumber(lib.ustring_length(coerce(str)))
 end
 
--- Get character at position (1-based)
-local function at(handle, pos)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
+-- Get character at position (1-based); 0 when out of range
+local function at(str, pos)
+    if pos < 1 then
         return 0
     end
-    return lib.ustring_at(ustring, pos - 1) -- Convert to 0-based
+    local cp = lib.ustring_at(coerce(str), pos - 1)
+    return cp < 0 and 0 or cp
 end
 
 -- Check if empty
-local function is_empty(handle)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
-        return true
+local function is_empty(str)
+    if is_rope(str) then
+        return str.len == 0
+    end
+    return lib.ustring_is_empty(coerce(str)) ~= 0
+end
+
+-- Concatenate two strings: short results are copied into one buffer, long
+-- ones become rope nodes
+local function concat(a, b)
+    a, b = coerce_piece(a), coerce_piece(b)
+    if a == EMPTY then
+        return b
+    elseif b == EMPTY then
+        return a
+    end
+    if is_rope(a) and not is_rope(b) then
+        local b_len = tonumber(lib.ustring_length(b))
+        if b_len <= ROPE_LEAF_MAX then
+            return append(a, b, b_len)
+        end
     end
-    return lib.ustring_is_empty(ustring) ~= 0
+    return join(a, b)
 end
 
--- Concatenate two strings
-local function concat(handle1, handle2)
-    local ustring1 = handle_to_ptr(handle1)
-    local ustring2 = handle_to_ptr(handle2)
-
-    if not ustring1 or not ustring2 then
-        return 0
+-- Substring (1-based start, optional length); out-of-range requests give ""
+local function substring(str, start, len)
+    str = coerce(str)
+    if len == nil then
+        len = tonumber(lib.ustring_length(str))
     end
-
-    local result = lib.ustring_concat(ustring1, ustring2, g_pool)
-    return ptr_to_handle(result)
-end
-
--- Substring (1-based start, length)
-local function substring(handle, start, len)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
-        return 0
+    if start < 1 or len <= 0 then
+        return EMPTY
     end
-
-    local result = lib.ustring_substring(ustring, start, len, g_pool) -- C function expects 1-based
-    return ptr_to_handle(result)
+    return own(lib.ustring_substring(str, start, len, g_pool))
 end
 
 -- Left substring
-local function left(handle, count)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
-        return 0
+local function left(str, count)
+    if count <= 0 then
+        return EMPTY
     end
-
-    local result = lib.ustring_left(ustring, count, g_pool)
-    return ptr_to_handle(result)
+    return own(lib.ustring_left(coerce(str), count, g_pool))
 end
 
 -- Right substring
-local function right(handle, count)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
-        return 0
+local function right(str, count)
+    if count <= 0 then
+        return EMPTY
     end
-
-    local result = lib.ustring_right(ustring, count, g_pool)
-    return ptr_to_handle(result)
+    return own(lib.ustring_right(coerce(str), count, g_pool))
 end
 
 -- Uppercase
-local function upper(handle)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
-        return 0
-    end
-
-    local result = lib.ustring_upper(ustring, g_pool)
-    return ptr_to_handle(result)
+local function upper(str)
+    return own(lib.ustring_upper(coerce(str), g_pool))
 end
 
 -- Lowercase
-local function lower(handle)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
-        return 0
-    end
-
-    local result = lib.ustring_lower(ustring, g_pool)
-    return ptr_to_handle(result)
+local function lower(str)
+    return own(lib.ustring_lower(coerce(str), g_pool))
 end
 
 -- Reverse
-local function reverse(handle)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
-        return 0
-    end
-
-    local result = lib.ustring_reverse(ustring, g_pool)
-    return ptr_to_handle(result)
+local function reverse(str)
+    return own(lib.ustring_reverse(coerce(str), g_pool))
 end
 
 -- Trim
-local function trim(handle)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
-        return 0
-    end
-
-    local result = lib.ustring_trim(ustring, g_pool)
-    return ptr_to_handle(result)
+local function ltrim(str)
+    return own(lib.ustring_ltrim(coerce(str), g_pool))
 end
 
--- Equality comparison
-local function equals(handle1, handle2)
-    local ustring1 = handle_to_ptr(handle1)
-    local ustring2 = handle_to_ptr(handle2)
+local function rtrim(str)
+    return own(lib.ustring_rtrim(coerce(str), g_pool))
+end
 
-    if not ustring1 or not ustring2 then
-        return false
-    end
+local function trim(str)
+    return own(lib.ustring_trim(coerce(str), g_pool))
+end
 
-    return lib.ustring_equals(ustring1, ustring2) ~= 0
+-- Equality comparison
+local function equals(a, b)
+    return lib.ustring_equals(coerce(a), coerce(b)) ~= 0
 end
 
 -- Compare (returns -1, 0, or 1)
-local function compare(handle1, handle2)
-    local ustring1 = handle_to_ptr(handle1)
-    local ustring2 = handle_to_ptr(handle2)
-
-    if not ustring1 or not ustring2 then
-        return 0
-    end
-
-    return lib.ustring_compare(ustring1, ustring2)
+local function compare(a, b)
+    return lib.ustring_compare(coerce(a), coerce(b))
 end
 
 -- Find substring (returns 1-based position, or 0 if not found)
-local function find(haystack_handle, needle_handle, start_pos)
+local function find(haystack, needle, start_pos)
     start_pos = start_pos or 1
-
-    local haystack = handle_to_ptr(haystack_handle)
-    local needle = handle_to_ptr(needle_handle)
-
-    if not haystack or not needle then
-        return 0
+    if start_pos < 1 then
+        start_pos = 1
     end
 
-    local pos = lib.ustring_find(haystack, needle, start_pos - 1) -- Convert to 0-based
-    if pos == 0 or pos == ffi.cast("size_t", -1) then
+    local pos = lib.ustring_find(coerce(haystack), coerce(needle), start_pos - 1) -- Convert to 0-based
+    if pos == not_found then
         return 0
     end
     return tonumber(pos) + 1 -- Convert back to 1-based
 end
 
--- Concatenate multiple handles
-local function concat_many(handle_array)
-    if not handle_array or #handle_array == 0 then
-        return empty()
+-- Concatenate many strings with a single allocation
+local function concat_many(list)
+    local n = list and #list or 0
+    if n == 0 then
+        return EMPTY
     end
 
-    local ustrings = ffi.new("UString[?]", #handle_array)
-    for i = 1, #handle_array do
-        ustrings[i - 1] = handle_to_ptr(handle_array[i])
+    local ustrings = ffi.new("UString[?]", n)
+    for i = 1, n do
+        ustrings[i - 1] = coerce(list[i])
     end
-
-    local result = lib.ustring_concat_many(ustrings, #handle_array, g_pool)
-    return ptr_to_handle(result)
+    -- list keeps every coerced value reachable until the call returns
+    local result = own(lib.ustring_concat_many(ustrings, n, g_pool))
+    return result
 end
 
--- Release a handle (IMPORTANT: must be called when done with string)
-local function release(handle)
-    local ustring = handle_to_ptr(handle)
-    if ustring then
-        lib.ustring_release(ustring)
+-- Drop a string's reference now instead of waiting for the GC
+local function release(str)
+    if ffi.istype(UString_t, str) and str ~= EMPTY then
+        ffi.gc(str, nil)
+        release_ref(str)
     end
 end
 
--- Release multiple handles
-local function release_many(handle_array)
-    for i = 1, #handle_array do
-        release(handle_array[i])
+-- Release multiple strings
+local function release_many(list)
+    for i = 1, #list do
+        release(list[i])
     end
 end
 
--- Retain (increment reference count) - returns same handle
-local function retain(handle)
-    local ustring = handle_to_ptr(handle)
-    if ustring then
-        lib.ustring_retain(ustring)
-    end
-    return handle
+-- Retain: returns a second owning reference to the same buffer
+local function retain(str)
+    return own(lib.ustring_retain(coerce(str)))
 end
 
 -- Get reference count
-local function refcount(handle)
-    local ustring = handle_to_ptr(handle)
-    if not ustring then
-        return 0
-    end
-    return lib.ustring_refcount(ustring)
+local function refcount(str)
+    return lib.ustring_refcount(coerce(str))
 end
 
 -- =============================================================================
--- BASIC-Compatible API (uses handles)
+-- BASIC-Compatible API
 -- =============================================================================
 
-local function unicode_from_utf8(utf8_str)
-    return from_utf8(utf8_str)
-end
-
-local function unicode_to_utf8(handle)
-    return to_utf8(handle)
-end
-
-local function unicode_len(handle)
-    return length(handle)
-end
-
-local function unicode_concat(h1, h2)
-    return concat(h1, h2)
-end
-
-local function unicode_left(handle, n)
-    return left(handle, n)
-end
-
-local function unicode_right(handle, n)
-    return right(handle, n)
-end
-
-local function unicode_mid(handle, start, len)
-    return substring(handle, start, len)
-end
-
-local function unicode_upper(handle)
-    return upper(handle)
-end
+-- String literals are converted once and shared (strings are immutable)
+local literal_cache = {}
+local literal_count = 0
+local LITERAL_CACHE_LIMIT = 4096
 
-local function unicode_lower(handle)
-    return lower(handle)
-end
-
-local function unicode_reverse(handle)
-    return reverse(handle)
-end
-
-local function unicode_trim(handle)
-    return trim(handle)
+local function unicode_from_utf8(utf8_str)
+    local cached = literal_cache[utf8_str]
+    if cached then
+        return cached
+    end
+    cached = from_utf8(utf8_str)
+    if literal_count >= LITERAL_CACHE_LIMIT then
+        literal_cache = {}
+        literal_count = 0
+    end
+    literal_cache[utf8_str] = cached
+    literal_count = literal_count + 1
+    return cached
 end
 
-local function unicode_string_equal(h1, h2)
-    return equals(h1, h2)
+local function unicode_mid(str, start, len)
+    return substring(str, start, len)
 end
 
-local function unicode_string_compare(h1, h2)
-    return compare(h1, h2)
+local function unicode_instr(haystack, needle, start)
+    return find(haystack, needle, start)
 end
 
-local function unicode_instr(haystack, needle, start)
+-- INSTR(start, haystack$, needle$)
+local function unicode_instr_start(start, haystack, needle)
     return find(haystack, needle, start)
 end
 
@@ -477,32 +609,21 @@ local function unicode_chr(codepoint)
     return repeat_char(codepoint, 1)
 end
 
-local function unicode_asc(handle, pos)
-    pos = pos or 1
-    return at(handle, pos)
+local function unicode_asc(str, pos)
+    return at(str, pos or 1)
 end
 
 local function unicode_space(count)
     return repeat_char(32, count) -- ASCII space
 end
 
-local function unicode_string(handle, count)
-    if type(handle) == "number" and count then
-        -- BASIC STRING$(count, char)
-        return repeat_char(handle, count)
-    elseif type(handle) == "number" then
-        -- BASIC STRING$(char)
-        return repeat_char(handle, 1)
+-- STRING$(count, char): char is a codepoint or a string whose first
+-- character is repeated
+local function unicode_string(count, char)
+    if type(char) ~= "number" then
+        char = at(char, 1)
     end
-    return 0
-end
-
-local function unicode_release(handle)
-    release(handle)
-end
-
-local function unicode_release_many(handle_array)
-    release_many(handle_array)
+    return repeat_char(char, count)
 end
 
 -- =============================================================================
@@ -530,24 +651,22 @@ local function version()
 end
 
 local function info()
-    print("Unified Unicode Library (Memory Addresses as Handles)")
+    print("Unified Unicode Library (FFI codepoint buffers)")
     print("  Available: " .. tostring(available))
     print("  Version: " .. version())
-    print("  Pool handle: 0x" .. string.format("%x", g_pool_handle))
     print("  Pool Statistics:")
     pool_stats()
     print()
-    print("  Zero overhead design:")
-    print("    • Handles ARE memory addresses (no table lookup)")
-    print("    • Direct pointer casting (no wrapper objects)")
-    print("    • Background thread memory reclamation")
-    print("    • Zero Lua GC overhead")
+    print("  Design:")
+    print("    • Strings are cdata pointers to contiguous int32_t buffers")
+    print("    • Operations are single FFI calls (memcpy / vectorized search)")
+    print("    • References are dropped by the LuaJIT GC")
+    print("    • Long concatenations are balanced ropes, flattened on demand")
 end
 
 -- Cleanup on exit
 local function cleanup()
-    -- User must release all handles manually before cleanup
-    -- Destroy pool
+    -- Strings still alive keep the pool's bookkeeping until their release
     if g_pool then
         lib.ustring_pool_destroy(g_pool)
         g_pool = nil
@@ -561,7 +680,7 @@ end
 return {
     available = available,
 
-    -- Core API (handles are memory addresses)
+    -- Core API
     from_utf8 = from_utf8,
     from_table = from_table,
     empty = empty,
@@ -570,9 +689,15 @@ return {
     release_many = release_many,
     retain = retain,
     refcount = refcount,
+    is_ustring = is_ustring,
+    is_rope = is_rope,
+    flatten = coerce,
+    coerce = coerce,
+    UString = UString_t,
 
-    -- String operations (all work with handles)
+    -- String operations
     to_utf8 = to_utf8,
+    write = write,
     to_table = to_table,
     length = length,
     at = at,
@@ -584,6 +709,8 @@ return {
     upper = upper,
     lower = lower,
     reverse = reverse,
+    ltrim = ltrim,
+    rtrim = rtrim,
     trim = trim,
     equals = equals,
     compare = compare,
@@ -592,32 +719,31 @@ return {
 
     -- BASIC-compatible API
     unicode_from_utf8 = unicode_from_utf8,
-    unicode_to_utf8 = unicode_to_utf8,
-    unicode_len = unicode_len,
-    unicode_concat = unicode_concat,
-    unicode_left = unicode_left,
-    unicode_right = unicode_right,
+    unicode_to_utf8 = to_utf8,
+    unicode_len = length,
+    unicode_concat = concat,
+    unicode_left = left,
+    unicode_right = right,
     unicode_mid = unicode_mid,
-    unicode_upper = unicode_upper,
-    unicode_lower = unicode_lower,
-    unicode_reverse = unicode_reverse,
-    unicode_trim = unicode_trim,
-    unicode_string_equal = unicode_string_equal,
-    unicode_string_compare = unicode_string_compare,
+    unicode_upper = upper,
+    unicode_lower = lower,
+    unicode_reverse = reverse,
+    unicode_ltrim = ltrim,
+    unicode_rtrim = rtrim,
+    unicode_trim = trim,
+    unicode_string_equal = equals,
+    unicode_string_compare = compare,
     unicode_instr = unicode_instr,
+    unicode_instr_start = unicode_instr_start,
     unicode_chr = unicode_chr,
     unicode_asc = unicode_asc,
     unicode_space = unicode_space,
     unicode_string = unicode_string,
-    unicode_release = unicode_release,
+    unicode_release = release,
 
     -- Utilities
     pool_stats = pool_stats,
     version = version,
     info = info,
     cleanup = cleanup,
-
-    -- Low-level (for advanced use)
-    ptr_to_handle = ptr_to_handle,
-    handle_to_ptr = handle_to_ptr,
 }
@@ -0,0 +1,86 @@
+--
+-- unicode_utf8_bench.lua
+-- FasterBASIC - UTF-8 transcoding throughput benchmark
+--
+-- Measures validation, UTF-8 -> UTF-32 decoding and UTF-32 -> UTF-8
+-- encoding in libunicode_string over ASCII-only, Latin and CJK corpora.
+-- These are the conversions every OPTION UNICODE string literal, INPUT and
+-- PRINT goes through.
+--
+-- Usage (from the directory containing runtime/):
+--   luajit runtime/unicode_utf8_bench.lua [megabytes]
+--
+
+local ffi = require('ffi')
+ffi.cdef [[
+    size_t unicode_utf8_count(const char* utf8, size_t byte_len);
+    size_t unicode_utf8_decode_into(const char* utf8, size_t byte_len, int32_t* out);
+    size_t unicode_utf8_encoded_size(const int32_t* codepoints, size_t len);
+    size_t unicode_utf8_encode_into(const int32_t* codepoints, size_t len, char* out);
+    int unicode_utf8_validate(const char* utf8, size_t byte_len);
+]]
+
+local lib = ffi.load('runtime/libunicode_string' .. (ffi.os == 'OSX' and '.dylib' or '.so'))
+
+local megabytes = tonumber(arg and arg[1]) or 64
+local target_bytes = megabytes * 1024 * 1024
+
+local corpora = {
+    { name = 'ASCII',
+      sample = 'The quick brown fox jumps over the lazy dog. 0123456789 ' },
+    { name = 'Latin',
+      sample = 'Größere Übungen für Çağdaş écoles — ¡niño! Ærø ñandú ' },
+    { name = 'CJK',
+      sample = '統一碼は世界中の文字を扱うための標準規格です。한국어 텍스트 ' },
+}
+
+-- Build a corpus of about 1 MB by repetition
+local function build_corpus(sample)
+    local copies = math.floor(1024 * 1024 / #sample) + 1
+    return string.rep(sample, copies)
+end
+
+local function bench(label, bytes_per_pass, passes, fn)
+    local start = os.clock()
+    for _ = 1, passes do
+        fn()
+    end
+    local elapsed = os.clock() - start
+    local mb = bytes_per_pass * passes / (1024 * 1024)
+    print(string.format('  %-10s %8.1f MB/s', label, mb / elapsed))
+end
+
+print('UTF-8 Transcoding Benchmark')
+print(string.format('  Data per test: %d MB', megabytes))
+print('')
+
+for _, corpus in ipairs(corpora) do
+    local text = build_corpus(corpus.sample)
+    local byte_len = #text
+    local passes = math.max(1, math.floor(target_bytes / byte_len))
+
+    local count = tonumber(lib.unicode_utf8_count(text, byte_len))
+    local codepoints = ffi.new('int32_t[?]', count)
+    lib.unicode_utf8_decode_into(text, byte_len, codepoints)
+    local encoded = ffi.new('char[?]', byte_len)
+
+    print(string.format('%s corpus: %d bytes, %d codepoints (%.2f bytes/codepoint)',
+        corpus.name, byte_len, count, byte_len / count))
+
+    assert(lib.unicode_utf8_validate(text, byte_len) == 1)
+    assert(tonumber(lib.unicode_utf8_encode_into(codepoints, count, encoded)) == byte_len)
+    assert(ffi.string(encoded, byte_len) == text)
+
+    bench('validate', byte_len, passes, function()
+        lib.unicode_utf8_validate(text, byte_len)
+    end)
+    bench('decode', byte_len, passes, function()
+        lib.unicode_utf8_count(text, byte_len)
+        lib.unicode_utf8_decode_into(text, byte_len, codepoints)
+    end)
+    bench('encode', byte_len, passes, function()
+        lib.unicode_utf8_encoded_size(codepoints, count)
+        lib.unicode_utf8_encode_into(codepoints, count, encoded)
+    end)
+    print('')
+end
@@ -60,6 +60,7 @@ extern "C" {
 extern "C" void register_unicode_module(lua_State* L);
 extern "C" void register_bitwise_module(lua_State* L);
 extern "C" void register_constants_module(lua_State* L);
+extern "C" void register_runtime_preload(lua_State* L);
 extern "C" void set_constants_manager(FasterBASIC::ConstantsManager* manager);
 
 // Forward declare file I/O bindings
@@ -1551,6 +1552,7 @@ bool ShellCore::executeCompiledProgram(const std::string& program, int startLine
         register_unicode_module(L);
         register_bitwise_module(L);
         register_constants_module(L);
+        register_runtime_preload(L);
         set_constants_manager(&semantic.getConstantsManager());
 
         FasterBASIC::register_fileio_functions(L);
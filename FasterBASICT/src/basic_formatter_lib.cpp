@@ -174,7 +174,7 @@ static std::string uppercaseKeywords(const std::string& content, const FasterBAS
         "FOR", "TO", "STEP", "NEXT", "WHILE", "WEND", "ENDWHILE",
         "REPEAT", "UNTIL", "DO", "LOOP", "IF", "THEN", "ELSE",
         "ELSEIF", "ELSIF", "ENDIF", "END", "GOTO", "GOSUB", "RETURN",
-        "DIM", "REDIM", "ERASE", "PRESERVE", "LOCAL", "SHARED", "LET", 
+        "DIM", "REDIM", "ERASE", "PRESERVE", "PUSH", "POP", "DICT", "REMOVE", "KEYS", "HAS", "LOCAL", "SHARED", "LET", 
         "PRINT", "CONSOLE", "INPUT", "READ", "DATA", "WRITE",
         "RESTORE", "REM", "AND", "OR", "NOT", "XOR", "MOD", "EQV", "IMP",
         "SUB", "FUNCTION", "ENDSUB", "ENDFUNCTION", "DEF", "FN", "CALL", "EXIT",
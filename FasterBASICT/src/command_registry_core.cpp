@@ -146,8 +146,8 @@ void CoreCommandRegistry::registerMathCommands(CommandRegistry& registry) {
     // RANDOMIZE - Initialize random number generator
     CommandDefinition randomize("RANDOMIZE",
                                "Initialize random number generator",
-                               "randomize", "math");
-    randomize.addParameter("seed", ParameterType::INT, "Random seed value", true, "nil");
+                               "basic_randomize", "math");
+    randomize.addParameter("seed", ParameterType::FLOAT, "Random seed value (clock if omitted)", true, "nil");
     registry.registerCommand(std::move(randomize));
 }
 
@@ -243,8 +243,8 @@ void CoreCommandRegistry::registerMathFunctions(CommandRegistry& registry) {
     registry.registerFunction(std::move(int_fn));
     
     // RND - Random number
-    CommandDefinition rnd("RND", "Return random number 0-1", "math.random", "math");
-    rnd.addParameter("seed", ParameterType::INT, "Random range (optional)", true, "1")
+    CommandDefinition rnd("RND", "Return random number 0-1", "basic_rnd", "math");
+    rnd.addParameter("n", ParameterType::FLOAT, "0 repeats the last value, < 0 reseeds (optional)", true, "1")
        .setReturnType(ReturnType::FLOAT);
     registry.registerFunction(std::move(rnd));
     
@@ -342,6 +342,19 @@ void CoreCommandRegistry::registerMathFunctions(CommandRegistry& registry) {
        .setReturnType(ReturnType::FLOAT);
     registry.registerFunction(std::move(mod));
     
+    // SHL, SHR - 32-bit shifts (SHR is arithmetic, keeping the sign)
+    CommandDefinition shl("SHL", "Shift left by n bits (32-bit)", "bit_shl", "math");
+    shl.addParameter("x", ParameterType::INT, "Value to shift")
+       .addParameter("n", ParameterType::INT, "Number of bits")
+       .setReturnType(ReturnType::INT);
+    registry.registerFunction(std::move(shl));
+    
+    CommandDefinition shr("SHR", "Arithmetic shift right by n bits (32-bit)", "bit_shr", "math");
+    shr.addParameter("x", ParameterType::INT, "Value to shift")
+       .addParameter("n", ParameterType::INT, "Number of bits")
+       .setReturnType(ReturnType::INT);
+    registry.registerFunction(std::move(shr));
+    
     // =========================================================================
     // BCX-Compatible Extended Math Functions
     // =========================================================================
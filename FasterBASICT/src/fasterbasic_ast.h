@@ -82,6 +82,10 @@ enum class ASTNodeType {
     STMT_DIM,
     STMT_REDIM,
     STMT_ERASE,
+    STMT_APPEND,
+    STMT_POP,
+    STMT_REMOVE,
+    STMT_KEYS,
     STMT_SWAP,
     STMT_INC,
     STMT_DEC,
@@ -1768,9 +1772,11 @@ public:
         std::vector<ExpressionPtr> dimensions;
         std::string asTypeName;        // For AS TypeName declarations (user-defined types)
         bool hasAsType;                // true if AS TypeName was specified
+        bool growable;                 // DIM A(): empty 1-D array grown by APPEND
+        bool isDict;                   // DIM D AS DICT: keys to values of D's type
 
         ArrayDim(const std::string& n, TokenType suffix = TokenType::UNKNOWN)
-            : name(n), typeSuffix(suffix), hasAsType(false) {}
+            : name(n), typeSuffix(suffix), hasAsType(false), growable(false), isDict(false) {}
     };
 
     std::vector<ArrayDim> arrays;
@@ -1811,9 +1817,13 @@ public:
                     oss << "dim" << i;
                 }
                 oss << ")";
+            } else if (arr.growable) {
+                oss << "()";
             }
             if (arr.hasAsType) {
                 oss << " AS " << arr.asTypeName;
+            } else if (arr.isDict) {
+                oss << " AS DICT";
             }
             oss << "\n";
             for (const auto& dim : arr.dimensions) {
@@ -1900,6 +1910,82 @@ public:
     }
 };
 
+// APPEND/PUSH statement (add an element to the end of a 1-D array)
+class AppendStatement : public Statement {
+public:
+    std::string arrayName;
+    ExpressionPtr value;
+
+    AppendStatement(const std::string& name, ExpressionPtr v)
+        : arrayName(name), value(std::move(v)) {}
+
+    ASTNodeType getType() const override { return ASTNodeType::STMT_APPEND; }
+
+    std::string toString(int indent = 0) const override {
+        std::ostringstream oss;
+        oss << makeIndent(indent) << "APPEND " << arrayName << "\n";
+        if (value) {
+            oss << value->toString(indent + 1);
+        }
+        return oss.str();
+    }
+};
+
+// POP statement (remove the last element of a 1-D array)
+class PopStatement : public Statement {
+public:
+    std::string arrayName;
+
+    explicit PopStatement(const std::string& name) : arrayName(name) {}
+
+    ASTNodeType getType() const override { return ASTNodeType::STMT_POP; }
+
+    std::string toString(int indent = 0) const override {
+        std::ostringstream oss;
+        oss << makeIndent(indent) << "POP " << arrayName << "\n";
+        return oss.str();
+    }
+};
+
+// REMOVE statement (delete a dictionary entry)
+class RemoveStatement : public Statement {
+public:
+    std::string dictName;
+    ExpressionPtr key;
+
+    RemoveStatement(const std::string& name, ExpressionPtr k)
+        : dictName(name), key(std::move(k)) {}
+
+    ASTNodeType getType() const override { return ASTNodeType::STMT_REMOVE; }
+
+    std::string toString(int indent = 0) const override {
+        std::ostringstream oss;
+        oss << makeIndent(indent) << "REMOVE " << dictName << "\n";
+        if (key) {
+            oss << key->toString(indent + 1);
+        }
+        return oss.str();
+    }
+};
+
+// KEYS statement (replace the contents of a 1-D array with a dictionary's keys)
+class KeysStatement : public Statement {
+public:
+    std::string dictName;
+    std::string arrayName;
+
+    KeysStatement(const std::string& dict, const std::string& array)
+        : dictName(dict), arrayName(array) {}
+
+    ASTNodeType getType() const override { return ASTNodeType::STMT_KEYS; }
+
+    std::string toString(int indent = 0) const override {
+        std::ostringstream oss;
+        oss << makeIndent(indent) << "KEYS " << dictName << ", " << arrayName << "\n";
+        return oss.str();
+    }
+};
+
 // SWAP statement (swap two variables)
 class SwapStatement : public Statement {
 public:
@@ -2071,7 +2157,10 @@ public:
         EXPLICIT,
         UNICODE,
         ERROR,
-        CANCELLABLE
+        CANCELLABLE,
+        FORCE_YIELD,
+        JIT,
+        GC
     };
 
     OptionType type;
@@ -2090,6 +2179,11 @@ public:
             case OptionType::BASE: oss << "BASE " << value; break;
             case OptionType::EXPLICIT: oss << "EXPLICIT"; break;
             case OptionType::UNICODE: oss << "UNICODE"; break;
+            case OptionType::ERROR: oss << "ERROR"; break;
+            case OptionType::CANCELLABLE: oss << "CANCELLABLE " << (value ? "ON" : "OFF"); break;
+            case OptionType::FORCE_YIELD: oss << "FORCE_YIELD"; break;
+            case OptionType::JIT: oss << "JIT"; break;
+            case OptionType::GC: oss << "GC"; break;
         }
         oss << "\n";
         return oss.str();
@@ -2256,11 +2350,18 @@ public:
 class ReadStatement : public Statement {
 public:
     std::vector<std::string> variables;
+    std::vector<std::vector<ExpressionPtr>> indices;  // Per variable; empty for scalars (READ A(I))
 
     ReadStatement() = default;
 
     void addVariable(const std::string& var) {
         variables.push_back(var);
+        indices.emplace_back();
+    }
+
+    void addElement(const std::string& array, std::vector<ExpressionPtr> elementIndices) {
+        variables.push_back(array);
+        indices.push_back(std::move(elementIndices));
     }
 
     ASTNodeType getType() const override { return ASTNodeType::STMT_READ; }
@@ -2271,6 +2372,7 @@ public:
         for (size_t i = 0; i < variables.size(); ++i) {
             if (i > 0) oss << ",";
             oss << " " << variables[i];
+            if (!indices[i].empty()) oss << "(" << indices[i].size() << " indices)";
         }
         oss << "\n";
         return oss.str();
@@ -57,10 +57,11 @@ public:
     // This simplifies the parser and makes GOTO resolution trivial
     static std::string preprocessLineNumbersToLabels(const std::string& source);
     
-private:
     // Parse a single data value string into typed variant
+    // (the DataManager rules; the Lua code generator types DATA with it)
     DataValue parseValue(const std::string& raw);
     
+private:
     // Check if a line is a DATA statement
     bool isDataLine(const std::string& line);
     
@@ -71,6 +71,10 @@ std::unique_ptr<IRCode> IRGenerator::generate(
     m_code->errorTracking = symbols.errorTracking;  // Copy OPTION ERROR setting
     m_code->forceYieldEnabled = symbols.forceYieldEnabled;  // Copy OPTION FORCE_YIELD setting
     m_code->forceYieldBudget = symbols.forceYieldBudget;  // Copy OPTION FORCE_YIELD budget
+    m_code->jitMode = symbols.jitMode;  // Copy OPTION JIT ON/OFF
+    m_code->jitSettings = symbols.jitSettings;  // Copy OPTION JIT parameters
+    m_code->gcPause = symbols.gcPause;  // Copy OPTION GC PAUSE
+    m_code->gcStepMul = symbols.gcStepMul;  // Copy OPTION GC STEPMUL
     m_code->cancellableLoops = symbols.cancellableLoops;  // Copy OPTION CANCELLABLE setting
     m_code->eventsUsed = symbols.eventsUsed;  // Copy EVENT DETECTION setting
 
@@ -117,6 +121,9 @@ std::unique_ptr<IRCode> IRGenerator::generate(
         }
     }
 
+    lowerDictAccesses();
+    fuseDataReadLoops();
+
     // Add final HALT instruction if not already present
     if (m_code->instructions.empty() ||
         m_code->instructions.back().opcode != IROpcode::HALT) {
@@ -267,6 +274,14 @@ void IRGenerator::generateStatement(const Statement* stmt, int lineNumber) {
         generateRedim(s, lineNumber);
     } else if (auto* s = dynamic_cast<const EraseStatement*>(stmt)) {
         generateErase(s, lineNumber);
+    } else if (auto* s = dynamic_cast<const AppendStatement*>(stmt)) {
+        generateAppend(s, lineNumber);
+    } else if (auto* s = dynamic_cast<const PopStatement*>(stmt)) {
+        generatePop(s, lineNumber);
+    } else if (auto* s = dynamic_cast<const RemoveStatement*>(stmt)) {
+        generateRemove(s, lineNumber);
+    } else if (auto* s = dynamic_cast<const KeysStatement*>(stmt)) {
+        generateKeys(s, lineNumber);
     } else if (auto* s = dynamic_cast<const SwapStatement*>(stmt)) {
         generateSwap(s, lineNumber);
     } else if (auto* s = dynamic_cast<const IncStatement*>(stmt)) {
@@ -442,7 +457,7 @@ void IRGenerator::generatePlay(const PlayStatement* stmt, int lineNumber) {
         generateExpression(fastExpr.get());
         
         // Call st_music_render_to_slot(inputPath, slotNumber, format, fastRender) - 4 arguments
-        emit(IROpcode::CALL_BUILTIN, "st_music_render_to_slot", 4);
+        emitStatementCall("st_music_render_to_slot", 4);
     }
     // Check if INTO_WAV is specified - use render function instead of play
     else if (stmt->hasWavOutput) {
@@ -467,7 +482,7 @@ void IRGenerator::generatePlay(const PlayStatement* stmt, int lineNumber) {
         generateExpression(fastExpr.get());
         
         // Call st_music_render_to_wav(inputPath, outputPath, format, fastRender) - 4 arguments
-        emit(IROpcode::CALL_BUILTIN, "st_music_render_to_wav", 4);
+        emitStatementCall("st_music_render_to_wav", 4);
     } else {
         // Normal playback mode
         // Generate the filename expression
@@ -480,10 +495,10 @@ void IRGenerator::generatePlay(const PlayStatement* stmt, int lineNumber) {
             generateExpression(formatExpr.get());
             
             // Call st_music_play_file_with_format(filename, format) - 2 arguments
-            emit(IROpcode::CALL_BUILTIN, "st_music_play_file_with_format", 2);
+            emitStatementCall("st_music_play_file_with_format", 2);
         } else {
             // Call st_music_play_file(filename) - 1 argument
-            emit(IROpcode::CALL_BUILTIN, "st_music_play_file", 1);
+            emitStatementCall("st_music_play_file", 1);
         }
     }
 }
@@ -509,7 +524,7 @@ void IRGenerator::generatePlaySound(const PlaySoundStatement* stmt, int lineNumb
     }
     
     // Call st_sound_play_with_fade(id, volume, cap_duration) - 3 arguments
-    emit(IROpcode::CALL_BUILTIN, "st_sound_play_with_fade", 3);
+    emitStatementCall("st_sound_play_with_fade", 3);
 }
 
 void IRGenerator::generatePrintAt(const PrintAtStatement* stmt, int lineNumber) {
@@ -666,28 +681,18 @@ void IRGenerator::generateLet(const LetStatement* stmt, int lineNumber) {
             }
         } else {
             // Array element member assignment: array(index).member = value
-            // Generate indices first
-            for (const auto& index : stmt->indices) {
-                generateExpression(index.get());
-            }
-
-            // Load array element as record
-            emit(IROpcode::LOAD_ARRAY, stmt->variable, static_cast<int>(stmt->indices.size()));
-            
-            // For each member in the chain
+            // The element is updated in place (records are references, and
+            // FFI struct array elements are stored inline)
+            std::string memberPath;
             for (size_t i = 0; i < stmt->memberChain.size(); ++i) {
-                if (i < stmt->memberChain.size() - 1) {
-                    emit(IROpcode::LOAD_MEMBER, stmt->memberChain[i]);
-                } else {
-                    emit(IROpcode::STORE_MEMBER, stmt->memberChain[i]);
-                }
+                if (i > 0) memberPath += ".";
+                memberPath += stmt->memberChain[i];
             }
-            
-            // Store the modified record back to array
+
             for (const auto& index : stmt->indices) {
                 generateExpression(index.get());
             }
-            emit(IROpcode::STORE_ARRAY, stmt->variable, static_cast<int>(stmt->indices.size()));
+            emit(IROpcode::STORE_ARRAY_MEMBER, stmt->variable, memberPath, static_cast<int>(stmt->indices.size()));
         }
     } else if (!stmt->indices.empty()) {
         // Array element assignment: array(index) = value
@@ -1165,7 +1170,7 @@ void IRGenerator::generateExpressionStatement(const ExpressionStatement* stmt, i
     }
     
     // Emit a CALL_BUILTIN instruction with the command name and argument count
-    emit(IROpcode::CALL_BUILTIN, stmt->name, static_cast<int>(stmt->arguments.size()));
+    emitStatementCall(stmt->name, static_cast<int>(stmt->arguments.size()));
 }
 
 void IRGenerator::generateSimpleStatement(const SimpleStatement* stmt, int lineNumber) {
@@ -1175,7 +1180,7 @@ void IRGenerator::generateSimpleStatement(const SimpleStatement* stmt, int lineN
     // These are essentially zero-argument function calls to the runtime API
     
     // Emit a CALL_BUILTIN instruction with the command name and 0 arguments
-    emit(IROpcode::CALL_BUILTIN, stmt->name, 0);
+    emitStatementCall(stmt->name, 0);
 }
 
 void IRGenerator::generateReturn(const ReturnStatement* stmt, int lineNumber) {
@@ -1358,6 +1363,12 @@ void IRGenerator::generateDim(const DimStatement* stmt, int lineNumber) {
         for (const auto& dim : arr.dimensions) {
             generateExpression(dim.get());
         }
+        int dimensionCount = static_cast<int>(arr.dimensions.size());
+        if (arr.growable) {
+            // DIM A(): upper bound one below OPTION BASE, i.e. no elements
+            emit(IROpcode::PUSH_INT, m_code->arrayBase - 1);
+            dimensionCount = 1;
+        }
 
         // Extract type suffix (may be useful for future optimizations)
         std::string typeSuffix;
@@ -1372,9 +1383,24 @@ void IRGenerator::generateDim(const DimStatement* stmt, int lineNumber) {
                 break;
         }
 
+        if (arr.isDict) {
+            // DIM D AS DICT: the key representation is fixed by how D is used
+            bool numericKeys = false;
+            if (m_symbols) {
+                auto it = m_symbols->arrays.find(arr.name);
+                numericKeys = it != m_symbols->arrays.end() &&
+                              it->second.keyType == VariableType::DOUBLE;
+            }
+            IRInstruction instr(IROpcode::DICT_NEW, arr.name, numericKeys ? 1 : 0);
+            instr.arrayElementTypeSuffix = typeSuffix;
+            instr.sourceLineNumber = m_currentLineNumber;
+            instr.blockId = m_currentBlockId;
+            m_code->instructions.push_back(instr);
+            continue;
+        }
+
         // Allocate array
-        IRInstruction instr(IROpcode::DIM_ARRAY, arr.name,
-                           static_cast<int>(arr.dimensions.size()));
+        IRInstruction instr(IROpcode::DIM_ARRAY, arr.name, dimensionCount);
         instr.arrayElementTypeSuffix = typeSuffix;
         instr.sourceLineNumber = m_currentLineNumber;
         instr.blockId = m_currentBlockId;
@@ -1425,8 +1451,155 @@ void IRGenerator::generateClose(const CloseStatement* stmt, int lineNumber) {
 void IRGenerator::generateRead(const ReadStatement* stmt, int lineNumber) {
     setSourceContext(lineNumber, m_currentBlockId);
 
-    for (const auto& varName : stmt->variables) {
-        emit(IROpcode::READ_DATA, varName);
+    for (size_t i = 0; i < stmt->variables.size(); ++i) {
+        const auto& indices = stmt->indices[i];
+        if (indices.empty()) {
+            emit(IROpcode::READ_DATA, stmt->variables[i]);
+            continue;
+        }
+
+        // READ A(I): the value goes through a normal array store
+        emit(IROpcode::READ_DATA_VALUE, stmt->variables[i]);
+        for (const auto& index : indices) {
+            generateExpression(index.get());
+        }
+        emit(IROpcode::STORE_ARRAY, stmt->variables[i], static_cast<int>(indices.size()));
+    }
+}
+
+// D(key) on a dictionary parses and generates as a 1-D array access; every
+// statement that reads or writes array elements (LET, READ, INPUT, INC, ...)
+// therefore works on dictionaries once the accesses are renamed here
+void IRGenerator::lowerDictAccesses() {
+    if (!m_symbols) {
+        return;
+    }
+
+    for (auto& instr : m_code->instructions) {
+        if ((instr.opcode != IROpcode::LOAD_ARRAY && instr.opcode != IROpcode::STORE_ARRAY) ||
+            !std::holds_alternative<std::string>(instr.operand1)) {
+            continue;
+        }
+        const std::string& name = std::get<std::string>(instr.operand1);
+        auto it = m_symbols->arrays.find(name);
+        if (it == m_symbols->arrays.end() || !it->second.isDict) {
+            continue;
+        }
+        instr.opcode = (instr.opcode == IROpcode::LOAD_ARRAY) ? IROpcode::DICT_GET : IROpcode::DICT_SET;
+    }
+}
+
+// A loop that only READs consecutive elements of a 1-D array,
+//     PUSH lo, PUSH hi, PUSH_INT 1, FOR_INIT v, [LABEL...],
+//     READ_DATA_VALUE A, LOAD_VAR v, STORE_ARRAY A 1, FOR_NEXT [v]
+// becomes PUSH lo, PUSH hi, READ_DATA_ARRAY A v, [LABEL...]: one copy from
+// the DATA table instead of a READ per element. The block labels inside the
+// loop are kept, and the loop is left alone if anything jumps to them.
+void IRGenerator::fuseDataReadLoops() {
+    auto& code = m_code->instructions;
+
+    std::unordered_set<int> jumpTargets;
+    for (const auto& instr : code) {
+        switch (instr.opcode) {
+            case IROpcode::JUMP:
+            case IROpcode::JUMP_IF_TRUE:
+            case IROpcode::JUMP_IF_FALSE:
+            case IROpcode::CALL_GOSUB:
+                if (std::holds_alternative<int>(instr.operand1)) {
+                    jumpTargets.insert(std::get<int>(instr.operand1));
+                }
+                break;
+            case IROpcode::ON_GOTO:
+            case IROpcode::ON_GOSUB:
+                if (std::holds_alternative<std::string>(instr.operand1)) {
+                    std::istringstream targets(std::get<std::string>(instr.operand1));
+                    std::string target;
+                    while (std::getline(targets, target, ',')) {
+                        jumpTargets.insert(std::atoi(target.c_str()));
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    bool fusedAny = false;
+    auto isString = [](const IROperand& operand, const std::string& value) {
+        return std::holds_alternative<std::string>(operand) && std::get<std::string>(operand) == value;
+    };
+
+    for (size_t i = 1; i < code.size(); ++i) {
+        if (code[i].opcode != IROpcode::FOR_INIT || !std::holds_alternative<std::string>(code[i].operand1)) {
+            continue;
+        }
+        const std::string loopVar = std::get<std::string>(code[i].operand1);
+
+        const IRInstruction& step = code[i - 1];
+        if (step.opcode != IROpcode::PUSH_INT || !std::holds_alternative<int>(step.operand1) ||
+            std::get<int>(step.operand1) != 1) {
+            continue;
+        }
+
+        size_t j = i + 1;
+        bool targeted = false;
+        while (j < code.size() && code[j].opcode == IROpcode::LABEL) {
+            if (std::holds_alternative<int>(code[j].operand1) &&
+                jumpTargets.count(std::get<int>(code[j].operand1))) {
+                targeted = true;
+            }
+            ++j;
+        }
+        if (targeted || j + 3 >= code.size()) continue;
+
+        const IRInstruction& read = code[j];
+        const IRInstruction& index = code[j + 1];
+        const IRInstruction& store = code[j + 2];
+        const IRInstruction& next = code[j + 3];
+        if (read.opcode != IROpcode::READ_DATA_VALUE || !std::holds_alternative<std::string>(read.operand1)) {
+            continue;
+        }
+        const std::string arrayName = std::get<std::string>(read.operand1);
+        if (index.opcode != IROpcode::LOAD_VAR || !isString(index.operand1, loopVar) ||
+            store.opcode != IROpcode::STORE_ARRAY || !isString(store.operand1, arrayName) ||
+            !std::holds_alternative<int>(store.operand2) || std::get<int>(store.operand2) != 1 ||
+            next.opcode != IROpcode::FOR_NEXT ||
+            !(isString(next.operand1, loopVar) || isString(next.operand1, ""))) {
+            continue;
+        }
+
+        IRInstruction fused = code[i];
+        fused.opcode = IROpcode::READ_DATA_ARRAY;
+        fused.operand1 = arrayName;
+        fused.operand2 = loopVar;
+
+        std::vector<IRInstruction> replacement;
+        replacement.push_back(fused);
+        replacement.insert(replacement.end(), code.begin() + i + 1, code.begin() + j);
+
+        size_t first = i - 1;
+        size_t end = j + 4;
+        code.erase(code.begin() + first, code.begin() + end);
+        code.insert(code.begin() + first, replacement.begin(), replacement.end());
+        fusedAny = true;
+
+        int removed = static_cast<int>(end - first - replacement.size());
+        for (auto& [line, addr] : m_code->lineToAddress) {
+            if (addr >= static_cast<int>(end)) {
+                addr -= removed;
+            } else if (addr > static_cast<int>(first)) {
+                addr = static_cast<int>(first);
+            }
+        }
+    }
+
+    if (fusedAny) {
+        m_code->labelToAddress.clear();
+        for (size_t i = 0; i < code.size(); i++) {
+            if (code[i].opcode == IROpcode::LABEL) {
+                m_code->labelToAddress[std::get<int>(code[i].operand1)] = static_cast<int>(i);
+            }
+        }
     }
 }
 
@@ -1663,6 +1836,53 @@ void IRGenerator::generateErase(const EraseStatement* stmt, int lineNumber) {
     }
 }
 
+void IRGenerator::generateAppend(const AppendStatement* stmt, int lineNumber) {
+    setSourceContext(lineNumber, m_currentBlockId);
+
+    generateExpression(stmt->value.get());
+
+    IRInstruction instr(IROpcode::ARRAY_APPEND, stmt->arrayName);
+    instr.arrayElementTypeSuffix = extractTypeSuffix(stmt->arrayName);
+    instr.sourceLineNumber = m_currentLineNumber;
+    instr.blockId = m_currentBlockId;
+    m_code->instructions.push_back(instr);
+}
+
+void IRGenerator::generatePop(const PopStatement* stmt, int lineNumber) {
+    setSourceContext(lineNumber, m_currentBlockId);
+
+    // POP A as a statement: remove the element and discard it
+    IRInstruction instr(IROpcode::ARRAY_POP, stmt->arrayName, 1);
+    instr.arrayElementTypeSuffix = extractTypeSuffix(stmt->arrayName);
+    instr.sourceLineNumber = m_currentLineNumber;
+    instr.blockId = m_currentBlockId;
+    m_code->instructions.push_back(instr);
+}
+
+void IRGenerator::generateRemove(const RemoveStatement* stmt, int lineNumber) {
+    setSourceContext(lineNumber, m_currentBlockId);
+
+    generateExpression(stmt->key.get());
+    emit(IROpcode::DICT_REMOVE, stmt->dictName);
+}
+
+void IRGenerator::generateKeys(const KeysStatement* stmt, int lineNumber) {
+    setSourceContext(lineNumber, m_currentBlockId);
+
+    // The target array's element type decides whether keys are converted
+    IRInstruction instr(IROpcode::DICT_KEYS, stmt->dictName, stmt->arrayName);
+    if (m_symbols) {
+        auto it = m_symbols->arrays.find(stmt->arrayName);
+        if (it != m_symbols->arrays.end() &&
+            (it->second.type == VariableType::STRING || it->second.type == VariableType::UNICODE)) {
+            instr.arrayElementTypeSuffix = "$";
+        }
+    }
+    instr.sourceLineNumber = m_currentLineNumber;
+    instr.blockId = m_currentBlockId;
+    m_code->instructions.push_back(instr);
+}
+
 void IRGenerator::generateSwap(const SwapStatement* stmt, int lineNumber) {
     setSourceContext(lineNumber, m_currentBlockId);
     emit(IROpcode::SWAP_VAR, stmt->var1, stmt->var2);
@@ -2003,6 +2223,10 @@ void IRGenerator::generateExpression(const Expression* expr) {
                         // Validate dimension
                         if (dimension < 1 || dimension > static_cast<int>(arraySymbol.dimensions.size())) {
                             emit(IROpcode::PUSH_INT, 0);  // Invalid dimension
+                        } else if (funcNameUpper == "UBOUND" && arraySymbol.dimensions.size() == 1 &&
+                                   (arraySymbol.isGrowable || arraySymbol.dimensions[0] < 0)) {
+                            // 1-D array grown by APPEND/POP or sized at runtime: ask the array
+                            emit(IROpcode::UBOUND_ARRAY, arrayName, dimension);
                         } else {
                             int value;
                             if (funcNameUpper == "LBOUND") {
@@ -2024,6 +2248,38 @@ void IRGenerator::generateExpression(const Expression* expr) {
             }
             return;  // Done handling LBOUND/UBOUND
         }
+
+        // HAS(D, key) and LEN(D) on a dictionary
+        if ((funcNameUpper == "HAS" || funcNameUpper == "LEN") && m_symbols &&
+            e->indices.size() == (funcNameUpper == "HAS" ? 2u : 1u) &&
+            e->indices[0]->getType() == ASTNodeType::EXPR_VARIABLE) {
+            std::string dictName = static_cast<const VariableExpression*>(e->indices[0].get())->name;
+            auto it = m_symbols->arrays.find(dictName);
+            if (it != m_symbols->arrays.end() && it->second.isDict) {
+                if (funcNameUpper == "HAS") {
+                    generateExpression(e->indices[1].get());
+                    emit(IROpcode::DICT_HAS, dictName);
+                } else {
+                    emit(IROpcode::DICT_COUNT, dictName);
+                }
+                return;
+            }
+        }
+
+        // POP(A) and LEN(A) on a declared array work on the array itself
+        if ((funcNameUpper == "POP" || funcNameUpper == "LEN") && e->indices.size() == 1 && m_symbols &&
+            e->indices[0]->getType() == ASTNodeType::EXPR_VARIABLE) {
+            std::string arrayName = static_cast<const VariableExpression*>(e->indices[0].get())->name;
+            if (m_symbols->arrays.count(arrayName)) {
+                IRInstruction instr(funcNameUpper == "POP" ? IROpcode::ARRAY_POP : IROpcode::ARRAY_LEN,
+                                    arrayName, 0);
+                instr.arrayElementTypeSuffix = extractTypeSuffix(arrayName);
+                instr.sourceLineNumber = m_currentLineNumber;
+                instr.blockId = m_currentBlockId;
+                m_code->instructions.push_back(instr);
+                return;
+            }
+        }
         
         // Check symbol table to determine if this is an array or function call
         // Priority: 1) Check if it's a declared array, 2) Check if it's a built-in function
@@ -2360,6 +2616,14 @@ void IRGenerator::emitLoopJump(IROpcode opcode, IROperand op1, bool isLoop) {
     m_code->emit(instr);
 }
 
+void IRGenerator::emitStatementCall(const std::string& name, int argCount) {
+    IRInstruction instr(IROpcode::CALL_BUILTIN, name, argCount);
+    instr.sourceLineNumber = m_currentLineNumber;
+    instr.blockId = m_currentBlockId;
+    instr.isStatement = true;
+    m_code->emit(instr);
+}
+
 void IRGenerator::setSourceContext(int lineNumber, int blockId) {
     m_currentLineNumber = lineNumber;
     m_currentBlockId = blockId;
@@ -2614,7 +2878,7 @@ void IRGenerator::generateRun(const RunStatement* stmt, int lineNumber) {
         
         // Call WAIT_FRAMES(1) as a function
         emit(IROpcode::PUSH_INT, 1);
-        emit(IROpcode::CALL_BUILTIN, "WAIT_FRAMES", 1);
+        emitStatementCall("WAIT_FRAMES", 1);
         
         // Jump back to start
         emit(IROpcode::JUMP, loopLabel);
@@ -2624,7 +2888,7 @@ void IRGenerator::generateRun(const RunStatement* stmt, int lineNumber) {
     } else {
         // RUN without condition - wait indefinitely (max int frames)
         emit(IROpcode::PUSH_INT, 2147483647);  // Max int32
-        emit(IROpcode::CALL_BUILTIN, "WAIT_FRAMES", 1);
+        emitStatementCall("WAIT_FRAMES", 1);
     }
 }
 
@@ -2727,6 +2991,7 @@ bool IRGenerator::tryEmitSIMDArrayOperation(const LetStatement* stmt,
                             instr.operand1 = stmt->variable; // result array
                             instr.operand2 = leftArray->name; // source array A
                             instr.operand3 = rightArray->name; // source array B
+                            instr.userDefinedType = lhsArray.asTypeName;
                             instr.sourceLineNumber = m_currentLineNumber;
                             instr.blockId = m_currentBlockId;
                             m_code->instructions.push_back(instr);
@@ -2747,6 +3012,7 @@ bool IRGenerator::tryEmitSIMDArrayOperation(const LetStatement* stmt,
                         instr.operand1 = stmt->variable; // result array
                         instr.operand2 = leftArray->name; // source array
                         instr.operand3 = ""; // scalar comes from stack
+                        instr.userDefinedType = lhsArray.asTypeName;
                         instr.sourceLineNumber = m_currentLineNumber;
                         instr.blockId = m_currentBlockId;
                         m_code->instructions.push_back(instr);
@@ -2770,6 +3036,7 @@ bool IRGenerator::tryEmitSIMDArrayOperation(const LetStatement* stmt,
                         instr.operand1 = stmt->variable;
                         instr.operand2 = leftArray->name;
                         instr.operand3 = "";
+                        instr.userDefinedType = lhsArray.asTypeName;
                         instr.sourceLineNumber = m_currentLineNumber;
                         instr.blockId = m_currentBlockId;
                         m_code->instructions.push_back(instr);
@@ -2846,6 +3113,7 @@ bool IRGenerator::tryEmitArrayOperation(const LetStatement* stmt,
                             instr.operand1 = stmt->variable; // result array
                             instr.operand2 = leftArray->name; // source array A
                             instr.operand3 = rightArray->name; // source array B
+                            instr.userDefinedType = lhsArray.asTypeName; // TYPE arrays: member-wise
                             instr.sourceLineNumber = m_currentLineNumber;
                             instr.blockId = m_currentBlockId;
                             m_code->instructions.push_back(instr);
@@ -2869,6 +3137,7 @@ bool IRGenerator::tryEmitArrayOperation(const LetStatement* stmt,
                         instr.operand1 = stmt->variable; // result array
                         instr.operand2 = leftArray->name; // source array
                         instr.operand3 = ""; // scalar comes from stack
+                        instr.userDefinedType = lhsArray.asTypeName; // TYPE arrays: member-wise
                         instr.sourceLineNumber = m_currentLineNumber;
                         instr.blockId = m_currentBlockId;
                         m_code->instructions.push_back(instr);
@@ -2878,6 +3147,18 @@ bool IRGenerator::tryEmitArrayOperation(const LetStatement* stmt,
                 }
             }
         }
+    } else if (rhsNodeType == ASTNodeType::EXPR_FUNCTION_CALL) {
+        // Random fill: A() = RND or A() = RND(n) with a positive literal n.
+        // Each element gets its own value, like the element-wise forms above
+        auto* call = static_cast<FunctionCallExpression*>(rhsExpr);
+        if (call->name != "RND" || call->arguments.size() > 1) return false;
+        if (!call->arguments.empty()) {
+            if (call->arguments[0]->getType() != ASTNodeType::EXPR_NUMBER) return false;
+            auto* seed = static_cast<NumberExpression*>(call->arguments[0].get());
+            if (seed->value <= 0) return false;
+        }
+        emit(IROpcode::FILL_ARRAY_RND, stmt->variable);
+        return true;
     } else if (rhsNodeType == ASTNodeType::EXPR_ARRAY_ACCESS) {
         // Simple copy: A() = B()
         // We can use ARRAY_ADD with operand3 empty to indicate copy
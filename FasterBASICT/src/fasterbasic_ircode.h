@@ -80,6 +80,17 @@ enum class IROpcode {
     LBOUND_ARRAY,       // Push lower bound of array dimension (operand: array name, operand2: dimension)
     UBOUND_ARRAY,       // Push upper bound of array dimension (operand: array name, operand2: dimension)
     FILL_ARRAY,         // Pop value, fill all array elements (operand: array name)
+    FILL_ARRAY_RND,     // A() = RND: fill with fresh random numbers (operand: array name)
+    ARRAY_APPEND,       // Pop value, add it after the last element of a 1-D array (operand: array name)
+    ARRAY_POP,          // Remove the last element and push it (operand: array name, operand2: 1 = discard)
+    ARRAY_LEN,          // Push the element count of a 1-D array (operand: array name)
+    DICT_NEW,           // Create an empty dictionary (operand: name, operand2: 1 = numeric keys)
+    DICT_GET,           // Pop key, push the value or the type's default (operand: dictionary name)
+    DICT_SET,           // Pop key, pop value, store the entry (operand: dictionary name)
+    DICT_HAS,           // Pop key, push TRUE if the entry exists (operand: dictionary name)
+    DICT_REMOVE,        // Pop key, delete the entry if present (operand: dictionary name)
+    DICT_KEYS,          // Replace a 1-D array with the sorted keys (operand: dictionary, operand2: array)
+    DICT_COUNT,         // Push the number of entries (operand: dictionary name)
     
     // Element-wise array operations (for regular non-SIMD arrays)
     ARRAY_ADD,          // result() = a() + b() element-wise (operand1: result, operand2: a, operand3: b)
@@ -156,6 +167,8 @@ enum class IROpcode {
 
     // === Data Statement Support ===
     READ_DATA,          // Pop var name, read next DATA value
+    READ_DATA_VALUE,    // Push next DATA value, typed for the target (operand: variable or array name)
+    READ_DATA_ARRAY,    // FOR v = lo TO hi: READ A(v): NEXT as one copy (operand1: array, operand2: v; pop hi, lo)
     RESTORE,            // Reset DATA pointer (operand: optional line number)
 
     // === Loop Support ===
@@ -270,6 +283,17 @@ inline const char* opcodeToString(IROpcode op) {
         case IROpcode::ERASE_ARRAY: return "ERASE_ARRAY";
         case IROpcode::LBOUND_ARRAY: return "LBOUND_ARRAY";
         case IROpcode::UBOUND_ARRAY: return "UBOUND_ARRAY";
+        case IROpcode::FILL_ARRAY_RND: return "FILL_ARRAY_RND";
+        case IROpcode::ARRAY_APPEND: return "ARRAY_APPEND";
+        case IROpcode::ARRAY_POP: return "ARRAY_POP";
+        case IROpcode::ARRAY_LEN: return "ARRAY_LEN";
+        case IROpcode::DICT_NEW: return "DICT_NEW";
+        case IROpcode::DICT_GET: return "DICT_GET";
+        case IROpcode::DICT_SET: return "DICT_SET";
+        case IROpcode::DICT_HAS: return "DICT_HAS";
+        case IROpcode::DICT_REMOVE: return "DICT_REMOVE";
+        case IROpcode::DICT_KEYS: return "DICT_KEYS";
+        case IROpcode::DICT_COUNT: return "DICT_COUNT";
         case IROpcode::SWAP_VAR: return "SWAP_VAR";
         case IROpcode::LABEL: return "LABEL";
         case IROpcode::JUMP: return "JUMP";
@@ -322,6 +346,8 @@ inline const char* opcodeToString(IROpcode op) {
         case IROpcode::LINE_INPUT_FILE: return "LINE_INPUT_FILE";
         case IROpcode::WRITE_FILE: return "WRITE_FILE";
         case IROpcode::READ_DATA: return "READ_DATA";
+        case IROpcode::READ_DATA_VALUE: return "READ_DATA_VALUE";
+        case IROpcode::READ_DATA_ARRAY: return "READ_DATA_ARRAY";
         case IROpcode::RESTORE: return "RESTORE";
         case IROpcode::FOR_INIT: return "FOR_INIT";
         case IROpcode::FOR_CHECK: return "FOR_CHECK";
@@ -410,6 +436,9 @@ struct IRInstruction {
     // Loop jump flag for GOTO cancellation (used by JUMP opcode)
     bool isLoopJump;  // True if this JUMP creates a loop (backward edge)
 
+    // Statement flag for CALL_BUILTIN: a command called for its effect pushes no result
+    bool isStatement;
+
     IRInstruction()
         : opcode(IROpcode::NOP)
         , sourceLineNumber(0)
@@ -417,6 +446,7 @@ struct IRInstruction {
         , arrayElementTypeSuffix("")
         , userDefinedType("")
         , isLoopJump(false)
+        , isStatement(false)
     {}
 
     explicit IRInstruction(IROpcode op)
@@ -426,6 +456,7 @@ struct IRInstruction {
         , arrayElementTypeSuffix("")
         , userDefinedType("")
         , isLoopJump(false)
+        , isStatement(false)
     {}
 
     IRInstruction(IROpcode op, IROperand op1)
@@ -436,6 +467,7 @@ struct IRInstruction {
         , arrayElementTypeSuffix("")
         , userDefinedType("")
         , isLoopJump(false)
+        , isStatement(false)
     {}
 
     IRInstruction(IROpcode op, IROperand op1, IROperand op2)
@@ -447,6 +479,7 @@ struct IRInstruction {
         , arrayElementTypeSuffix("")
         , userDefinedType("")
         , isLoopJump(false)
+        , isStatement(false)
     {}
 
     IRInstruction(IROpcode op, IROperand op1, IROperand op2, IROperand op3)
@@ -459,6 +492,7 @@ struct IRInstruction {
         , arrayElementTypeSuffix("")
         , userDefinedType("")
         , isLoopJump(false)
+        , isStatement(false)
     {}
 
     // Helper to format operand for display
@@ -538,9 +572,14 @@ public:
     bool eventsUsed;  // EVENT DETECTION: if true, program uses ON EVENT statements and needs event processing code
     bool forceYieldEnabled;  // OPTION FORCE_YIELD: enable quasi-preemptive handler yielding
     int forceYieldBudget;  // OPTION FORCE_YIELD budget: instructions before forced yield
+    int jitMode;  // OPTION JIT ON/OFF: -1 = leave as configured, 0 = off, 1 = on
+    std::vector<std::string> jitSettings;  // OPTION JIT: jit.opt.start() arguments
+    int gcPause;  // OPTION GC PAUSE: 0 = collector default
+    int gcStepMul;  // OPTION GC STEPMUL: 0 = collector default
 
     IRCode()
-        : blockCount(0)
+        : constantsManager(nullptr)  // No inlining unless a host provides constants
+        , blockCount(0)
         , labelCount(0)
         , arrayBase(1)  // Default to 1 (matches Lua arrays)
         , unicodeMode(false)  // Default to standard byte strings
@@ -549,6 +588,9 @@ public:
         , eventsUsed(false)  // Default to no events (zero overhead when not used)
         , forceYieldEnabled(false)  // Default to cooperative (no forced yielding)
         , forceYieldBudget(10000)  // Default instruction budget
+        , jitMode(-1)  // Default to the host's JIT configuration
+        , gcPause(0)
+        , gcStepMul(0)
     {}
 
     // Add an instruction
@@ -735,6 +777,10 @@ private:
     void generateDim(const DimStatement* stmt, int lineNumber);
     void generateRedim(const RedimStatement* stmt, int lineNumber);
     void generateErase(const EraseStatement* stmt, int lineNumber);
+    void generateAppend(const AppendStatement* stmt, int lineNumber);
+    void generatePop(const PopStatement* stmt, int lineNumber);
+    void generateRemove(const RemoveStatement* stmt, int lineNumber);
+    void generateKeys(const KeysStatement* stmt, int lineNumber);
     void generateSwap(const SwapStatement* stmt, int lineNumber);
     void generateInc(const IncStatement* stmt, int lineNumber);
     void generateDec(const DecStatement* stmt, int lineNumber);
@@ -786,6 +832,9 @@ private:
     // Emit jump instruction with loop flag
     void emitLoopJump(IROpcode opcode, IROperand op1, bool isLoop);
 
+    // Emit CALL_BUILTIN for a command whose result (if any) is not used
+    void emitStatementCall(const std::string& name, int argCount);
+
     // Function inlining helper
     void generateInlinedFunction(const std::string& funcName,
                                   const std::vector<const Expression*>& arguments);
@@ -807,6 +856,12 @@ private:
     bool tryEmitArrayOperation(const LetStatement* stmt,
                                const ArraySymbol& lhsArray);
 
+    // Rewrite LOAD_ARRAY/STORE_ARRAY on dictionaries into DICT_GET/DICT_SET
+    void lowerDictAccesses();
+
+    // Rewrite FOR v = lo TO hi: READ A(v): NEXT into READ_DATA_ARRAY
+    void fuseDataReadLoops();
+
     // Set current source context for emitted instructions
     void setSourceContext(int lineNumber, int blockId);
 
@@ -21,9 +21,6 @@ namespace FasterBASIC {
 std::map<std::string, TokenType> Lexer::s_keywords;
 std::once_flag Lexer::s_keywordsInitFlag;
 
-// Registry-based dynamic commands
-std::map<std::string, TokenType> Lexer::s_dynamicCommands;
-
 void Lexer::initializeKeywords() {
     std::call_once(s_keywordsInitFlag, []() {
         // Control Flow
@@ -92,6 +89,11 @@ void Lexer::initializeKeywords() {
         s_keywords["REDIM"] = TokenType::REDIM;
         s_keywords["ERASE"] = TokenType::ERASE;
         s_keywords["PRESERVE"] = TokenType::PRESERVE;
+        s_keywords["APPEND"] = TokenType::APPEND;
+        s_keywords["PUSH"] = TokenType::PUSH;
+        s_keywords["POP"] = TokenType::POP;
+        s_keywords["REMOVE"] = TokenType::REMOVE;
+        s_keywords["KEYS"] = TokenType::KEYS;
         s_keywords["SWAP"] = TokenType::SWAP;
         s_keywords["INC"] = TokenType::INC;
         s_keywords["DEC"] = TokenType::DEC;
@@ -201,18 +203,19 @@ void Lexer::initializeKeywords() {
 
 void Lexer::initializeDynamicCommands() {
     // Clear any existing dynamic commands
-    s_dynamicCommands.clear();
+    m_dynamicCommands.clear();
     
-    // Initialize the global registry if not already done
-    FasterBASIC::ModularCommands::initializeGlobalRegistry();
+    if (!m_commandTable) {
+        // Initialize the global registry if not already done
+        FasterBASIC::ModularCommands::initializeGlobalRegistry();
+        m_commandTable = FasterBASIC::ModularCommands::getGlobalCommandRegistry().snapshot();
+    }
     
     // Get all registered commands and functions and create tokens for them
-    auto& registry = FasterBASIC::ModularCommands::getGlobalCommandRegistry();
-    auto commandNames = registry.getCommandNames();
-    auto functionNames = registry.getFunctionNames();
-
+    const auto& registry = m_commandTable;
     
-    for (const auto& commandName : commandNames) {
+    for (const auto& entry : registry->getCommands()) {
+        const std::string& commandName = entry.name;
         // Skip PRINT_AT - it's now a special keyword with PRINT-style syntax
         if (commandName == "PRINT_AT") {
             continue;
@@ -221,12 +224,18 @@ void Lexer::initializeDynamicCommands() {
         if (commandName == "INPUT_AT") {
             continue;
         }
-        s_dynamicCommands[commandName] = TokenType::REGISTRY_COMMAND;
+        m_dynamicCommands[commandName] = TokenType::REGISTRY_COMMAND;
     }
     
-    for (const auto& functionName : functionNames) {
-        s_dynamicCommands[functionName] = TokenType::REGISTRY_FUNCTION;
+    for (const auto& entry : registry->getFunctions()) {
+        m_dynamicCommands[entry.name] = TokenType::REGISTRY_FUNCTION;
     }
+    m_dynamicCommandsLoaded = true;
+}
+
+void Lexer::setCommandTable(std::shared_ptr<const ModularCommands::RegistrySnapshot> table) {
+    m_commandTable = std::move(table);
+    m_dynamicCommandsLoaded = false;
 }
 
 // =============================================================================
@@ -237,9 +246,9 @@ Lexer::Lexer()
     : m_position(0)
     , m_line(1)
     , m_column(1)
+    , m_dynamicCommandsLoaded(false)
 {
     initializeKeywords();
-    initializeDynamicCommands();
 }
 
 Lexer::~Lexer() {
@@ -251,6 +260,9 @@ Lexer::~Lexer() {
 
 bool Lexer::tokenize(const std::string& source) {
     clear();
+    if (!m_dynamicCommandsLoaded) {
+        initializeDynamicCommands();
+    }
     m_source = source;
     m_position = 0;
     m_line = 1;
@@ -566,8 +578,8 @@ TokenType Lexer::getKeywordType(const std::string& text) const {
     }
     
     // Then check dynamic registry commands
-    auto dynIt = s_dynamicCommands.find(text);
-    if (dynIt != s_dynamicCommands.end()) {
+    auto dynIt = m_dynamicCommands.find(text);
+    if (dynIt != m_dynamicCommands.end()) {
         return dynIt->second;
     }
     
@@ -576,7 +588,7 @@ TokenType Lexer::getKeywordType(const std::string& text) const {
 
 bool Lexer::isKeyword(const std::string& text) const {
     return s_keywords.find(text) != s_keywords.end() || 
-           s_dynamicCommands.find(text) != s_dynamicCommands.end();
+           m_dynamicCommands.find(text) != m_dynamicCommands.end();
 }
 
 // =============================================================================
@@ -19,6 +19,10 @@
 
 namespace FasterBASIC {
 
+namespace ModularCommands {
+class RegistrySnapshot;
+}
+
 // =============================================================================
 // Lexer Error
 // =============================================================================
@@ -61,6 +65,10 @@ public:
     // Clear state
     void clear();
     
+    // Frozen command registry whose names tokenize as registry commands and
+    // functions (defaults to a snapshot of the global registry)
+    void setCommandTable(std::shared_ptr<const ModularCommands::RegistrySnapshot> table);
+    
 private:
     // Source code state
     std::string m_source;
@@ -77,9 +85,12 @@ private:
     static std::once_flag s_keywordsInitFlag;
     static void initializeKeywords();
     
-    // Registry-based dynamic commands
-    static std::map<std::string, TokenType> s_dynamicCommands;
-    static void initializeDynamicCommands();
+    // Registry-based dynamic commands, built from the command table on the
+    // first tokenize()
+    std::shared_ptr<const ModularCommands::RegistrySnapshot> m_commandTable;
+    std::map<std::string, TokenType> m_dynamicCommands;
+    bool m_dynamicCommandsLoaded;
+    void initializeDynamicCommands();
     
     // Character inspection
     char currentChar() const;
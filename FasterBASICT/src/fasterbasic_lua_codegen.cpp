@@ -5,6 +5,7 @@
 
 #include "fasterbasic_lua_codegen.h"
 #include "../runtime/ConstantsManager.h"
+#include "fasterbasic_data_preprocessor.h"
 #include "modular_commands.h"
 #include "plugin_loader.h"
 #include <chrono>
@@ -15,6 +16,10 @@
 #include <unordered_set>
 #include <algorithm>
 #include <numeric>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
 
 namespace FasterBASIC {
 
@@ -29,6 +34,13 @@ void LuaCodeGenStats::print() const {
     std::cout << "Variables: " << variablesUsed << std::endl;
     std::cout << "Arrays: " << arraysUsed << std::endl;
     std::cout << "Labels: " << labelsGenerated << std::endl;
+    std::cout << "Prelude Helpers: " << helpersEmitted << " emitted, " << helpersDropped
+              << " dropped (" << helperBytesDropped << " bytes)" << std::endl;
+    if (registerFallback.empty()) {
+        std::cout << "Stack Registers: " << stackRegisters << std::endl;
+    } else {
+        std::cout << "Stack Registers: runtime stack kept (" << registerFallback << ")" << std::endl;
+    }
     std::cout << "Generation Time: " << generationTimeMs << " ms" << std::endl;
 }
 
@@ -72,9 +84,9 @@ LuaCodeGenerator::LuaCodeGenerator()
     : m_usesConstants(false)
     , m_unicodeMode(false)
     , m_arrayBase(1)
-    , m_bufferMode(false)
     , m_errorTracking(false)
-    , m_usesSIMD(false) {
+    , m_usesSIMD(false)
+    , m_usesDicts(false) {
 }
 
 LuaCodeGenerator::LuaCodeGenerator(const LuaCodeGenConfig& config)
@@ -82,14 +94,23 @@ LuaCodeGenerator::LuaCodeGenerator(const LuaCodeGenConfig& config)
     , m_usesConstants(false)
     , m_unicodeMode(false)
     , m_arrayBase(1)
-    , m_bufferMode(false)
     , m_errorTracking(false)
-    , m_usesSIMD(false) {
+    , m_usesSIMD(false)
+    , m_usesDicts(false) {
 }
 
 LuaCodeGenerator::~LuaCodeGenerator() {
 }
 
+const ModularCommands::RegistrySnapshot& LuaCodeGenerator::commandTable() {
+    if (!m_commandTable) {
+        // Ensure the global registry is initialized
+        ModularCommands::initializeGlobalRegistry();
+        m_commandTable = ModularCommands::getGlobalCommandRegistry().snapshot();
+    }
+    return *m_commandTable;
+}
+
 std::string LuaCodeGenerator::generate(const IRCode& irCode) {
     auto startTime = std::chrono::high_resolution_clock::now();
 
@@ -118,7 +139,6 @@ std::string LuaCodeGenerator::generate(const IRCode& irCode) {
     m_lastEmittedOpcode = IROpcode::NOP;
     m_arrayBase = irCode.arrayBase;  // Copy OPTION BASE setting from IR
     m_unicodeMode = irCode.unicodeMode;  // Copy OPTION UNICODE setting from IR
-    m_bufferMode = m_config.enableBufferMode;  // Copy buffer mode setting from config
     m_errorTracking = irCode.errorTracking;  // Copy OPTION ERROR setting from IR
     m_forceYieldEnabled = irCode.forceYieldEnabled;  // Copy OPTION FORCE_YIELD setting from IR
     m_forceYieldBudget = irCode.forceYieldBudget;  // Copy OPTION FORCE_YIELD budget from IR
@@ -130,15 +150,41 @@ std::string LuaCodeGenerator::generate(const IRCode& irCode) {
     m_coldVariableIDs.clear();
     m_usedLocalSlots = 0;
     m_usesSIMD = false;  // Reset SIMD detection flag
+    m_usesDicts = false;
+    m_dictInfo.clear();
+    m_bufferVariables.clear();
+    m_nativeLibraries.clear();
+    m_nativeDeclarations.clear();
+    m_usingFormatIds.clear();
+    m_usingFormatters.clear();
+    m_preludeHelpers.clear();
+    m_registerDecls.clear();
+    m_registerFailure.clear();
+    m_registerScope = RegisterScope{};
 
     m_stats.irInstructions = irCode.instructions.size();
 
-    // First pass: detect SIMD usage
+    // Stack depths for register lowering
+    m_registerMode = false;
+    if (m_config.lowerStackToRegisters) {
+        m_registerMode = m_registerIR.build(irCode);
+        if (!m_registerMode) {
+            m_stats.registerFallback = m_registerIR.getError();
+        }
+    }
+
+    // First pass: detect SIMD usage and dictionaries
     for (const auto& instr : irCode.instructions) {
         if (instr.opcode >= IROpcode::SIMD_PAIR_ARRAY_ADD && 
             instr.opcode <= IROpcode::SIMD_QUAD_ARRAY_SUB_SCALAR) {
             m_usesSIMD = true;
-            break;
+        } else if (instr.opcode == IROpcode::DICT_NEW &&
+                   std::holds_alternative<std::string>(instr.operand1)) {
+            m_usesDicts = true;
+            DictInfo info;
+            info.numericKeys = std::holds_alternative<int>(instr.operand2) && std::get<int>(instr.operand2) == 1;
+            info.valueSuffix = instr.arrayElementTypeSuffix;
+            m_dictInfo[std::get<std::string>(instr.operand1)] = info;
         }
     }
 
@@ -154,6 +200,12 @@ std::string LuaCodeGenerator::generate(const IRCode& irCode) {
         selectHotVariables();
     }
 
+    // Fifth pass: find MID$ assignment targets that can live in string buffers
+    analyzeBufferVariables(irCode);
+
+    // Sixth pass: plugin functions bound to native symbols (plugin API v2)
+    collectNativePluginCalls(irCode);
+
     // Generate code sections
     emitHeader();
     emitVariableDeclarations();
@@ -164,10 +216,284 @@ std::string LuaCodeGenerator::generate(const IRCode& irCode) {
     emitMainFunction(irCode);
     emitFooter();
 
+    // Some emitted stack operation disagreed with the register IR: generate
+    // again with the runtime stack
+    if (!m_registerFailure.empty()) {
+        std::string reason = m_registerFailure;
+        LuaCodeGenConfig config = m_config;
+        m_config.lowerStackToRegisters = false;
+        std::string code = generate(irCode);
+        m_config = config;
+        m_stats.registerFallback = reason;
+        return code;
+    }
+
+    // Declare the registers, then leave out prelude helpers that nothing
+    // refers to (push/pop among them once registers replace the stack)
+    std::string code = stripUnusedHelpers(insertRegisterDeclarations(m_output.str()));
+
     auto endTime = std::chrono::high_resolution_clock::now();
     m_stats.generationTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
 
-    return m_output.str();
+    return code;
+}
+
+// =============================================================================
+// Prelude Helper Tracking
+// =============================================================================
+
+// Everything emitted between beginHelper() and endHelper() defines the given
+// locals and nothing else that generated code depends on
+void LuaCodeGenerator::beginHelper(std::initializer_list<const char*> names) {
+    PreludeHelper helper;
+    helper.names.assign(names.begin(), names.end());
+    helper.begin = static_cast<size_t>(m_output.tellp());
+    helper.end = helper.begin;
+    m_preludeHelpers.push_back(std::move(helper));
+}
+
+void LuaCodeGenerator::endHelper() {
+    m_preludeHelpers.back().end = static_cast<size_t>(m_output.tellp());
+}
+
+// Identifiers in code[begin, end), skipping comments and quoted strings
+static void collectLuaIdentifiers(const std::string& code, size_t begin, size_t end,
+                                  std::vector<std::string>& identifiers) {
+    size_t i = begin;
+    while (i < end) {
+        char c = code[i];
+        if (c == '-' && i + 1 < end && code[i + 1] == '-') {
+            while (i < end && code[i] != '\n') i++;
+        } else if (c == '\'' || c == '"') {
+            i++;
+            while (i < end && code[i] != c && code[i] != '\n') {
+                if (code[i] == '\\') i++;
+                i++;
+            }
+            i++;
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = i;
+            while (i < end && (std::isalnum(static_cast<unsigned char>(code[i])) || code[i] == '_')) i++;
+            identifiers.emplace_back(code, start, i - start);
+        } else if (std::isdigit(static_cast<unsigned char>(c))) {
+            // Skip numerals so hex digits and suffixes (0x1FULL) are not names
+            while (i < end && (std::isalnum(static_cast<unsigned char>(code[i])) || code[i] == '.')) i++;
+        } else {
+            i++;
+        }
+    }
+}
+
+// Keep the helpers reachable from code outside all helpers, following
+// references between helpers, and cut the rest out of the chunk
+std::string LuaCodeGenerator::stripUnusedHelpers(const std::string& code) {
+    if (m_preludeHelpers.empty()) {
+        return code;
+    }
+
+    std::unordered_map<std::string, size_t> definedBy;
+    for (size_t h = 0; h < m_preludeHelpers.size(); h++) {
+        for (const auto& name : m_preludeHelpers[h].names) {
+            definedBy[name] = h;
+        }
+    }
+
+    std::vector<bool> used(m_preludeHelpers.size(), false);
+    std::vector<size_t> worklist;
+    std::vector<std::string> identifiers;
+    auto markReferences = [&](size_t begin, size_t end) {
+        identifiers.clear();
+        collectLuaIdentifiers(code, begin, end, identifiers);
+        for (const auto& identifier : identifiers) {
+            auto it = definedBy.find(identifier);
+            if (it != definedBy.end() && !used[it->second]) {
+                used[it->second] = true;
+                worklist.push_back(it->second);
+            }
+        }
+    };
+
+    size_t pos = 0;
+    for (const auto& helper : m_preludeHelpers) {
+        markReferences(pos, helper.begin);
+        pos = helper.end;
+    }
+    markReferences(pos, code.size());
+    while (!worklist.empty()) {
+        const PreludeHelper& helper = m_preludeHelpers[worklist.back()];
+        worklist.pop_back();
+        markReferences(helper.begin, helper.end);
+    }
+
+    std::string result;
+    result.reserve(code.size());
+    pos = 0;
+    for (size_t h = 0; h < m_preludeHelpers.size(); h++) {
+        const PreludeHelper& helper = m_preludeHelpers[h];
+        result.append(code, pos, helper.begin - pos);
+        if (used[h]) {
+            result.append(code, helper.begin, helper.end - helper.begin);
+            m_stats.helpersEmitted++;
+        } else {
+            m_stats.helpersDropped++;
+            m_stats.helperBytesDropped += helper.end - helper.begin;
+        }
+        pos = helper.end;
+    }
+    result.append(code, pos, std::string::npos);
+    return result;
+}
+
+// =============================================================================
+// Register Lowering
+// =============================================================================
+
+// Registers are locals of the Lua function being emitted; their declaration
+// is placed where the scope opens, ahead of every label in the function
+LuaCodeGenerator::RegisterScope LuaCodeGenerator::openRegisterScope(const std::string& indent) {
+    RegisterScope outer = m_registerScope;
+    m_registerScope = RegisterScope{};
+    m_registerScope.open = m_registerMode;
+    m_registerScope.declOffset = static_cast<size_t>(m_output.tellp());
+    m_registerScope.indent = indent;
+    return outer;
+}
+
+void LuaCodeGenerator::closeRegisterScope(const RegisterScope& outer) {
+    if (m_registerScope.open && m_registerScope.registers > 0) {
+        std::string decl = m_registerScope.indent + "local _r1";
+        for (int r = 2; r <= m_registerScope.registers; r++) {
+            decl += ", _r" + std::to_string(r);
+        }
+        m_registerDecls.emplace_back(m_registerScope.declOffset, decl + "\n");
+        m_stats.stackRegisters = std::max(m_stats.stackRegisters, m_registerScope.registers);
+    }
+    m_registerScope = outer;
+}
+
+// The runtime stack depth the generator has reached must be the IR depth
+// less the values the expression optimizer still holds. Labels reached only
+// by jumps take the IR depth
+void LuaCodeGenerator::checkStackDepth(const IRInstruction& instr, size_t index) {
+    RegisterScope& scope = m_registerScope;
+    if (!scope.open || !m_registerFailure.empty()) {
+        return;
+    }
+    int depth = m_registerIR.depthAt(index);
+    if (depth < 0) {
+        return;
+    }
+
+    int expected = depth - static_cast<int>(m_exprOptimizer.size()) - static_cast<int>(m_exprStack.size());
+    bool fallsThrough = !scope.hasLast || (scope.lastIndex + 1 == index && !isTerminator(scope.lastOpcode));
+    bool jumpedTo = (scope.hasLast && isTerminator(scope.lastOpcode)) ||
+                    (instr.opcode == IROpcode::LABEL && !fallsThrough);
+    if (jumpedTo) {
+        scope.depth = expected;
+    } else if (scope.depth != expected) {
+        m_registerFailure = "IR[" + std::to_string(index) + "] " + opcodeToString(instr.opcode) +
+                            ": stack depth " + std::to_string(scope.depth) + ", expected " +
+                            std::to_string(expected);
+    }
+    scope.hasLast = true;
+    scope.lastIndex = index;
+    scope.lastOpcode = instr.opcode;
+}
+
+// Rename push(v) to "_rN = v" and pop() to "_rN", left to right as the
+// line executes, outside strings and comments
+std::string LuaCodeGenerator::lowerStackOps(const std::string& code) {
+    RegisterScope& scope = m_registerScope;
+    std::string out;
+    out.reserve(code.size());
+
+    auto skipString = [&](size_t i) {
+        char quote = code[i++];
+        while (i < code.size() && code[i] != quote) {
+            if (code[i] == '\\') i++;
+            i++;
+        }
+        return std::min(i + 1, code.size());
+    };
+
+    size_t i = 0;
+    while (i < code.size()) {
+        char c = code[i];
+        if (c == '-' && i + 1 < code.size() && code[i + 1] == '-') {
+            out.append(code, i, std::string::npos);
+            break;
+        } else if (c == '"' || c == '\'') {
+            size_t end = skipString(i);
+            out.append(code, i, end - i);
+            i = end;
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = i;
+            while (i < code.size() && (std::isalnum(static_cast<unsigned char>(code[i])) || code[i] == '_')) i++;
+            bool field = start > 0 && (code[start - 1] == '.' || code[start - 1] == ':');
+            if (!field && code.compare(start, i - start, "pop") == 0 && code.compare(i, 2, "()") == 0) {
+                if (scope.depth <= 0 && m_registerFailure.empty()) {
+                    m_registerFailure = "pop() of an empty stack in: " + code;
+                }
+                out += "_r" + std::to_string(scope.depth--);
+                i += 2;
+            } else if (!field && code.compare(start, i - start, "push") == 0 && i < code.size() && code[i] == '(') {
+                // Argument ends at the matching parenthesis
+                size_t end = i + 1;
+                int nesting = 1;
+                while (end < code.size()) {
+                    if (code[end] == '"' || code[end] == '\'') {
+                        end = skipString(end);
+                        continue;
+                    }
+                    if (code[end] == '(') nesting++;
+                    if (code[end] == ')' && --nesting == 0) break;
+                    end++;
+                }
+                std::string value = lowerStackOps(code.substr(i + 1, end - i - 1));
+                scope.depth++;
+                scope.registers = std::max(scope.registers, scope.depth);
+                out += "_r" + std::to_string(scope.depth) + " = " + value;
+                i = std::min(end + 1, code.size());
+            } else {
+                out.append(code, start, i - start);
+            }
+        } else {
+            out += c;
+            i++;
+        }
+    }
+    return out;
+}
+
+// Splice the register declarations recorded by closeRegisterScope into the
+// chunk, keeping the prelude helper ranges in step
+std::string LuaCodeGenerator::insertRegisterDeclarations(const std::string& code) {
+    if (m_registerDecls.empty()) {
+        return code;
+    }
+    std::sort(m_registerDecls.begin(), m_registerDecls.end());
+
+    for (auto& helper : m_preludeHelpers) {
+        size_t beginShift = 0;
+        size_t endShift = 0;
+        for (const auto& decl : m_registerDecls) {
+            if (decl.first <= helper.begin) beginShift += decl.second.size();
+            if (decl.first < helper.end) endShift += decl.second.size();
+        }
+        helper.begin += beginShift;
+        helper.end += endShift;
+    }
+
+    std::string result;
+    size_t pos = 0;
+    for (const auto& decl : m_registerDecls) {
+        result.append(code, pos, decl.first - pos);
+        result += decl.second;
+        pos = decl.first;
+        m_stats.linesGenerated++;
+    }
+    result.append(code, pos, std::string::npos);
+    return result;
 }
 
 // =============================================================================
@@ -179,15 +505,16 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("-- Optimized for LuaJIT trace compilation");
     emitLine("");
 
+    emitRuntimeDirectives();
+    if (m_config.runtimeStats) {
+        emitRuntimeStats();
+    }
+
     if (m_config.useLuaJITHints) {
         emitLine("-- LuaJIT optimization hints");
         emitLine("local ffi = require('ffi')");
         emitLine("");
 
-        emitLine("-- Bitwise operations (check if already injected by runtime)");
-        emitLine("local bitwise = bitwise or require('runtime.bitwise_ffi_bindings')");
-        emitLine("");
-        
         emitLine("-- String functions library (BCX-compatible extended functions)");
         emitLine("local string_ok, string_lib = pcall(require, 'runtime.string_functions')");
         emitLine("if not string_ok then");
@@ -207,41 +534,82 @@ void LuaCodeGenerator::emitHeader() {
 
     // Constants are now inlined directly, no runtime needed
 
+    // AND/OR/XOR/EQV/IMP/NOT and SHL/SHR lower to the bit library; the JIT
+    // compiles these to single instructions on 32-bit integers
+    emitLine("-- Bitwise operators: LuaJIT bit intrinsics (32-bit, like classic BASIC)");
+    emitLine("local bit = require('bit')");
+    beginHelper({"band", "bor", "bxor", "bnot"});
+    emitLine("local band, bor, bxor, bnot = bit.band, bit.bor, bit.bxor, bit.bnot");
+    endHelper();
+    beginHelper({"lshift", "arshift"});
+    emitLine("local lshift, arshift = bit.lshift, bit.arshift");
+    endHelper();
+    beginHelper({"bit_int"});
+    emitLine("-- Operands truncate toward zero (bit.* alone would round)");
+    emitLine("local function bit_int(x)");
+    emitLine("    if x >= 0 then return math.floor(x) end");
+    emitLine("    return math.ceil(x)");
+    emitLine("end");
+    endHelper();
+    beginHelper({"bit_shl"});
+    emitLine("-- Shift counts outside 0..31 shift every bit out (bit.* takes them mod 32)");
+    emitLine("local function bit_shl(x, n)");
+    emitLine("    x, n = bit_int(x), bit_int(n)");
+    emitLine("    if n < 0 then return bit.tobit(x) end");
+    emitLine("    if n > 31 then return 0 end");
+    emitLine("    return lshift(x, n)");
+    emitLine("end");
+    endHelper();
+    beginHelper({"bit_shr"});
+    emitLine("local function bit_shr(x, n)");
+    emitLine("    x, n = bit_int(x), bit_int(n)");
+    emitLine("    if n < 0 then return bit.tobit(x) end");
+    emitLine("    return arshift(x, n > 31 and 31 or n)");
+    emitLine("end");
+    endHelper();
+    emitLine("");
+
+    // PRINT, STR$ and VAL go through runtime/number_format.lua (libbasic_number);
+    // without it they are plain tostring/tonumber, with identical results
+    emitLine("-- Number/text conversion: libbasic_number through the FFI, else tostring/tonumber");
+    emitLine("local num_ok, num_format = pcall(require, 'number_format')");
+    emitLine("if not num_ok then");
+    emitLine("    num_ok, num_format = pcall(dofile, 'runtime/number_format.lua')");
+    emitLine("end");
+    emitLine("local basic_str = num_ok and num_format.str or tostring");
+    beginHelper({"basic_val"});
+    emitLine("local basic_val = num_ok and num_format.val or function(s) return tonumber(s) or 0 end");
+    endHelper();
+    emitLine("");
+
     // Unicode support if OPTION UNICODE is enabled
     if (m_unicodeMode) {
-        emitLine("-- Unicode runtime: Unified handle-based library with rope optimization");
+        emitLine("-- Unicode runtime: strings are FFI codepoint buffers (UString cdata) or ropes");
         emitLine("local unicode_ok, unicode = pcall(require, 'runtime.unicode_unified')");
         emitLine("if not unicode_ok then");
         emitLine("    -- Fallback: try loading from current directory");
         emitLine("    unicode_ok, unicode = pcall(dofile, 'runtime/unicode_unified.lua')");
         emitLine("end");
         emitLine("if not unicode_ok or not unicode or not unicode.available then");
-        emitLine("    error('OPTION UNICODE requires unicode_unified.lua library')");
+        emitLine("    error('OPTION UNICODE: ' .. tostring(unicode_ok and unicode and unicode.error or unicode), 0)");
         emitLine("end");
+        emitLine("local unicode_string_equal = unicode.unicode_string_equal");
+        emitLine("local unicode_string_compare = unicode.unicode_string_compare");
         emitLine("");
-        emitLine("-- Define basic_print for Unicode mode (handles integer handles)");
+        emitLine("-- Define basic_print for Unicode mode");
+        emitLine("local unicode_is_ustring, unicode_write = unicode.is_ustring, unicode.write");
         emitLine("function basic_print(val)");
-        emitLine("    if type(val) == 'number' and val > 0 and val < 2^48 then");
-        emitLine("        -- Likely a handle - try to convert to UTF-8");
-        emitLine("        local str = unicode.unicode_to_utf8(val)");
-        emitLine("        if str then");
-        emitLine("            io.write(str)");
-        emitLine("        else");
-        emitLine("            io.write(tostring(val))");
-        emitLine("        end");
-        emitLine("    elseif type(val) == 'table' then");
-        emitLine("        -- Old table-based Unicode (fallback)");
-        emitLine("        local str = unicode.to_utf8 and unicode.to_utf8(val) or tostring(val)");
-        emitLine("        io.write(str)");
+        emitLine("    if unicode_is_ustring(val) then");
+        emitLine("        unicode_write(val)");
         emitLine("    else");
-        emitLine("        io.write(tostring(val))");
+        emitLine("        io.write(basic_str(val))");
         emitLine("    end");
         emitLine("end");
         emitLine("");
     } else {
         emitLine("-- Define basic_print for ASCII mode");
         emitLine("function basic_print(val)");
-        emitLine("    io.write(tostring(val))");
+        emitLine("    io.write(basic_str(val))");
         emitLine("end");
         emitLine("");
     }
@@ -250,6 +618,8 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("local ffi_ok, ffi = pcall(require, 'ffi')");
     emitLine("local use_ffi = ffi_ok and ffi and jit and jit.status()");
     emitLine("");
+    emitNativePluginBindings();
+    beginHelper({"create_ffi_array"});
     emitLine("-- FFI array creation helper");
     emitLine("local function create_ffi_array(size, element_type)");
     emitLine("    if not use_ffi then return nil end");
@@ -263,7 +633,9 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("    end)");
     emitLine("    return ok and result or nil");
     emitLine("end");
+    endHelper();
     emitLine("");
+    beginHelper({"detect_array_type"});
     emitLine("-- Array type detection helper");
     emitLine("local function detect_array_type(type_suffix)");
     emitLine("    if type_suffix == '%' then return 'int32_t' end  -- INTEGER");
@@ -273,7 +645,211 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("    if type_suffix == '$' then return nil end        -- STRING (no FFI)");
     emitLine("    return 'double' -- Default to DOUBLE for untyped numeric");
     emitLine("end");
+    endHelper();
     emitLine("");
+
+    // APPEND/PUSH, POP and LEN on 1-D arrays. Element i of a Lua table array
+    // lives at [i + 1] under OPTION BASE 0 and at [i] under OPTION BASE 1
+    std::string base = std::to_string(m_arrayBase);
+    std::string tableOffset = (m_arrayBase == 0) ? " + 1" : "";
+    beginHelper({"array_slots"});
+    emitLine("-- Growable arrays: arr.size counts the slots in use (UBOUND + 1),");
+    emitLine("-- separately from the FFI allocation in arr.cap, which doubles when");
+    emitLine("-- full so that N appends copy O(N) elements in total. Lua table");
+    emitLine("-- arrays keep the same count and let the table grow itself");
+    emitLine("local function array_slots(arr)");
+    emitLine("    return arr.size or math.max(#arr, " + base + ")");
+    emitLine("end");
+    endHelper();
+    beginHelper({"array_append"});
+    emitLine("local function array_append(arr, value)");
+    emitLine("    local n = array_slots(arr)");
+    emitLine("    local data = arr.data");
+    emitLine("    if data then");
+    emitLine("        local cap = arr.cap or n");
+    emitLine("        if n >= cap then");
+    emitLine("            cap = math.max(cap * 2, 8)");
+    emitLine("            local grown = ffi.new(arr.type .. '[?]', cap)");
+    emitLine("            ffi.copy(grown, data, n * ffi.sizeof(arr.type))");
+    emitLine("            arr.data, arr.cap = grown, cap");
+    emitLine("            data = grown");
+    emitLine("        end");
+    emitLine("        data[n] = value");
+    emitLine("    else");
+    emitLine("        arr[n" + tableOffset + "] = value");
+    emitLine("    end");
+    emitLine("    arr.size = n + 1");
+    emitLine("end");
+    endHelper();
+    beginHelper({"array_pop"});
+    emitLine("local function array_pop(arr)");
+    emitLine("    local n = array_slots(arr) - 1");
+    emitLine("    if n < " + base + " then error('POP FROM EMPTY ARRAY', 0) end");
+    emitLine("    local data, value = arr.data");
+    emitLine("    if data then");
+    emitLine("        value = data[n]");
+    emitLine("        data[n] = 0");
+    emitLine("    else");
+    emitLine("        value = arr[n" + tableOffset + "]");
+    emitLine("        arr[n" + tableOffset + "] = nil");
+    emitLine("    end");
+    emitLine("    arr.size = n");
+    emitLine("    return value");
+    emitLine("end");
+    endHelper();
+    beginHelper({"array_len"});
+    emitLine("local function array_len(arr)");
+    emitLine("    return array_slots(arr)" + (m_arrayBase == 0 ? "" : " - " + base));
+    emitLine("end");
+    endHelper();
+    emitLine("");
+
+    if (m_usesDicts) {
+        beginHelper({"dict_new"});
+        emitLine("-- Dictionaries (DIM D AS DICT) keep an entry count in d.n. String keys");
+        emitLine("-- or string values live in the Lua table d.t. Numeric keys with numeric");
+        emitLine("-- values use an open-addressing hash table in FFI arrays: linear probing");
+        emitLine("-- over a power-of-two capacity, state 0 = empty, 1 = used, 2 = deleted,");
+        emitLine("-- rehashed when three quarters of the slots are not empty");
+        emitLine("local function dict_new()");
+        emitLine("    return {t = {}, n = 0}");
+        emitLine("end");
+        endHelper();
+        beginHelper({"dict_bits", "dict_hash"});
+        emitLine("local dict_bits = use_ffi and ffi.new('union { double d; int32_t w[2]; }')");
+        emitLine("local function dict_hash(k)");
+        emitLine("    local h = bit.tobit(k)");
+        emitLine("    if h ~= k then");
+        emitLine("        dict_bits.d = k");
+        emitLine("        h = bxor(dict_bits.w[0], dict_bits.w[1])");
+        emitLine("    end");
+        emitLine("    return bxor(h, bit.rshift(h, 7), bit.rshift(h, 15))");
+        emitLine("end");
+        endHelper();
+        beginHelper({"dict_alloc"});
+        emitLine("local function dict_alloc(d, cap)");
+        emitLine("    d.keys = ffi.new('double[?]', cap)");
+        emitLine("    d.vals = ffi.new(d.type .. '[?]', cap)");
+        emitLine("    d.state = ffi.new('uint8_t[?]', cap)");
+        emitLine("    d.cap, d.mask, d.used = cap, cap - 1, 0");
+        emitLine("end");
+        endHelper();
+        beginHelper({"dict_new_numeric"});
+        emitLine("local function dict_new_numeric(value_type)");
+        emitLine("    if not use_ffi then return dict_new() end");
+        emitLine("    local d = {type = value_type, n = 0}");
+        emitLine("    dict_alloc(d, 16)");
+        emitLine("    return d");
+        emitLine("end");
+        endHelper();
+        beginHelper({"dict_find"});
+        emitLine("local function dict_find(d, k)");
+        emitLine("    local keys, state, mask = d.keys, d.state, d.mask");
+        emitLine("    local i = band(dict_hash(k), mask)");
+        emitLine("    while true do");
+        emitLine("        local s = state[i]");
+        emitLine("        if s == 0 then return -1 end");
+        emitLine("        if s == 1 and keys[i] == k then return i end");
+        emitLine("        i = band(i + 1, mask)");
+        emitLine("    end");
+        emitLine("end");
+        endHelper();
+        beginHelper({"dict_rehash"});
+        emitLine("local function dict_rehash(d)");
+        emitLine("    local keys, vals, state, cap = d.keys, d.vals, d.state, d.cap");
+        emitLine("    local size = cap");
+        emitLine("    while d.n * 2 >= size do size = size * 2 end");
+        emitLine("    dict_alloc(d, size)");
+        emitLine("    local new_keys, new_vals, new_state, mask = d.keys, d.vals, d.state, d.mask");
+        emitLine("    for j = 0, cap - 1 do");
+        emitLine("        if state[j] == 1 then");
+        emitLine("            local i = band(dict_hash(keys[j]), mask)");
+        emitLine("            while new_state[i] ~= 0 do i = band(i + 1, mask) end");
+        emitLine("            new_keys[i], new_vals[i], new_state[i] = keys[j], vals[j], 1");
+        emitLine("        end");
+        emitLine("    end");
+        emitLine("    d.used = d.n");
+        emitLine("end");
+        endHelper();
+        beginHelper({"dict_get"});
+        emitLine("local function dict_get(d, k)");
+        emitLine("    local t = d.t");
+        emitLine("    if t then return t[k] or 0 end");
+        emitLine("    local i = dict_find(d, k)");
+        emitLine("    return i >= 0 and d.vals[i] or 0");
+        emitLine("end");
+        endHelper();
+        beginHelper({"dict_set"});
+        emitLine("local function dict_set(d, k, v)");
+        emitLine("    local t = d.t");
+        emitLine("    if t then");
+        emitLine("        if t[k] == nil then d.n = d.n + 1 end");
+        emitLine("        t[k] = v");
+        emitLine("        return");
+        emitLine("    end");
+        emitLine("    if k ~= k then error('DICTIONARY KEY IS NOT A NUMBER', 0) end");
+        emitLine("    local keys, state, mask = d.keys, d.state, d.mask");
+        emitLine("    local i, free = band(dict_hash(k), mask), -1");
+        emitLine("    while true do");
+        emitLine("        local s = state[i]");
+        emitLine("        if s == 0 then break end");
+        emitLine("        if s == 1 then");
+        emitLine("            if keys[i] == k then d.vals[i] = v return end");
+        emitLine("        elseif free < 0 then");
+        emitLine("            free = i");
+        emitLine("        end");
+        emitLine("        i = band(i + 1, mask)");
+        emitLine("    end");
+        emitLine("    if free >= 0 then i = free else d.used = d.used + 1 end");
+        emitLine("    keys[i], d.vals[i], state[i] = k, v, 1");
+        emitLine("    d.n = d.n + 1");
+        emitLine("    if d.used * 4 >= d.cap * 3 then dict_rehash(d) end");
+        emitLine("end");
+        endHelper();
+        beginHelper({"dict_has"});
+        emitLine("local function dict_has(d, k)");
+        emitLine("    local t = d.t");
+        emitLine("    if t then return t[k] ~= nil and -1 or 0 end");
+        emitLine("    return dict_find(d, k) >= 0 and -1 or 0");
+        emitLine("end");
+        endHelper();
+        beginHelper({"dict_remove"});
+        emitLine("local function dict_remove(d, k)");
+        emitLine("    local t = d.t");
+        emitLine("    if t then");
+        emitLine("        if t[k] ~= nil then t[k] = nil; d.n = d.n - 1 end");
+        emitLine("        return");
+        emitLine("    end");
+        emitLine("    local i = dict_find(d, k)");
+        emitLine("    if i >= 0 then d.state[i], d.vals[i], d.n = 2, 0, d.n - 1 end");
+        emitLine("end");
+        endHelper();
+        beginHelper({"dict_keys"});
+        emitLine("-- KEYS D, A: A becomes the keys in ascending order");
+        emitLine("local function dict_keys(d, arr, convert)");
+        emitLine("    local list, count = {}, 0");
+        emitLine("    if d.t then");
+        emitLine("        for k in pairs(d.t) do count = count + 1; list[count] = k end");
+        emitLine("    else");
+        emitLine("        local keys, state = d.keys, d.state");
+        emitLine("        for i = 0, d.cap - 1 do");
+        emitLine("            if state[i] == 1 then count = count + 1; list[count] = keys[i] end");
+        emitLine("        end");
+        emitLine("    end");
+        emitLine("    table.sort(list)");
+        emitLine("    if arr.data then");
+        emitLine("        arr.cap = arr.cap or arr.size");
+        emitLine("    else");
+        emitLine("        for i = #arr, 1, -1 do arr[i] = nil end");
+        emitLine("    end");
+        emitLine("    arr.size = " + base);
+        emitLine("    for i = 1, count do");
+        emitLine("        array_append(arr, convert and convert(list[i]) or list[i])");
+        emitLine("    end");
+        emitLine("end");
+        endHelper();
+        emitLine("");
+    }
     
     // SIMD support for ARM NEON acceleration (if program uses SIMD operations)
     if (m_usesSIMD) {
@@ -340,6 +916,7 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("local _main_coroutine = nil  -- Main script coroutine");
     emitLine("local _main_wait_until_frame = nil  -- Frame when main script should resume");
     emitLine("");
+    beginHelper({"basic_wait_frame"});
     emitLine("-- Smart WAIT wrappers that yield in handlers, block in main program");
     emitLine("local function basic_wait_frame()");
     emitLine("    if _current_handler then");
@@ -349,7 +926,9 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("        wait_frame()");
     emitLine("    end");
     emitLine("end");
+    endHelper();
     emitLine("");
+    beginHelper({"basic_wait_frames"});
     emitLine("local function basic_wait_frames(count)");
     emitLine("    if _current_handler then");
     emitLine("        -- Handler waiting - yield the handler coroutine");
@@ -361,7 +940,9 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("        coroutine.yield('wait_frames', _main_wait_until_frame)");
     emitLine("    end");
     emitLine("end");
+    endHelper();
     emitLine("");
+    beginHelper({"basic_wait_ms"});
     emitLine("local function basic_wait_ms(milliseconds)");
     emitLine("    if _current_handler then");
     emitLine("        local frames = math.ceil(milliseconds / 16.67)");
@@ -371,7 +952,9 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("        wait_ms(milliseconds)");
     emitLine("    end");
     emitLine("end");
+    endHelper();
     emitLine("");
+    beginHelper({"basic_sleep"});
     emitLine("local function basic_sleep(seconds)");
     emitLine("    -- Convert seconds to milliseconds and yield appropriately");
     emitLine("    if _current_handler then");
@@ -388,6 +971,7 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("        coroutine.yield('wait_frames', _main_wait_until_frame)");
     emitLine("    end");
     emitLine("end");
+    endHelper();
     emitLine("");
     emitLine("-- Enhanced event-checker coroutine with WAIT support");
     emitLine("local _event_checker = coroutine.create(function()");
@@ -559,138 +1143,242 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("    end");
     emitLine("end");
     emitLine("");
+    beginHelper({"_set_timer_interval"});
     emitLine("-- Function to set timer check interval");
     emitLine("local function _set_timer_interval(interval)");
     emitLine("    _timer_check_interval = interval");
     emitLine("    debug.sethook(_event_checker_hook, '', interval)");
     emitLine("end");
+    endHelper();
     emitLine("");
     emitLine("-- Install the debug hook with default interval");
     emitLine("debug.sethook(_event_checker_hook, '', _timer_check_interval)");
     emitLine("");
 
+    beginHelper({"basic_input"});
     emitLine("local function basic_input()");
-    emitLine("    return tonumber(io.read()) or 0");
+    emitLine("    return basic_val(io.read())");
     emitLine("end");
+    endHelper();
     emitLine("");
 
-    emitLine("local function basic_rnd()");
-    emitLine("    return math.random()");
+    // RND/RANDOMIZE: xoshiro256** on uint64_t cdata. The step is a handful of
+    // 64-bit bit ops the JIT compiles inline, and a seed gives the same
+    // sequence on every platform (math.random is libc-dependent)
+    beginHelper({"rnd_state", "rnd_seed_bits", "rnd_rol", "rnd_shr", "rnd_last", "rnd_seed", "rnd_next"});
+    emitLine("-- RND: xoshiro256** generator, seeded through splitmix64");
+    emitLine("local rnd_state = ffi.new('uint64_t[4]')");
+    emitLine("local rnd_seed_bits = ffi.new('union { double d; uint64_t u; }')");
+    emitLine("local rnd_rol, rnd_shr = bit.rol, bit.rshift");
+    emitLine("local rnd_last = 0");
+    emitLine("local function rnd_seed(seed)");
+    emitLine("    rnd_seed_bits.d = seed");
+    emitLine("    local z = rnd_seed_bits.u");
+    emitLine("    for i = 0, 3 do");
+    emitLine("        z = z + 0x9E3779B97F4A7C15ULL");
+    emitLine("        local x = z");
+    emitLine("        x = bxor(x, rnd_shr(x, 30)) * 0xBF58476D1CE4E5B9ULL");
+    emitLine("        x = bxor(x, rnd_shr(x, 27)) * 0x94D049BB133111EBULL");
+    emitLine("        rnd_state[i] = bxor(x, rnd_shr(x, 31))");
+    emitLine("    end");
     emitLine("end");
+    emitLine("-- Next value in [0, 1) from the top 53 bits of the output");
+    emitLine("local function rnd_next()");
+    emitLine("    local s = rnd_state");
+    emitLine("    local s0, s1, s2, s3 = s[0], s[1], s[2], s[3]");
+    emitLine("    local result = rnd_rol(s1 * 5, 7) * 9");
+    emitLine("    local t = lshift(s1, 17)");
+    emitLine("    s2 = bxor(s2, s0)");
+    emitLine("    s3 = bxor(s3, s1)");
+    emitLine("    s[0] = bxor(s0, s3)");
+    emitLine("    s[1] = bxor(s1, s2)");
+    emitLine("    s[2] = bxor(s2, t)");
+    emitLine("    s[3] = rnd_rol(s3, 45)");
+    emitLine("    return tonumber(rnd_shr(result, 11)) * 2^-53");
+    emitLine("end");
+    emitLine("rnd_seed(0)");
+    endHelper();
+    beginHelper({"basic_rnd"});
+    emitLine("-- RND(n): n > 0 or omitted = next value, n = 0 = last value again,");
+    emitLine("-- n < 0 = reseed with n first (the same n always gives the same value)");
+    emitLine("local function basic_rnd(n)");
+    emitLine("    if n and n <= 0 then");
+    emitLine("        if n == 0 then return rnd_last end");
+    emitLine("        rnd_seed(n)");
+    emitLine("    end");
+    emitLine("    rnd_last = rnd_next()");
+    emitLine("    return rnd_last");
+    emitLine("end");
+    endHelper();
+    beginHelper({"basic_randomize"});
+    emitLine("-- RANDOMIZE [seed]: without a seed, seed from the clock");
+    emitLine("local function basic_randomize(seed)");
+    emitLine("    rnd_seed(seed or (os.time() + os.clock()))");
+    emitLine("end");
+    endHelper();
+    beginHelper({"basic_rnd_fill"});
+    emitLine("-- A() = RND: fill a whole array with fresh values");
+    emitLine("local function basic_rnd_fill(arr)");
+    emitLine("    local v = rnd_last");
+    emitLine("    if arr.data then");
+    emitLine("        local data = arr.data");
+    emitLine("        for i = 0, arr.size - 1 do");
+    emitLine("            v = rnd_next()");
+    emitLine("            data[i] = v");
+    emitLine("        end");
+    emitLine("    else");
+    emitLine("        for i = 1, #arr do");
+    emitLine("            v = rnd_next()");
+    emitLine("            arr[i] = v");
+    emitLine("        end");
+    emitLine("    end");
+    emitLine("    rnd_last = v");
+    emitLine("end");
+    endHelper();
     emitLine("");
 
     emitLine("-- BASIC Boolean Conversion Functions");
     emitLine("-- BASIC uses 0 for FALSE and -1 for TRUE");
     emitLine("-- Lua uses false and true, where ONLY false and nil are falsy (0 is truthy!)");
     emitLine("");
+    beginHelper({"basicBoolToLua"});
     emitLine("-- Convert BASIC boolean (0/-1 or any number) to Lua boolean");
     emitLine("-- Also handles Lua booleans (true/false) from comparison operators");
     emitLine("local function basicBoolToLua(val)");
     emitLine("    if type(val) == 'boolean' then return val end");
     emitLine("    return val ~= 0");
     emitLine("end");
+    endHelper();
     emitLine("");
+    beginHelper({"luaBoolToBasic"});
     emitLine("-- Convert Lua boolean to BASIC boolean (-1 for true, 0 for false)");
     emitLine("local function luaBoolToBasic(val)");
     emitLine("    return val and -1 or 0");
     emitLine("end");
+    endHelper();
     emitLine("");
 
+    beginHelper({"string_buffer_mt", "create_string_buffer", "is_string_buffer", "string_buffer_value", "buffer_to_string", "buffer_value", "mid_assign_buffer", "basic_mid_assign_buffer"});
     emitLine("-- String Buffer System for Efficient MID$ Assignment");
-    emitLine("-- Creates a mutable character array for efficient string manipulation");
+    emitLine("-- A buffer is a growable FFI byte array: MID$ writes go in place and the");
+    emitLine("-- Lua string is rebuilt only when the whole value is read (then cached)");
+    emitLine("local string_buffer_mt = {}");
+    emitLine("");
     emitLine("local function create_string_buffer(initial_string)");
-    emitLine("    if not initial_string then initial_string = '' end");
-    emitLine("    local buffer = {}");
-    emitLine("    -- Convert string to character array for O(1) access");
-    emitLine("    for i = 1, #initial_string do");
-    emitLine("        buffer[i] = initial_string:sub(i, i)");
+    emitLine("    if getmetatable(initial_string) == string_buffer_mt then");
+    emitLine("        initial_string = initial_string:value()");
     emitLine("    end");
-    emitLine("    buffer._length = #initial_string");
-    emitLine("    buffer._is_buffer = true");
-    emitLine("    return buffer");
+    emitLine("    initial_string = tostring(initial_string or '')");
+    emitLine("    local length = #initial_string");
+    emitLine("    local capacity = length < 16 and 16 or length");
+    emitLine("    local data = ffi.new('uint8_t[?]', capacity)");
+    emitLine("    ffi.copy(data, initial_string, length)");
+    emitLine("    return setmetatable({");
+    emitLine("        _data = data,");
+    emitLine("        _length = length,");
+    emitLine("        _capacity = capacity,");
+    emitLine("        _string = initial_string,");
+    emitLine("        _is_buffer = true");
+    emitLine("    }, string_buffer_mt)");
+    emitLine("end");
+    emitLine("");
+    emitLine("-- Check if a value is a string buffer");
+    emitLine("local function is_string_buffer(value)");
+    emitLine("    return getmetatable(value) == string_buffer_mt");
+    emitLine("end");
+    emitLine("");
+    emitLine("-- Current contents as a Lua string (cached until the next write)");
+    emitLine("local function string_buffer_value(buffer)");
+    emitLine("    local s = buffer._string");
+    emitLine("    if not s then");
+    emitLine("        s = ffi.string(buffer._data, buffer._length)");
+    emitLine("        buffer._string = s");
+    emitLine("    end");
+    emitLine("    return s");
+    emitLine("end");
+    emitLine("");
+    emitLine("string_buffer_mt.__index = { value = string_buffer_value }");
+    emitLine("string_buffer_mt.__tostring = string_buffer_value");
+    emitLine("string_buffer_mt.__concat = function(a, b)");
+    emitLine("    if is_string_buffer(a) then a = string_buffer_value(a) end");
+    emitLine("    if is_string_buffer(b) then b = string_buffer_value(b) end");
+    emitLine("    return a .. b");
     emitLine("end");
     emitLine("");
     emitLine("-- Convert string buffer back to regular string");
     emitLine("local function buffer_to_string(buffer)");
-    emitLine("    if not buffer or not buffer._is_buffer then");
+    emitLine("    if not is_string_buffer(buffer) then");
     emitLine("        return tostring(buffer or '')");
     emitLine("    end");
-    emitLine("    return table.concat(buffer, '', 1, buffer._length)");
+    emitLine("    return string_buffer_value(buffer)");
     emitLine("end");
     emitLine("");
-    emitLine("-- Efficient MID$ assignment using string buffer");
-    emitLine("local function mid_assign_buffer(buffer, pos, len, replacement)");
-    emitLine("    if not buffer._is_buffer then");
-    emitLine("        error('mid_assign_buffer requires a string buffer')");
+    emitLine("-- Read a buffered variable: buffers become strings, other values pass through");
+    emitLine("local function buffer_value(value)");
+    emitLine("    if getmetatable(value) == string_buffer_mt then");
+    emitLine("        return string_buffer_value(value)");
     emitLine("    end");
+    emitLine("    return value");
+    emitLine("end");
+    emitLine("");
+    emitLine("-- In-place MID$ assignment; same result as rebuilding the string");
+    emitLine("local function mid_assign_buffer(buffer, pos, len, replacement)");
     emitLine("    if pos < 1 then pos = 1 end");
-    emitLine("    if len < 1 then return end");
+    emitLine("    local length = buffer._length");
+    emitLine("    if len < 1 or pos > length then return end");
+    emitLine("    replacement = buffer_to_string(replacement)");
+    emitLine("    local rep_len = math.min(len, #replacement)");
+    emitLine("    if rep_len < 1 then return end");
     emitLine("    ");
-    emitLine("    -- Extend buffer if necessary");
-    emitLine("    local end_pos = pos + len - 1");
-    emitLine("    if end_pos > buffer._length then");
-    emitLine("        -- Extend buffer with spaces");
-    emitLine("        for i = buffer._length + 1, end_pos do");
-    emitLine("            buffer[i] = ' '");
-    emitLine("        end");
-    emitLine("        buffer._length = end_pos");
+    emitLine("    -- A replacement running past the end extends the string");
+    emitLine("    local end_pos = pos + rep_len - 1");
+    emitLine("    if end_pos > buffer._capacity then");
+    emitLine("        local capacity = math.max(end_pos, buffer._capacity * 2)");
+    emitLine("        local data = ffi.new('uint8_t[?]', capacity)");
+    emitLine("        ffi.copy(data, buffer._data, length)");
+    emitLine("        buffer._data = data");
+    emitLine("        buffer._capacity = capacity");
     emitLine("    end");
-    emitLine("    ");
-    emitLine("    -- Perform efficient character-by-character assignment");
-    emitLine("    local rep_len = math.min(len, #replacement)");
-    emitLine("    for i = 1, rep_len do");
-    emitLine("        buffer[pos + i - 1] = replacement:sub(i, i)");
+    emitLine("    ffi.copy(buffer._data + (pos - 1), replacement, rep_len)");
+    emitLine("    if end_pos > length then");
+    emitLine("        buffer._length = end_pos");
     emitLine("    end");
+    emitLine("    buffer._string = nil");
     emitLine("end");
     emitLine("");
-    emitLine("-- Check if a value is a string buffer");
-    emitLine("local function is_string_buffer(value)");
-    emitLine("    return type(value) == 'table' and value._is_buffer == true");
-    emitLine("end");
-    emitLine("");
-    emitLine("-- Ensure a string value is converted to a buffer if needed");
-    emitLine("local function ensure_string_buffer(value)");
-    emitLine("    if is_string_buffer(value) then");
-    emitLine("        return value");
-    emitLine("    else");
-    emitLine("        return create_string_buffer(tostring(value))");
+    emitLine("-- MID$ assignment to a buffered variable: the first write converts it");
+    emitLine("local function basic_mid_assign_buffer(target, pos, len, replacement)");
+    emitLine("    if not is_string_buffer(target) then");
+    emitLine("        target = create_string_buffer(target)");
     emitLine("    end");
+    emitLine("    mid_assign_buffer(target, pos, len, replacement)");
+    emitLine("    return target");
     emitLine("end");
-    emitLine("");
-    emitLine("-- Auto-convert variable to buffer mode for efficient MID$ assignment");
-    emitLine("local function auto_convert_to_buffer(value)");
-    if (m_bufferMode) {
-        emitLine("    -- Buffer mode enabled: always convert to buffers");
-        emitLine("    return ensure_string_buffer(value)");
-    } else {
-        emitLine("    -- Buffer mode disabled: return as-is");
-        emitLine("    return value");
-    }
-    emitLine("end");
+    endHelper();
     emitLine("");
 
+    beginHelper({"basic_mid_assign"});
     emitLine("-- MID$ assignment function with intelligent buffer support");
     emitLine("-- Simulates: MID$(original$, pos, len) = replacement$");
 
     if (m_unicodeMode) {
-        emitLine("-- Unicode mode: strings are tables of codepoints (mutable!)");
-        emitLine("-- We can do TRUE in-place modification for better performance");
+        emitLine("-- Unicode mode: strings are immutable codepoint buffers, so splice");
+        emitLine("-- the replacement in with a single concat_many allocation");
         emitLine("local function basic_mid_assign(original, pos, len, replacement)");
         emitLine("    -- Handle edge cases");
         emitLine("    if pos < 1 then pos = 1 end");
         emitLine("    if len < 1 then return original end");
         emitLine("    ");
         emitLine("    -- If position is beyond the string, return original unchanged");
-        emitLine("    if pos > #original then return original end");
+        emitLine("    local origLen = unicode.length(original)");
+        emitLine("    if pos > origLen then return original end");
         emitLine("    ");
-        emitLine("    -- Modify the table IN PLACE (tables are mutable!)");
-        emitLine("    local replaceLen = math.min(len, #replacement)");
-        emitLine("    for i = 1, replaceLen do");
-        emitLine("        original[pos + i - 1] = replacement[i]");
-        emitLine("    end");
-        emitLine("    ");
-        emitLine("    -- Return the modified table (same reference)");
-        emitLine("    return original");
+        emitLine("    local replaceLen = math.min(len, unicode.length(replacement), origLen - pos + 1)");
+        emitLine("    return unicode.concat_many({");
+        emitLine("        unicode.left(original, pos - 1),");
+        emitLine("        unicode.left(replacement, replaceLen),");
+        emitLine("        unicode.substring(original, pos + replaceLen)");
+        emitLine("    })");
         emitLine("end");
     } else {
         emitLine("-- Standard mode: intelligent buffer vs string reconstruction");
@@ -699,20 +1387,10 @@ void LuaCodeGenerator::emitHeader() {
         emitLine("    if pos < 1 then pos = 1 end");
         emitLine("    if len < 1 then return original end");
         emitLine("    ");
-        emitLine("    -- Check if original is already a buffer");
+        emitLine("    -- Check if original is already a buffer (BUFFER$)");
         emitLine("    if is_string_buffer(original) then");
-        emitLine("        -- Use efficient buffer assignment");
-        emitLine("        mid_assign_buffer(original, pos, len, tostring(replacement))");
+        emitLine("        mid_assign_buffer(original, pos, len, replacement)");
         emitLine("        return original");
-        
-        if (m_bufferMode) {
-            emitLine("    elseif type(original) == 'string' then");
-            emitLine("        -- Buffer mode enabled: convert to buffer for efficient assignment");
-            emitLine("        local buffer = create_string_buffer(original)");
-            emitLine("        mid_assign_buffer(buffer, pos, len, tostring(replacement))");
-            emitLine("        return buffer");
-        }
-        
         emitLine("    end");
         emitLine("    ");
         emitLine("    -- For regular strings, use reconstruction (preserves current behavior)");
@@ -751,21 +1429,27 @@ void LuaCodeGenerator::emitHeader() {
         emitLine("    return result");
         emitLine("end");
     }
+    endHelper();
     emitLine("");
 
+    beginHelper({"basic_sgn"});
     emitLine("-- Custom math functions for BBC BASIC compatibility");
     emitLine("local function basic_sgn(x)");
     emitLine("    if x > 0 then return 1");
     emitLine("    elseif x < 0 then return -1");
     emitLine("    else return 0 end");
     emitLine("end");
+    endHelper();
     emitLine("");
+    beginHelper({"basic_fix"});
     emitLine("local function basic_fix(x)");
     emitLine("    -- Truncate towards zero (different from math.floor)");
     emitLine("    if x >= 0 then return math.floor(x)");
     emitLine("    else return math.ceil(x) end");
     emitLine("end");
+    endHelper();
     emitLine("");
+    beginHelper({"basic_mod"});
     emitLine("local function basic_mod(x, y)");
     emitLine("    -- Enhanced MOD function");
     emitLine("    if y then");
@@ -782,115 +1466,148 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("        return 0  -- Invalid usage");
     emitLine("    end");
     emitLine("end");
+    endHelper();
     emitLine("");
 
-    emitLine("-- PRINT USING formatter");
-    emitLine("local function basic_print_using(format, ...)");
-    emitLine("    local values = {...}");
-    emitLine("    local result = ''");
-    emitLine("    local valueIndex = 1");
-    emitLine("    local i = 1");
-    emitLine("    ");
-    emitLine("    while i <= #format do");
-    emitLine("        local ch = format:sub(i, i)");
-    emitLine("        ");
+    beginHelper({"using_format", "using_fmt", "using_cache", "using_cache_size", "using_buf", "using_commas", "using_field", "using_compile", "basic_print_using"});
+    emitLine("-- PRINT USING formatter. A format is parsed once into literal runs and");
+    emitLine("-- field converters, cached by format string; literal formats are");
+    emitLine("-- specialized at compile time into using_fmt[] (emitted before main runs)");
+    emitLine("local using_format = string.format");
+    emitLine("local using_fmt = {}");
+    emitLine("local using_cache = {}");
+    emitLine("local using_cache_size = 0");
+    emitLine("local using_buf = {}");
+    emitLine("");
+    emitLine("-- Integer field with thousands separators, right-aligned in width");
+    emitLine("local function using_commas(v, width)");
+    emitLine("    local formatted, k = using_format('%d', math.floor(tonumber(v) or 0)), 1");
+    emitLine("    while k > 0 do");
+    emitLine("        formatted, k = string.gsub(formatted, '^(-?%d+)(%d%d%d)', '%1,%2')");
+    emitLine("    end");
+    emitLine("    if #formatted < width then");
+    emitLine("        formatted = string.rep(' ', width - #formatted) .. formatted");
+    emitLine("    end");
+    emitLine("    return formatted");
+    emitLine("end");
+    emitLine("");
+    emitLine("local function using_field(spec, width)");
+    emitLine("    return function(v)");
+    emitLine("        local formatted = using_format(spec, tonumber(v) or 0)");
+    emitLine("        if #formatted < width then");
+    emitLine("            formatted = string.rep(' ', width - #formatted) .. formatted");
+    emitLine("        end");
+    emitLine("        return formatted");
+    emitLine("    end");
+    emitLine("end");
+    emitLine("");
+    emitLine("local function using_compile(format)");
+    emitLine("    local lits, convs = {}, {}");
+    emitLine("    local lit = ''");
+    emitLine("    local i, n = 1, #format");
+    emitLine("    while i <= n do");
+    emitLine("        local ch = string.sub(format, i, i)");
+    emitLine("        local conv");
     emitLine("        if ch == '&' then");
     emitLine("            -- Whole string");
-    emitLine("            if valueIndex <= #values then");
-    emitLine("                result = result .. tostring(values[valueIndex])");
-    emitLine("                valueIndex = valueIndex + 1");
-    emitLine("            end");
+    emitLine("            conv = tostring");
     emitLine("            i = i + 1");
-    emitLine("            ");
     emitLine("        elseif ch == '!' then");
     emitLine("            -- First character only");
-    emitLine("            if valueIndex <= #values then");
-    emitLine("                local s = tostring(values[valueIndex])");
-    emitLine("                result = result .. s:sub(1, 1)");
-    emitLine("                valueIndex = valueIndex + 1");
-    emitLine("            end");
+    emitLine("            conv = function(v) return string.sub(tostring(v), 1, 1) end");
     emitLine("            i = i + 1");
-    emitLine("            ");
     emitLine("        elseif ch == '\\\\' then");
     emitLine("            -- Fixed width string: \\  \\");
-    emitLine("            local endSlash = format:find('\\\\', i + 1)");
+    emitLine("            local endSlash = string.find(format, '\\\\', i + 1, true)");
     emitLine("            if endSlash then");
     emitLine("                local width = endSlash - i + 1");
-    emitLine("                if valueIndex <= #values then");
-    emitLine("                    local s = tostring(values[valueIndex])");
-    emitLine("                    if #s > width then");
-    emitLine("                        result = result .. s:sub(1, width)");
-    emitLine("                    else");
-    emitLine("                        result = result .. s .. string.rep(' ', width - #s)");
-    emitLine("                    end");
-    emitLine("                    valueIndex = valueIndex + 1");
+    emitLine("                conv = function(v)");
+    emitLine("                    local s = tostring(v)");
+    emitLine("                    if #s > width then return string.sub(s, 1, width) end");
+    emitLine("                    return s .. string.rep(' ', width - #s)");
     emitLine("                end");
     emitLine("                i = endSlash + 1");
     emitLine("            else");
-    emitLine("                result = result .. ch");
+    emitLine("                lit = lit .. ch");
     emitLine("                i = i + 1");
     emitLine("            end");
-    emitLine("            ");
     emitLine("        elseif ch == '#' then");
     emitLine("            -- Numeric format: ###.##");
-    emitLine("            local beforeDecimal = 0");
-    emitLine("            local afterDecimal = 0");
-    emitLine("            local hasDecimal = false");
-    emitLine("            local hasComma = false");
-    emitLine("            ");
-    emitLine("            while i <= #format and (format:sub(i,i) == '#' or format:sub(i,i) == '.' or format:sub(i,i) == ',') do");
-    emitLine("                if format:sub(i,i) == '.' then");
+    emitLine("            local field = string.match(format, '^[#.,]+', i)");
+    emitLine("            local beforeDecimal, afterDecimal = 0, 0");
+    emitLine("            local hasDecimal, hasComma = false, false");
+    emitLine("            for j = 1, #field do");
+    emitLine("                local c = string.sub(field, j, j)");
+    emitLine("                if c == '.' then");
     emitLine("                    hasDecimal = true");
-    emitLine("                elseif format:sub(i,i) == ',' then");
+    emitLine("                elseif c == ',' then");
     emitLine("                    hasComma = true");
+    emitLine("                elseif hasDecimal then");
+    emitLine("                    afterDecimal = afterDecimal + 1");
     emitLine("                else");
-    emitLine("                    if hasDecimal then");
-    emitLine("                        afterDecimal = afterDecimal + 1");
-    emitLine("                    else");
-    emitLine("                        beforeDecimal = beforeDecimal + 1");
-    emitLine("                    end");
+    emitLine("                    beforeDecimal = beforeDecimal + 1");
     emitLine("                end");
-    emitLine("                i = i + 1");
     emitLine("            end");
-    emitLine("            ");
-    emitLine("            if valueIndex <= #values then");
-    emitLine("                local num = tonumber(values[valueIndex]) or 0");
-    emitLine("                local formatted");
-    emitLine("                if hasDecimal then");
-    emitLine("                    formatted = string.format('%.'..afterDecimal..'f', num)");
-    emitLine("                else");
-    emitLine("                    formatted = string.format('%d', math.floor(num))");
-    emitLine("                end");
-    emitLine("                ");
-    emitLine("                -- Add thousands separators if requested");
-    emitLine("                if hasComma and not hasDecimal then");
-    emitLine("                    local k");
-    emitLine("                    formatted, k = string.gsub(formatted, '^(-?%d+)(%d%d%d)', '%1,%2')");
-    emitLine("                    while k > 0 do");
-    emitLine("                        formatted, k = string.gsub(formatted, '^(-?%d+),(%d%d%d,)', '%1,%2')");
-    emitLine("                    end");
-    emitLine("                end");
-    emitLine("                ");
-    emitLine("                -- Right-align in field");
-    emitLine("                local totalWidth = beforeDecimal + (hasDecimal and 1 + afterDecimal or 0)");
-    emitLine("                if #formatted < totalWidth then");
-    emitLine("                    result = result .. string.rep(' ', totalWidth - #formatted)");
-    emitLine("                end");
-    emitLine("                result = result .. formatted");
-    emitLine("                valueIndex = valueIndex + 1");
+    emitLine("            i = i + #field");
+    emitLine("            local width = beforeDecimal + (hasDecimal and 1 + afterDecimal or 0)");
+    emitLine("            if hasDecimal then");
+    emitLine("                conv = using_field('%.' .. afterDecimal .. 'f', width)");
+    emitLine("            elseif hasComma then");
+    emitLine("                conv = function(v) return using_commas(v, width) end");
+    emitLine("            else");
+    emitLine("                local field_d = using_field('%d', width)");
+    emitLine("                conv = function(v) return field_d(math.floor(tonumber(v) or 0)) end");
     emitLine("            end");
-    emitLine("            ");
     emitLine("        else");
-    emitLine("            -- Literal character");
-    emitLine("            result = result .. ch");
-    emitLine("            i = i + 1");
+    emitLine("            -- Literal run up to the next field character");
+    emitLine("            local j = string.find(format, '[&!\\\\#]', i) or n + 1");
+    emitLine("            lit = lit .. string.sub(format, i, j - 1)");
+    emitLine("            i = j");
+    emitLine("        end");
+    emitLine("        if conv then");
+    emitLine("            lits[#lits + 1] = lit");
+    emitLine("            convs[#convs + 1] = conv");
+    emitLine("            lit = ''");
     emitLine("        end");
     emitLine("    end");
-    emitLine("    ");
-    emitLine("    return result");
+    emitLine("    local tail, count = lit, #convs");
+    emitLine("    if count == 0 then");
+    emitLine("        return function() return tail end");
+    emitLine("    end");
+    emitLine("    return function(...)");
+    emitLine("        local argc = select('#', ...)");
+    emitLine("        local buf, k = using_buf, 0");
+    emitLine("        for f = 1, count do");
+    emitLine("            k = k + 1");
+    emitLine("            buf[k] = lits[f]");
+    emitLine("            if f <= argc then");
+    emitLine("                k = k + 1");
+    emitLine("                buf[k] = convs[f]((select(f, ...)))");
+    emitLine("            end");
+    emitLine("        end");
+    emitLine("        k = k + 1");
+    emitLine("        buf[k] = tail");
+    emitLine("        return table.concat(buf, '', 1, k)");
+    emitLine("    end");
+    emitLine("end");
+    emitLine("");
+    emitLine("local function basic_print_using(format, ...)");
+    emitLine("    local formatter = using_cache[format]");
+    emitLine("    if not formatter then");
+    emitLine("        -- Bound the cache for programs that build formats dynamically");
+    emitLine("        if using_cache_size >= 256 then");
+    emitLine("            using_cache, using_cache_size = {}, 0");
+    emitLine("        end");
+    emitLine("        formatter = using_compile(format)");
+    emitLine("        using_cache[format] = formatter");
+    emitLine("        using_cache_size = using_cache_size + 1");
+    emitLine("    end");
+    emitLine("    return formatter(...)");
     emitLine("end");
+    endHelper();
     emitLine("");
 
+    beginHelper({"string_instr"});
     emitLine("-- INSTR function for string searching");
     emitLine("local function string_instr(haystack, needle, start)");
     emitLine("    start = start or 1");
@@ -898,8 +1615,10 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("    local pos = string.find(haystack, needle, start, true)");
     emitLine("    return pos or 0");
     emitLine("end");
+    endHelper();
     emitLine("");
 
+    beginHelper({"string_join"});
     emitLine("-- JOIN$ function for joining string arrays");
     emitLine("local function string_join(array, separator)");
     emitLine("    if not array then return '' end");
@@ -929,8 +1648,10 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("    end");
     emitLine("    return result");
     emitLine("end");
+    endHelper();
     emitLine("");
 
+    beginHelper({"string_split"});
     emitLine("-- SPLIT$ function for splitting strings into arrays");
     emitLine("local function string_split(str, delimiter)");
     emitLine("    if not str or str == '' then return {} end");
@@ -957,8 +1678,10 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("    until not pos");
     emitLine("    return result");
     emitLine("end");
+    endHelper();
     emitLine("");
 
+    beginHelper({"stack", "sp", "push", "pop"});
     emitLine("-- Stack for expression evaluation");
     emitLine("local stack = {}");
     emitLine("local sp = 0");
@@ -975,8 +1698,10 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("    sp = sp - 1");
     emitLine("    return v");
     emitLine("end");
+    endHelper();
     emitLine("");
     
+    beginHelper({"LBOUND"});
     emitLine("-- LBOUND/UBOUND functions for array bounds");
     emitLine("-- These look up the array from global scope since argument is evaluated as variable");
     emitLine("local function LBOUND(arr_or_var, dim)");
@@ -984,8 +1709,10 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("    -- Always return OPTION BASE for LBOUND");
     emitLine("    return " + std::to_string(m_arrayBase));
     emitLine("end");
+    endHelper();
     emitLine("");
     
+    beginHelper({"UBOUND"});
     emitLine("local function UBOUND(arr_or_var, dim)");
     emitLine("    dim = dim or 1");
     emitLine("    -- arr_or_var might be a variable value or an array");
@@ -997,8 +1724,8 @@ void LuaCodeGenerator::emitHeader() {
     emitLine("        return 0  -- Cannot determine bounds");
     emitLine("    end");
     emitLine("    local max_idx = 0");
-    emitLine("    -- Handle FFI arrays");
-    emitLine("    if arr.data and arr.size then");
+    emitLine("    -- FFI arrays, and arrays grown by APPEND/POP");
+    emitLine("    if arr.size then");
     emitLine("        return arr.size - 1");
     emitLine("    end");
     emitLine("    -- Handle regular Lua tables");
@@ -1013,24 +1740,35 @@ void LuaCodeGenerator::emitHeader() {
         emitLine("    return max_idx - 1  -- Adjust for array size");
     }
     emitLine("end");
+    endHelper();
     emitLine("");
 
+    beginHelper({"constants"});
     emitLine("-- Constants table");
     emitLine("local constants = {}");
+    endHelper();
     emitLine("");
     emitLine("-- Temp variables for operations (declared at function scope to avoid goto issues)");
     emitLine("local _on_temp = 0  -- For ON GOTO/GOSUB/CALL selector");
     emitLine("local a, b, done, dim, idx, val, ret_label");
     emitLine("");
+    beginHelper({"idx0", "idx1", "idx2", "idx3", "idx4", "idx5", "idx6", "idx7", "idx8", "idx9"});
     emitLine("-- Reusable variables for multi-dimensional arrays (reduces local count)");
     emitLine("local idx0, idx1, idx2, idx3, idx4, idx5, idx6, idx7, idx8, idx9");
+    endHelper();
+    beginHelper({"dim0", "dim1", "dim2", "dim3", "dim4", "dim5", "dim6", "dim7", "dim8", "dim9"});
     emitLine("local dim0, dim1, dim2, dim3, dim4, dim5, dim6, dim7, dim8, dim9");
+    endHelper();
     emitLine("");
+    beginHelper({"for_start", "for_end", "for_step"});
     emitLine("-- Reusable FOR loop control variables (reduces local count)");
     emitLine("local for_start, for_end, for_step");
+    endHelper();
     emitLine("");
+    beginHelper({"_cursor_x", "_cursor_y"});
     emitLine("-- Cursor position for AT/LOCATE commands");
     emitLine("local _cursor_x, _cursor_y = 0, 0");
+    endHelper();
     emitLine("");
 
     // Error tracking variable (if enabled)
@@ -1050,7 +1788,123 @@ void LuaCodeGenerator::emitHeader() {
     emitParameterPoolDeclaration();
 }
 
+// OPTION JIT and OPTION GC: applied before anything runs, so every trace the
+// program records and every collection it triggers uses the program's settings
+void LuaCodeGenerator::emitRuntimeDirectives() {
+    bool jitDirectives = m_code->jitMode >= 0 || !m_code->jitSettings.empty();
+    bool gcDirectives = m_code->gcPause > 0 || m_code->gcStepMul > 0;
+    if (!jitDirectives && !gcDirectives) {
+        return;
+    }
+
+    emitLine("-- OPTION JIT / OPTION GC");
+    if (m_code->jitMode == 0) {
+        emitLine("if jit then jit.off() end");
+    } else if (m_code->jitMode == 1) {
+        emitLine("if jit then jit.on() end");
+    }
+    if (!m_code->jitSettings.empty()) {
+        std::string args;
+        for (const auto& setting : m_code->jitSettings) {
+            if (!args.empty()) args += ", ";
+            args += "'" + setting + "'";
+        }
+        emitLine("do");
+        emitLine("    local jit_opt_ok, jit_opt = pcall(require, 'jit.opt')");
+        emitLine("    if jit_opt_ok then jit_opt.start(" + args + ") end");
+        emitLine("end");
+    }
+    if (m_code->gcPause > 0) {
+        emitLine("collectgarbage('setpause', " + std::to_string(m_code->gcPause) + ")");
+    }
+    if (m_code->gcStepMul > 0) {
+        emitLine("collectgarbage('setstepmul', " + std::to_string(m_code->gcStepMul) + ")");
+    }
+    emitLine("");
+}
+
+// fbc --runtime-stats: count traces, aborts and machine code through
+// jit.attach, and GC cycles through a finalizer sentinel that re-arms itself
+// every cycle. The heap peak is sampled at those events and at exit, so it is
+// a lower bound. _rs.report() runs once, from the footer
+void LuaCodeGenerator::emitRuntimeStats() {
+    emitLine("-- Runtime statistics (fbc --runtime-stats)");
+    emitLine("local _rs = { start = os.clock(), traces = 0, aborts = 0, flushes = 0, mcode = 0,");
+    emitLine("    gc_cycles = 0, heap_peak = collectgarbage('count'), reasons = {}, done = false }");
+    emitLine("function _rs.sample()");
+    emitLine("    local kb = collectgarbage('count')");
+    emitLine("    if kb > _rs.heap_peak then _rs.heap_peak = kb end");
+    emitLine("end");
+    emitLine("function _rs.arm_gc()");
+    emitLine("    getmetatable(newproxy(true)).__gc = function()");
+    emitLine("        if _rs.done then return end");
+    emitLine("        _rs.gc_cycles = _rs.gc_cycles + 1");
+    emitLine("        _rs.sample()");
+    emitLine("        _rs.arm_gc()");
+    emitLine("    end");
+    emitLine("end");
+    emitLine("_rs.arm_gc()");
+    emitLine("if jit and jit.attach then");
+    emitLine("    local util_ok, jit_util = pcall(require, 'jit.util')");
+    emitLine("    local vmdef_ok, vmdef = pcall(require, 'jit.vmdef')");
+    emitLine("    jit.attach(function(what, tr, func, pc, otr, oex)");
+    emitLine("        if what == 'stop' then");
+    emitLine("            _rs.traces = _rs.traces + 1");
+    emitLine("            local mcode = util_ok and jit_util.tracemc(tr)");
+    emitLine("            if mcode then _rs.mcode = _rs.mcode + #mcode end");
+    emitLine("        elseif what == 'abort' then");
+    emitLine("            _rs.aborts = _rs.aborts + 1");
+    emitLine("            local reason = 'trace error ' .. tostring(otr)");
+    emitLine("            if vmdef_ok and type(otr) == 'number' and vmdef.traceerr[otr] then");
+    emitLine("                reason = vmdef.traceerr[otr]");
+    emitLine("                if type(oex) == 'number' or type(oex) == 'string' then");
+    emitLine("                    local ok, text = pcall(string.format, reason, oex)");
+    emitLine("                    if ok then reason = text end");
+    emitLine("                end");
+    emitLine("            end");
+    emitLine("            _rs.reasons[reason] = (_rs.reasons[reason] or 0) + 1");
+    emitLine("        elseif what == 'flush' then");
+    emitLine("            _rs.flushes = _rs.flushes + 1");
+    emitLine("        end");
+    emitLine("        _rs.sample()");
+    emitLine("    end, 'trace')");
+    emitLine("end");
+    emitLine("function _rs.report()");
+    emitLine("    if _rs.done then return end");
+    emitLine("    _rs.sample()");
+    emitLine("    _rs.done = true");
+    emitLine("    io.stdout:flush()");
+    emitLine("    local out = io.stderr");
+    emitLine("    out:write('\\n=== Runtime Statistics ===\\n')");
+    emitLine("    if jit then");
+    emitLine("        out:write(string.format('JIT:          %s (%s)\\n', jit.status() and 'on' or 'off', jit.version))");
+    emitLine("        out:write(string.format('Traces:       %d compiled, %d aborted, %d flushes\\n', _rs.traces, _rs.aborts, _rs.flushes))");
+    emitLine("        local reasons = {}");
+    emitLine("        for reason, count in pairs(_rs.reasons) do reasons[#reasons + 1] = { reason, count } end");
+    emitLine("        table.sort(reasons, function(a, b) return a[2] > b[2] end)");
+    emitLine("        for i = 1, math.min(#reasons, 5) do");
+    emitLine("            out:write(string.format('  %6d x %s\\n', reasons[i][2], reasons[i][1]))");
+    emitLine("        end");
+    emitLine("        out:write(string.format('Machine code: %.1f KB\\n', _rs.mcode / 1024))");
+    emitLine("    else");
+    emitLine("        out:write('JIT:          not available\\n')");
+    emitLine("    end");
+    emitLine("    out:write(string.format('GC cycles:    %d\\n', _rs.gc_cycles))");
+    emitLine("    out:write(string.format('Heap peak:    %.1f KB (sampled), %.1f KB at exit\\n', _rs.heap_peak, collectgarbage('count')))");
+    emitLine("    out:write(string.format('CPU time:     %.3f s\\n', os.clock() - _rs.start))");
+    emitLine("end");
+    emitLine("");
+}
+
 void LuaCodeGenerator::emitFooter() {
+    if (!m_usingFormatters.empty()) {
+        emitLine("");
+        emitLine("-- PRINT USING formatters for literal formats");
+        for (size_t i = 0; i < m_usingFormatters.size(); i++) {
+            emitLine("using_fmt[" + std::to_string(i + 1) + "] = " + m_usingFormatters[i]);
+        }
+    }
+
     emitLine("");
     emitLine("-- Entry point: wrap main in coroutine and start event loop");
     emitLine("_main_coroutine = coroutine.create(main)");
@@ -1061,6 +1915,9 @@ void LuaCodeGenerator::emitFooter() {
     emitLine("    -- Cleanup timer system on error");
     emitLine("    debug.sethook(nil)");
     emitLine("    basic_timer_shutdown()");
+    if (m_config.runtimeStats) {
+        emitLine("    _rs.report()");
+    }
     emitLine("    ");
     if (m_errorTracking) {
         emitLine("    if _LINE > 0 then");
@@ -1106,6 +1963,9 @@ void LuaCodeGenerator::emitFooter() {
     emitLine("-- Cleanup");
     emitLine("debug.sethook(nil)");
     emitLine("basic_timer_shutdown()");
+    if (m_config.runtimeStats) {
+        emitLine("_rs.report()");
+    }
 }
 
 void LuaCodeGenerator::emitVariableDeclarations() {
@@ -1132,11 +1992,153 @@ void LuaCodeGenerator::emitArrayDeclarations() {
     m_stats.arraysUsed = m_arrays.size();
 }
 
+// Format a number (a DATA value or a literal) as a Lua constant that reads
+// back to the same double
+static std::string numberLiteral(double value) {
+    if (std::isnan(value)) return "(0/0)";
+    if (std::isinf(value)) return value > 0 ? "(1/0)" : "(-1/0)";
+    if (value == std::floor(value) && std::fabs(value) < 1e15) {
+        return std::to_string(static_cast<long long>(value));
+    }
+    // 15 digits when they round-trip (0.1 stays 0.1), otherwise all 17
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+    if (std::strtod(buffer, nullptr) != value) {
+        std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    }
+    return buffer;
+}
+
 void LuaCodeGenerator::emitDataSection(const IRCode& irCode) {
-    // DATA is now stored in C++ DataManager, not in Lua
-    // The DataManager will be initialized by FBRunner3 before script execution
-    // So we don't need to emit anything here
-    (void)irCode;
+    // DATA is typed at compile time and emitted as constant tables: READ is an
+    // index increment plus a table load, with no call into the C++ DataManager.
+    // Values are converted with the DataManager rules, so a READ into a
+    // numeric variable sees data_num[i] and one into a string sees data_str[i]
+    bool readsNumbers = false;
+    bool readsStrings = false;
+    bool bulkReads = false;
+    bool usesData = false;
+    for (const auto& instr : irCode.instructions) {
+        if (instr.opcode != IROpcode::READ_DATA && instr.opcode != IROpcode::READ_DATA_VALUE &&
+            instr.opcode != IROpcode::READ_DATA_ARRAY && instr.opcode != IROpcode::RESTORE) {
+            continue;
+        }
+        usesData = true;
+        if (instr.opcode == IROpcode::RESTORE ||
+            !std::holds_alternative<std::string>(instr.operand1)) {
+            continue;
+        }
+        bool isString = std::get<std::string>(instr.operand1).find("_STRING") != std::string::npos;
+        (isString ? readsStrings : readsNumbers) = true;
+        if (instr.opcode == IROpcode::READ_DATA_ARRAY) {
+            bulkReads = true;
+        }
+    }
+    if (!usesData) return;
+
+    DataPreprocessor dataParser;
+    std::vector<std::string> numbers;
+    std::vector<std::string> strings;
+    numbers.reserve(irCode.dataValues.size());
+    strings.reserve(irCode.dataValues.size());
+    for (const auto& raw : irCode.dataValues) {
+        DataValue value = dataParser.parseValue(raw);
+        if (std::holds_alternative<int>(value)) {
+            int n = std::get<int>(value);
+            numbers.push_back(std::to_string(n));
+            strings.push_back(escapeString(std::to_string(n)));
+        } else if (std::holds_alternative<double>(value)) {
+            double d = std::get<double>(value);
+            numbers.push_back(numberLiteral(d));
+            strings.push_back(escapeString(std::to_string(d)));
+        } else {
+            const std::string& str = std::get<std::string>(value);
+            char* end = nullptr;
+            double d = std::strtod(str.c_str(), &end);
+            bool numeric = end != str.c_str() && *end == '\0';
+            numbers.push_back(numeric ? numberLiteral(d) : "0");
+            strings.push_back(escapeString(str));
+        }
+    }
+
+    auto emitTable = [this](const std::string& name, const std::vector<std::string>& values) {
+        emitLine("local " + name + " = {");
+        const size_t perLine = 16;
+        for (size_t i = 0; i < values.size(); i += perLine) {
+            std::string line = "   ";
+            for (size_t j = i; j < std::min(i + perLine, values.size()); ++j) {
+                line += " " + values[j] + ",";
+            }
+            emitLine(line);
+        }
+        emitLine("}");
+    };
+
+    emitLine("-- DATA segment, typed at compile time (" + std::to_string(numbers.size()) + " values)");
+    if (readsNumbers) emitTable("data_num", numbers);
+    if (readsStrings) emitTable("data_str", strings);
+    emitLine("local data_ptr = 0");
+    emitLine("local function data_out()");
+    emitLine("    error('OUT OF DATA', 0)");
+    emitLine("end");
+    if (readsNumbers) {
+        emitLine("local function basic_read_data()");
+        emitLine("    local p = data_ptr + 1");
+        emitLine("    data_ptr = p");
+        emitLine("    return data_num[p] or data_out()");
+        emitLine("end");
+    }
+    if (readsStrings) {
+        emitLine("local function basic_read_data_string()");
+        emitLine("    local p = data_ptr + 1");
+        emitLine("    data_ptr = p");
+        emitLine("    return data_str[p] or data_out()");
+        emitLine("end");
+    }
+    if (bulkReads) {
+        emitDataBulkRead(readsNumbers, readsStrings);
+    }
+    emitLine("");
+}
+
+// data_read_array(arr, lo, hi, values, offset) copies DATA into A(lo..hi),
+// one element per iteration FOR would make (so hi = 2.5 copies A(1), A(2)).
+// FFI double arrays take one ffi.copy from a cdata copy of data_num; other
+// arrays get a plain loop. Running out of DATA part way fills what it can
+// and raises OUT OF DATA, as the element-by-element loop would.
+void LuaCodeGenerator::emitDataBulkRead(bool readsNumbers, bool readsStrings) {
+    (void)readsStrings;
+    if (readsNumbers) {
+        emitLine("local data_num_cdata");
+    }
+    emitLine("local function data_read_array(arr, lo, hi, values, offset)");
+    emitLine("    local n = math.floor(hi - lo) + 1");
+    emitLine("    if n <= 0 then return end");
+    emitLine("    local p = data_ptr");
+    emitLine("    local count = math.min(n, #values - p)");
+    emitLine("    local data = arr.data");
+    if (readsNumbers) {
+        emitLine("    if data and arr.type == 'double' and values == data_num and");
+        emitLine("       lo >= 0 and lo + count <= arr.size then");
+        emitLine("        if not data_num_cdata then");
+        emitLine("            data_num_cdata = ffi.new('double[?]', #data_num, data_num)");
+        emitLine("        end");
+        emitLine("        ffi.copy(data + lo, data_num_cdata + p, count * 8)");
+        emitLine("    elseif data then");
+    } else {
+        emitLine("    if data then");
+    }
+    emitLine("        for i = 0, count - 1 do");
+    emitLine("            data[lo + i] = values[p + 1 + i]");
+    emitLine("        end");
+    emitLine("    else");
+    emitLine("        for i = 0, count - 1 do");
+    emitLine("            arr[lo + i + offset] = values[p + 1 + i]");
+    emitLine("        end");
+    emitLine("    end");
+    emitLine("    data_ptr = p + count");
+    emitLine("    if count < n then data_out() end");
+    emitLine("end");
 }
 
 void LuaCodeGenerator::emitTypeDefinitions(const IRCode& irCode) {
@@ -1144,6 +2146,7 @@ void LuaCodeGenerator::emitTypeDefinitions(const IRCode& irCode) {
     // This ensures type constructors are available when functions are defined
     emitLine("-- User-defined type constructors");
     emitLine("");
+    m_ffiRecordTypes.clear();
     
     for (const auto& instr : irCode.instructions) {
         if (instr.opcode == IROpcode::DEFINE_TYPE) {
@@ -1158,6 +2161,7 @@ void LuaCodeGenerator::emitUserFunctions(const IRCode& irCode) {
 
     bool inFunctionDef = false;
     size_t funcStartIndex = 0;
+    RegisterScope outerScope;
     std::vector<std::string> definedHandlers;  // Track handler names for registration
 
     for (size_t i = 0; i < irCode.instructions.size(); i++) {
@@ -1167,6 +2171,7 @@ void LuaCodeGenerator::emitUserFunctions(const IRCode& irCode) {
             inFunctionDef = true;
             funcStartIndex = i;
             emitFunctionDefinition(instr);
+            outerScope = openRegisterScope("    ");
 
             // Track the function/sub name for timer handler registration
             if (std::holds_alternative<std::string>(instr.operand1)) {
@@ -1182,6 +2187,7 @@ void LuaCodeGenerator::emitUserFunctions(const IRCode& irCode) {
             }
         } else if (inFunctionDef && (instr.opcode == IROpcode::END_FUNCTION ||
                                       instr.opcode == IROpcode::END_SUB)) {
+            closeRegisterScope(outerScope);
             emitFunctionDefinition(instr);
             inFunctionDef = false;
         } else if (inFunctionDef) {
@@ -1206,6 +2212,7 @@ void LuaCodeGenerator::emitUserFunctions(const IRCode& irCode) {
 void LuaCodeGenerator::emitMainFunction(const IRCode& irCode) {
     emitLine("-- Main program");
     emitLine("local function main()");
+    RegisterScope outerScope = openRegisterScope("    ");
 
     // First pass: collect all GOSUB target labels (subroutines to convert to functions)
     std::set<std::string> gosubTargets;
@@ -1287,6 +2294,7 @@ void LuaCodeGenerator::emitMainFunction(const IRCode& irCode) {
     // Fourth pass: emit subroutines as table entries
     for (const auto& targetLabel : gosubTargets) {
         emitLine("    _gosub." + getLabelName(targetLabel) + " = function()");
+        RegisterScope mainScope = openRegisterScope("        ");
 
         // Find the label in the IR and emit code until RETURN
         bool inSubroutine = false;
@@ -1322,6 +2330,7 @@ void LuaCodeGenerator::emitMainFunction(const IRCode& irCode) {
             }
         }
 
+        closeRegisterScope(mainScope);
         emitLine("    end");
         emitLine("");
     }
@@ -1403,14 +2412,11 @@ void LuaCodeGenerator::emitMainFunction(const IRCode& irCode) {
     emitLine("    -- Shutdown timer system");
     emitLine("    debug.sethook(nil)");
     emitLine("    basic_timer_shutdown()");
+    closeRegisterScope(outerScope);
 
     emitLine("end");
     emitLine("");
 
-    // DATA/READ/RESTORE support
-    // Note: basic_read_data(), basic_read_data_string(), and basic_restore()
-    // are provided by C++ bindings in FBTBindings.cpp
-    // The DataManager is initialized with DATA values before script execution
 }
 
 // =============================================================================
@@ -1518,6 +2524,8 @@ void LuaCodeGenerator::collectFunctionDefinitions(const IRCode& irCode) {
 // =============================================================================
 
 void LuaCodeGenerator::emitInstruction(const IRInstruction& instr, size_t index) {
+    checkStackDepth(instr, index);
+
     // Emit line number tracking if enabled and line changed
     if (m_errorTracking && instr.sourceLineNumber > 0 && instr.sourceLineNumber != m_lastEmittedLine) {
         emitLine("    -- LINE " + std::to_string(instr.sourceLineNumber));
@@ -1602,6 +2610,10 @@ void LuaCodeGenerator::emitInstruction(const IRInstruction& instr, size_t index)
         case IROpcode::REDIM_ARRAY:
         case IROpcode::ERASE_ARRAY:
         case IROpcode::FILL_ARRAY:
+        case IROpcode::FILL_ARRAY_RND:
+        case IROpcode::ARRAY_APPEND:
+        case IROpcode::ARRAY_POP:
+        case IROpcode::ARRAY_LEN:
         case IROpcode::ARRAY_ADD:
         case IROpcode::ARRAY_SUB:
         case IROpcode::ARRAY_MUL:
@@ -1622,6 +2634,16 @@ void LuaCodeGenerator::emitInstruction(const IRInstruction& instr, size_t index)
             emitArrayBounds(instr);
             break;
 
+        case IROpcode::DICT_NEW:
+        case IROpcode::DICT_GET:
+        case IROpcode::DICT_SET:
+        case IROpcode::DICT_HAS:
+        case IROpcode::DICT_REMOVE:
+        case IROpcode::DICT_KEYS:
+        case IROpcode::DICT_COUNT:
+            emitDict(instr);
+            break;
+
         // SIMD array operations
         case IROpcode::SIMD_PAIR_ARRAY_ADD:
         case IROpcode::SIMD_PAIR_ARRAY_SUB:
@@ -1683,6 +2705,8 @@ void LuaCodeGenerator::emitInstruction(const IRInstruction& instr, size_t index)
         case IROpcode::INPUT:
         case IROpcode::INPUT_PROMPT:
         case IROpcode::READ_DATA:
+        case IROpcode::READ_DATA_VALUE:
+        case IROpcode::READ_DATA_ARRAY:
         case IROpcode::RESTORE:
         case IROpcode::OPEN_FILE:
         case IROpcode::CLOSE_FILE:
@@ -1798,7 +2822,7 @@ void LuaCodeGenerator::emitStackOp(const IRInstruction& instr) {
 
             case IROpcode::PUSH_DOUBLE:
                 if (std::holds_alternative<double>(instr.operand1)) {
-                    m_exprOptimizer.pushLiteral(std::to_string(std::get<double>(instr.operand1)));
+                    m_exprOptimizer.pushLiteral(numberLiteral(std::get<double>(instr.operand1)));
                 } else {
                     m_exprOptimizer.pushLiteral("0.0");
                 }
@@ -1806,7 +2830,8 @@ void LuaCodeGenerator::emitStackOp(const IRInstruction& instr) {
 
             case IROpcode::PUSH_STRING:
                 if (std::holds_alternative<std::string>(instr.operand1)) {
-                    m_exprOptimizer.pushLiteral(escapeString(std::get<std::string>(instr.operand1)));
+                    const std::string& value = std::get<std::string>(instr.operand1);
+                    m_exprOptimizer.pushStringLiteral(escapeString(value), value);
                 } else {
                     m_exprOptimizer.pushLiteral("''");
                 }
@@ -1829,7 +2854,7 @@ void LuaCodeGenerator::emitStackOp(const IRInstruction& instr) {
 
         case IROpcode::PUSH_DOUBLE:
             if (std::holds_alternative<double>(instr.operand1)) {
-                emitLine("    push(" + std::to_string(std::get<double>(instr.operand1)) + ")");
+                emitLine("    push(" + numberLiteral(std::get<double>(instr.operand1)) + ")");
             } else {
                 emitLine("    push(0.0)");
             }
@@ -2022,22 +3047,22 @@ void LuaCodeGenerator::emitLogical(const IRInstruction& instr) {
     // Use bitwise operations by default for BASIC compatibility
     switch (instr.opcode) {
         case IROpcode::AND:
-            emitLine("    b = pop(); a = pop(); push(bitwise.band(a, b))");
+            emitLine("    b = pop(); a = pop(); push(band(bit_int(a), bit_int(b)))");
             break;
         case IROpcode::OR:
-            emitLine("    b = pop(); a = pop(); push(bitwise.bor(a, b))");
+            emitLine("    b = pop(); a = pop(); push(bor(bit_int(a), bit_int(b)))");
             break;
         case IROpcode::XOR:
-            emitLine("    b = pop(); a = pop(); push(bitwise.bxor(a, b))");
+            emitLine("    b = pop(); a = pop(); push(bxor(bit_int(a), bit_int(b)))");
             break;
         case IROpcode::EQV:
-            emitLine("    b = pop(); a = pop(); push(bitwise.beqv(a, b))");
+            emitLine("    b = pop(); a = pop(); push(bnot(bxor(bit_int(a), bit_int(b))))");
             break;
         case IROpcode::IMP:
-            emitLine("    b = pop(); a = pop(); push(bitwise.bimp(a, b))");
+            emitLine("    b = pop(); a = pop(); push(bor(bnot(bit_int(a)), bit_int(b)))");
             break;
         case IROpcode::NOT:
-            emitLine("    push(bitwise.bnot(pop()))");
+            emitLine("    push(bnot(bit_int(pop())))");
             break;
         default:
             break;
@@ -2062,6 +3087,11 @@ void LuaCodeGenerator::emitVariable(const IRInstruction& instr) {
             std::string varRef = m_config.useVariableCache ?
                                  getVariableReference(varName) : luaVarName;
 
+            // Buffered MID$ targets are read as a whole string
+            if (m_bufferVariables.count(varName)) {
+                varRef = "buffer_value(" + varRef + ")";
+            }
+
             if (canUseExpressionMode()) {
                 m_exprOptimizer.pushVariable(varRef);
             } else {
@@ -2077,6 +3107,10 @@ void LuaCodeGenerator::emitVariable(const IRInstruction& instr) {
             std::string varRef = m_config.useVariableCache ?
                 getVariableReference(varName) : getVarName(varName);
 
+            // Buffered targets are patched in place (see analyzeBufferVariables)
+            std::string assignFunc = m_bufferVariables.count(varName) ?
+                "basic_mid_assign_buffer" : "basic_mid_assign";
+
             if (canUseExpressionMode() && m_exprOptimizer.size() >= 3) {
                 // Pop replacement, len, pos from expression optimizer
                 auto replacement = m_exprOptimizer.pop();
@@ -2088,16 +3122,18 @@ void LuaCodeGenerator::emitVariable(const IRInstruction& instr) {
                     std::string lenStr = m_exprOptimizer.toString(len);
                     std::string posStr = m_exprOptimizer.toString(pos);
 
-                    emitLine("    " + varRef + " = basic_mid_assign(" + varRef + ", " +
+                    emitLine("    " + varRef + " = " + assignFunc + "(" + varRef + ", " +
                              posStr + ", " + lenStr + ", " + replacementStr + ")");
-                } else {
-                    flushExpressionToStack();
-                    emitLine("    " + varRef + " = basic_mid_assign(" + varRef + ", pop(), pop(), pop())");
+                    break;
                 }
-            } else {
-                flushExpressionToStack();
-                emitLine("    " + varRef + " = basic_mid_assign(" + varRef + ", pop(), pop(), pop())");
             }
+
+            // Stack holds pos, len, replacement (top)
+            flushExpressionToStack();
+            emitLine("    do");
+            emitLine("        local replacement, len, pos = pop(), pop(), pop()");
+            emitLine("        " + varRef + " = " + assignFunc + "(" + varRef + ", pos, len, replacement)");
+            emitLine("    end");
             break;
         }
 
@@ -2188,6 +3224,12 @@ void LuaCodeGenerator::emitArray(const IRInstruction& instr) {
             // These are handled as statements, not expressions
             // They modify arrays but don't produce values
             flushExpressionToStack();
+            if (instr.opcode == IROpcode::REDIM_ARRAY && std::holds_alternative<int>(instr.operand2)) {
+                // Consume the new bounds so they do not stay on the stack
+                for (int d = 0; d < std::get<int>(instr.operand2); d++) {
+                    emitLine("    pop()");
+                }
+            }
             break;
 
         case IROpcode::DIM_ARRAY: {
@@ -2208,11 +3250,21 @@ void LuaCodeGenerator::emitArray(const IRInstruction& instr) {
                 if (!instr.userDefinedType.empty()) {
                     // Array of user-defined types - initialize each element with constructor
                     std::string constructorName = instr.userDefinedType + "_new";
-                    emitLine("    " + luaArrayName + " = {}");
+                    std::string indent = "    ";
+                    if (m_ffiRecordTypes.count(instr.userDefinedType)) {
+                        // Struct TYPE: one contiguous FFI array when available
+                        emitLine("    " + luaArrayName + " = " + instr.userDefinedType + "_array(dim + 1)");
+                        emitLine("    if not " + luaArrayName + " then");
+                        indent = "        ";
+                    }
+                    emitLine(indent + luaArrayName + " = {}");
                     if (m_arrayBase == 0) {
-                        emitLine("    for i = 0, dim do " + luaArrayName + "[i + 1] = " + constructorName + "() end");
+                        emitLine(indent + "for i = 0, dim do " + luaArrayName + "[i + 1] = " + constructorName + "() end");
                     } else {
-                        emitLine("    for i = 1, dim + 1 do " + luaArrayName + "[i] = " + constructorName + "() end");
+                        emitLine(indent + "for i = 1, dim + 1 do " + luaArrayName + "[i] = " + constructorName + "() end");
+                    }
+                    if (m_ffiRecordTypes.count(instr.userDefinedType)) {
+                        emitLine("    end");
                     }
                 } else {
                     // Standard array allocation
@@ -2338,42 +3390,20 @@ void LuaCodeGenerator::emitArray(const IRInstruction& instr) {
                     } else {
                         // Fallback to stack operations
                         emitLine("    idx = pop()");
+                        std::string element = luaArrayName + (m_arrayBase == 0 ? "[idx + 1]" : "[idx]");
                         if (mayUseFFI) {
-                            emitLine("    if " + luaArrayName + ".data then");
-                            emitLine("        push(" + luaArrayName + ".data[idx] or 0)");
-                            emitLine("    else");
-                            if (m_arrayBase == 0) {
-                                emitLine("        push(" + luaArrayName + "[idx + 1] or 0)");
-                            } else {
-                                emitLine("        push(" + luaArrayName + "[idx] or 0)");
-                            }
-                            emitLine("    end");
+                            emitLine("    push(" + luaArrayName + ".data and " + luaArrayName + ".data[idx] or " + element + " or 0)");
                         } else {
-                            if (m_arrayBase == 0) {
-                                emitLine("    push(" + luaArrayName + "[idx + 1] or 0)");
-                            } else {
-                                emitLine("    push(" + luaArrayName + "[idx] or 0)");
-                            }
+                            emitLine("    push(" + element + " or 0)");
                         }
                     }
                 } else {
                     emitLine("    idx = pop()");
+                    std::string element = luaArrayName + (m_arrayBase == 0 ? "[idx + 1]" : "[idx]");
                     if (mayUseFFI) {
-                        emitLine("    if " + luaArrayName + ".data then");
-                        emitLine("        push(" + luaArrayName + ".data[idx] or 0)");
-                        emitLine("    else");
-                        if (m_arrayBase == 0) {
-                            emitLine("        push(" + luaArrayName + "[idx + 1] or 0)");
-                        } else {
-                            emitLine("        push(" + luaArrayName + "[idx] or 0)");
-                        }
-                        emitLine("    end");
+                        emitLine("    push(" + luaArrayName + ".data and " + luaArrayName + ".data[idx] or " + element + " or 0)");
                     } else {
-                        if (m_arrayBase == 0) {
-                            emitLine("    push(" + luaArrayName + "[idx + 1] or 0)");
-                        } else {
-                            emitLine("    push(" + luaArrayName + "[idx] or 0)");
-                        }
+                        emitLine("    push(" + element + " or 0)");
                     }
                 }
             } else {
@@ -2603,6 +3633,42 @@ void LuaCodeGenerator::emitArray(const IRInstruction& instr) {
             break;
         }
 
+        case IROpcode::FILL_ARRAY_RND: {
+            // A() = RND: one tight loop over .data for FFI arrays
+            flushExpressionToStack();
+            emitLine("    basic_rnd_fill(" + luaArrayName + ")");
+            break;
+        }
+
+        case IROpcode::ARRAY_APPEND: {
+            // APPEND A, value: amortized O(1), see array_append
+            if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
+                auto valueExpr = m_exprOptimizer.pop();
+                if (valueExpr) {
+                    emitLine("    array_append(" + luaArrayName + ", " + m_exprOptimizer.toString(valueExpr) + ")");
+                    break;
+                }
+            }
+            emitLine("    array_append(" + luaArrayName + ", pop())");
+            break;
+        }
+
+        case IROpcode::ARRAY_POP:
+        case IROpcode::ARRAY_LEN: {
+            std::string call = (instr.opcode == IROpcode::ARRAY_POP ? "array_pop(" : "array_len(") +
+                               luaArrayName + ")";
+            if (std::holds_alternative<int>(instr.operand2) && std::get<int>(instr.operand2) == 1) {
+                // POP A as a statement
+                flushExpressionToStack();
+                emitLine("    " + call);
+            } else if (canUseExpressionMode()) {
+                m_exprOptimizer.pushVariable(call);
+            } else {
+                emitLine("    push(" + call + ")");
+            }
+            break;
+        }
+
         case IROpcode::ARRAY_ADD:
         case IROpcode::ARRAY_SUB:
         case IROpcode::ARRAY_MUL:
@@ -2621,6 +3687,11 @@ void LuaCodeGenerator::emitArray(const IRInstruction& instr) {
             else if (instr.opcode == IROpcode::ARRAY_MUL) op = "*";
             else if (instr.opcode == IROpcode::ARRAY_DIV) op = "/";
             
+            if (!instr.userDefinedType.empty()) {
+                emitRecordArrayArithmetic(instr, op);
+                break;
+            }
+            
             // Check if arrays use FFI
             bool resultFFI = m_arrayInfo.count(arrayName) && m_arrayInfo[arrayName].usesFFI;
             bool aFFI = m_arrayInfo.count(std::get<std::string>(instr.operand2)) && 
@@ -2660,8 +3731,6 @@ void LuaCodeGenerator::emitArray(const IRInstruction& instr) {
             // Element-wise array-scalar operations: result() = a() op scalar
             flushExpressionToStack();
             
-            emitLine("    scalar = pop()");
-            
             std::string resultArray = luaArrayName;
             std::string arrayA = getArrayName(std::get<std::string>(instr.operand2));
             
@@ -2672,6 +3741,13 @@ void LuaCodeGenerator::emitArray(const IRInstruction& instr) {
             else if (instr.opcode == IROpcode::ARRAY_MUL_SCALAR) op = "*";
             else if (instr.opcode == IROpcode::ARRAY_DIV_SCALAR) op = "/";
             
+            if (!instr.userDefinedType.empty()) {
+                emitRecordArrayArithmetic(instr, op);
+                break;
+            }
+            
+            emitLine("    scalar = pop()");
+            
             // Check if arrays use FFI
             bool resultFFI = m_arrayInfo.count(arrayName) && m_arrayInfo[arrayName].usesFFI;
             bool aFFI = m_arrayInfo.count(std::get<std::string>(instr.operand2)) && 
@@ -3557,12 +4633,24 @@ void LuaCodeGenerator::emitIO(const IRInstruction& instr) {
                     formatStr = "pop()";
                 }
 
-                // Emit call to basic_print_using
-                std::string args = formatStr;
+                // A literal format gets a formatter specialized at compile time
+                std::string formatter;
+                if (formatExpr && formatExpr->type == ExprType::LITERAL && formatExpr->isString &&
+                    !m_unicodeMode) {
+                    formatter = usingFormatter(formatExpr->stringValue, argCount);
+                }
+
+                std::string args;
                 for (const auto& val : values) {
-                    args += ", " + val;
+                    args += (args.empty() ? "" : ", ") + val;
+                }
+                if (!formatter.empty()) {
+                    emitLine("    basic_print(" + formatter + "(" + args + "))");
+                } else {
+                    // Emit call to basic_print_using (runtime cache keyed by format)
+                    args = formatStr + (args.empty() ? "" : ", " + args);
+                    emitLine("    basic_print(basic_print_using(" + args + "))");
                 }
-                emitLine("    basic_print(basic_print_using(" + args + "))");
                 emitLine("    basic_print_newline()");
             } else {
                 // Fallback to stack-based
@@ -3727,23 +4815,84 @@ void LuaCodeGenerator::emitIO(const IRInstruction& instr) {
             }
             break;
 
-        case IROpcode::RESTORE:
+        case IROpcode::READ_DATA_VALUE:
+            // READ A(I): the value is pushed for the STORE_ARRAY that follows
+            if (std::holds_alternative<std::string>(instr.operand1)) {
+                bool isString = std::get<std::string>(instr.operand1).find("_STRING") != std::string::npos;
+                std::string read = isString ? "basic_read_data_string()" : "basic_read_data()";
+                if (canUseExpressionMode()) {
+                    m_exprOptimizer.pushVariable(read);
+                } else {
+                    emitLine("    push(" + read + ")");
+                }
+            }
+            break;
+
+        case IROpcode::READ_DATA_ARRAY: {
+            // FOR v = lo TO hi: READ A(v): NEXT (fused by the IR generator).
+            // Like a native FOR loop, the copy leaves v itself unchanged
+            std::string arrayName = std::get<std::string>(instr.operand1);
+            std::string lo, hi;
+            if (canUseExpressionMode() && m_exprOptimizer.size() >= 2) {
+                auto hiExpr = m_exprOptimizer.pop();
+                auto loExpr = m_exprOptimizer.pop();
+                lo = m_exprOptimizer.toString(loExpr);
+                hi = m_exprOptimizer.toString(hiExpr);
+            } else {
+                flushExpressionToStack();
+                emitLine("    idx = pop()");
+                emitLine("    val = pop()");
+                lo = "val";
+                hi = "idx";
+            }
+            bool isString = arrayName.find("_STRING") != std::string::npos;
+            emitLine("    data_read_array(" + getArrayName(arrayName) + ", " + lo + ", " + hi + ", " +
+                     (isString ? "data_str" : "data_num") + ", " + (m_arrayBase == 0 ? "1" : "0") + ")");
+
+            // Hot variables start at 0; one in vars[] would still be nil
+            if (m_config.useVariableCache && std::holds_alternative<std::string>(instr.operand2)) {
+                std::string loopVar = std::get<std::string>(instr.operand2);
+                if (!isHotVariable(loopVar)) {
+                    std::string varRef = getVariableReference(loopVar);
+                    emitLine("    " + varRef + " = " + varRef + " or 0");
+                }
+            }
+            break;
+        }
+
+        case IROpcode::RESTORE: {
             // Flush expression optimizer before RESTORE (side-effecting)
             flushExpressionToStack();
 
+            // Restore points are known at compile time: RESTORE sets the index
+            // of the last value read (0 = before the first DATA value)
+            std::string target;
+            bool found = true;
+            size_t index = 0;
             if (std::holds_alternative<int>(instr.operand1)) {
                 // RESTORE to line number
                 int lineNumber = std::get<int>(instr.operand1);
-                emitLine("    basic_restore(" + std::to_string(lineNumber) + ")");
+                target = std::to_string(lineNumber);
+                auto it = m_code->dataLineRestorePoints.find(lineNumber);
+                found = it != m_code->dataLineRestorePoints.end();
+                if (found) index = it->second;
             } else if (std::holds_alternative<std::string>(instr.operand1)) {
                 // RESTORE to label name
-                std::string labelName = std::get<std::string>(instr.operand1);
-                emitLine("    basic_restore(" + escapeString(labelName) + ")");
-            } else {
-                // RESTORE with no argument - restore to beginning
-                emitLine("    basic_restore()");
+                target = std::get<std::string>(instr.operand1);
+                auto it = m_code->dataLabelRestorePoints.find(target);
+                found = it != m_code->dataLabelRestorePoints.end();
+                if (found) index = it->second;
+            }
+
+            if (!found) {
+                // Same fallback as the DataManager: warn, restore to the beginning
+                emitLine("    io.stderr:write(" +
+                         escapeString("Warning: RESTORE " + target + " - no DATA there, restoring to beginning\n") +
+                         ")");
             }
+            emitLine("    data_ptr = " + std::to_string(index));
             break;
+        }
 
         case IROpcode::OPEN_FILE:
             // OPEN file (operands: filename, mode, filenum)
@@ -3829,16 +4978,194 @@ void LuaCodeGenerator::emitIO(const IRInstruction& instr) {
                     emitLine("    basic_write_file(" + filenum + ", " + code + ", " + (isLast ? "true" : "false") + ")");
                 }
             } else {
-                flushExpressionToStack();
-                std::string filenum = std::get<std::string>(instr.operand1);
-                bool isLast = std::get<int>(instr.operand2) != 0;
-                emitLine("    basic_write_file(" + filenum + ", pop(), " + (isLast ? "true" : "false") + ")");
+                flushExpressionToStack();
+                std::string filenum = std::get<std::string>(instr.operand1);
+                bool isLast = std::get<int>(instr.operand2) != 0;
+                emitLine("    basic_write_file(" + filenum + ", pop(), " + (isLast ? "true" : "false") + ")");
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool LuaCodeGenerator::hasUnicodeLowering(const std::string& funcName) {
+    static const std::unordered_set<std::string> unicodeFunctions = {
+        "LEFT$", "RIGHT$", "MID$", "CHR$", "INSTR", "STRING$", "SPACE$",
+        "LCASE$", "UCASE$", "LTRIM$", "RTRIM$", "TRIM$", "REVERSE$"
+    };
+    return unicodeFunctions.count(funcName) > 0;
+}
+
+// MID$(s, i, 1), LEFT$(s, 1) and RIGHT$(s, 1) become CHAR_AT expressions.
+// Used as strings they emit the same substring call as before; ASC() and
+// comparisons with one-character literals read the character code instead.
+bool LuaCodeGenerator::emitSingleCharExtract(const std::string& funcName, int argCount) {
+    bool isMid = (funcName == "MID$" && argCount == 3);
+    bool isLeft = (funcName == "LEFT$" && argCount == 2);
+    bool isRight = (funcName == "RIGHT$" && argCount == 2);
+    if (!(isMid || isLeft || isRight)) return false;
+    if (!canUseExpressionMode() || m_exprOptimizer.size() < static_cast<size_t>(argCount)) return false;
+    if (!m_exprOptimizer.isNumericLiteral(m_exprOptimizer.peek(), 1.0)) return false;
+
+    // Substring code exactly as the regular lowering would emit it
+    std::string luaFunc;
+    if (m_unicodeMode) {
+        luaFunc = isMid ? "unicode.unicode_mid" : isLeft ? "unicode.unicode_left" : "unicode.unicode_right";
+    } else {
+        const auto* def = commandTable().getFunction(funcName);
+        if (!def || def->hasCustomCodeGen) return false;
+        luaFunc = def->luaFunction;
+    }
+
+    auto countExpr = m_exprOptimizer.pop();
+    auto indexExpr = isMid ? m_exprOptimizer.pop() : nullptr;
+    auto sourceExpr = m_exprOptimizer.pop();
+
+    // The last codepoint is found via LEN, so the source is evaluated twice
+    if (isRight && m_unicodeMode && !m_exprOptimizer.isSimple(sourceExpr)) {
+        m_exprOptimizer.pushVariable(luaFunc + "(" + m_exprOptimizer.toString(sourceExpr) + ", " +
+                                     m_exprOptimizer.toString(countExpr) + ")");
+        return true;
+    }
+
+    std::string code = luaFunc + "(" + m_exprOptimizer.toString(sourceExpr) + ", ";
+    if (indexExpr) {
+        code += m_exprOptimizer.toString(indexExpr) + ", ";
+    }
+    code += m_exprOptimizer.toString(countExpr) + ")";
+
+    if (isLeft) {
+        indexExpr = Expr::makeLiteral("1");
+    }
+    m_exprOptimizer.applyCharAt(sourceExpr, indexExpr, code);
+    return true;
+}
+
+// RND and RND(n). A positive literal n (the usual RND(1)) is just the next
+// value; any other argument is passed on for basic_rnd's n <= 0 handling.
+void LuaCodeGenerator::emitRandomCall(int argCount) {
+    if (argCount == 0) {
+        if (canUseExpressionMode()) {
+            m_exprOptimizer.pushVariable("basic_rnd()");
+        } else {
+            emitLine("    push(basic_rnd())");
+        }
+        return;
+    }
+
+    if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
+        auto argExpr = m_exprOptimizer.pop();
+        double n = 0;
+        if (m_exprOptimizer.numericLiteralValue(argExpr, n) && n > 0) {
+            m_exprOptimizer.pushVariable("basic_rnd()");
+        } else {
+            m_exprOptimizer.pushVariable("basic_rnd(" + m_exprOptimizer.toString(argExpr) + ")");
+        }
+        return;
+    }
+    emitLine("    push(basic_rnd(pop()))");
+}
+
+// PRINT USING with a literal format: parse the format here, mirroring
+// using_compile in the prelude, into one string.format call over the argCount
+// values (fields past the last value print nothing, as at runtime). Returns
+// the formatter ("using_fmt[n]"), or "" when a field is too wide for a
+// string.format specifier and the runtime cache has to handle it.
+std::string LuaCodeGenerator::usingFormatter(const std::string& format, int argCount) {
+    auto key = std::make_pair(format, argCount);
+    auto found = m_usingFormatIds.find(key);
+    if (found != m_usingFormatIds.end()) {
+        return "using_fmt[" + std::to_string(found->second) + "]";
+    }
+
+    std::string spec;                   // string.format specifier for the whole line
+    std::vector<std::string> values;    // Converted values, one per field
+    size_t i = 0;
+    while (i < format.size()) {
+        char ch = format[i];
+        std::string field;
+        std::string value;
+        std::string v = "v" + std::to_string(values.size() + 1);
+        if (ch == '&') {
+            field = "%s";
+            value = "tostring(" + v + ")";
+            i++;
+        } else if (ch == '!') {
+            field = "%.1s";
+            value = "tostring(" + v + ")";
+            i++;
+        } else if (ch == '\\' && format.find('\\', i + 1) != std::string::npos) {
+            size_t endSlash = format.find('\\', i + 1);
+            size_t width = endSlash - i + 1;
+            if (width > 99) return "";
+            field = "%-" + std::to_string(width) + "." + std::to_string(width) + "s";
+            value = "tostring(" + v + ")";
+            i = endSlash + 1;
+        } else if (ch == '#') {
+            int beforeDecimal = 0;
+            int afterDecimal = 0;
+            bool hasDecimal = false;
+            bool hasComma = false;
+            for (; i < format.size() && (format[i] == '#' || format[i] == '.' || format[i] == ','); i++) {
+                if (format[i] == '.') {
+                    hasDecimal = true;
+                } else if (format[i] == ',') {
+                    hasComma = true;
+                } else if (hasDecimal) {
+                    afterDecimal++;
+                } else {
+                    beforeDecimal++;
+                }
+            }
+            int width = beforeDecimal + (hasDecimal ? 1 + afterDecimal : 0);
+            if (width > 99) return "";
+            if (hasDecimal) {
+                field = "%" + std::to_string(width) + "." + std::to_string(afterDecimal) + "f";
+                value = "tonumber(" + v + ") or 0";
+            } else if (hasComma) {
+                field = "%s";
+                value = "using_commas(" + v + ", " + std::to_string(width) + ")";
+            } else {
+                field = "%" + std::to_string(width) + "d";
+                value = "math.floor(tonumber(" + v + ") or 0)";
             }
-            break;
+        } else {
+            spec += (ch == '%') ? "%%" : std::string(1, ch);
+            i++;
+            continue;
+        }
+        if (static_cast<int>(values.size()) < argCount) {
+            spec += field;
+            values.push_back(value);
+        }
+    }
 
-        default:
-            break;
+    std::string params;
+    for (int n = 1; n <= argCount; n++) {
+        params += (n > 1 ? ", v" : "v") + std::to_string(n);
+    }
+    std::string body;
+    if (values.empty()) {
+        // No fields consume a value: the line is constant (%% back to %)
+        std::string text;
+        for (size_t n = 0; n < spec.size(); n++) {
+            text += spec[n];
+            if (spec[n] == '%') n++;
+        }
+        body = escapeString(text);
+    } else {
+        body = "using_format(" + escapeString(spec);
+        for (const auto& value : values) {
+            body += ", " + value;
+        }
+        body += ")";
     }
+    m_usingFormatters.push_back("function(" + params + ") return " + body + " end");
+    int id = static_cast<int>(m_usingFormatters.size());
+    m_usingFormatIds.emplace(key, id);
+    return "using_fmt[" + std::to_string(id) + "]";
 }
 
 void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
@@ -3872,7 +5199,8 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
                 emitLine("        local __iif_false = pop()");
                 emitLine("        local __iif_true = pop()");
                 emitLine("        local __iif_cond = pop()");
-                emitLine("        if basicBoolToLua(__iif_cond) then push(__iif_true) else push(__iif_false) end");
+                emitLine("        if not basicBoolToLua(__iif_cond) then __iif_true = __iif_false end");
+                emitLine("        push(__iif_true)");
                 emitLine("    end");
             }
         } else {
@@ -3881,7 +5209,8 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
             emitLine("        local __iif_false = pop()");
             emitLine("        local __iif_true = pop()");
             emitLine("        local __iif_cond = pop()");
-            emitLine("        if basicBoolToLua(__iif_cond) then push(__iif_true) else push(__iif_false) end");
+            emitLine("        if not basicBoolToLua(__iif_cond) then __iif_true = __iif_false end");
+            emitLine("        push(__iif_true)");
             emitLine("    end");
         }
         return;
@@ -4072,6 +5401,27 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
         }
         return;
     }
+    else if (funcName == "SHL" || funcName == "SHR") {
+        // A constant count in 0..31 maps straight onto the bit intrinsic
+        std::string helper = (funcName == "SHL") ? "bit_shl" : "bit_shr";
+        if (canUseExpressionMode() && m_exprOptimizer.size() >= 2) {
+            auto countExpr = m_exprOptimizer.pop();
+            auto valueExpr = m_exprOptimizer.pop();
+            double count = -1;
+            if (m_exprOptimizer.numericLiteralValue(countExpr, count) &&
+                count == std::floor(count) && count >= 0 && count <= 31) {
+                std::string intrinsic = (funcName == "SHL") ? "lshift" : "arshift";
+                m_exprOptimizer.pushVariable(intrinsic + "(" + m_exprOptimizer.bitOperand(valueExpr) + ", " +
+                                             std::to_string(static_cast<int>(count)) + ")");
+            } else {
+                m_exprOptimizer.pushVariable(helper + "(" + m_exprOptimizer.toString(valueExpr) + ", " +
+                                             m_exprOptimizer.toString(countExpr) + ")");
+            }
+        } else {
+            emitLine("    b = pop(); a = pop(); push(" + helper + "(a, b))");
+        }
+        return;
+    }
     else if (funcName == "INT") {
         if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
             auto argExpr = m_exprOptimizer.pop();
@@ -4143,11 +5493,7 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
     
     // OPTIMIZATION 2: Handle RND, TIMER and key string functions BEFORE modular registry
     else if (funcName == "RND") {
-        if (canUseExpressionMode()) {
-            m_exprOptimizer.pushVariable("basic_rnd()");
-        } else {
-            emitLine("    push(basic_rnd())");
-        }
+        emitRandomCall(argCount);
         return;
     }
     else if (funcName == "GETTICKS") {
@@ -4162,12 +5508,12 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
         if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
             auto argExpr = m_exprOptimizer.pop();
             if (argExpr) {
-                m_exprOptimizer.pushVariable("tostring(" + m_exprOptimizer.toString(argExpr) + ")");
+                m_exprOptimizer.pushVariable("basic_str(" + m_exprOptimizer.toString(argExpr) + ")");
             } else {
-                emitLine("    push(tostring(pop()))");
+                emitLine("    push(basic_str(pop()))");
             }
         } else {
-            emitLine("    push(tostring(pop()))");
+            emitLine("    push(basic_str(pop()))");
         }
         return;
     }
@@ -4176,12 +5522,12 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
         if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
             auto argExpr = m_exprOptimizer.pop();
             if (argExpr) {
-                m_exprOptimizer.pushVariable("tonumber(" + m_exprOptimizer.toString(argExpr) + ") or 0");
+                m_exprOptimizer.pushVariable("basic_val(" + m_exprOptimizer.toString(argExpr) + ")");
             } else {
-                emitLine("    push(tonumber(pop()) or 0)");
+                emitLine("    push(basic_val(pop()))");
             }
         } else {
-            emitLine("    push(tonumber(pop()) or 0)");
+            emitLine("    push(basic_val(pop()))");
         }
         return;
     }
@@ -4190,7 +5536,9 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
         if (m_unicodeMode) {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
                 auto argExpr = m_exprOptimizer.pop();
-                if (argExpr) {
+                if (argExpr && argExpr->type == ExprType::CHAR_AT) {
+                    m_exprOptimizer.pushVariable(m_exprOptimizer.charCodeString(argExpr));
+                } else if (argExpr) {
                     m_exprOptimizer.pushVariable("unicode.unicode_asc(" + m_exprOptimizer.toString(argExpr) + ")");
                 } else {
                     emitLine("    push(unicode.unicode_asc(pop()))");
@@ -4201,7 +5549,10 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
         } else {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
                 auto argExpr = m_exprOptimizer.pop();
-                if (argExpr) {
+                if (argExpr && argExpr->type == ExprType::CHAR_AT) {
+                    // ASC(MID$(s, i, 1)) reads the byte in place
+                    m_exprOptimizer.pushVariable(m_exprOptimizer.charCodeString(argExpr));
+                } else if (argExpr) {
                     std::string argStr = m_exprOptimizer.toString(argExpr);
                     m_exprOptimizer.pushVariable("string.byte(" + argStr + ", 1)");
                 } else {
@@ -4502,16 +5853,25 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
         return;
     }
     
+    // Single-character extraction (tokenizer loops): see emitSingleCharExtract
+    if (emitSingleCharExtract(funcName, argCount)) {
+        return;
+    }
+
     // Check if this is a modular command/function
-    // Ensure the global registry is initialized
-    FasterBASIC::ModularCommands::initializeGlobalRegistry();
-    auto& registry = FasterBASIC::ModularCommands::getGlobalCommandRegistry();
+    const auto& registry = commandTable();
 
     // Check both commands and functions
     const auto* commandDef = registry.getCommand(funcName);
     const auto* functionDef = registry.getFunction(funcName);
     const auto* def = commandDef ? commandDef : functionDef;
 
+    // OPTION UNICODE string functions have codepoint-aware lowerings below;
+    // the registry entries map to the byte-oriented string_* helpers
+    if (def && m_unicodeMode && hasUnicodeLowering(funcName)) {
+        def = nullptr;
+    }
+
     if (def) {
 
         
@@ -4520,6 +5880,12 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
         int paramCount = def->parameters.size();
         bool usedExpressionMode = false;
         
+        // Trailing optional parameters may be omitted (bare RANDOMIZE); only
+        // pop what was pushed and let the Lua call see nil for the rest
+        if (std::holds_alternative<int>(instr.operand2) && argCount < paramCount) {
+            paramCount = argCount;
+        }
+        
         if (paramCount > 0) {
             // Try direct expression optimization first (no locals needed)
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty() && 
@@ -4547,8 +5913,17 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
             }
         }
 
-        // Check if we have custom code generation
-        if (def->hasCustomCodeGen) {
+        // Plugin API v2: direct FFI call to the bound C symbol
+        if (def->isNative() && m_nativeDeclarations.count(funcName)) {
+            std::string nativeCall = nativePluginCall(*def, paramNames);
+            if (!def->isFunction) {
+                emitLine("    " + nativeCall);
+            } else if (usedExpressionMode && canUseExpressionMode()) {
+                m_exprOptimizer.pushVariable(nativeCall);
+            } else {
+                emitLine("    push(" + nativeCall + ")");
+            }
+        } else if (def->hasCustomCodeGen) {
             // Use custom code template - simple substitution for now
             std::string customCode = def->customCodeTemplate;
             // Replace parameter placeholders with actual parameter names
@@ -4578,7 +5953,7 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
             
             // Build parameters, expanding TYPENAME parameters to include schema
             size_t paramIdx = 0;
-            for (size_t i = 0; i < def->parameters.size(); i++) {
+            for (size_t i = 0; i < def->parameters.size() && paramIdx < paramNames.size(); i++) {
                 const auto& paramDef = def->parameters[i];
                 
                 if (i > 0) callParams += ", ";
@@ -4750,11 +6125,7 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
     
     // RND is special - no arguments
     else if (funcName == "RND") {
-        if (canUseExpressionMode()) {
-            m_exprOptimizer.pushVariable("basic_rnd()");
-        } else {
-            emitLine("    push(basic_rnd())");
-        }
+        emitRandomCall(argCount);
         return;
     }
     // String functions
@@ -4781,7 +6152,9 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
         if (m_unicodeMode) {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
                 auto argExpr = m_exprOptimizer.pop();
-                if (argExpr) {
+                if (argExpr && argExpr->type == ExprType::CHAR_AT) {
+                    m_exprOptimizer.pushVariable(m_exprOptimizer.charCodeString(argExpr));
+                } else if (argExpr) {
                     m_exprOptimizer.pushVariable("unicode.unicode_asc(" + m_exprOptimizer.toString(argExpr) + ")");
                 } else {
                     emitLine("    push(unicode.unicode_asc(pop()))");
@@ -4792,7 +6165,10 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
         } else {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
                 auto argExpr = m_exprOptimizer.pop();
-                if (argExpr) {
+                if (argExpr && argExpr->type == ExprType::CHAR_AT) {
+                    // ASC(MID$(s, i, 1)) reads the byte in place
+                    m_exprOptimizer.pushVariable(m_exprOptimizer.charCodeString(argExpr));
+                } else if (argExpr) {
                     std::string argStr = m_exprOptimizer.toString(argExpr);
                     m_exprOptimizer.pushVariable("string.byte(" + argStr + ", 1)");
                 } else {
@@ -4812,10 +6188,10 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
                 if (argExpr) {
                     m_exprOptimizer.pushVariable("unicode.unicode_chr(" + m_exprOptimizer.toString(argExpr) + ")");
                 } else {
-                    emitLine("    push(unicode.chr(pop()))");
+                    emitLine("    push(unicode.unicode_chr(pop()))");
                 }
             } else {
-                emitLine("    push(unicode.chr(pop()))");
+                emitLine("    push(unicode.unicode_chr(pop()))");
             }
         } else {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
@@ -4837,12 +6213,12 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
         if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
             auto argExpr = m_exprOptimizer.pop();
             if (argExpr) {
-                m_exprOptimizer.pushVariable("tostring(" + m_exprOptimizer.toString(argExpr) + ")");
+                m_exprOptimizer.pushVariable("basic_str(" + m_exprOptimizer.toString(argExpr) + ")");
             } else {
-                emitLine("    push(tostring(pop()))");
+                emitLine("    push(basic_str(pop()))");
             }
         } else {
-            emitLine("    push(tostring(pop()))");
+            emitLine("    push(basic_str(pop()))");
         }
         return;
     }
@@ -4851,12 +6227,12 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
         if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
             auto argExpr = m_exprOptimizer.pop();
             if (argExpr) {
-                m_exprOptimizer.pushVariable("tonumber(" + m_exprOptimizer.toString(argExpr) + ") or 0");
+                m_exprOptimizer.pushVariable("basic_val(" + m_exprOptimizer.toString(argExpr) + ")");
             } else {
-                emitLine("    push(tonumber(pop()) or 0)");
+                emitLine("    push(basic_val(pop()))");
             }
         } else {
-            emitLine("    push(tonumber(pop()) or 0)");
+            emitLine("    push(basic_val(pop()))");
         }
         return;
     }
@@ -4871,10 +6247,10 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
                                         m_exprOptimizer.toString(lenExpr) + ")";
                     m_exprOptimizer.pushVariable(result);
                 } else {
-                    emitLine("    b = pop(); a = pop(); push(unicode.left(a, b))");
+                    emitLine("    b = pop(); a = pop(); push(unicode.unicode_left(a, b))");
                 }
             } else {
-                emitLine("    b = pop(); a = pop(); push(unicode.left(a, b))");
+                emitLine("    b = pop(); a = pop(); push(unicode.unicode_left(a, b))");
             }
         } else {
             if (canUseExpressionMode() && m_exprOptimizer.size() >= 2) {
@@ -4904,10 +6280,10 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
                                         m_exprOptimizer.toString(lenExpr) + ")";
                     m_exprOptimizer.pushVariable(result);
                 } else {
-                    emitLine("    b = pop(); a = pop(); push(unicode.right(a, b))");
+                    emitLine("    b = pop(); a = pop(); push(unicode.unicode_right(a, b))");
                 }
             } else {
-                emitLine("    b = pop(); a = pop(); push(unicode.right(a, b))");
+                emitLine("    b = pop(); a = pop(); push(unicode.unicode_right(a, b))");
             }
         } else {
             if (canUseExpressionMode() && m_exprOptimizer.size() >= 2) {
@@ -4939,10 +6315,10 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
                                         m_exprOptimizer.toString(lenExpr) + ")";
                     m_exprOptimizer.pushVariable(result);
                 } else {
-                    emitLine("    len = pop(); start = pop(); s = pop(); push(unicode.mid(s, start, len))");
+                    emitLine("    len = pop(); start = pop(); s = pop(); push(unicode.unicode_mid(s, start, len))");
                 }
             } else {
-                emitLine("    len = pop(); start = pop(); s = pop(); push(unicode.mid(s, start, len))");
+                emitLine("    len = pop(); start = pop(); s = pop(); push(unicode.unicode_mid(s, start, len))");
             }
         } else {
             if (canUseExpressionMode() && m_exprOptimizer.size() >= 3) {
@@ -4976,15 +6352,15 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
                     auto haystackExpr = m_exprOptimizer.pop();
                     auto startExpr = m_exprOptimizer.pop();
                     if (needleExpr && haystackExpr && startExpr) {
-                        std::string result = "unicode.unicode_instr(" + m_exprOptimizer.toString(startExpr) + ", " +
-                                            m_exprOptimizer.toString(haystackExpr) + ", " +
-                                            m_exprOptimizer.toString(needleExpr) + ")";
+                        std::string result = "unicode.unicode_instr(" + m_exprOptimizer.toString(haystackExpr) + ", " +
+                                            m_exprOptimizer.toString(needleExpr) + ", " +
+                                            m_exprOptimizer.toString(startExpr) + ")";
                         m_exprOptimizer.pushVariable(result);
                     } else {
-                        emitLine("    c = pop(); b = pop(); a = pop(); push(unicode.instr_start(a, b, c))");
+                        emitLine("    c = pop(); b = pop(); a = pop(); push(unicode.unicode_instr_start(a, b, c))");
                     }
                 } else {
-                    emitLine("    c = pop(); b = pop(); a = pop(); push(unicode.instr_start(a, b, c))");
+                    emitLine("    c = pop(); b = pop(); a = pop(); push(unicode.unicode_instr_start(a, b, c))");
                 }
             } else {
                 if (canUseExpressionMode() && m_exprOptimizer.size() >= 3) {
@@ -5014,10 +6390,10 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
                                             m_exprOptimizer.toString(needleExpr) + ")";
                         m_exprOptimizer.pushVariable(result);
                     } else {
-                        emitLine("    b = pop(); a = pop(); push(unicode.instr(a, b))");
+                        emitLine("    b = pop(); a = pop(); push(unicode.unicode_instr(a, b))");
                     }
                 } else {
-                    emitLine("    b = pop(); a = pop(); push(unicode.instr(a, b))");
+                    emitLine("    b = pop(); a = pop(); push(unicode.unicode_instr(a, b))");
                 }
             } else {
                 if (canUseExpressionMode() && m_exprOptimizer.size() >= 2) {
@@ -5046,14 +6422,14 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
                 if (charExpr && countExpr) {
                     std::string charStr = m_exprOptimizer.toString(charExpr);
                     std::string countStr = m_exprOptimizer.toString(countExpr);
-                    // Handle both table (codepoint array) and number: if number, use directly
-                    std::string result = "unicode.unicode_string(" + countStr + ", (type(" + charStr + ") == 'number' and " + charStr + " or unicode.unicode_asc(" + charStr + ")))";
+                    // unicode_string accepts a codepoint or a string for the character
+                    std::string result = "unicode.unicode_string(" + countStr + ", " + charStr + ")";
                     m_exprOptimizer.pushVariable(result);
                 } else {
-                    emitLine("    b = pop(); a = pop(); push(unicode.unicode_string(a, type(b) == 'number' and b or unicode.unicode_asc(b)))");
+                    emitLine("    b = pop(); a = pop(); push(unicode.unicode_string(a, b))");
                 }
             } else {
-                emitLine("    b = pop(); a = pop(); push(unicode.unicode_string(a, type(b) == 'number' and b or unicode.unicode_asc(b)))");
+                emitLine("    b = pop(); a = pop(); push(unicode.unicode_string(a, b))");
             }
         } else {
             if (canUseExpressionMode() && m_exprOptimizer.size() >= 2) {
@@ -5080,12 +6456,12 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
                 auto countExpr = m_exprOptimizer.pop();
                 if (countExpr) {
-                    m_exprOptimizer.pushVariable("unicode_space(" + m_exprOptimizer.toString(countExpr) + ")");
+                    m_exprOptimizer.pushVariable("unicode.unicode_space(" + m_exprOptimizer.toString(countExpr) + ")");
                 } else {
-                    emitLine("    push(unicode.space(pop()))");
+                    emitLine("    push(unicode.unicode_space(pop()))");
                 }
             } else {
-                emitLine("    push(unicode.space(pop()))");
+                emitLine("    push(unicode.unicode_space(pop()))");
             }
         } else {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
@@ -5109,10 +6485,10 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
                 if (strExpr) {
                     m_exprOptimizer.pushVariable("unicode.unicode_lower(" + m_exprOptimizer.toString(strExpr) + ")");
                 } else {
-                    emitLine("    push(unicode.lower(pop()))");
+                    emitLine("    push(unicode.unicode_lower(pop()))");
                 }
             } else {
-                emitLine("    push(unicode.lower(pop()))");
+                emitLine("    push(unicode.unicode_lower(pop()))");
             }
         } else {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
@@ -5136,10 +6512,10 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
                 if (strExpr) {
                     m_exprOptimizer.pushVariable("unicode.unicode_upper(" + m_exprOptimizer.toString(strExpr) + ")");
                 } else {
-                    emitLine("    push(unicode.upper(pop()))");
+                    emitLine("    push(unicode.unicode_upper(pop()))");
                 }
             } else {
-                emitLine("    push(unicode.upper(pop()))");
+                emitLine("    push(unicode.unicode_upper(pop()))");
             }
         } else {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
@@ -5161,12 +6537,12 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
                 auto strExpr = m_exprOptimizer.pop();
                 if (strExpr) {
-                    m_exprOptimizer.pushVariable("unicode_ltrim(" + m_exprOptimizer.toString(strExpr) + ")");
+                    m_exprOptimizer.pushVariable("unicode.unicode_ltrim(" + m_exprOptimizer.toString(strExpr) + ")");
                 } else {
-                    emitLine("    push(unicode.ltrim(pop()))");
+                    emitLine("    push(unicode.unicode_ltrim(pop()))");
                 }
             } else {
-                emitLine("    push(unicode.ltrim(pop()))");
+                emitLine("    push(unicode.unicode_ltrim(pop()))");
             }
         } else {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
@@ -5188,12 +6564,12 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
                 auto strExpr = m_exprOptimizer.pop();
                 if (strExpr) {
-                    m_exprOptimizer.pushVariable("unicode_rtrim(" + m_exprOptimizer.toString(strExpr) + ")");
+                    m_exprOptimizer.pushVariable("unicode.unicode_rtrim(" + m_exprOptimizer.toString(strExpr) + ")");
                 } else {
-                    emitLine("    push(unicode.rtrim(pop()))");
+                    emitLine("    push(unicode.unicode_rtrim(pop()))");
                 }
             } else {
-                emitLine("    push(unicode.rtrim(pop()))");
+                emitLine("    push(unicode.unicode_rtrim(pop()))");
             }
         } else {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
@@ -5215,12 +6591,12 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
                 auto strExpr = m_exprOptimizer.pop();
                 if (strExpr) {
-                    m_exprOptimizer.pushVariable("unicode_trim(" + m_exprOptimizer.toString(strExpr) + ")");
+                    m_exprOptimizer.pushVariable("unicode.unicode_trim(" + m_exprOptimizer.toString(strExpr) + ")");
                 } else {
-                    emitLine("    push(unicode.trim(pop()))");
+                    emitLine("    push(unicode.unicode_trim(pop()))");
                 }
             } else {
-                emitLine("    push(unicode.trim(pop()))");
+                emitLine("    push(unicode.unicode_trim(pop()))");
             }
         } else {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
@@ -5242,12 +6618,12 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
                 auto strExpr = m_exprOptimizer.pop();
                 if (strExpr) {
-                    m_exprOptimizer.pushVariable("unicode_reverse(" + m_exprOptimizer.toString(strExpr) + ")");
+                    m_exprOptimizer.pushVariable("unicode.unicode_reverse(" + m_exprOptimizer.toString(strExpr) + ")");
                 } else {
-                    emitLine("    push(unicode.reverse(pop()))");
+                    emitLine("    push(unicode.unicode_reverse(pop()))");
                 }
             } else {
-                emitLine("    push(unicode.reverse(pop()))");
+                emitLine("    push(unicode.unicode_reverse(pop()))");
             }
         } else {
             if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
@@ -5266,33 +6642,25 @@ void LuaCodeGenerator::emitBuiltinFunction(const IRInstruction& instr) {
 
     // RND is special - no arguments
     else if (funcName == "RND") {
-        if (canUseExpressionMode()) {
-            m_exprOptimizer.pushVariable("basic_rnd()");
-        } else {
-            emitLine("    push(basic_rnd())");
-        }
+        emitRandomCall(argCount);
         return;
     }
     
     // OPTIMIZATION 2: Handle RND and key string functions BEFORE modular registry
     else if (funcName == "RND") {
-        if (canUseExpressionMode()) {
-            m_exprOptimizer.pushVariable("basic_rnd()");
-        } else {
-            emitLine("    push(basic_rnd())");
-        }
+        emitRandomCall(argCount);
         return;
     }
     else if (funcName == "STR_STRING" || funcName == "STR$" || funcName == "STR") {
         if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
             auto argExpr = m_exprOptimizer.pop();
             if (argExpr) {
-                m_exprOptimizer.pushVariable("tostring(" + m_exprOptimizer.toString(argExpr) + ")");
+                m_exprOptimizer.pushVariable("basic_str(" + m_exprOptimizer.toString(argExpr) + ")");
             } else {
-                emitLine("    push(tostring(pop()))");
+                emitLine("    push(basic_str(pop()))");
             }
         } else {
-            emitLine("    push(tostring(pop()))");
+            emitLine("    push(basic_str(pop()))");
         }
         return;
     }
@@ -6137,11 +7505,26 @@ void LuaCodeGenerator::emit(const std::string& code) {
 }
 
 void LuaCodeGenerator::emitLine(const std::string& code) {
+    // Inside a register scope stack operations become register moves; a
+    // pop() whose value is discarded leaves nothing to emit
+    const std::string* line = &code;
+    std::string lowered;
+    if (m_registerScope.open &&
+        (code.find("push(") != std::string::npos || code.find("pop()") != std::string::npos)) {
+        lowered = lowerStackOps(code);
+        size_t start = lowered.find_first_not_of(' ');
+        if (start != std::string::npos && lowered.compare(start, 2, "_r") == 0 &&
+            lowered.find_first_not_of("0123456789", start + 2) == std::string::npos) {
+            return;
+        }
+        line = &lowered;
+    }
+
     // Apply indentation offset for nested contexts (e.g., subroutines)
-    if (m_indentOffset > 0 && !code.empty()) {
-        m_output << std::string(m_indentOffset, ' ') << code << "\n";
+    if (m_indentOffset > 0 && !line->empty()) {
+        m_output << std::string(m_indentOffset, ' ') << *line << "\n";
     } else {
-        m_output << code << "\n";
+        m_output << *line << "\n";
     }
     m_stats.linesGenerated++;
 }
@@ -6433,6 +7816,15 @@ void LuaCodeGenerator::analyzeVariableAccess(const IRCode& irCode) {
             }
         }
 
+        // A fused FOR ... READ loop keeps its counter where the loop had it
+        if (instr.opcode == IROpcode::READ_DATA_ARRAY &&
+            std::holds_alternative<std::string>(instr.operand2)) {
+            std::string varName = std::get<std::string>(instr.operand2);
+            loopCounters.insert(varName);
+            m_variableAccess[varName].name = varName;
+            m_variableAccess[varName].isLoopCounter = true;
+        }
+
         // Count LOAD_VAR and STORE_VAR accesses
         if (instr.opcode == IROpcode::LOAD_VAR || instr.opcode == IROpcode::STORE_VAR) {
             if (std::holds_alternative<std::string>(instr.operand1)) {
@@ -6461,6 +7853,148 @@ void LuaCodeGenerator::analyzeVariableAccess(const IRCode& irCode) {
     }
 }
 
+void LuaCodeGenerator::analyzeBufferVariables(const IRCode& irCode) {
+    // Unicode strings are immutable codepoint buffers; basic_mid_assign
+    // already splices them with a single allocation
+    if (m_unicodeMode) return;
+
+    // Candidates: every MID$ assignment target
+    for (const auto& instr : irCode.instructions) {
+        if (instr.opcode == IROpcode::MID_ASSIGN &&
+            std::holds_alternative<std::string>(instr.operand1)) {
+            m_bufferVariables.insert(std::get<std::string>(instr.operand1));
+        }
+    }
+    if (m_bufferVariables.empty()) return;
+
+    // A buffer is only safe where every access goes through LOAD_VAR (which
+    // materializes it), STORE_VAR or MID_ASSIGN. Any other instruction naming
+    // the variable (INPUT, SWAP, BYREF parameters, ...) keeps it a plain string.
+    auto disqualify = [this](const IROperand& operand) {
+        if (std::holds_alternative<std::string>(operand)) {
+            m_bufferVariables.erase(std::get<std::string>(operand));
+        }
+    };
+    for (const auto& instr : irCode.instructions) {
+        switch (instr.opcode) {
+            case IROpcode::LOAD_VAR:
+            case IROpcode::STORE_VAR:
+            case IROpcode::MID_ASSIGN:
+            case IROpcode::DECLARE_LOCAL:
+            case IROpcode::DECLARE_SHARED:
+                break;
+            default:
+                disqualify(instr.operand1);
+                disqualify(instr.operand2);
+                disqualify(instr.operand3);
+                break;
+        }
+    }
+}
+
+void LuaCodeGenerator::collectNativePluginCalls(const IRCode& irCode) {
+    const auto& registry = commandTable();
+
+    for (const auto& instr : irCode.instructions) {
+        if (instr.opcode != IROpcode::CALL_BUILTIN ||
+            !std::holds_alternative<std::string>(instr.operand1)) {
+            continue;
+        }
+        const std::string& funcName = std::get<std::string>(instr.operand1);
+        if (m_nativeDeclarations.count(funcName)) continue;
+        if (m_unicodeMode && hasUnicodeLowering(funcName)) continue;
+
+        const auto* def = registry.getCommand(funcName);
+        if (!def) def = registry.getFunction(funcName);
+        if (!def || !def->isNative()) continue;
+
+        // One ffi.load() namespace per library; declarations are prefixed per
+        // library so equal symbol names in different plugins do not collide
+        auto lib = m_nativeLibraries.find(def->nativeLibrary);
+        if (lib == m_nativeLibraries.end()) {
+            std::string local = "fb_native" + std::to_string(m_nativeLibraries.size() + 1);
+            lib = m_nativeLibraries.emplace(def->nativeLibrary, local).first;
+        }
+        m_nativeDeclarations[funcName] = {def->nativeLibrary, def->nativeSymbol,
+                                          def->getNativeDeclaration(lib->second + "_" + def->nativeSymbol)};
+    }
+}
+
+void LuaCodeGenerator::emitNativePluginBindings() {
+    if (m_nativeDeclarations.empty()) return;
+
+    emitLine("-- Native plugin bindings (plugin API v2): called through the FFI,");
+    emitLine("-- which the JIT compiles to direct calls into the plugin library");
+    emitLine("if not ffi_ok then error('native plugin functions require the LuaJIT FFI') end");
+    // Re-running a program in the same Lua state declares the symbols again;
+    // only that redefinition is ignored, a bad declaration names its plugin
+    emitLine("local function native_cdef(decl, plugin, symbol)");
+    emitLine("    local ok, err = pcall(ffi.cdef, decl)");
+    emitLine("    if not ok and not tostring(err):find('attempt to redefine', 1, true) then");
+    emitLine("        error('plugin ' .. plugin .. ': bad declaration for ' .. symbol .. ': ' .. tostring(err), 0)");
+    emitLine("    end");
+    emitLine("end");
+    auto luaQuote = [](const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '\\' || c == '"') quoted += '\\';
+            quoted += c;
+        }
+        return quoted + "\"";
+    };
+    for (const auto& decl : m_nativeDeclarations) {
+        std::string plugin = decl.second.library;
+        size_t slash = plugin.find_last_of("/\\");
+        if (slash != std::string::npos) plugin = plugin.substr(slash + 1);
+        emitLine("native_cdef([[" + decl.second.declaration + ";]], " + luaQuote(plugin) + ", " +
+                 luaQuote(decl.second.symbol + " (" + decl.first + ")") + ")");
+    }
+    for (const auto& lib : m_nativeLibraries) {
+        emitLine("local " + lib.second + " = ffi.load(" + luaQuote(lib.first) + ")");
+    }
+    emitLine("local function native_string(ptr)");
+    emitLine("    if ptr == nil then return \"\" end");
+    emitLine("    return ffi.string(ptr)");
+    emitLine("end");
+    emitLine("");
+}
+
+// Call expression for a plugin function bound to a native symbol: strings
+// cross as UTF-8 const char*, BASIC booleans as 0/1 ints
+std::string LuaCodeGenerator::nativePluginCall(const ModularCommands::CommandDefinition& def,
+                                               const std::vector<std::string>& args) {
+    using FasterBASIC::ModularCommands::ParameterType;
+    using FasterBASIC::ModularCommands::ReturnType;
+
+    const std::string& lib = m_nativeLibraries[def.nativeLibrary];
+    std::string call = lib + "." + lib + "_" + def.nativeSymbol + "(";
+    for (size_t i = 0; i < def.parameters.size() && i < args.size(); i++) {
+        if (i > 0) call += ", ";
+        switch (def.parameters[i].type) {
+            case ParameterType::STRING:
+                call += m_unicodeMode ? "unicode.to_utf8(" + args[i] + ")" : args[i];
+                break;
+            case ParameterType::BOOL:
+                call += "(basicBoolToLua(" + args[i] + ") and 1 or 0)";
+                break;
+            default:
+                call += args[i];
+                break;
+        }
+    }
+    call += ")";
+
+    switch (def.returnType) {
+        case ReturnType::STRING:
+            return m_unicodeMode ? "unicode.from_utf8(native_string(" + call + "))"
+                                 : "native_string(" + call + ")";
+        case ReturnType::BOOL:
+            return "(" + call + " ~= 0 and -1 or 0)";
+        default:
+            return call;
+    }
+}
+
 void LuaCodeGenerator::selectHotVariables() {
     // Build list of candidates sorted by access count
     std::vector<std::pair<std::string, int>> candidates;
@@ -6553,9 +8087,10 @@ void LuaCodeGenerator::emitVariableTableDeclaration() {
         }
         emitLine(hotDecl);
 
-        // Initialize all hot variables to 0
+        // Initialize all hot variables to 0 (Unicode strings to the empty string)
         for (const auto& varName : m_hotVariables) {
-            emitLine(getVarName(varName) + " = 0");
+            bool isString = !varName.empty() && varName.back() == '$';
+            emitLine(getVarName(varName) + ((m_unicodeMode && isString) ? " = unicode.empty()" : " = 0"));
         }
     }
 
@@ -6597,9 +8132,28 @@ void LuaCodeGenerator::emitTypeDefinition(const IRInstruction& instr) {
     
     const TypeSymbol& typeSymbol = it->second;
     
+    // TYPEs of numbers (and of such TYPEs) become FFI structs: fields are
+    // loads and stores at fixed offsets, and arrays of them are one block of
+    // memory instead of a table per element. Lua tables remain the fallback
+    std::vector<std::string> nestedTypes;
+    std::string structDecl = ffiStructDeclaration(typeSymbol, nestedTypes);
+    bool isStruct = !structDecl.empty();
+    
     emitLine("");
     emitComment("Constructor for TYPE " + typeName);
+    if (isStruct) {
+        m_ffiRecordTypes.insert(typeName);
+        std::string typeofArgs = "'" + structDecl + "'";
+        for (const auto& nested : nestedTypes) {
+            typeofArgs += ", " + nested + "_ct";
+        }
+        emitLine("local " + typeName + "_ct = use_ffi and ffi.typeof(" + typeofArgs + ")");
+        emitLine("local " + typeName + "_vla = " + typeName + "_ct and ffi.typeof('$[?]', " + typeName + "_ct)");
+    }
     emitLine("local function " + typeName + "_new()");
+    if (isStruct) {
+        emitLine("    if " + typeName + "_ct then return " + typeName + "_ct() end");
+    }
     emitLine("    return {");
     
     // Initialize each field to its default value
@@ -6617,7 +8171,7 @@ void LuaCodeGenerator::emitTypeDefinition(const IRInstruction& instr) {
                     break;
                 case VariableType::STRING:
                 case VariableType::UNICODE:
-                    defaultValue = m_unicodeMode ? "{}" : "\"\"";
+                    defaultValue = m_unicodeMode ? "unicode.empty()" : "\"\"";
                     break;
                 default:
                     defaultValue = "nil";
@@ -6633,9 +8187,57 @@ void LuaCodeGenerator::emitTypeDefinition(const IRInstruction& instr) {
     
     emitLine("    }");
     emitLine("end");
+    if (isStruct) {
+        // DIM A(n) AS TypeName: elements 0..n inline in .data, zero-filled
+        emitLine("local function " + typeName + "_array(size)");
+        emitLine("    if not " + typeName + "_vla then return nil end");
+        emitLine("    return {data = " + typeName + "_vla(size), size = size}");
+        emitLine("end");
+    }
     emitLine("");
 }
 
+// C declaration for a TYPE whose fields are all numbers or TYPEs already
+// emitted as structs; nested struct fields are '$' parameters, listed in
+// nestedTypes. Empty when the TYPE has to stay a Lua table (strings)
+std::string LuaCodeGenerator::ffiStructDeclaration(const TypeSymbol& type,
+                                                   std::vector<std::string>& nestedTypes) {
+    static const std::unordered_set<std::string> cKeywords = {
+        "auto", "bool", "break", "case", "char", "const", "continue", "default", "do",
+        "double", "else", "enum", "extern", "float", "for", "goto", "if", "int", "long",
+        "register", "return", "short", "signed", "sizeof", "static", "struct", "switch",
+        "typedef", "union", "unsigned", "void", "volatile", "while"
+    };
+    
+    if (type.fields.empty()) {
+        return "";
+    }
+    
+    std::string decl = "struct {";
+    for (const auto& field : type.fields) {
+        if (cKeywords.count(field.name)) {
+            return "";
+        }
+        std::string cType;
+        if (!field.isBuiltIn) {
+            if (!m_ffiRecordTypes.count(field.typeName)) {
+                return "";
+            }
+            cType = "$";
+            nestedTypes.push_back(field.typeName);
+        } else {
+            switch (field.builtInType) {
+                case VariableType::INT:    cType = "int32_t"; break;
+                case VariableType::FLOAT:  cType = "float"; break;
+                case VariableType::DOUBLE: cType = "double"; break;
+                default:                   return "";
+            }
+        }
+        decl += " " + cType + " " + field.name + ";";
+    }
+    return decl + " }";
+}
+
 void LuaCodeGenerator::emitLoadMember(const IRInstruction& instr) {
     // LOAD_MEMBER: pop record from stack, push member value
     // Stack-based: pop record, push record.member
@@ -6722,6 +8324,7 @@ void LuaCodeGenerator::emitLoadArrayMember(const IRInstruction& instr) {
     }
     
     std::string arrayName = std::get<std::string>(instr.operand1);
+    std::string luaArrayName = getArrayName(arrayName);
     std::string memberPath = std::get<std::string>(instr.operand2);
     
     // Get dimension count (default to 1 for backward compatibility)
@@ -6730,6 +8333,27 @@ void LuaCodeGenerator::emitLoadArrayMember(const IRInstruction& instr) {
         dims = std::get<int>(instr.operand3);
     }
     
+    if (dims == 1) {
+        // FFI struct arrays hold element i at .data[i]; Lua tables follow
+        // the OPTION BASE layout of LOAD_ARRAY
+        if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
+            auto indexExpr = m_exprOptimizer.pop();
+            if (indexExpr) {
+                std::string indexCode = m_exprOptimizer.toString(indexExpr);
+                std::string tableIndex = (m_arrayBase == 0) ? indexCode + " + 1" : indexCode;
+                m_exprOptimizer.pushVariable("(" + luaArrayName + ".data and " + luaArrayName + ".data[" +
+                                             indexCode + "] or " + luaArrayName + "[" + tableIndex + "])." +
+                                             memberPath);
+                return;
+            }
+        }
+        flushExpressionToStack();
+        emitLine("    idx = pop()");
+        emitLine("    push((" + luaArrayName + ".data and " + luaArrayName + ".data[idx] or " + luaArrayName +
+                 "[idx" + (m_arrayBase == 0 ? " + 1" : "") + "])." + memberPath + ")");
+        return;
+    }
+    
     // Flush any pending expressions to ensure indices are on stack
     flushExpressionToStack();
     
@@ -6741,26 +8365,16 @@ void LuaCodeGenerator::emitLoadArrayMember(const IRInstruction& instr) {
         indexVars.insert(indexVars.begin(), idxVar);
     }
     
-    // Build array access and load the member value
-    if (dims == 1) {
-        // For 1D arrays, handle both FFI and regular arrays
-        emitLine("    if arr_" + arrayName + ".data then");
-        emitLine("        push(arr_" + arrayName + ".data[" + indexVars[0] + "]." + memberPath + ")");
-        emitLine("    else");
-        emitLine("        push(arr_" + arrayName + "[" + indexVars[0] + "]." + memberPath + ")");
-        emitLine("    end");
-    } else {
-        // For multi-dimensional arrays
-        std::string arrayAccess = "arr_" + arrayName;
-        for (const auto& idx : indexVars) {
-            arrayAccess += "[" + idx + "]";
-        }
-        emitLine("    push(" + arrayAccess + "." + memberPath + ")");
+    // For multi-dimensional arrays
+    std::string arrayAccess = luaArrayName;
+    for (const auto& idx : indexVars) {
+        arrayAccess += "[" + idx + "]";
     }
+    emitLine("    push(" + arrayAccess + "." + memberPath + ")");
 }
 
 void LuaCodeGenerator::emitStoreArrayMember(const IRInstruction& instr) {
-    // STORE_ARRAY_MEMBER: pop value, pop indices, store to array[index].member
+    // STORE_ARRAY_MEMBER: pop indices, pop value, store to array[index].member
     // operand1 = array name
     // operand2 = member path (e.g., "Name" or "Position.X")
     // operand3 = dimension count (optional)
@@ -6771,6 +8385,7 @@ void LuaCodeGenerator::emitStoreArrayMember(const IRInstruction& instr) {
     }
     
     std::string arrayName = std::get<std::string>(instr.operand1);
+    std::string luaArrayName = getArrayName(arrayName);
     std::string memberPath = std::get<std::string>(instr.operand2);
     
     // Get dimension count (default to 1 for backward compatibility)
@@ -6779,6 +8394,34 @@ void LuaCodeGenerator::emitStoreArrayMember(const IRInstruction& instr) {
         dims = std::get<int>(instr.operand3);
     }
     
+    if (dims == 1) {
+        // Stack has: [..., value, index] (index on top), as for STORE_ARRAY
+        std::string indexCode = "idx";
+        std::string valueCode = "val";
+        bool fromOptimizer = false;
+        if (canUseExpressionMode() && m_exprOptimizer.size() >= 2) {
+            auto indexExpr = m_exprOptimizer.pop();
+            auto valueExpr = m_exprOptimizer.pop();
+            if (indexExpr && valueExpr) {
+                indexCode = m_exprOptimizer.toString(indexExpr);
+                valueCode = m_exprOptimizer.toString(valueExpr);
+                fromOptimizer = true;
+            }
+        }
+        if (!fromOptimizer) {
+            flushExpressionToStack();
+            emitLine("    idx = pop()");
+            emitLine("    val = pop()");
+        }
+        std::string tableIndex = (m_arrayBase == 0) ? indexCode + " + 1" : indexCode;
+        emitLine("    if " + luaArrayName + ".data then");
+        emitLine("        " + luaArrayName + ".data[" + indexCode + "]." + memberPath + " = " + valueCode);
+        emitLine("    else");
+        emitLine("        " + luaArrayName + "[" + tableIndex + "]." + memberPath + " = " + valueCode);
+        emitLine("    end");
+        return;
+    }
+    
     // Flush any pending expressions
     flushExpressionToStack();
     
@@ -6794,27 +8437,13 @@ void LuaCodeGenerator::emitStoreArrayMember(const IRInstruction& instr) {
     // Pop value expression
     std::string valueExpr = popExpr();
     
-    // Build array access expression with all dimensions
-    std::string arrayAccess;
-    if (dims == 1) {
-        // For 1D arrays
-        arrayAccess = "arr_" + arrayName;
-        // Check if it's an FFI array or regular table
-        emitLine("    if arr_" + arrayName + ".data then");
-        emitLine("        arr_" + arrayName + ".data[" + indexVars[0] + "]." + memberPath + " = " + valueExpr);
-        emitLine("    else");
-        emitLine("        arr_" + arrayName + "[" + indexVars[0] + "]." + memberPath + " = " + valueExpr);
-        emitLine("    end");
-        return;
-    } else {
-        // For multi-dimensional arrays
-        arrayAccess = "arr_" + arrayName;
-        for (const auto& idx : indexVars) {
-            arrayAccess += "[" + idx + "]";
-        }
-        // Generate assignment: array[index1][index2]...member = value
-        emitLine("    " + arrayAccess + "." + memberPath + " = " + valueExpr);
+    // For multi-dimensional arrays
+    std::string arrayAccess = luaArrayName;
+    for (const auto& idx : indexVars) {
+        arrayAccess += "[" + idx + "]";
     }
+    // Generate assignment: array[index1][index2]...member = value
+    emitLine("    " + arrayAccess + "." + memberPath + " = " + valueExpr);
 }
 
 void LuaCodeGenerator::emitSwap(const IRInstruction& instr) {
@@ -6936,17 +8565,13 @@ void LuaCodeGenerator::emitArrayBounds(const IRInstruction& instr) {
         // LBOUND returns the lower bound (typically 0 or 1 based on OPTION BASE)
         emitLine("    push(" + std::to_string(m_arrayBase) + ")");
     } else {
-        // UBOUND returns the upper bound
-        // For Lua arrays, we need to find the highest index
+        // UBOUND returns the upper bound. Only emitted for arrays whose bound
+        // is not known at compile time (runtime DIM sizes, APPEND/POP)
         if (dimension == 1) {
-            emitLine("    local max_idx = 0");
-            emitLine("    for k, v in pairs(" + luaArrayName + ") do");
-            emitLine("        if type(k) == 'number' and k > max_idx then max_idx = k end");
-            emitLine("    end");
-            if (m_arrayBase == 0) {
-                emitLine("    push(max_idx - 1)  -- Convert from 1-based to 0-based");
+            if (canUseExpressionMode()) {
+                m_exprOptimizer.pushVariable("UBOUND(" + luaArrayName + ")");
             } else {
-                emitLine("    push(max_idx - 1)  -- Adjust for OPTION BASE 1");
+                emitLine("    push(UBOUND(" + luaArrayName + "))");
             }
         } else {
             // Multi-dimensional arrays are more complex
@@ -6955,6 +8580,117 @@ void LuaCodeGenerator::emitArrayBounds(const IRInstruction& instr) {
     }
 }
 
+void LuaCodeGenerator::emitDict(const IRInstruction& instr) {
+    if (!std::holds_alternative<std::string>(instr.operand1)) return;
+
+    std::string dictName = std::get<std::string>(instr.operand1);
+    std::string luaDictName = getArrayName(dictName);
+    const DictInfo& info = m_dictInfo[dictName];
+    std::string valueSuffix = info.valueSuffix;
+
+    // String keys and string values always use the Lua table form, so their
+    // lookups are inlined; numeric dictionaries may be FFI hash tables
+    bool numericKeys = info.numericKeys;
+    bool tableForm = !numericKeys || valueSuffix == "$";
+    std::string defaultValue = (valueSuffix != "$") ? "0" : (m_unicodeMode ? "unicode.empty()" : "\"\"");
+
+    // Key operand: from the expression optimizer when it holds it, else from
+    // the stack. Unicode strings are tables, so their keys are the UTF-8 text
+    auto keyCode = [&](const std::string& key) {
+        return (m_unicodeMode && !numericKeys) ? "unicode.to_utf8(" + key + ")" : key;
+    };
+    bool keyFromStack = false;
+    auto popKey = [&]() -> std::string {
+        if (canUseExpressionMode() && !m_exprOptimizer.isEmpty()) {
+            auto keyExpr = m_exprOptimizer.pop();
+            if (keyExpr) {
+                return keyCode(m_exprOptimizer.toString(keyExpr));
+            }
+        }
+        flushExpressionToStack();
+        keyFromStack = true;
+        return keyCode("pop()");
+    };
+    auto pushResult = [&](const std::string& value) {
+        if (canUseExpressionMode() && !keyFromStack) {
+            m_exprOptimizer.pushVariable(value);
+        } else {
+            emitLine("    push(" + value + ")");
+        }
+    };
+
+    switch (instr.opcode) {
+        case IROpcode::DICT_NEW:
+            flushExpressionToStack();
+            if (tableForm) {
+                emitLine("    " + luaDictName + " = dict_new()");
+            } else {
+                emitLine("    " + luaDictName + " = dict_new_numeric(detect_array_type('" + valueSuffix + "'))");
+            }
+            break;
+
+        case IROpcode::DICT_GET: {
+            std::string key = popKey();
+            if (tableForm) {
+                pushResult("(" + luaDictName + ".t[" + key + "] or " + defaultValue + ")");
+            } else {
+                pushResult("dict_get(" + luaDictName + ", " + key + ")");
+            }
+            break;
+        }
+
+        case IROpcode::DICT_SET: {
+            // Stack has: [..., value, key] (key on top), as for STORE_ARRAY
+            if (canUseExpressionMode() && m_exprOptimizer.size() >= 2) {
+                auto keyExpr = m_exprOptimizer.pop();
+                auto valueExpr = m_exprOptimizer.pop();
+                if (keyExpr && valueExpr) {
+                    emitLine("    dict_set(" + luaDictName + ", " + keyCode(m_exprOptimizer.toString(keyExpr)) +
+                             ", " + m_exprOptimizer.toString(valueExpr) + ")");
+                    break;
+                }
+            }
+            flushExpressionToStack();
+            emitLine("    idx = pop()");
+            emitLine("    val = pop()");
+            emitLine("    dict_set(" + luaDictName + ", " + keyCode("idx") + ", val)");
+            break;
+        }
+
+        case IROpcode::DICT_HAS: {
+            std::string key = popKey();
+            if (tableForm) {
+                pushResult("(" + luaDictName + ".t[" + key + "] ~= nil and -1 or 0)");
+            } else {
+                pushResult("dict_has(" + luaDictName + ", " + key + ")");
+            }
+            break;
+        }
+
+        case IROpcode::DICT_REMOVE: {
+            std::string key = popKey();
+            emitLine("    dict_remove(" + luaDictName + ", " + key + ")");
+            break;
+        }
+
+        case IROpcode::DICT_KEYS: {
+            flushExpressionToStack();
+            std::string arrayName = std::get<std::string>(instr.operand2);
+            bool toStrings = (instr.arrayElementTypeSuffix == "$");
+            std::string convert = (m_unicodeMode && !numericKeys && toStrings) ? ", unicode.from_utf8" : "";
+            emitLine("    dict_keys(" + luaDictName + ", " + getArrayName(arrayName) + convert + ")");
+            break;
+        }
+
+        case IROpcode::DICT_COUNT:
+            pushResult(luaDictName + ".n");
+            break;
+
+        default:
+            break;
+    }
+}
+
 void LuaCodeGenerator::emitSIMD(const IRInstruction& instr) {
     // SIMD operations format:
     // operand1: result array name
@@ -7034,59 +8770,130 @@ void LuaCodeGenerator::emitSIMD(const IRInstruction& instr) {
     
     // Mark that we use SIMD operations (for requiring the module in header)
     m_usesSIMD = true;
+    flushExpressionToStack();
     
-    emitLine("    -- SIMD operation: " + opName);
-    emitLine("    do");
+    // Record TYPEs lowered to FFI structs are contiguous pairs of doubles or
+    // quads of floats, which is the layout the native kernels take; other
+    // arrays (tables of records) use the field-by-field Lua loop
+    std::string pointerType = isPair ? "double*" : "float*";
+    std::string op = (opName.find("sub") != std::string::npos) ? "-" :
+                     (opName.find("scale") != std::string::npos) ? "*" : "+";
+    std::vector<std::string> fields;
+    auto typeIt = m_code->types.find(instr.userDefinedType);
+    if (typeIt != m_code->types.end()) {
+        for (const auto& field : typeIt->second.fields) {
+            fields.push_back(field.name);
+        }
+    }
     
+    std::string luaSourceB;
     if (needsArrayB) {
-        // Binary array operation (A() + B())
         if (!std::holds_alternative<std::string>(instr.operand3)) {
-            emitLine("    end");
             return;
         }
-        std::string sourceArrayB = std::get<std::string>(instr.operand3);
-        std::string luaSourceB = getArrayName(sourceArrayB);
-        
-        emitLine("        if _SIMD and _SIMD.is_available() then");
-        emitLine("            -- Get array lengths (assuming same size)");
-        emitLine("            local count = #" + luaSourceA);
-        emitLine("            -- Check if arrays are FFI-backed with aligned pointers");
-        emitLine("            if " + luaResultArray + ".data and " + luaSourceA + ".data and " + luaSourceB + ".data then");
-        emitLine("                -- Use native SIMD acceleration");
-        emitLine("                _SIMD." + opName + "(" + luaResultArray + ".data, " + luaSourceA + ".data, " + luaSourceB + ".data, count)");
-        emitLine("            else");
-        emitLine("                -- Fallback to Lua implementation");
-        emitLine("                _SIMD." + opName + "_fallback(" + luaResultArray + ", " + luaSourceA + ", " + luaSourceB + ", count)");
-        emitLine("            end");
-        emitLine("        else");
-        emitLine("            -- SIMD not available, use pure Lua fallback");
-        emitLine("            local count = #" + luaSourceA);
-        emitLine("            for i = 1, count do");
-        emitLine("                " + luaResultArray + "[i] = " + luaSourceA + "[i] + " + luaSourceB + "[i]");
-        emitLine("            end");
-        emitLine("        end");
-    } else if (needsScalar) {
-        // Scalar operation (A() * scalar)
+        luaSourceB = getArrayName(std::get<std::string>(instr.operand3));
+    }
+    
+    emitLine("    -- SIMD operation: " + opName);
+    emitLine("    do");
+    if (needsScalar) {
         emitLine("        local scalar = pop()  -- Get scalar value from stack");
-        emitLine("        if _SIMD and _SIMD.is_available() then");
-        emitLine("            local count = #" + luaSourceA);
-        emitLine("            if " + luaResultArray + ".data and " + luaSourceA + ".data then");
-        emitLine("                -- Use native SIMD acceleration");
-        emitLine("                _SIMD." + opName + "(" + luaResultArray + ".data, " + luaSourceA + ".data, scalar, count)");
-        emitLine("            else");
-        emitLine("                -- Fallback to Lua implementation");
-        emitLine("                _SIMD." + opName + "_fallback(" + luaResultArray + ", " + luaSourceA + ", scalar, count)");
-        emitLine("            end");
-        emitLine("        else");
-        emitLine("            -- SIMD not available, use pure Lua fallback");
-        emitLine("            local count = #" + luaSourceA);
-        emitLine("            for i = 1, count do");
-        emitLine("                " + luaResultArray + "[i] = " + luaSourceA + "[i] * scalar");
-        emitLine("            end");
-        emitLine("        end");
+    }
+    emitLine("        local count = " + luaSourceA + ".size or #" + luaSourceA);
+    std::string allData = luaResultArray + ".data and " + luaSourceA + ".data" +
+                          (needsArrayB ? " and " + luaSourceB + ".data" : "");
+    std::string nativeArgs = "ffi.cast('" + pointerType + "', " + luaResultArray + ".data), " +
+                             "ffi.cast('" + pointerType + "', " + luaSourceA + ".data), " +
+                             (needsArrayB ? "ffi.cast('" + pointerType + "', " + luaSourceB + ".data)" : "scalar");
+    emitLine("        if _SIMD and _SIMD.is_available() and " + allData + " then");
+    emitLine("            -- Use native SIMD acceleration");
+    emitLine("            _SIMD." + opName + "(" + nativeArgs + ", count)");
+    emitLine("        else");
+    emitLine("            -- Element-wise Lua loop (FFI elements from 0, table elements from 1)");
+    emitLine("            local r, a = " + luaResultArray + ".data or " + luaResultArray + ", " +
+             luaSourceA + ".data or " + luaSourceA);
+    if (needsArrayB) {
+        emitLine("            local b = " + luaSourceB + ".data or " + luaSourceB);
+    }
+    emitLine("            local first = " + luaSourceA + ".data and 0 or 1");
+    emitLine("            for i = first, first + count - 1 do");
+    emitLine("                local re, ae" + std::string(needsArrayB ? ", be" : "") + " = r[i], a[i]" +
+             (needsArrayB ? ", b[i]" : ""));
+    for (const auto& field : fields) {
+        std::string rhs = needsArrayB ? "be." + field : "scalar";
+        emitLine("                re." + field + " = ae." + field + " " + op + " " + rhs);
+    }
+    emitLine("            end");
+    emitLine("        end");
+    emitLine("    end");
+}
+
+// Whole-array arithmetic on TYPE arrays (ARRAY_ADD.. and ARRAY_ADD_SCALAR..
+// with userDefinedType set): op applies to each numeric member, for FFI
+// struct arrays (elements from .data[0]) and tables of records alike.
+// TYPEs with STRING members have no such meaning and raise TYPE MISMATCH
+void LuaCodeGenerator::emitRecordArrayArithmetic(const IRInstruction& instr, const std::string& op) {
+    bool hasArrayB = instr.opcode == IROpcode::ARRAY_ADD || instr.opcode == IROpcode::ARRAY_SUB ||
+                     instr.opcode == IROpcode::ARRAY_MUL || instr.opcode == IROpcode::ARRAY_DIV;
+    std::string resultArray = getArrayName(std::get<std::string>(instr.operand1));
+    std::string arrayA = getArrayName(std::get<std::string>(instr.operand2));
+    std::string arrayB = hasArrayB ? getArrayName(std::get<std::string>(instr.operand3)) : "";
+    
+    std::vector<std::string> members;
+    if (!collectRecordMembers(instr.userDefinedType, "", members)) {
+        if (!hasArrayB) {
+            emitLine("    pop()");
+        }
+        emitLine("    error('TYPE MISMATCH: " + instr.userDefinedType + " HAS NON-NUMERIC MEMBERS', 0)");
+        return;
     }
     
+    emitLine("    -- " + instr.userDefinedType + " array: " + op + " member by member");
+    emitLine("    do");
+    if (!hasArrayB) {
+        emitLine("        local scalar = pop()");
+    }
+    emitLine("        local r, a = " + resultArray + ".data or " + resultArray + ", " +
+             arrayA + ".data or " + arrayA);
+    std::string size = "math.min(" + resultArray + ".size or #" + resultArray + ", " +
+                       arrayA + ".size or #" + arrayA;
+    if (hasArrayB) {
+        emitLine("        local b = " + arrayB + ".data or " + arrayB);
+        size += ", " + arrayB + ".size or #" + arrayB;
+    }
+    emitLine("        local first = " + resultArray + ".data and 0 or 1");
+    emitLine("        for i = first, first + " + size + ") - 1 do");
+    emitLine("            local re, ae" + std::string(hasArrayB ? ", be" : "") + " = r[i], a[i]" +
+             (hasArrayB ? ", b[i]" : ""));
+    for (const auto& member : members) {
+        std::string rhs = hasArrayB ? "be." + member : "scalar";
+        emitLine("            re." + member + " = ae." + member + " " + op + " " + rhs);
+    }
+    emitLine("        end");
     emitLine("    end");
 }
 
+// Member paths of a TYPE, nested TYPEs flattened ("Pos.X"); false if the
+// TYPE is unknown or has a member that is not a number
+bool LuaCodeGenerator::collectRecordMembers(const std::string& typeName, const std::string& prefix,
+                                            std::vector<std::string>& memberPaths) const {
+    auto typeIt = m_code->types.find(typeName);
+    if (typeIt == m_code->types.end()) {
+        return false;
+    }
+    for (const auto& field : typeIt->second.fields) {
+        if (!field.isBuiltIn) {
+            if (!collectRecordMembers(field.typeName, prefix + field.name + ".", memberPaths)) {
+                return false;
+            }
+        } else if (field.builtInType == VariableType::INT || field.builtInType == VariableType::FLOAT ||
+                   field.builtInType == VariableType::DOUBLE) {
+            memberPaths.push_back(prefix + field.name);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
 } // namespace FasterBASIC
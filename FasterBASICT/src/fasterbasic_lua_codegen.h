@@ -18,16 +18,24 @@
 
 #include "fasterbasic_ircode.h"
 #include "fasterbasic_lua_expr.h"
+#include "fasterbasic_regir.h"
 
 #include <string>
 #include <sstream>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <map>
 #include <memory>
+#include <initializer_list>
 
 namespace FasterBASIC {
 
+namespace ModularCommands {
+struct CommandDefinition;
+class RegistrySnapshot;
+}
+
 // =============================================================================
 // Lua Code Generation Configuration
 // =============================================================================
@@ -40,9 +48,10 @@ struct LuaCodeGenConfig {
     bool generateDebugInfo = false;   // Generate debug metadata
     bool useLuaJITHints = true;       // Add LuaJIT-specific optimizations
     bool useVariableCache = true;     // Use hot/cold variable caching (unlimited vars)
-    bool enableBufferMode = false;    // Use string buffers for efficient MID$ assignment
     bool exitOnError = true;          // Call os.exit(1) on runtime error (disable for interactive shells)
     int maxLocalVariables = 150;      // Max locals to use (under 200 limit, leaving room for temps)
+    bool runtimeStats = false;        // Report JIT traces and GC activity on stderr at exit
+    bool lowerStackToRegisters = true; // Hold stack IR values in locals (_r1.._rN) instead of push/pop
 
     LuaCodeGenConfig() = default;
 };
@@ -57,6 +66,11 @@ struct LuaCodeGenStats {
     size_t variablesUsed = 0;
     size_t arraysUsed = 0;
     size_t labelsGenerated = 0;
+    size_t helpersEmitted = 0;   // Prelude helpers the program references
+    size_t helpersDropped = 0;   // Prelude helpers left out as unreferenced
+    size_t helperBytesDropped = 0;
+    int stackRegisters = 0;      // Most register locals one Lua function uses (0: none needed)
+    std::string registerFallback;  // Why the runtime stack was kept, empty if it was not
     double generationTimeMs = 0.0;
 
     void print() const;
@@ -82,6 +96,12 @@ public:
     void setConfig(const LuaCodeGenConfig& config) { m_config = config; }
     const LuaCodeGenConfig& getConfig() const { return m_config; }
 
+    // Frozen command registry for builtin and plugin lowering
+    // (defaults to a snapshot of the global registry)
+    void setCommandTable(std::shared_ptr<const ModularCommands::RegistrySnapshot> table) {
+        m_commandTable = std::move(table);
+    }
+
 private:
     // Code generation state
     std::ostringstream m_output;
@@ -90,7 +110,17 @@ private:
     const IRCode* m_code;  // Pointer to IR code for accessing metadata (types, etc.)
     int m_arrayBase;  // OPTION BASE: 0 or 1 (from IRCode metadata)
     bool m_unicodeMode;  // OPTION UNICODE: strings as codepoint arrays (from IRCode metadata)
-    bool m_bufferMode;   // Buffer mode: use string buffers for efficient MID$ assignment
+    std::unordered_set<std::string> m_bufferVariables;  // MID$ assignment targets held in string buffers
+    std::map<std::string, std::string> m_nativeLibraries;  // Plugin API v2: library path -> Lua local holding ffi.load()
+    struct NativeDeclaration {
+        std::string library;      // Plugin library path
+        std::string symbol;       // Exported C symbol
+        std::string declaration;  // ffi.cdef declaration
+    };
+    std::map<std::string, NativeDeclaration> m_nativeDeclarations;  // Plugin API v2: BASIC name -> binding
+    std::map<std::pair<std::string, int>, int> m_usingFormatIds;  // PRINT USING (format, value count) -> using_fmt index
+    std::vector<std::string> m_usingFormatters;  // Lua functions specialized for literal PRINT USING formats
+    std::shared_ptr<const ModularCommands::RegistrySnapshot> m_commandTable;  // Registry commands/functions (lock-free)
     bool m_errorTracking;  // OPTION ERROR: emit _LINE tracking for error messages (from IRCode metadata)
     bool m_forceYieldEnabled;  // OPTION FORCE_YIELD: quasi-preemptive handler yielding (from IRCode metadata)
     int m_forceYieldBudget;  // OPTION FORCE_YIELD budget: instructions before forced yield (from IRCode metadata)
@@ -101,6 +131,42 @@ private:
     bool m_cancellableLoops;  // OPTION CANCELLABLE: inject script cancellation checks in loops
     bool m_eventsUsed;  // EVENT DETECTION: if true, program uses ON EVENT statements and needs event processing code
     bool m_usesSIMD;    // SIMD DETECTION: if true, program uses SIMD array operations and needs SIMD module
+    bool m_usesDicts;   // DICT DETECTION: if true, program declares DIM ... AS DICT and needs the dict helpers
+    struct DictInfo {
+        bool numericKeys;         // Keys are numbers (otherwise strings)
+        std::string valueSuffix;  // "%", "#", "!", "$", "&", or ""
+    };
+    std::unordered_map<std::string, DictInfo> m_dictInfo;  // dictName -> key/value representation
+    std::unordered_set<std::string> m_ffiRecordTypes;  // TYPEs emitted as FFI structs (all fields numeric)
+
+    // Prelude helpers: ranges of m_output holding local definitions that are
+    // dropped after generation when no emitted code refers to their names
+    struct PreludeHelper {
+        std::vector<std::string> names;  // Locals the helper defines
+        size_t begin;
+        size_t end;
+    };
+    std::vector<PreludeHelper> m_preludeHelpers;
+
+    // Register lowering: stack slot k becomes the local _rk of the Lua
+    // function being emitted. Stack operations the generator still writes
+    // as push()/pop() are renamed in emitLine against the depth the
+    // register IR predicts; any disagreement regenerates with the stack
+    RegisterIR m_registerIR;
+    bool m_registerMode = false;
+    struct RegisterScope {
+        bool open = false;
+        size_t declOffset = 0;     // Where "local _r1, ..." goes in m_output
+        std::string indent;
+        int depth = 0;             // Runtime stack depth at this point
+        int registers = 0;         // Highest register used
+        bool hasLast = false;      // An instruction was emitted in this scope
+        size_t lastIndex = 0;
+        IROpcode lastOpcode = IROpcode::NOP;
+    };
+    RegisterScope m_registerScope;
+    std::vector<std::pair<size_t, std::string>> m_registerDecls;  // (offset, declaration line)
+    std::string m_registerFailure;
 
     // Symbol tables
     std::unordered_map<std::string, int> m_variables;   // varName -> index
@@ -144,6 +210,8 @@ private:
 
     // Code generation helpers
     void emitHeader();
+    void emitRuntimeDirectives();
+    void emitRuntimeStats();
     void emitFooter();
     void emitVariableDeclarations();
     void emitArrayDeclarations();
@@ -169,7 +237,14 @@ private:
     void emitControlFlow(const IRInstruction& instr, size_t index);
     void emitLoop(const IRInstruction& instr);
     void emitIO(const IRInstruction& instr);
+    void emitDataBulkRead(bool readsNumbers, bool readsStrings);
     void emitBuiltinFunction(const IRInstruction& instr);
+    static bool hasUnicodeLowering(const std::string& funcName);
+    bool emitSingleCharExtract(const std::string& funcName, int argCount);
+    void emitRandomCall(int argCount);
+    std::string usingFormatter(const std::string& format, int argCount);
+    std::string nativePluginCall(const ModularCommands::CommandDefinition& def,
+                                 const std::vector<std::string>& args);
     void emitFunctionDefinition(const IRInstruction& instr);
     void emitFunctionCall(const IRInstruction& instr);
     void emitReturn(const IRInstruction& instr);
@@ -182,15 +257,31 @@ private:
     void emitStoreMember(const IRInstruction& instr);
     void emitLoadArrayMember(const IRInstruction& instr);
     void emitStoreArrayMember(const IRInstruction& instr);
+    void emitRecordArrayArithmetic(const IRInstruction& instr, const std::string& op);
+    bool collectRecordMembers(const std::string& typeName, const std::string& prefix,
+                              std::vector<std::string>& memberPaths) const;
     void emitSwap(const IRInstruction& instr);
     void emitRedim(const IRInstruction& instr);
     void emitErase(const IRInstruction& instr);
     void emitArrayBounds(const IRInstruction& instr);
+    void emitDict(const IRInstruction& instr);
     void emitSIMD(const IRInstruction& instr);
 
     // Function/Sub collection
     void collectFunctionDefinitions(const IRCode& irCode);
 
+    // Prelude helper tracking
+    void beginHelper(std::initializer_list<const char*> names);
+    void endHelper();
+    std::string stripUnusedHelpers(const std::string& code);
+
+    // Register lowering
+    RegisterScope openRegisterScope(const std::string& indent);
+    void closeRegisterScope(const RegisterScope& outer);
+    void checkStackDepth(const IRInstruction& instr, size_t index);
+    std::string lowerStackOps(const std::string& code);
+    std::string insertRegisterDeclarations(const std::string& code);
+
     // Helper functions
     void emit(const std::string& code);
     void emitLine(const std::string& code);
@@ -209,11 +300,16 @@ private:
     
     // TYPE schema generation for TYPENAME parameters
     std::string generateTypeSchemaTable(const std::string& typeName);
+    std::string ffiStructDeclaration(const TypeSymbol& type, std::vector<std::string>& nestedTypes);
     std::string mapToSQLType(VariableType type);
     
     // Variable access tracking and hot/cold management
     void analyzeVariableAccess(const IRCode& irCode);
     void selectHotVariables();
+    void analyzeBufferVariables(const IRCode& irCode);
+    void collectNativePluginCalls(const IRCode& irCode);
+    const ModularCommands::RegistrySnapshot& commandTable();
+    void emitNativePluginBindings();
     bool isHotVariable(const std::string& varName);
     std::string getVariableReference(const std::string& varName);
     void emitVariableTableDeclaration();
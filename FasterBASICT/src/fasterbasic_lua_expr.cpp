@@ -5,6 +5,9 @@
 
 #include "fasterbasic_lua_expr.h"
 #include <sstream>
+#include <cstdlib>
+#include <cmath>
+#include <cstdint>
 
 namespace FasterBASIC {
 
@@ -82,6 +85,205 @@ std::string ExpressionOptimizer::maybeParenthesize(std::shared_ptr<Expr> expr,
     return toString(expr);
 }
 
+// =============================================================================
+// Single-Character Lowering
+// =============================================================================
+
+std::string ExpressionOptimizer::charCodeString(std::shared_ptr<Expr> charExpr) const {
+    std::string source = toString(charExpr->charSource);
+    if (m_unicodeMode) {
+        std::string index = charExpr->charIndex ? toString(charExpr->charIndex)
+                                                : "unicode.unicode_len(" + source + ")";
+        return "unicode.unicode_asc(" + source + ", " + index + ")";
+    }
+    std::string index = charExpr->charIndex ? toString(charExpr->charIndex) : "-1";
+    return "string.byte(" + source + ", " + index + ")";
+}
+
+bool ExpressionOptimizer::isNumericLiteral(std::shared_ptr<Expr> expr, double value) const {
+    double parsed = 0;
+    return numericLiteralValue(expr, parsed) && parsed == value;
+}
+
+bool ExpressionOptimizer::numericLiteralValue(std::shared_ptr<Expr> expr, double& value) const {
+    if (!expr || expr->type != ExprType::LITERAL || expr->isString || expr->literal.empty()) {
+        return false;
+    }
+    const char* text = expr->literal.c_str();
+    char* end = nullptr;
+    value = std::strtod(text, &end);
+    return end && *end == '\0';
+}
+
+// =============================================================================
+// Bitwise Lowering
+// =============================================================================
+// AND, OR, XOR, EQV, IMP and NOT work on 32-bit integers and lower to the
+// LuaJIT bit intrinsics bound as locals in the generated header (band, bor,
+// bxor, bnot). bit.* rounds non-integral numbers, while BASIC truncates
+// toward zero (basic_bitwise.cpp), so operands that are not provably whole
+// go through bit_int first.
+
+// Literals within this magnitude convert exactly (beyond it bit.* wraps)
+static const double BIT_LITERAL_LIMIT = 9007199254740992.0;  // 2^53
+
+// Truncate toward zero, then wrap to int32 as bit.tobit does
+static bool literalBitInt(double value, int32_t& out) {
+    if (!std::isfinite(value) || std::fabs(value) >= BIT_LITERAL_LIMIT) {
+        return false;
+    }
+    out = static_cast<int32_t>(static_cast<uint32_t>(static_cast<int64_t>(std::trunc(value))));
+    return true;
+}
+
+bool ExpressionOptimizer::isIntegral(std::shared_ptr<Expr> expr) const {
+    if (!expr) return false;
+
+    switch (expr->type) {
+        case ExprType::LITERAL: {
+            double value = 0;
+            return numericLiteralValue(expr, value) && value == std::trunc(value) &&
+                   std::fabs(value) < BIT_LITERAL_LIMIT;
+        }
+        case ExprType::BINARY_OP:
+            switch (expr->binaryOp) {
+                // Comparisons give -1/0; bit operations give int32
+                case BinaryOp::EQ: case BinaryOp::NE: case BinaryOp::LT:
+                case BinaryOp::LE: case BinaryOp::GT: case BinaryOp::GE:
+                case BinaryOp::AND: case BinaryOp::OR: case BinaryOp::XOR:
+                case BinaryOp::EQV: case BinaryOp::IMP:
+                case BinaryOp::IDIV:
+                    return true;
+                case BinaryOp::ADD: case BinaryOp::SUB:
+                case BinaryOp::MUL: case BinaryOp::MOD:
+                    return isIntegral(expr->left) && isIntegral(expr->right);
+                default:
+                    return false;
+            }
+        case ExprType::UNARY_OP:
+            return expr->unaryOp == UnaryOp::NOT || isIntegral(expr->operand);
+        case ExprType::CALL:
+            return expr->funcName == "math.floor";
+        default:
+            return false;
+    }
+}
+
+bool ExpressionOptimizer::bitConstant(std::shared_ptr<Expr> expr, int32_t& value) const {
+    bool negate = false;
+    if (expr && expr->type == ExprType::UNARY_OP && expr->unaryOp == UnaryOp::NEG) {
+        negate = true;
+        expr = expr->operand;
+    }
+    double literal = 0;
+    return numericLiteralValue(expr, literal) && literalBitInt(negate ? -literal : literal, value);
+}
+
+std::string ExpressionOptimizer::bitOperand(std::shared_ptr<Expr> expr) const {
+    int32_t converted = 0;
+    if (bitConstant(expr, converted)) {
+        return std::to_string(converted);
+    }
+    if (isIntegral(expr)) {
+        return toString(expr);
+    }
+    return "bit_int(" + toString(expr) + ")";
+}
+
+bool ExpressionOptimizer::foldBitwise(BinaryOp op, std::shared_ptr<Expr> left,
+                                      std::shared_ptr<Expr> right, std::string& out) const {
+    if (op != BinaryOp::AND && op != BinaryOp::OR && op != BinaryOp::XOR &&
+        op != BinaryOp::EQV && op != BinaryOp::IMP) {
+        return false;
+    }
+    int32_t a = 0, b = 0;
+    if (!bitConstant(left, a) || !bitConstant(right, b)) {
+        return false;
+    }
+    int32_t result = 0;
+    switch (op) {
+        case BinaryOp::AND: result = a & b; break;
+        case BinaryOp::OR:  result = a | b; break;
+        case BinaryOp::XOR: result = a ^ b; break;
+        case BinaryOp::EQV: result = ~(a ^ b); break;
+        default:            result = ~a | b; break;  // IMP
+    }
+    out = std::to_string(result);
+    return true;
+}
+
+bool ExpressionOptimizer::foldBitwiseNot(std::shared_ptr<Expr> operand, std::string& out) const {
+    int32_t a = 0;
+    if (!bitConstant(operand, a)) {
+        return false;
+    }
+    out = std::to_string(~a);
+    return true;
+}
+
+bool ExpressionOptimizer::singleCharCode(std::shared_ptr<Expr> expr, long& code) const {
+    if (!expr || expr->type != ExprType::LITERAL || !expr->isString) {
+        return false;
+    }
+    const std::string& value = expr->stringValue;
+    if (value.empty()) {
+        return false;
+    }
+    unsigned char lead = static_cast<unsigned char>(value[0]);
+    if (!m_unicodeMode || lead < 0x80) {
+        if (value.size() != 1 || lead == 0) return false;
+        code = lead;
+        return true;
+    }
+
+    // Unicode mode: the literal must be exactly one UTF-8 sequence
+    size_t length = (lead >= 0xF0) ? 4 : (lead >= 0xE0) ? 3 : (lead >= 0xC0) ? 2 : 0;
+    if (length == 0 || value.size() != length) {
+        return false;
+    }
+    long cp = lead & (0x7F >> length);
+    for (size_t i = 1; i < length; i++) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if ((c & 0xC0) != 0x80) return false;
+        cp = (cp << 6) | (c & 0x3F);
+    }
+    code = cp;
+    return true;
+}
+
+bool ExpressionOptimizer::lowerCharComparison(std::shared_ptr<Expr> expr, std::string& out) const {
+    std::shared_ptr<Expr> charExpr;
+    long code = 0;
+    bool charOnLeft = false;
+    if (expr->left && expr->left->type == ExprType::CHAR_AT && singleCharCode(expr->right, code)) {
+        charExpr = expr->left;
+        charOnLeft = true;
+    } else if (expr->right && expr->right->type == ExprType::CHAR_AT && singleCharCode(expr->left, code)) {
+        charExpr = expr->right;
+    } else {
+        return false;
+    }
+
+    // An out-of-range position gives "" as a string; as a code it is nil
+    // (string.byte) or 0 (unicode_asc), which orders below every character
+    std::string charCode = charCodeString(charExpr);
+    bool ordered = expr->binaryOp != BinaryOp::EQ && expr->binaryOp != BinaryOp::NE;
+    if (ordered && !m_unicodeMode) {
+        charCode = "(" + charCode + " or 0)";
+    }
+    std::string codeStr = std::to_string(code);
+    std::string opStr = getBinaryOpStr(expr->binaryOp);
+
+    std::ostringstream oss;
+    if (charOnLeft) {
+        oss << "((" << charCode << " " << opStr << " " << codeStr << ") and -1 or 0)";
+    } else {
+        oss << "((" << codeStr << " " << opStr << " " << charCode << ") and -1 or 0)";
+    }
+    out = oss.str();
+    return true;
+}
+
 std::string ExpressionOptimizer::toString(std::shared_ptr<Expr> expr) const {
     if (!expr) return "nil";
 
@@ -117,6 +319,13 @@ std::string ExpressionOptimizer::toString(std::shared_ptr<Expr> expr) const {
                                 expr->binaryOp == BinaryOp::GT ||
                                 expr->binaryOp == BinaryOp::GE);
 
+            // MID$(s, i, 1) = "x" and friends compare character codes,
+            // without building a one-character string
+            std::string charComparison;
+            if (isComparison && lowerCharComparison(expr, charComparison)) {
+                return charComparison;
+            }
+
             // In Unicode mode, use unicode_string_equal for EQ and NE comparisons
             // (Unicode strings are tables, so == compares references, not content)
             if (m_unicodeMode && (expr->binaryOp == BinaryOp::EQ || expr->binaryOp == BinaryOp::NE)) {
@@ -151,39 +360,19 @@ std::string ExpressionOptimizer::toString(std::shared_ptr<Expr> expr) const {
                 return oss.str();
             }
 
-            // Use bitwise FFI functions for AND, OR, XOR, EQV, IMP (BASIC compatibility)
-            if (expr->binaryOp == BinaryOp::AND) {
-                std::string leftStr = maybeParenthesize(expr->left, precedence);
-                std::string rightStr = maybeParenthesize(expr->right, precedence);
-                oss << "bitwise.band(" << leftStr << ", " << rightStr << ")";
-                return oss.str();
-            }
-            
-            if (expr->binaryOp == BinaryOp::OR) {
-                std::string leftStr = maybeParenthesize(expr->left, precedence);
-                std::string rightStr = maybeParenthesize(expr->right, precedence);
-                oss << "bitwise.bor(" << leftStr << ", " << rightStr << ")";
-                return oss.str();
-            }
-            
-            if (expr->binaryOp == BinaryOp::XOR) {
-                std::string leftStr = maybeParenthesize(expr->left, precedence);
-                std::string rightStr = maybeParenthesize(expr->right, precedence);
-                oss << "bitwise.bxor(" << leftStr << ", " << rightStr << ")";
-                return oss.str();
-            }
-            
-            if (expr->binaryOp == BinaryOp::EQV) {
-                std::string leftStr = maybeParenthesize(expr->left, precedence);
-                std::string rightStr = maybeParenthesize(expr->right, precedence);
-                oss << "bitwise.beqv(" << leftStr << ", " << rightStr << ")";
-                return oss.str();
-            }
-            
-            if (expr->binaryOp == BinaryOp::IMP) {
-                std::string leftStr = maybeParenthesize(expr->left, precedence);
-                std::string rightStr = maybeParenthesize(expr->right, precedence);
-                oss << "bitwise.bimp(" << leftStr << ", " << rightStr << ")";
+            // AND, OR, XOR, EQV, IMP: LuaJIT bit intrinsics (EQV and IMP composed)
+            if (expr->binaryOp == BinaryOp::AND || expr->binaryOp == BinaryOp::OR ||
+                expr->binaryOp == BinaryOp::XOR || expr->binaryOp == BinaryOp::EQV ||
+                expr->binaryOp == BinaryOp::IMP) {
+                std::string leftStr = bitOperand(expr->left);
+                std::string rightStr = bitOperand(expr->right);
+                switch (expr->binaryOp) {
+                    case BinaryOp::AND: oss << "band(" << leftStr << ", " << rightStr << ")"; break;
+                    case BinaryOp::OR:  oss << "bor(" << leftStr << ", " << rightStr << ")"; break;
+                    case BinaryOp::XOR: oss << "bxor(" << leftStr << ", " << rightStr << ")"; break;
+                    case BinaryOp::EQV: oss << "bnot(bxor(" << leftStr << ", " << rightStr << "))"; break;
+                    default:            oss << "bor(bnot(" << leftStr << "), " << rightStr << ")"; break;
+                }
                 return oss.str();
             }
 
@@ -219,11 +408,15 @@ std::string ExpressionOptimizer::toString(std::shared_ptr<Expr> expr) const {
                 // Function-style
                 return "math.abs(" + toString(expr->operand) + ")";
             } else if (expr->unaryOp == UnaryOp::NOT) {
-                // Use bitwise NOT for BASIC compatibility
-                return "bitwise.bnot(" + toString(expr->operand) + ")";
+                // 32-bit NOT, like the binary bit operators
+                return "bnot(" + bitOperand(expr->operand) + ")";
             } else {
-                // Prefix operator
-                return getUnaryOpStr(expr->unaryOp) + toString(expr->operand);
+                // Prefix operator (parenthesized: "--1" would start a Lua comment)
+                std::string operandStr = toString(expr->operand);
+                if (!operandStr.empty() && operandStr[0] == '-') {
+                    operandStr = "(" + operandStr + ")";
+                }
+                return getUnaryOpStr(expr->unaryOp) + operandStr;
             }
         }
 
@@ -236,6 +429,10 @@ std::string ExpressionOptimizer::toString(std::shared_ptr<Expr> expr) const {
             oss << ")";
             return oss.str();
 
+        case ExprType::CHAR_AT:
+            // Used as a string value: the original substring call
+            return expr->literal;
+
         case ExprType::STACK_REF:
             // Fallback to stack reference
             oss << "stack[" << expr->stackPos << "]";
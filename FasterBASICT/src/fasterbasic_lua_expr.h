@@ -17,6 +17,7 @@
 #include <vector>
 #include <memory>
 #include <sstream>
+#include <cstdint>
 
 namespace FasterBASIC {
 
@@ -31,6 +32,7 @@ enum class ExprType {
     BINARY_OP,      // Binary operation (a + b)
     UNARY_OP,       // Unary operation (-a, NOT a)
     CALL,           // Function call (math.sin(x))
+    CHAR_AT,        // One character of a string (MID$(s,i,1), LEFT$(s,1), RIGHT$(s,1))
     STACK_REF       // Reference to stack position (for complex cases)
 };
 
@@ -52,9 +54,13 @@ enum class UnaryOp {
 struct Expr {
     ExprType type;
     
-    // For literals
+    // For literals (and CHAR_AT: the substring code used as a string value)
     std::string literal;
     
+    // For string literals: the unescaped value
+    bool isString;
+    std::string stringValue;
+    
     // For variables
     std::string varName;
     
@@ -75,10 +81,14 @@ struct Expr {
     std::string funcName;
     std::vector<std::shared_ptr<Expr>> args;
     
+    // For single-character extraction (charIndex is null for the last character)
+    std::shared_ptr<Expr> charSource;
+    std::shared_ptr<Expr> charIndex;
+    
     // For stack references
     int stackPos;
     
-    Expr() : type(ExprType::LITERAL), binaryOp(BinaryOp::ADD), 
+    Expr() : type(ExprType::LITERAL), isString(false), binaryOp(BinaryOp::ADD), 
              unaryOp(UnaryOp::NEG), stackPos(-1) {}
     
     static std::shared_ptr<Expr> makeLiteral(const std::string& value) {
@@ -88,6 +98,14 @@ struct Expr {
         return e;
     }
     
+    static std::shared_ptr<Expr> makeStringLiteral(const std::string& code,
+                                                     const std::string& value) {
+        auto e = makeLiteral(code);
+        e->isString = true;
+        e->stringValue = value;
+        return e;
+    }
+    
     static std::shared_ptr<Expr> makeVariable(const std::string& name) {
         auto e = std::make_shared<Expr>();
         e->type = ExprType::VARIABLE;
@@ -133,6 +151,17 @@ struct Expr {
         return e;
     }
     
+    static std::shared_ptr<Expr> makeCharAt(std::shared_ptr<Expr> source,
+                                              std::shared_ptr<Expr> index,
+                                              const std::string& substringCode) {
+        auto e = std::make_shared<Expr>();
+        e->type = ExprType::CHAR_AT;
+        e->charSource = source;
+        e->charIndex = index;
+        e->literal = substringCode;
+        return e;
+    }
+    
     static std::shared_ptr<Expr> makeStackRef(int pos) {
         auto e = std::make_shared<Expr>();
         e->type = ExprType::STACK_REF;
@@ -152,6 +181,7 @@ public:
     
     // Push an expression onto the symbolic stack
     void pushLiteral(const std::string& value);
+    void pushStringLiteral(const std::string& code, const std::string& value);
     void pushVariable(const std::string& name);
     void pushArrayAccess(const std::string& arrayName, std::shared_ptr<Expr> index);
     
@@ -171,10 +201,25 @@ public:
     void applyBinaryOp(BinaryOp op);
     void applyUnaryOp(UnaryOp op);
     void applyCall(const std::string& funcName, int argCount);
+    void applyCharAt(std::shared_ptr<Expr> source, std::shared_ptr<Expr> index,
+                     const std::string& substringCode);
+    
+    // Character code of a CHAR_AT without building the one-character string:
+    // string.byte(s, i) in ASCII mode, the codepoint in Unicode mode
+    std::string charCodeString(std::shared_ptr<Expr> charExpr) const;
+    
+    // Check for a numeric literal with the given value
+    bool isNumericLiteral(std::shared_ptr<Expr> expr, double value) const;
+    
+    // Value of a numeric literal
+    bool numericLiteralValue(std::shared_ptr<Expr> expr, double& value) const;
     
     // Convert expression to Lua code
     std::string toString(std::shared_ptr<Expr> expr) const;
     
+    // Operand of a bit.* call, truncated toward zero unless already integral
+    std::string bitOperand(std::shared_ptr<Expr> expr) const;
+    
     // Check if expression is simple enough to inline
     bool isSimple(std::shared_ptr<Expr> expr) const;
     
@@ -204,6 +249,23 @@ private:
     
     // Helper to add parentheses if needed
     std::string maybeParenthesize(std::shared_ptr<Expr> expr, int parentPrecedence) const;
+    
+    // Character code of a one-character string literal (byte or codepoint)
+    bool singleCharCode(std::shared_ptr<Expr> expr, long& code) const;
+    
+    // Lower CHAR_AT compared with a one-character literal to a code comparison
+    bool lowerCharComparison(std::shared_ptr<Expr> expr, std::string& out) const;
+    
+    // Whether expr always evaluates to a whole number (no bit_int needed)
+    bool isIntegral(std::shared_ptr<Expr> expr) const;
+    
+    // int32 value of a numeric literal or a negated one
+    bool bitConstant(std::shared_ptr<Expr> expr, int32_t& value) const;
+    
+    // Fold AND/OR/XOR/EQV/IMP/NOT of numeric literals to a literal result
+    bool foldBitwise(BinaryOp op, std::shared_ptr<Expr> left, std::shared_ptr<Expr> right,
+                     std::string& out) const;
+    bool foldBitwiseNot(std::shared_ptr<Expr> operand, std::string& out) const;
 };
 
 // =============================================================================
@@ -225,6 +287,11 @@ inline void ExpressionOptimizer::pushLiteral(const std::string& value) {
     m_stack.push_back(Expr::makeLiteral(value));
 }
 
+inline void ExpressionOptimizer::pushStringLiteral(const std::string& code,
+                                                    const std::string& value) {
+    m_stack.push_back(Expr::makeStringLiteral(code, value));
+}
+
 inline void ExpressionOptimizer::pushVariable(const std::string& name) {
     m_stack.push_back(Expr::makeVariable(name));
 }
@@ -255,6 +322,11 @@ inline void ExpressionOptimizer::applyBinaryOp(BinaryOp op) {
     
     auto right = pop();
     auto left = pop();
+    std::string folded;
+    if (foldBitwise(op, left, right, folded)) {
+        m_stack.push_back(Expr::makeLiteral(folded));
+        return;
+    }
     m_stack.push_back(Expr::makeBinaryOp(op, left, right));
 }
 
@@ -262,6 +334,11 @@ inline void ExpressionOptimizer::applyUnaryOp(UnaryOp op) {
     if (m_stack.empty()) return;
     
     auto operand = pop();
+    std::string folded;
+    if (op == UnaryOp::NOT && foldBitwiseNot(operand, folded)) {
+        m_stack.push_back(Expr::makeLiteral(folded));
+        return;
+    }
     m_stack.push_back(Expr::makeUnaryOp(op, operand));
 }
 
@@ -275,6 +352,12 @@ inline void ExpressionOptimizer::applyCall(const std::string& funcName, int argC
     m_stack.push_back(Expr::makeCall(funcName, args));
 }
 
+inline void ExpressionOptimizer::applyCharAt(std::shared_ptr<Expr> source,
+                                             std::shared_ptr<Expr> index,
+                                             const std::string& substringCode) {
+    m_stack.push_back(Expr::makeCharAt(source, index, substringCode));
+}
+
 inline bool ExpressionOptimizer::isSimple(std::shared_ptr<Expr> expr) const {
     if (!expr) return false;
     
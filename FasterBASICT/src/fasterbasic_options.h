@@ -9,6 +9,9 @@
 #ifndef FASTERBASIC_OPTIONS_H
 #define FASTERBASIC_OPTIONS_H
 
+#include <string>
+#include <vector>
+
 namespace FasterBASIC {
 
 // =============================================================================
@@ -51,6 +54,17 @@ struct CompilerOptions {
     bool forceYieldEnabled = false;
     int forceYieldBudget = 10000;  // Default: yield every 10,000 instructions
     
+    // JIT tuning: OPTION JIT ON/OFF and OPTION JIT level, param=value, flag ON/OFF
+    // jitMode: -1 leaves the JIT as the host configured it, 0 = off, 1 = on
+    // jitSettings are jit.opt.start() arguments in source order ("3", "maxtrace=4000", "-fold")
+    int jitMode = -1;
+    std::vector<std::string> jitSettings;
+    
+    // Collector tuning: OPTION GC PAUSE n, STEPMUL n
+    // 0 keeps the collector's own setting
+    int gcPause = 0;
+    int gcStepMul = 0;
+    
     // Constructor with defaults
     CompilerOptions() = default;
     
@@ -64,6 +78,10 @@ struct CompilerOptions {
         explicitDeclarations = false;
         forceYieldEnabled = false;
         forceYieldBudget = 10000;
+        jitMode = -1;
+        jitSettings.clear();
+        gcPause = 0;
+        gcStepMul = 0;
     }
 };
 
@@ -16,6 +16,7 @@
 #include <fstream>
 #include <set>
 #include <climits>
+#include <iterator>
 
 // For realpath()
 #ifndef _WIN32
@@ -47,6 +48,15 @@ Parser::Parser()
 
 Parser::~Parser() = default;
 
+const ModularCommands::RegistrySnapshot& Parser::commandTable() {
+    if (!m_commandTable) {
+        // Ensure the global registry is initialized
+        ModularCommands::initializeGlobalRegistry();
+        m_commandTable = ModularCommands::getGlobalCommandRegistry().snapshot();
+    }
+    return *m_commandTable;
+}
+
 // =============================================================================
 // Token Stream Management
 // =============================================================================
@@ -344,6 +354,12 @@ void Parser::collectOptionsFromTokens() {
                     m_options.forceYieldBudget = budget;
                 }
                 // If no number, keep default budget (10000)
+            } else if (isOptionWord("JIT")) {
+                advance();
+                collectJitOption();
+            } else if (isOptionWord("GC")) {
+                advance();
+                collectGcOption();
             } else {
                 error("Unknown OPTION type");
             }
@@ -364,6 +380,115 @@ void Parser::collectOptionsFromTokens() {
     m_currentIndex = savedIndex;
 }
 
+// Is the current token the (case-insensitive) word? JIT, GC and their
+// parameter names are not keywords, so programs may still use them as names
+bool Parser::isOptionWord(const char* word) const {
+    std::string upper = current().value;
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    return upper == word;
+}
+
+void Parser::collectJitOption() {
+    // OPTION JIT ON | OFF
+    if (match(TokenType::ON)) {
+        m_options.jitMode = 1;
+        return;
+    }
+    if (match(TokenType::OFF)) {
+        m_options.jitMode = 0;
+        return;
+    }
+
+    // OPTION JIT item {, item}: an optimization level 0-3, a parameter
+    // (name [=] n) or an optimization flag (name ON | OFF), passed on to
+    // jit.opt.start() in order
+    static const char* const parameters[] = {
+        "maxtrace", "maxrecord", "maxirconst", "maxside", "maxsnap", "minstitch",
+        "hotloop", "hotexit", "tryside", "instunroll", "loopunroll", "callunroll",
+        "recunroll", "sizemcode", "maxmcode"
+    };
+    static const char* const flags[] = {
+        "fold", "cse", "dce", "fwd", "dse", "narrow", "loop", "abc", "sink", "fuse"
+    };
+
+    do {
+        if (current().type == TokenType::NUMBER) {
+            int level = static_cast<int>(current().numberValue);
+            advance();
+            if (level < 0 || level > 3) {
+                error("OPTION JIT optimization level must be 0 to 3");
+                continue;
+            }
+            m_options.jitSettings.push_back(std::to_string(level));
+            continue;
+        }
+
+        std::string name = current().value;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (name.empty() || current().type == TokenType::END_OF_LINE) {
+            error("Expected ON, OFF, an optimization level or a JIT parameter after OPTION JIT");
+            return;
+        }
+        advance();
+
+        bool isParameter = std::find_if(std::begin(parameters), std::end(parameters),
+            [&](const char* p) { return name == p; }) != std::end(parameters);
+        bool isFlag = std::find_if(std::begin(flags), std::end(flags),
+            [&](const char* f) { return name == f; }) != std::end(flags);
+
+        if (isParameter) {
+            match(TokenType::EQUAL);
+            if (current().type != TokenType::NUMBER) {
+                error("Expected number after OPTION JIT " + name);
+                return;
+            }
+            int value = static_cast<int>(current().numberValue);
+            advance();
+            if (value < 0) {
+                error("OPTION JIT " + name + " cannot be negative");
+                continue;
+            }
+            m_options.jitSettings.push_back(name + "=" + std::to_string(value));
+        } else if (isFlag) {
+            if (match(TokenType::ON)) {
+                m_options.jitSettings.push_back("+" + name);
+            } else if (match(TokenType::OFF)) {
+                m_options.jitSettings.push_back("-" + name);
+            } else {
+                error("Expected ON or OFF after OPTION JIT " + name);
+                return;
+            }
+        } else {
+            error("Unknown OPTION JIT parameter: " + name);
+            return;
+        }
+    } while (match(TokenType::COMMA));
+}
+
+void Parser::collectGcOption() {
+    // OPTION GC PAUSE [=] n, STEPMUL [=] n
+    do {
+        bool isPause = isOptionWord("PAUSE");
+        if (!isPause && !isOptionWord("STEPMUL")) {
+            error("Expected PAUSE or STEPMUL after OPTION GC");
+            return;
+        }
+        advance();
+        match(TokenType::EQUAL);
+        if (current().type != TokenType::NUMBER) {
+            error(std::string("Expected number after OPTION GC ") + (isPause ? "PAUSE" : "STEPMUL"));
+            return;
+        }
+        int value = static_cast<int>(current().numberValue);
+        advance();
+        if (value <= 0) {
+            error(std::string("OPTION GC ") + (isPause ? "PAUSE" : "STEPMUL") + " must be positive");
+            continue;
+        }
+        (isPause ? m_options.gcPause : m_options.gcStepMul) = value;
+    } while (match(TokenType::COMMA));
+}
+
 void Parser::validateStringLiterals() {
     // Validate all string literals in the token stream
     // In ASCII mode, string literals with non-ASCII characters are errors
@@ -699,6 +824,15 @@ StatementPtr Parser::parseStatement() {
             return parseRedimStatement();
         case TokenType::ERASE:
             return parseEraseStatement();
+        case TokenType::APPEND:
+        case TokenType::PUSH:
+            return parseAppendStatement();
+        case TokenType::POP:
+            return parsePopStatement();
+        case TokenType::REMOVE:
+            return parseRemoveStatement();
+        case TokenType::KEYS:
+            return parseKeysStatement();
         case TokenType::SWAP:
             return parseSwapStatement();
         case TokenType::INC:
@@ -2450,12 +2584,17 @@ StatementPtr Parser::parseDimStatement() {
         bool hasIndices = false;
         if (match(TokenType::LPAREN)) {
             hasIndices = true;
-            // Parse dimensions
-            do {
-                stmt->addDimension(parseExpression());
-            } while (match(TokenType::COMMA));
+            if (match(TokenType::RPAREN)) {
+                // DIM A(): empty 1-D array, filled with APPEND/PUSH
+                stmt->arrays.back().growable = true;
+            } else {
+                // Parse dimensions
+                do {
+                    stmt->addDimension(parseExpression());
+                } while (match(TokenType::COMMA));
 
-            consume(TokenType::RPAREN, "Expected ')' after array dimensions");
+                consume(TokenType::RPAREN, "Expected ')' after array dimensions");
+            }
         }
         // Otherwise it's a scalar variable (no dimensions)
 
@@ -2476,6 +2615,11 @@ StatementPtr Parser::parseDimStatement() {
                 if (!stmt->arrays.empty()) {
                     stmt->arrays.back().typeSuffix = mergeTypes(suffix, convertedType, varName);
                 }
+            } else if (current().type == TokenType::IDENTIFIER && !hasIndices &&
+                       isDictTypeName(current().value)) {
+                // DIM D AS DICT: the name's suffix gives the value type
+                advance();
+                stmt->arrays.back().isDict = true;
             } else if (current().type == TokenType::IDENTIFIER) {
                 // User-defined type
                 std::string userTypeName = current().value;
@@ -2560,6 +2704,92 @@ StatementPtr Parser::parseEraseStatement() {
     return stmt;
 }
 
+StatementPtr Parser::parseAppendStatement() {
+    advance(); // consume APPEND/PUSH
+
+    if (current().type != TokenType::IDENTIFIER) {
+        error("Expected array name in APPEND statement");
+        return std::make_unique<RemStatement>("");
+    }
+
+    TokenType suffix = TokenType::UNKNOWN;
+    std::string arrayName = parseVariableName(suffix);
+
+    // Optional () after the name: APPEND A(), value
+    if (match(TokenType::LPAREN)) {
+        consume(TokenType::RPAREN, "Expected ')' after array name in APPEND");
+    }
+
+    if (!match(TokenType::COMMA)) {
+        error("Expected comma between array and value in APPEND");
+        return std::make_unique<RemStatement>("");
+    }
+
+    return std::make_unique<AppendStatement>(arrayName, parseExpression());
+}
+
+StatementPtr Parser::parsePopStatement() {
+    advance(); // consume POP
+
+    if (current().type != TokenType::IDENTIFIER) {
+        error("Expected array name in POP statement");
+        return std::make_unique<RemStatement>("");
+    }
+
+    TokenType suffix = TokenType::UNKNOWN;
+    std::string arrayName = parseVariableName(suffix);
+
+    if (match(TokenType::LPAREN)) {
+        consume(TokenType::RPAREN, "Expected ')' after array name in POP");
+    }
+
+    return std::make_unique<PopStatement>(arrayName);
+}
+
+StatementPtr Parser::parseRemoveStatement() {
+    advance(); // consume REMOVE
+
+    if (current().type != TokenType::IDENTIFIER) {
+        error("Expected dictionary name in REMOVE statement");
+        return std::make_unique<RemStatement>("");
+    }
+
+    TokenType suffix = TokenType::UNKNOWN;
+    std::string dictName = parseVariableName(suffix);
+
+    if (!match(TokenType::COMMA)) {
+        error("Expected comma between dictionary and key in REMOVE");
+        return std::make_unique<RemStatement>("");
+    }
+
+    return std::make_unique<RemoveStatement>(dictName, parseExpression());
+}
+
+StatementPtr Parser::parseKeysStatement() {
+    advance(); // consume KEYS
+
+    if (current().type != TokenType::IDENTIFIER) {
+        error("Expected dictionary name in KEYS statement");
+        return std::make_unique<RemStatement>("");
+    }
+
+    TokenType dictSuffix = TokenType::UNKNOWN;
+    std::string dictName = parseVariableName(dictSuffix);
+
+    if (!match(TokenType::COMMA) || current().type != TokenType::IDENTIFIER) {
+        error("Expected KEYS dictionary, array");
+        return std::make_unique<RemStatement>("");
+    }
+
+    TokenType arraySuffix = TokenType::UNKNOWN;
+    std::string arrayName = parseVariableName(arraySuffix);
+    if (match(TokenType::LPAREN)) {
+        consume(TokenType::RPAREN, "Expected ')' after array name in KEYS");
+    }
+
+    return std::make_unique<KeysStatement>(dictName, arrayName);
+}
+
 StatementPtr Parser::parseSwapStatement() {
     advance(); // consume SWAP
 
@@ -2947,7 +3177,18 @@ StatementPtr Parser::parseReadStatement() {
 
         TokenType suffix = TokenType::UNKNOWN;
         std::string varName = parseVariableName(suffix);
-        stmt->addVariable(varName);
+
+        // Array element target: READ A(I) or READ M(R, C)
+        if (match(TokenType::LPAREN)) {
+            std::vector<ExpressionPtr> elementIndices;
+            do {
+                elementIndices.push_back(parseExpression());
+            } while (match(TokenType::COMMA));
+            consume(TokenType::RPAREN, "Expected ')' after array indices");
+            stmt->addElement(varName, std::move(elementIndices));
+        } else {
+            stmt->addVariable(varName);
+        }
 
     } while (match(TokenType::COMMA));
 
@@ -3030,10 +3271,13 @@ StatementPtr Parser::parseOpenStatement() {
     }
 
     // Parse mode (INPUT, OUTPUT, APPEND, RANDOM)
-    // INPUT is a keyword token, others are identifiers
+    // INPUT and APPEND are keyword tokens, others are identifiers
     if (current().type == TokenType::INPUT) {
         stmt->mode = "INPUT";
         advance();
+    } else if (current().type == TokenType::APPEND) {
+        stmt->mode = "APPEND";
+        advance();
     } else if (current().type == TokenType::IDENTIFIER) {
         stmt->mode = current().value;
         advance();
@@ -3285,8 +3529,17 @@ StatementPtr Parser::parseOptionStatement() {
             error("Expected ON or OFF after OPTION CANCELLABLE");
             return nullptr;
         }
+    } else if (current().type == TokenType::FORCE_YIELD || isOptionWord("JIT") || isOptionWord("GC")) {
+        // Settings were read by collectOptionsFromTokens(); skip them here
+        OptionStatement::OptionType type =
+            current().type == TokenType::FORCE_YIELD ? OptionStatement::OptionType::FORCE_YIELD :
+            isOptionWord("JIT") ? OptionStatement::OptionType::JIT : OptionStatement::OptionType::GC;
+        while (!isAtEnd() && current().type != TokenType::END_OF_LINE && current().type != TokenType::COLON) {
+            advance();
+        }
+        return std::make_unique<OptionStatement>(type);
     } else {
-        error("Unknown OPTION type. Expected BITWISE, LOGICAL, BASE, EXPLICIT, UNICODE, ERROR, or CANCELLABLE");
+        error("Unknown OPTION type. Expected BITWISE, LOGICAL, BASE, EXPLICIT, UNICODE, ERROR, CANCELLABLE, FORCE_YIELD, JIT, or GC");
         return nullptr;
     }
 }
@@ -4256,6 +4509,25 @@ ExpressionPtr Parser::parsePrimary() {
         return call;
     }
 
+    // POP(A): remove and return the last element of a 1-D array.
+    // Represented like UBOUND(A), as a call with the array name as argument
+    if (match(TokenType::POP)) {
+        consume(TokenType::LPAREN, "Expected '(' after POP");
+        auto call = std::make_unique<ArrayAccessExpression>("POP");
+        if (current().type != TokenType::IDENTIFIER) {
+            error("Expected array name in POP()");
+            return std::make_unique<NumberExpression>(0);
+        }
+        TokenType suffix = TokenType::UNKNOWN;
+        std::string arrayName = parseVariableName(suffix);
+        if (match(TokenType::LPAREN)) {
+            consume(TokenType::RPAREN, "Expected ')' after array name in POP");
+        }
+        call->addIndex(std::make_unique<VariableExpression>(arrayName, suffix));
+        consume(TokenType::RPAREN, "Expected ')' after POP argument");
+        return call;
+    }
+
     // IIF (Immediate IF) function - inline conditional expression
     if (match(TokenType::IIF)) {
         consume(TokenType::LPAREN, "Expected '(' after IIF");
@@ -4351,12 +4623,8 @@ ExpressionPtr Parser::parseRegistryFunctionExpression() {
     std::string functionName = current().value;
     advance(); // consume the function token
 
-    // Ensure the global registry is initialized
-    FasterBASIC::ModularCommands::initializeGlobalRegistry();
-
     // Get the function definition from the registry
-    auto& registry = FasterBASIC::ModularCommands::getGlobalCommandRegistry();
-    const auto* functionDef = registry.getFunction(functionName);
+    const auto* functionDef = commandTable().getFunction(functionName);
 
     if (!functionDef) {
         error("Unknown registry function: " + functionName);
@@ -4566,6 +4834,12 @@ bool Parser::isTypeKeyword(TokenType type) const {
            type == TokenType::KEYWORD_LONG;
 }
 
+bool Parser::isDictTypeName(const std::string& name) const {
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    return upper == "DICT";
+}
+
 // Convert AS type keyword to equivalent type suffix
 TokenType Parser::asTypeToSuffix(TokenType asType) const {
     switch (asType) {
@@ -5192,12 +5466,8 @@ StatementPtr Parser::parseRegistryCommandStatement() {
     std::string commandName = current().value;
     advance(); // consume the command token
 
-    // Ensure the global registry is initialized
-    FasterBASIC::ModularCommands::initializeGlobalRegistry();
-
     // Get the command definition from the registry
-    auto& registry = FasterBASIC::ModularCommands::getGlobalCommandRegistry();
-    const auto* commandDef = registry.getCommand(commandName);
+    const auto* commandDef = commandTable().getCommand(commandName);
 
     if (!commandDef) {
         error("Unknown registry command: " + commandName);
@@ -5265,7 +5535,11 @@ StatementPtr Parser::parseRegistryCommandStatement() {
     // Check for optional parentheses around argument list
     bool hasParens = match(TokenType::LPAREN);
 
-    if (totalParams > 0) {
+    // A command whose parameters are all optional may be used bare (RANDOMIZE)
+    bool noArguments = isAtEnd() || check(TokenType::END_OF_LINE) || check(TokenType::COLON) ||
+                       check(TokenType::ELSE) || (hasParens && check(TokenType::RPAREN));
+
+    if (totalParams > 0 && !(requiredParams == 0 && noArguments)) {
         // Parse first parameter
         auto expr = parseExpression();
         if (commandDef->parameters.size() > 0) {
@@ -22,6 +22,10 @@
 #include <set>
 namespace FasterBASIC {
 
+namespace ModularCommands {
+class RegistrySnapshot;
+}
+
 // =============================================================================
 // LineNumberMapping - Tracks BASIC line numbers to physical line mapping
 // =============================================================================
@@ -109,6 +113,12 @@ public:
     void setAllowImplicitLet(bool allow) { m_allowImplicitLet = allow; }
     void setConstantsManager(ConstantsManager* manager) { m_constantsManager = manager; }
     
+    // Frozen command registry to resolve commands and functions against
+    // (defaults to a snapshot of the global registry)
+    void setCommandTable(std::shared_ptr<const ModularCommands::RegistrySnapshot> table) {
+        m_commandTable = std::move(table);
+    }
+    
 private:
     // Token stream management
     const std::vector<Token>* m_tokens;
@@ -118,6 +128,10 @@ private:
     // Constants manager (for fast constant lookup)
     ConstantsManager* m_constantsManager;
     
+    // Registry commands and functions (lock-free snapshot)
+    std::shared_ptr<const ModularCommands::RegistrySnapshot> m_commandTable;
+    const ModularCommands::RegistrySnapshot& commandTable();
+    
     // Line number preprocessing
     LineNumberMapping m_lineNumberMapping;  // Maps physical lines to BASIC line numbers
     
@@ -204,6 +218,7 @@ private:
     // Type suffix helpers
     TokenType parseAsType();  // Parse AS INTEGER/DOUBLE/STRING/etc.
     bool isTypeKeyword(TokenType type) const;
+    bool isDictTypeName(const std::string& name) const;  // AS DICT (any case)
     TokenType asTypeToSuffix(TokenType asType) const;  // Convert AS type to suffix
     TokenType mergeTypes(TokenType suffix, TokenType asType, const std::string& varName);  // Validate and merge types
     
@@ -243,6 +258,10 @@ private:
     StatementPtr parseDimStatement();
     StatementPtr parseRedimStatement();
     StatementPtr parseEraseStatement();
+    StatementPtr parseAppendStatement();
+    StatementPtr parsePopStatement();
+    StatementPtr parseRemoveStatement();
+    StatementPtr parseKeysStatement();
     StatementPtr parseSwapStatement();
     StatementPtr parseIncStatement();
     StatementPtr parseDecStatement();
@@ -263,6 +282,9 @@ private:
     
     // Collect compiler options from OPTION statements before main parsing
     void collectOptionsFromTokens();
+    void collectJitOption();
+    void collectGcOption();
+    bool isOptionWord(const char* word) const;
     
     // Validate string literals based on Unicode mode (called after collectOptionsFromTokens)
     void validateStringLiterals();
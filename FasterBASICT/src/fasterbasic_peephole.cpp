@@ -186,9 +186,8 @@ bool PeepholeConstantFoldingPass::canFold(IROpcode op) const {
         case IROpcode::LE:
         case IROpcode::GT:
         case IROpcode::GE:
-        case IROpcode::AND:
-        case IROpcode::OR:
             return true;
+        // AND/OR are bitwise at run time; a logical fold gets 12 AND 10 wrong
         default:
             return false;
     }
@@ -209,8 +208,6 @@ double PeepholeConstantFoldingPass::foldOperation(IROpcode op, double a, double
         case IROpcode::LE: return (a <= b) ? -1.0 : 0.0;
         case IROpcode::GT: return (a > b) ? -1.0 : 0.0;
         case IROpcode::GE: return (a >= b) ? -1.0 : 0.0;
-        case IROpcode::AND: return (a != 0.0 && b != 0.0) ? -1.0 : 0.0;
-        case IROpcode::OR: return (a != 0.0 || b != 0.0) ? -1.0 : 0.0;
         default: return 0.0;
     }
 }
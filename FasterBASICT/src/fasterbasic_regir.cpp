@@ -0,0 +1,457 @@
+//
+// fasterbasic_regir.cpp
+// FasterBASIC - Register IR Implementation
+//
+// Depth analysis over the stack IR and the three-address listing built
+// from it. See fasterbasic_regir.h.
+//
+
+#include "fasterbasic_regir.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+namespace FasterBASIC {
+
+// =============================================================================
+// Stack Effects
+// =============================================================================
+
+static int intOperand(const IROperand& operand, int fallback = 0) {
+    return std::holds_alternative<int>(operand) ? std::get<int>(operand) : fallback;
+}
+
+StackEffect stackEffect(const IRInstruction& instr) {
+    switch (instr.opcode) {
+        case IROpcode::PUSH_INT:
+        case IROpcode::PUSH_FLOAT:
+        case IROpcode::PUSH_DOUBLE:
+        case IROpcode::PUSH_STRING:
+        case IROpcode::LOAD_VAR:
+        case IROpcode::LOAD_CONST:
+        case IROpcode::LBOUND_ARRAY:
+        case IROpcode::UBOUND_ARRAY:
+        case IROpcode::ARRAY_LEN:
+        case IROpcode::DICT_COUNT:
+        case IROpcode::READ_DATA_VALUE:
+        case IROpcode::CREATE_RECORD:
+            return {0, 1};
+
+        case IROpcode::POP:
+        case IROpcode::STORE_VAR:
+        case IROpcode::FILL_ARRAY:
+        case IROpcode::ARRAY_APPEND:
+        case IROpcode::DICT_REMOVE:
+        case IROpcode::ARRAY_ADD_SCALAR:
+        case IROpcode::ARRAY_SUB_SCALAR:
+        case IROpcode::ARRAY_MUL_SCALAR:
+        case IROpcode::ARRAY_DIV_SCALAR:
+        case IROpcode::SIMD_PAIR_ARRAY_SCALE:
+        case IROpcode::SIMD_PAIR_ARRAY_ADD_SCALAR:
+        case IROpcode::SIMD_PAIR_ARRAY_SUB_SCALAR:
+        case IROpcode::SIMD_QUAD_ARRAY_SCALE:
+        case IROpcode::SIMD_QUAD_ARRAY_ADD_SCALAR:
+        case IROpcode::SIMD_QUAD_ARRAY_SUB_SCALAR:
+        case IROpcode::JUMP_IF_TRUE:
+        case IROpcode::JUMP_IF_FALSE:
+        case IROpcode::ON_GOTO:
+        case IROpcode::ON_GOSUB:
+        case IROpcode::ON_CALL:
+        case IROpcode::IF_START:
+        case IROpcode::ELSEIF_START:
+        case IROpcode::RETURN_VALUE:
+        case IROpcode::PRINT:
+        case IROpcode::CONSOLE:
+        case IROpcode::PRINT_FILE:
+        case IROpcode::WRITE_FILE:
+        case IROpcode::FOR_IN_INIT:
+        case IROpcode::REPEAT_END:
+        case IROpcode::DO_WHILE_START:
+        case IROpcode::DO_UNTIL_START:
+        case IROpcode::DO_LOOP_WHILE:
+        case IROpcode::DO_LOOP_UNTIL:
+        case IROpcode::AFTER_TIMER:
+        case IROpcode::EVERY_TIMER:
+        case IROpcode::AFTER_FRAMES:
+        case IROpcode::EVERY_FRAMES:
+            return {1, 0};
+
+        case IROpcode::DUP:
+            return {1, 2};
+
+        case IROpcode::NEG:
+        case IROpcode::NOT:
+        case IROpcode::CONV_TO_INT:
+        case IROpcode::CONV_TO_FLOAT:
+        case IROpcode::CONV_TO_STRING:
+        case IROpcode::LOAD_MEMBER:
+        case IROpcode::DICT_GET:
+        case IROpcode::DICT_HAS:
+            return {1, 1};
+
+        case IROpcode::ADD:
+        case IROpcode::SUB:
+        case IROpcode::MUL:
+        case IROpcode::DIV:
+        case IROpcode::IDIV:
+        case IROpcode::MOD:
+        case IROpcode::POW:
+        case IROpcode::EQ:
+        case IROpcode::NE:
+        case IROpcode::LT:
+        case IROpcode::LE:
+        case IROpcode::GT:
+        case IROpcode::GE:
+        case IROpcode::AND:
+        case IROpcode::OR:
+        case IROpcode::XOR:
+        case IROpcode::EQV:
+        case IROpcode::IMP:
+        case IROpcode::STR_CONCAT:
+        case IROpcode::UNICODE_CONCAT:
+        case IROpcode::STR_LEFT:
+        case IROpcode::STR_RIGHT:
+            return {2, 1};
+
+        case IROpcode::STR_MID:
+            return {3, 1};
+
+        case IROpcode::STORE_MEMBER:
+        case IROpcode::DICT_SET:
+        case IROpcode::INPUT_AT:
+        case IROpcode::READ_DATA_ARRAY:
+            return {2, 0};
+
+        case IROpcode::MID_ASSIGN:
+        case IROpcode::FOR_INIT:
+            return {3, 0};
+
+        // Indexed accesses: operand2 (operand3 for members) is the index count
+        case IROpcode::LOAD_ARRAY:
+            return {intOperand(instr.operand2, 1), 1};
+        case IROpcode::STORE_ARRAY:
+            return {intOperand(instr.operand2, 1) + 1, 0};
+        case IROpcode::LOAD_ARRAY_MEMBER:
+            return {intOperand(instr.operand3, 1), 1};
+        case IROpcode::STORE_ARRAY_MEMBER:
+            return {intOperand(instr.operand3, 1) + 1, 0};
+        case IROpcode::DIM_ARRAY:
+        case IROpcode::REDIM_ARRAY:
+            return {intOperand(instr.operand2), 0};
+
+        case IROpcode::ARRAY_POP:
+            // operand2 = 1: POP A as a statement discards the element
+            return {0, intOperand(instr.operand2) == 1 ? 0 : 1};
+
+        // Calls: operand2 is the argument count
+        case IROpcode::CALL_BUILTIN:
+            return {intOperand(instr.operand2), instr.isStatement ? 0 : 1};
+        case IROpcode::CALL_FUNCTION:
+            // TYPE constructors are emitted with the string "0"
+            return {intOperand(instr.operand2), 1};
+        case IROpcode::CALL_SUB:
+            return {intOperand(instr.operand2), 0};
+
+        // PRINT USING: format and N values; PRINT_AT adds x, y, fg and bg
+        case IROpcode::PRINT_USING:
+            return {intOperand(instr.operand1) + 1, 0};
+        case IROpcode::PRINT_AT:
+            return {intOperand(instr.operand1) + 4, 0};
+        case IROpcode::PRINT_AT_USING:
+            return {intOperand(instr.operand1) + 5, 0};
+
+        // A serialized condition string is evaluated by the loop itself
+        case IROpcode::WHILE_START:
+            return {std::holds_alternative<std::string>(instr.operand1) ? 0 : 1, 0};
+
+        // With an operand the timer is named; otherwise its id is on the stack
+        case IROpcode::TIMER_STOP:
+        case IROpcode::TIMER_INTERVAL:
+            return {std::holds_alternative<std::monostate>(instr.operand1) ? 1 : 0, 0};
+
+        default:
+            return {0, 0};
+    }
+}
+
+// =============================================================================
+// Flow Analysis
+// =============================================================================
+
+static std::string labelKey(const IROperand& operand) {
+    if (std::holds_alternative<int>(operand)) {
+        return std::to_string(std::get<int>(operand));
+    } else if (std::holds_alternative<std::string>(operand)) {
+        return std::get<std::string>(operand);
+    }
+    return "";
+}
+
+static bool isFunctionStart(IROpcode opcode) {
+    return opcode == IROpcode::DEFINE_FUNCTION || opcode == IROpcode::DEFINE_SUB;
+}
+
+static bool isFunctionEnd(IROpcode opcode) {
+    return opcode == IROpcode::END_FUNCTION || opcode == IROpcode::END_SUB;
+}
+
+bool isTerminator(IROpcode opcode) {
+    switch (opcode) {
+        case IROpcode::JUMP:
+        case IROpcode::RETURN_GOSUB:
+        case IROpcode::RETURN_VALUE:
+        case IROpcode::RETURN_VOID:
+        case IROpcode::EXIT_FUNCTION:
+        case IROpcode::EXIT_SUB:
+        case IROpcode::END:
+        case IROpcode::HALT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool RegisterIR::fail(size_t index, const std::string& message) {
+    m_valid = false;
+    m_error = "IR[" + std::to_string(index) + "]: " + message;
+    return false;
+}
+
+bool RegisterIR::build(const IRCode& code) {
+    const auto& instrs = code.instructions;
+    const size_t count = instrs.size();
+
+    m_depth.assign(count, -1);
+    m_instructions.clear();
+    m_regions.clear();
+    m_valid = true;
+    m_error.clear();
+
+    std::unordered_map<std::string, size_t> labels;
+    for (size_t i = 0; i < count; i++) {
+        if (instrs[i].opcode == IROpcode::LABEL) {
+            labels[labelKey(instrs[i].operand1)] = i;
+        }
+    }
+
+    // FUNCTION/SUB bodies are separate regions: the main program flows
+    // around them, and their header (parameter count and names, pushed as
+    // metadata) is not code
+    std::vector<size_t> skipTo(count, 0);
+    std::vector<int> regionOf(count, 0);
+    m_regions.push_back({"main", 0, count, 0});
+    std::vector<size_t> open;
+    for (size_t i = 0; i < count; i++) {
+        const auto& instr = instrs[i];
+        if (isFunctionStart(instr.opcode)) {
+            open.push_back(i);
+            size_t body = i + 1;
+            if (body < count && instrs[body].opcode == IROpcode::PUSH_INT) {
+                int params = intOperand(instrs[body].operand1);
+                body++;
+                for (int p = 0; p < params && body < count; body++) {
+                    if (instrs[body].opcode == IROpcode::PUSH_STRING) {
+                        p++;
+                    }
+                }
+                while (body < count && instrs[body].opcode == IROpcode::PARAM_BYREF) {
+                    body++;
+                }
+            }
+            RegRegion region;
+            region.name = labelKey(instr.operand1);
+            region.begin = body;
+            region.end = body;
+            region.registerCount = 0;
+            m_regions.push_back(region);
+            for (size_t h = i; h < body && h < count; h++) {
+                regionOf[h] = -1;
+            }
+            i = body - 1;
+        } else if (isFunctionEnd(instr.opcode) && !open.empty()) {
+            size_t start = open.back();
+            open.pop_back();
+            skipTo[start] = i + 1;
+            for (auto& region : m_regions) {
+                if (region.begin > start && region.begin <= i + 1 && region.end == region.begin &&
+                    region.name == labelKey(instrs[start].operand1)) {
+                    region.end = i + 1;
+                    break;
+                }
+            }
+        }
+    }
+    for (size_t r = 1; r < m_regions.size(); r++) {
+        for (size_t i = m_regions[r].begin; i < m_regions[r].end; i++) {
+            if (regionOf[i] == 0) {
+                regionOf[i] = static_cast<int>(r);
+            }
+        }
+    }
+
+    // Next instruction of the same region, stepping over nested definitions
+    auto nextOf = [&](size_t i) {
+        size_t next = i + 1;
+        while (next < count && isFunctionStart(instrs[next].opcode) && skipTo[next] > next) {
+            next = skipTo[next];
+        }
+        return next;
+    };
+
+    std::vector<size_t> worklist;
+    auto reach = [&](size_t from, size_t target, int depth) {
+        if (target >= count || regionOf[target] < 0) {
+            return true;
+        }
+        if (regionOf[target] != regionOf[from]) {
+            return fail(from, "jump leaves its FUNCTION/SUB");
+        }
+        if (m_depth[target] < 0) {
+            m_depth[target] = depth;
+            worklist.push_back(target);
+        } else if (m_depth[target] != depth) {
+            return fail(target, "reached at stack depth " + std::to_string(m_depth[target]) +
+                                " and " + std::to_string(depth));
+        }
+        return true;
+    };
+    auto reachLabel = [&](size_t from, const std::string& key, int depth) {
+        auto it = labels.find(key);
+        return it == labels.end() || reach(from, it->second, depth);
+    };
+
+    auto propagate = [&]() {
+        while (!worklist.empty() && m_valid) {
+            size_t i = worklist.back();
+            worklist.pop_back();
+            const auto& instr = instrs[i];
+            if (isFunctionEnd(instr.opcode)) {
+                continue;
+            }
+
+            StackEffect effect = stackEffect(instr);
+            int depth = m_depth[i] - effect.pops;
+            if (depth < 0) {
+                fail(i, std::string(opcodeToString(instr.opcode)) + " pops an empty stack");
+                return;
+            }
+            depth += effect.pushes;
+
+            switch (instr.opcode) {
+                case IROpcode::JUMP:
+                case IROpcode::JUMP_IF_TRUE:
+                case IROpcode::JUMP_IF_FALSE:
+                case IROpcode::CALL_GOSUB:
+                    reachLabel(i, labelKey(instr.operand1), depth);
+                    break;
+                case IROpcode::ON_GOTO:
+                case IROpcode::ON_GOSUB: {
+                    std::istringstream targets(labelKey(instr.operand1));
+                    std::string target;
+                    while (std::getline(targets, target, ',')) {
+                        reachLabel(i, target, depth);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+            if (!isTerminator(instr.opcode)) {
+                reach(i, nextOf(i), depth);
+            }
+        }
+    };
+
+    // Region entries first, then whatever is only reachable from dead code
+    for (const auto& region : m_regions) {
+        size_t entry = region.begin;
+        while (entry < region.end && regionOf[entry] < 0) {
+            entry++;
+        }
+        if (entry < region.end && m_depth[entry] < 0) {
+            m_depth[entry] = 0;
+            worklist.push_back(entry);
+            propagate();
+        }
+    }
+    for (size_t i = 0; i < count && m_valid; i++) {
+        if (m_depth[i] < 0 && regionOf[i] >= 0 && !isFunctionStart(instrs[i].opcode)) {
+            m_depth[i] = 0;
+            worklist.push_back(i);
+            propagate();
+        }
+    }
+    if (!m_valid) {
+        return false;
+    }
+
+    // Three-address form
+    for (size_t i = 0; i < count; i++) {
+        if (m_depth[i] < 0) {
+            continue;
+        }
+        StackEffect effect = stackEffect(instrs[i]);
+        RegInstruction reg;
+        reg.index = i;
+        reg.depth = m_depth[i];
+        int base = m_depth[i] - effect.pops;
+        for (int k = 1; k <= effect.pops; k++) {
+            reg.sources.push_back(base + k);
+        }
+        for (int k = 1; k <= effect.pushes; k++) {
+            reg.dests.push_back(base + k);
+        }
+        auto& region = m_regions[regionOf[i]];
+        region.registerCount = std::max(region.registerCount, std::max(m_depth[i], base + effect.pushes));
+        m_instructions.push_back(std::move(reg));
+    }
+
+    return true;
+}
+
+int RegisterIR::getMaxRegisters() const {
+    int registers = 0;
+    for (const auto& region : m_regions) {
+        registers = std::max(registers, region.registerCount);
+    }
+    return registers;
+}
+
+// =============================================================================
+// Listing
+// =============================================================================
+
+std::string RegisterIR::toString(const IRCode& code) const {
+    std::ostringstream oss;
+    if (!m_valid) {
+        oss << "; register IR unavailable: " << m_error << "\n";
+        return oss.str();
+    }
+
+    for (const auto& region : m_regions) {
+        oss << "; " << region.name << " (" << region.registerCount << " registers)\n";
+    }
+
+    for (const auto& reg : m_instructions) {
+        const auto& instr = code.instructions[reg.index];
+        oss << std::setw(5) << std::setfill('0') << reg.index << ": ";
+        for (size_t k = 0; k < reg.dests.size(); k++) {
+            oss << (k > 0 ? ", " : "") << "r" << reg.dests[k];
+        }
+        if (!reg.dests.empty()) {
+            oss << " = ";
+        }
+        std::string text = instr.toString();
+        oss << text;
+        for (size_t k = 0; k < reg.sources.size(); k++) {
+            oss << (k > 0 ? ", " : (text.find(' ') != std::string::npos ? ", " : " "))
+                << "r" << reg.sources[k];
+        }
+        oss << "\n";
+    }
+
+    return oss.str();
+}
+
+} // namespace FasterBASIC
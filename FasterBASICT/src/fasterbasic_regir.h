@@ -0,0 +1,98 @@
+//
+// fasterbasic_regir.h
+// FasterBASIC - Register IR
+//
+// Lowers the stack IR to a three-address form over virtual registers.
+// Register k is stack slot k: a flow analysis assigns every instruction its
+// stack depth on entry, so each pop reads a known register and each push
+// writes one. The Lua backend turns the registers into locals instead of a
+// runtime stack, and later passes get an explicit operand model.
+//
+
+#ifndef FASTERBASIC_REGIR_H
+#define FASTERBASIC_REGIR_H
+
+#include "fasterbasic_ircode.h"
+#include <string>
+#include <vector>
+
+namespace FasterBASIC {
+
+// =============================================================================
+// Stack Effects
+// =============================================================================
+
+struct StackEffect {
+    int pops;    // Values consumed (top of stack first)
+    int pushes;  // Values produced
+};
+
+// Values an instruction takes from and leaves on the stack
+StackEffect stackEffect(const IRInstruction& instr);
+
+// Control never reaches the next instruction (JUMP, RETURN, END, ...)
+bool isTerminator(IROpcode opcode);
+
+// =============================================================================
+// Register Instructions
+// =============================================================================
+
+// One IR instruction with its stack operands named
+struct RegInstruction {
+    size_t index;               // Position in IRCode::instructions
+    int depth;                  // Stack depth on entry
+    std::vector<int> sources;   // Registers read, bottom of stack first
+    std::vector<int> dests;     // Registers written, bottom of stack first
+};
+
+// Main program or one FUNCTION/SUB body; registers are local to a region
+struct RegRegion {
+    std::string name;           // "main" or the FUNCTION/SUB name
+    size_t begin;               // First body instruction
+    size_t end;                 // One past END_FUNCTION/END_SUB (main: the code size)
+    int registerCount;          // Highest register used
+};
+
+// =============================================================================
+// Register IR
+// =============================================================================
+
+class RegisterIR {
+public:
+    RegisterIR() = default;
+
+    // Analyze code; false if some join point is reached at two depths or an
+    // instruction pops an empty stack (the stack form is then kept)
+    bool build(const IRCode& code);
+
+    bool isValid() const { return m_valid; }
+    const std::string& getError() const { return m_error; }
+
+    // Stack depth on entry to an instruction, -1 if it is not analyzed
+    // (function headers, unreachable code)
+    int depthAt(size_t index) const {
+        return index < m_depth.size() ? m_depth[index] : -1;
+    }
+
+    const std::vector<RegInstruction>& getInstructions() const { return m_instructions; }
+    const std::vector<RegRegion>& getRegions() const { return m_regions; }
+
+    // Largest register count over all regions
+    int getMaxRegisters() const;
+
+    // Listing in three-address form, e.g. "r1 = ADD r1, r2"
+    std::string toString(const IRCode& code) const;
+
+private:
+    std::vector<int> m_depth;
+    std::vector<RegInstruction> m_instructions;
+    std::vector<RegRegion> m_regions;
+    bool m_valid = false;
+    std::string m_error;
+
+    bool fail(size_t index, const std::string& message);
+};
+
+} // namespace FasterBASIC
+
+#endif // FASTERBASIC_REGIR_H
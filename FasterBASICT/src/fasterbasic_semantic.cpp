@@ -140,9 +140,6 @@ SemanticAnalyzer::SemanticAnalyzer()
 {
     initializeBuiltinFunctions();
     
-    // Load additional functions from the global command registry
-    loadFromCommandRegistry(ModularCommands::getGlobalCommandRegistry());
-    
     m_constantsManager.addPredefinedConstants();
     
     // Register voice waveform constants (WAVE_SINE, WAVE_SQUARE, etc.)
@@ -289,6 +286,9 @@ bool SemanticAnalyzer::analyze(Program& program, const CompilerOptions& options)
     m_errors.clear();
     m_warnings.clear();
     
+    // Additional functions from the command registry
+    loadFromCommandRegistry(commandTable());
+    
     // Preserve predefined constants before resetting symbol table
     auto savedConstants = m_symbolTable.constants;
     
@@ -304,6 +304,10 @@ bool SemanticAnalyzer::analyze(Program& program, const CompilerOptions& options)
     m_symbolTable.cancellableLoops = options.cancellableLoops;
     m_symbolTable.forceYieldEnabled = options.forceYieldEnabled;
     m_symbolTable.forceYieldBudget = options.forceYieldBudget;
+    m_symbolTable.jitMode = options.jitMode;
+    m_symbolTable.jitSettings = options.jitSettings;
+    m_symbolTable.gcPause = options.gcPause;
+    m_symbolTable.gcStepMul = options.gcStepMul;
     m_cancellableLoops = options.cancellableLoops;
     
     // Clear control flow stacks
@@ -852,6 +856,16 @@ void SemanticAnalyzer::processDimStatement(const DimStatement& stmt) {
             }
         }
         
+        if (arrayDim.growable) {
+            // DIM A(): one dimension, empty (UBOUND = LBOUND - 1)
+            dimensions.push_back(m_symbolTable.arrayBase);
+            hasUnknownDimensions = true;
+        } else if (arrayDim.isDict) {
+            // DIM D AS DICT: accessed as D(key), no bounds
+            dimensions.push_back(-1);
+            hasUnknownDimensions = true;
+        }
+        
         ArraySymbol sym;
         sym.name = arrayDim.name;
         sym.type = inferTypeFromSuffix(arrayDim.typeSuffix);
@@ -865,6 +879,8 @@ void SemanticAnalyzer::processDimStatement(const DimStatement& stmt) {
         sym.totalSize = hasUnknownDimensions ? -1 : totalSize;
         // Store the AS TypeName for user-defined types
         sym.asTypeName = arrayDim.asTypeName;
+        sym.isGrowable = arrayDim.growable;
+        sym.isDict = arrayDim.isDict;
         
         m_symbolTable.arrays[arrayDim.name] = sym;
     }
@@ -1042,6 +1058,18 @@ void SemanticAnalyzer::validateStatement(const Statement& stmt) {
         case ASTNodeType::STMT_READ:
             validateReadStatement(static_cast<const ReadStatement&>(stmt));
             break;
+        case ASTNodeType::STMT_APPEND:
+            validateAppendStatement(static_cast<const AppendStatement&>(stmt));
+            break;
+        case ASTNodeType::STMT_POP:
+            validatePopStatement(static_cast<const PopStatement&>(stmt));
+            break;
+        case ASTNodeType::STMT_REMOVE:
+            validateRemoveStatement(static_cast<const RemoveStatement&>(stmt));
+            break;
+        case ASTNodeType::STMT_KEYS:
+            validateKeysStatement(static_cast<const KeysStatement&>(stmt));
+            break;
         case ASTNodeType::STMT_RESTORE:
             validateRestoreStatement(static_cast<const RestoreStatement&>(stmt));
             break;
@@ -1294,14 +1322,16 @@ void SemanticAnalyzer::validateLetStatement(const LetStatement& stmt) {
         }
     }
     
-    // Validate array indices if present
-    for (const auto& index : stmt.indices) {
-        validateExpression(*index);
-        VariableType indexType = inferExpressionType(*index);
-        if (!isNumericType(indexType)) {
-            error(SemanticErrorType::INVALID_ARRAY_INDEX,
-                  "Array index must be numeric",
-                  stmt.location);
+    // Validate array indices (or dictionary key) if present
+    if (!validateDictKeys(stmt.variable, stmt.indices, stmt.location)) {
+        for (const auto& index : stmt.indices) {
+            validateExpression(*index);
+            VariableType indexType = inferExpressionType(*index);
+            if (!isNumericType(indexType)) {
+                error(SemanticErrorType::INVALID_ARRAY_INDEX,
+                      "Array index must be numeric",
+                      stmt.location);
+            }
         }
     }
     
@@ -1334,6 +1364,38 @@ void SemanticAnalyzer::validateLetStatement(const LetStatement& stmt) {
     checkTypeCompatibility(targetType, valueType, stmt.location, "assignment");
 }
 
+void SemanticAnalyzer::validateAppendStatement(const AppendStatement& stmt) {
+    auto* arraySym = useGrowableArray(stmt.arrayName, "APPEND", stmt.location);
+    
+    validateExpression(*stmt.value);
+    if (arraySym) {
+        VariableType valueType = inferExpressionType(*stmt.value);
+        checkTypeCompatibility(arraySym->type, valueType, stmt.location, "APPEND");
+    }
+}
+
+void SemanticAnalyzer::validatePopStatement(const PopStatement& stmt) {
+    useGrowableArray(stmt.arrayName, "POP", stmt.location);
+}
+
+void SemanticAnalyzer::validateRemoveStatement(const RemoveStatement& stmt) {
+    auto* dictSym = useDict(stmt.dictName, "REMOVE", stmt.location);
+    
+    validateExpression(*stmt.key);
+    if (dictSym) {
+        checkDictKey(*dictSym, *stmt.key, stmt.location);
+    }
+}
+
+void SemanticAnalyzer::validateKeysStatement(const KeysStatement& stmt) {
+    auto* dictSym = useDict(stmt.dictName, "KEYS", stmt.location);
+    auto* arraySym = useGrowableArray(stmt.arrayName, "KEYS", stmt.location);
+    
+    if (dictSym && arraySym && dictSym->keyType != VariableType::UNKNOWN) {
+        checkTypeCompatibility(arraySym->type, dictSym->keyType, stmt.location, "KEYS");
+    }
+}
+
 void SemanticAnalyzer::validateGotoStatement(const GotoStatement& stmt) {
     if (stmt.isLabel) {
         // Symbolic label - resolve it
@@ -1546,8 +1608,24 @@ void SemanticAnalyzer::validateLoopStatement(const LoopStatement& stmt) {
 }
 
 void SemanticAnalyzer::validateReadStatement(const ReadStatement& stmt) {
-    for (const auto& varName : stmt.variables) {
-        useVariable(varName, stmt.location);
+    for (size_t i = 0; i < stmt.variables.size(); ++i) {
+        const auto& indices = stmt.indices[i];
+        if (indices.empty()) {
+            useVariable(stmt.variables[i], stmt.location);
+            continue;
+        }
+
+        if (!validateDictKeys(stmt.variables[i], indices, stmt.location)) {
+            for (const auto& index : indices) {
+                validateExpression(*index);
+                if (!isNumericType(inferExpressionType(*index))) {
+                    error(SemanticErrorType::INVALID_ARRAY_INDEX,
+                          "Array index must be numeric",
+                          stmt.location);
+                }
+            }
+        }
+        useArray(stmt.variables[i], indices.size(), stmt.location);
     }
 }
 
@@ -2107,6 +2185,30 @@ VariableType SemanticAnalyzer::inferVariableType(const VariableExpression& expr)
 }
 
 VariableType SemanticAnalyzer::inferArrayAccessType(const ArrayAccessExpression& expr) {
+    // POP(A) yields an element of A
+    if (expr.name == "POP" && expr.indices.size() == 1 &&
+        expr.indices[0]->getType() == ASTNodeType::EXPR_VARIABLE) {
+        const auto& arrayName = static_cast<const VariableExpression&>(*expr.indices[0]).name;
+        auto* arraySym = useGrowableArray(arrayName, "POP", expr.location);
+        return arraySym ? arraySym->type : VariableType::UNKNOWN;
+    }
+    
+    // HAS(D, key): TRUE if dictionary D has an entry for key
+    if (expr.indices.size() == 2 && expr.indices[0]->getType() == ASTNodeType::EXPR_VARIABLE &&
+        !lookupArray(expr.name) && m_symbolTable.functions.find(expr.name) == m_symbolTable.functions.end()) {
+        std::string upperName = expr.name;
+        std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
+        if (upperName == "HAS") {
+            const auto& dictName = static_cast<const VariableExpression&>(*expr.indices[0]).name;
+            auto* dictSym = useDict(dictName, "HAS", expr.location);
+            validateExpression(*expr.indices[1]);
+            if (dictSym) {
+                checkDictKey(*dictSym, *expr.indices[1], expr.location);
+            }
+            return VariableType::INT;
+        }
+    }
+    
     // Check if this is a function/sub call first
     if (m_symbolTable.functions.find(expr.name) != m_symbolTable.functions.end()) {
         // It's a function or sub call - validate arguments but don't treat as array
@@ -2124,6 +2226,9 @@ VariableType SemanticAnalyzer::inferArrayAccessType(const ArrayAccessExpression&
         useArray(expr.name, expr.indices.size(), expr.location);
         
         // Validate indices
+        if (validateDictKeys(expr.name, expr.indices, expr.location)) {
+            return arraySym->type;
+        }
         for (const auto& index : expr.indices) {
             validateExpression(*index);
             VariableType indexType = inferExpressionType(*index);
@@ -2501,6 +2606,83 @@ void SemanticAnalyzer::useArray(const std::string& name, size_t dimensionCount,
     }
 }
 
+// APPEND/PUSH and POP work on declared 1-D arrays, whose upper bound from
+// then on is only known at runtime
+ArraySymbol* SemanticAnalyzer::useGrowableArray(const std::string& name, const std::string& op,
+                                                const SourceLocation& loc) {
+    auto* sym = lookupArray(name);
+    if (!sym) {
+        error(SemanticErrorType::ARRAY_NOT_DECLARED,
+              "Array '" + name + "' used in " + op + " without DIM declaration",
+              loc);
+        return nullptr;
+    }
+    
+    if (sym->dimensions.size() != 1 || !sym->asTypeName.empty() || sym->isDict) {
+        error(SemanticErrorType::WRONG_DIMENSION_COUNT,
+              op + " requires a one-dimensional array of numbers or strings: '" + name + "'",
+              loc);
+        return nullptr;
+    }
+    
+    sym->isGrowable = true;
+    return sym;
+}
+
+// HAS, REMOVE, KEYS and LEN work on dictionaries declared with DIM D AS DICT
+ArraySymbol* SemanticAnalyzer::useDict(const std::string& name, const std::string& op,
+                                       const SourceLocation& loc) {
+    auto* sym = lookupArray(name);
+    if (!sym || !sym->isDict) {
+        error(SemanticErrorType::TYPE_MISMATCH,
+              op + " requires a dictionary declared with DIM " + name + " AS DICT",
+              loc);
+        return nullptr;
+    }
+    return sym;
+}
+
+// D(key) on a dictionary: validates the key and returns true; false if name
+// is not a dictionary (the caller validates numeric array indices instead)
+bool SemanticAnalyzer::validateDictKeys(const std::string& name,
+                                        const std::vector<ExpressionPtr>& keys,
+                                        const SourceLocation& loc) {
+    auto* sym = lookupArray(name);
+    if (!sym || !sym->isDict) {
+        return false;
+    }
+    
+    for (const auto& key : keys) {
+        validateExpression(*key);
+    }
+    if (keys.size() == 1) {
+        checkDictKey(*sym, *keys[0], loc);
+    }
+    return true;
+}
+
+// Keys are all strings or all numbers; the first use decides, so that the
+// code generator can pick the key representation at compile time
+void SemanticAnalyzer::checkDictKey(ArraySymbol& dict, const Expression& key,
+                                    const SourceLocation& loc) {
+    VariableType keyType = inferExpressionType(key);
+    if (keyType == VariableType::UNKNOWN) {
+        return;
+    }
+    VariableType keyClass = isNumericType(keyType) ? VariableType::DOUBLE : VariableType::STRING;
+    
+    if (dict.keyType == VariableType::UNKNOWN) {
+        dict.keyType = keyClass;
+    } else if (dict.keyType != keyClass) {
+        error(SemanticErrorType::TYPE_MISMATCH,
+              "Dictionary '" + dict.name + "' has " +
+              (dict.keyType == VariableType::STRING ? "string" : "numeric") +
+              " keys; cannot use a " +
+              (keyClass == VariableType::STRING ? "string" : "numeric") + " key",
+              loc);
+    }
+}
+
 // =============================================================================
 // Type Inference from Name/Suffix
 // =============================================================================
@@ -3026,13 +3208,18 @@ int SemanticAnalyzer::getBuiltinArgCount(const std::string& name) const {
     return 0;
 }
 
-void SemanticAnalyzer::loadFromCommandRegistry(const ModularCommands::CommandRegistry& registry) {
-    // Get all commands and functions from the registry
-    const auto& commands = registry.getAllCommands();
-    
-    for (const auto& pair : commands) {
-        const std::string& name = pair.first;
-        const ModularCommands::CommandDefinition& def = pair.second;
+const ModularCommands::RegistrySnapshot& SemanticAnalyzer::commandTable() {
+    if (!m_commandTable) {
+        m_commandTable = ModularCommands::getGlobalCommandRegistry().snapshot();
+    }
+    return *m_commandTable;
+}
+
+void SemanticAnalyzer::loadFromCommandRegistry(const ModularCommands::RegistrySnapshot& registry) {
+    // Get all commands from the registry
+    for (const auto& entry : registry.getCommands()) {
+        const std::string& name = entry.name;
+        const ModularCommands::CommandDefinition& def = *entry.definition;
         
         // Add to builtin functions map with parameter count
         // Use required parameter count (commands may have optional parameters)
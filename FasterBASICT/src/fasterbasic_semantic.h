@@ -83,9 +83,13 @@ struct ArraySymbol {
     SourceLocation declaration;
     int totalSize;          // Product of all dimensions
     std::string asTypeName; // For user-defined types (AS TypeName)
+    bool isGrowable;        // DIM A() or APPEND/POP target: UBOUND known only at runtime
+    bool isDict;            // DIM D AS DICT: D(key) maps keys to values of `type`
+    VariableType keyType;   // Dictionary keys: STRING or DOUBLE, fixed by the first use
 
     ArraySymbol()
-        : type(VariableType::UNKNOWN), isDeclared(false), totalSize(0) {}
+        : type(VariableType::UNKNOWN), isDeclared(false), totalSize(0), isGrowable(false),
+          isDict(false), keyType(VariableType::UNKNOWN) {}
 
     std::string toString() const {
         std::ostringstream oss;
@@ -276,6 +280,10 @@ struct SymbolTable {
     bool eventsUsed = false;  // EVENT DETECTION: if true, program uses ON EVENT statements and needs event processing code
     bool forceYieldEnabled = false;  // OPTION FORCE_YIELD: if true, enable quasi-preemptive handler yielding
     int forceYieldBudget = 10000;  // OPTION FORCE_YIELD budget: instructions before forced yield
+    int jitMode = -1;  // OPTION JIT ON/OFF: -1 = leave as configured, 0 = off, 1 = on
+    std::vector<std::string> jitSettings;  // OPTION JIT: jit.opt.start() arguments
+    int gcPause = 0;  // OPTION GC PAUSE: 0 = collector default
+    int gcStepMul = 0;  // OPTION GC STEPMUL: 0 = collector default
 
     std::string toString() const;
 };
@@ -369,12 +377,18 @@ public:
     void ensureConstantsLoaded();
 
     // Load functions from command registry
-    void loadFromCommandRegistry(const ModularCommands::CommandRegistry& registry);
+    void loadFromCommandRegistry(const ModularCommands::RegistrySnapshot& registry);
     const ConstantsManager& getConstantsManager() const { return m_constantsManager; }
 
     // Configuration
     void setStrictMode(bool strict) { m_strictMode = strict; }
     void setWarnUnused(bool warn) { m_warnUnused = warn; }
+    
+    // Frozen command registry whose functions analyze() accepts
+    // (defaults to a snapshot of the global registry)
+    void setCommandTable(std::shared_ptr<const ModularCommands::RegistrySnapshot> table) {
+        m_commandTable = std::move(table);
+    }
     void setRequireExplicitDim(bool require) { m_requireExplicitDim = require; }
 
     // Register DATA labels (from preprocessor) so RESTORE can find them
@@ -446,6 +460,10 @@ private:
     void validateLoopStatement(const LoopStatement& stmt);
     void validateReadStatement(const ReadStatement& stmt);
     void validateRestoreStatement(const RestoreStatement& stmt);
+    void validateAppendStatement(const AppendStatement& stmt);
+    void validatePopStatement(const PopStatement& stmt);
+    void validateRemoveStatement(const RemoveStatement& stmt);
+    void validateKeysStatement(const KeysStatement& stmt);
     void validateExpressionStatement(const ExpressionStatement& stmt);
     void validateOnEventStatement(const OnEventStatement& stmt);
     
@@ -501,6 +519,11 @@ private:
     // Variable/array usage tracking
     void useVariable(const std::string& name, const SourceLocation& loc);
     void useArray(const std::string& name, size_t dimensionCount, const SourceLocation& loc);
+    ArraySymbol* useGrowableArray(const std::string& name, const std::string& op, const SourceLocation& loc);
+    ArraySymbol* useDict(const std::string& name, const std::string& op, const SourceLocation& loc);
+    bool validateDictKeys(const std::string& name, const std::vector<ExpressionPtr>& keys,
+                          const SourceLocation& loc);
+    void checkDictKey(ArraySymbol& dict, const Expression& key, const SourceLocation& loc);
 
     // Type suffix handling
     VariableType inferTypeFromSuffix(TokenType suffix);
@@ -539,6 +562,10 @@ private:
     std::vector<SemanticError> m_errors;
     std::vector<SemanticWarning> m_warnings;
     ConstantsManager m_constantsManager;
+    
+    // Registry commands and functions (lock-free snapshot)
+    std::shared_ptr<const ModularCommands::RegistrySnapshot> m_commandTable;
+    const ModularCommands::RegistrySnapshot& commandTable();
 
     // Configuration
     bool m_strictMode;
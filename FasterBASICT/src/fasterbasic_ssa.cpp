@@ -0,0 +1,1447 @@
+//
+// fasterbasic_ssa.cpp
+// FasterBASIC - SSA Form and Global Value Numbering Implementation
+//
+// Blocks and edges from the structured and unstructured control opcodes,
+// dominators after Cooper, Harvey and Kennedy, phis on iterated dominance
+// frontiers (Cytron et al.), then value numbering in one walk of the
+// dominator tree. See fasterbasic_ssa.h.
+//
+
+#include "fasterbasic_ssa.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace FasterBASIC {
+
+// =============================================================================
+// Instruction Classes
+// =============================================================================
+
+static std::string labelKey(const IROperand& operand) {
+    if (std::holds_alternative<int>(operand)) {
+        return std::to_string(std::get<int>(operand));
+    } else if (std::holds_alternative<std::string>(operand)) {
+        return std::get<std::string>(operand);
+    }
+    return "";
+}
+
+static std::string stringOperand(const IROperand& operand) {
+    return std::holds_alternative<std::string>(operand) ? std::get<std::string>(operand) : "";
+}
+
+static std::vector<std::string> labelList(const IROperand& operand) {
+    std::vector<std::string> labels;
+    std::istringstream targets(labelKey(operand));
+    std::string target;
+    while (std::getline(targets, target, ',')) {
+        labels.push_back(target);
+    }
+    return labels;
+}
+
+// Lua name of a BASIC variable, as the backend spells it
+static std::string mangledName(const std::string& name) {
+    std::string mangled = name;
+    for (char& c : mangled) {
+        if (!std::isalnum(static_cast<unsigned char>(c))) c = '_';
+    }
+    return mangled;
+}
+
+// Builtins whose result depends only on their arguments
+static bool isPureBuiltin(const std::string& name) {
+    static const std::unordered_set<std::string> pure = [] {
+        std::unordered_set<std::string> names = {
+            "SIN", "COS", "TAN", "ATN", "SQR", "ACS", "ASN", "DEG", "RAD", "SGN",
+            "FIX", "LN", "LOG", "EXP", "INT", "ABS", "PI", "MOD", "SHL", "SHR",
+            "ASC", "VAL", "INSTR"
+        };
+        for (const char* base : {"CHR", "STR", "LEFT", "RIGHT", "MID", "STRING", "SPACE",
+                                 "LCASE", "UCASE", "LTRIM", "RTRIM", "TRIM", "REVERSE",
+                                 "HEX", "BIN", "OCT"}) {
+            names.insert(base);
+            names.insert(std::string(base) + "$");
+            names.insert(std::string(base) + "_STRING");
+        }
+        return names;
+    }();
+    return pure.count(name) > 0;
+}
+
+// Pushes one value computed only from its operands and variables
+static bool isPureOpcode(const IRInstruction& instr) {
+    switch (instr.opcode) {
+        case IROpcode::PUSH_INT:
+        case IROpcode::PUSH_FLOAT:
+        case IROpcode::PUSH_DOUBLE:
+        case IROpcode::PUSH_STRING:
+        case IROpcode::LOAD_VAR:
+        case IROpcode::LOAD_CONST:
+        case IROpcode::ADD:
+        case IROpcode::SUB:
+        case IROpcode::MUL:
+        case IROpcode::DIV:
+        case IROpcode::IDIV:
+        case IROpcode::MOD:
+        case IROpcode::POW:
+        case IROpcode::NEG:
+        case IROpcode::NOT:
+        case IROpcode::EQ:
+        case IROpcode::NE:
+        case IROpcode::LT:
+        case IROpcode::LE:
+        case IROpcode::GT:
+        case IROpcode::GE:
+        case IROpcode::AND:
+        case IROpcode::OR:
+        case IROpcode::XOR:
+        case IROpcode::EQV:
+        case IROpcode::IMP:
+        case IROpcode::STR_CONCAT:
+        case IROpcode::STR_LEFT:
+        case IROpcode::STR_RIGHT:
+        case IROpcode::STR_MID:
+        case IROpcode::CONV_TO_INT:
+        case IROpcode::CONV_TO_FLOAT:
+        case IROpcode::CONV_TO_STRING:
+            return true;
+        case IROpcode::CALL_BUILTIN:
+            return !instr.isStatement && isPureBuiltin(stringOperand(instr.operand1));
+        default:
+            return false;
+    }
+}
+
+static bool isNumericPush(IROpcode opcode) {
+    return opcode == IROpcode::PUSH_INT || opcode == IROpcode::PUSH_FLOAT ||
+           opcode == IROpcode::PUSH_DOUBLE;
+}
+
+// Operands may be swapped without changing the value
+static bool isCommutative(IROpcode opcode) {
+    return opcode == IROpcode::MUL || opcode == IROpcode::EQ || opcode == IROpcode::NE;
+}
+
+// Opcodes that shape control flow; none may sit inside a condition
+static bool isControl(IROpcode opcode) {
+    if (isTerminator(opcode)) return true;
+    switch (opcode) {
+        case IROpcode::LABEL:
+        case IROpcode::JUMP_IF_TRUE:
+        case IROpcode::JUMP_IF_FALSE:
+        case IROpcode::CALL_GOSUB:
+        case IROpcode::ON_GOTO:
+        case IROpcode::ON_GOSUB:
+        case IROpcode::IF_START:
+        case IROpcode::ELSEIF_START:
+        case IROpcode::ELSE_START:
+        case IROpcode::IF_END:
+        case IROpcode::FOR_INIT:
+        case IROpcode::FOR_CHECK:
+        case IROpcode::FOR_NEXT:
+        case IROpcode::FOR_IN_INIT:
+        case IROpcode::FOR_IN_CHECK:
+        case IROpcode::FOR_IN_NEXT:
+        case IROpcode::WHILE_START:
+        case IROpcode::WHILE_END:
+        case IROpcode::REPEAT_START:
+        case IROpcode::REPEAT_END:
+        case IROpcode::DO_WHILE_START:
+        case IROpcode::DO_UNTIL_START:
+        case IROpcode::DO_START:
+        case IROpcode::DO_LOOP_WHILE:
+        case IROpcode::DO_LOOP_UNTIL:
+        case IROpcode::DO_LOOP_END:
+        case IROpcode::EXIT_FOR:
+        case IROpcode::EXIT_DO:
+        case IROpcode::EXIT_WHILE:
+        case IROpcode::EXIT_REPEAT:
+        case IROpcode::END_FUNCTION:
+        case IROpcode::END_SUB:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// How an instruction changes scalar variables
+enum class VariableWrites {
+    None,       // Leaves every variable alone
+    Named,      // Writes the variables named in its string operands
+    All         // May write any variable (calls, GOSUB, unknown opcodes)
+};
+
+static VariableWrites variableWrites(const IRInstruction& instr, std::vector<std::string>& names) {
+    names.clear();
+    auto named = [&]() {
+        for (const IROperand* operand : {&instr.operand1, &instr.operand2, &instr.operand3}) {
+            std::string name = stringOperand(*operand);
+            if (!name.empty()) names.push_back(name);
+        }
+        return VariableWrites::Named;
+    };
+
+    if (isPureOpcode(instr)) return VariableWrites::None;
+
+    switch (instr.opcode) {
+        case IROpcode::STORE_VAR:
+        case IROpcode::MID_ASSIGN:
+        case IROpcode::SWAP_VAR:
+        case IROpcode::INPUT:
+        case IROpcode::INPUT_AT:
+        case IROpcode::INPUT_FILE:
+        case IROpcode::LINE_INPUT_FILE:
+        case IROpcode::FOR_INIT:
+        case IROpcode::DECLARE_LOCAL:
+        case IROpcode::DECLARE_SHARED:
+        case IROpcode::READ_DATA_ARRAY:
+            return named();
+
+        // NEXT without a variable steps whichever loop is open
+        case IROpcode::FOR_NEXT:
+            named();
+            return names.empty() ? VariableWrites::All : VariableWrites::Named;
+
+        // Arrays, dictionaries and records live outside the scalar variables
+        case IROpcode::POP:
+        case IROpcode::DUP:
+        case IROpcode::LOAD_ARRAY:
+        case IROpcode::STORE_ARRAY:
+        case IROpcode::DIM_ARRAY:
+        case IROpcode::REDIM_ARRAY:
+        case IROpcode::ERASE_ARRAY:
+        case IROpcode::LBOUND_ARRAY:
+        case IROpcode::UBOUND_ARRAY:
+        case IROpcode::FILL_ARRAY:
+        case IROpcode::FILL_ARRAY_RND:
+        case IROpcode::ARRAY_APPEND:
+        case IROpcode::ARRAY_POP:
+        case IROpcode::ARRAY_LEN:
+        case IROpcode::DICT_NEW:
+        case IROpcode::DICT_GET:
+        case IROpcode::DICT_SET:
+        case IROpcode::DICT_HAS:
+        case IROpcode::DICT_REMOVE:
+        case IROpcode::DICT_KEYS:
+        case IROpcode::DICT_COUNT:
+        case IROpcode::ARRAY_ADD:
+        case IROpcode::ARRAY_SUB:
+        case IROpcode::ARRAY_MUL:
+        case IROpcode::ARRAY_DIV:
+        case IROpcode::ARRAY_ADD_SCALAR:
+        case IROpcode::ARRAY_SUB_SCALAR:
+        case IROpcode::ARRAY_MUL_SCALAR:
+        case IROpcode::ARRAY_DIV_SCALAR:
+        case IROpcode::SIMD_PAIR_ARRAY_ADD:
+        case IROpcode::SIMD_PAIR_ARRAY_SUB:
+        case IROpcode::SIMD_PAIR_ARRAY_SCALE:
+        case IROpcode::SIMD_PAIR_ARRAY_ADD_SCALAR:
+        case IROpcode::SIMD_PAIR_ARRAY_SUB_SCALAR:
+        case IROpcode::SIMD_QUAD_ARRAY_ADD:
+        case IROpcode::SIMD_QUAD_ARRAY_SUB:
+        case IROpcode::SIMD_QUAD_ARRAY_SCALE:
+        case IROpcode::SIMD_QUAD_ARRAY_ADD_SCALAR:
+        case IROpcode::SIMD_QUAD_ARRAY_SUB_SCALAR:
+        case IROpcode::DEFINE_TYPE:
+        case IROpcode::CREATE_RECORD:
+        case IROpcode::LOAD_MEMBER:
+        case IROpcode::STORE_MEMBER:
+        case IROpcode::LOAD_ARRAY_MEMBER:
+        case IROpcode::STORE_ARRAY_MEMBER:
+        case IROpcode::UNICODE_CONCAT:
+
+        // Control flow; its effect is in the edges
+        case IROpcode::LABEL:
+        case IROpcode::JUMP:
+        case IROpcode::JUMP_IF_TRUE:
+        case IROpcode::JUMP_IF_FALSE:
+        case IROpcode::ON_GOTO:
+        case IROpcode::RETURN_GOSUB:
+        case IROpcode::IF_START:
+        case IROpcode::ELSEIF_START:
+        case IROpcode::ELSE_START:
+        case IROpcode::IF_END:
+        case IROpcode::WHILE_START:
+        case IROpcode::WHILE_END:
+        case IROpcode::REPEAT_START:
+        case IROpcode::REPEAT_END:
+        case IROpcode::DO_WHILE_START:
+        case IROpcode::DO_UNTIL_START:
+        case IROpcode::DO_START:
+        case IROpcode::DO_LOOP_WHILE:
+        case IROpcode::DO_LOOP_UNTIL:
+        case IROpcode::DO_LOOP_END:
+        case IROpcode::EXIT_FOR:
+        case IROpcode::EXIT_DO:
+        case IROpcode::EXIT_WHILE:
+        case IROpcode::EXIT_REPEAT:
+        case IROpcode::EXIT_FUNCTION:
+        case IROpcode::EXIT_SUB:
+        case IROpcode::RETURN_VALUE:
+        case IROpcode::RETURN_VOID:
+        case IROpcode::END_FUNCTION:
+        case IROpcode::END_SUB:
+        case IROpcode::PARAM_BYREF:
+
+        // Output, files and DATA pointer
+        case IROpcode::PRINT:
+        case IROpcode::CONSOLE:
+        case IROpcode::PRINT_NEWLINE:
+        case IROpcode::PRINT_TAB:
+        case IROpcode::PRINT_USING:
+        case IROpcode::PRINT_AT:
+        case IROpcode::PRINT_AT_USING:
+        case IROpcode::OPEN_FILE:
+        case IROpcode::CLOSE_FILE:
+        case IROpcode::CLOSE_FILE_ALL:
+        case IROpcode::PRINT_FILE:
+        case IROpcode::PRINT_FILE_NEWLINE:
+        case IROpcode::WRITE_FILE:
+        case IROpcode::READ_DATA_VALUE:
+        case IROpcode::RESTORE:
+        case IROpcode::TIMER_STOP:
+        case IROpcode::TIMER_INTERVAL:
+        case IROpcode::NOP:
+        case IROpcode::HALT:
+        case IROpcode::END:
+            return VariableWrites::None;
+
+        default:
+            return VariableWrites::All;
+    }
+}
+
+// =============================================================================
+// SSA Form
+// =============================================================================
+
+bool SSAForm::fail(size_t index, const std::string& message) {
+    m_valid = false;
+    m_error = "IR[" + std::to_string(index) + "]: " + message;
+    return false;
+}
+
+const std::vector<int>& SSAForm::getEscapes(size_t index) const {
+    static const std::vector<int> none;
+    auto it = m_escapes.find(index);
+    return it == m_escapes.end() ? none : it->second;
+}
+
+int SSAForm::variableIndex(const std::string& name) const {
+    auto it = std::find(m_variables.begin(), m_variables.end(), name);
+    return it == m_variables.end() ? -1 : static_cast<int>(it - m_variables.begin());
+}
+
+bool SSAForm::build(const IRCode& code, const RegisterIR& registers, size_t regionIndex) {
+    const auto& instrs = code.instructions;
+    const auto& regions = registers.getRegions();
+    m_blocks.clear();
+    m_order.clear();
+    m_rpoNumber.clear();
+    m_children.clear();
+    m_variables.clear();
+    m_aliases.clear();
+    m_escapes.clear();
+    m_valid = true;
+    m_error.clear();
+
+    if (!registers.isValid() || regionIndex >= regions.size()) {
+        m_valid = false;
+        m_error = "register IR unavailable";
+        return false;
+    }
+    const RegRegion& region = regions[regionIndex];
+
+    // Instructions of this region in program order, stepping over nested
+    // FUNCTION/SUB bodies and their headers
+    std::vector<bool> owned(instrs.size(), false);
+    for (size_t i = region.begin; i < region.end && i < instrs.size(); i++) {
+        owned[i] = registers.depthAt(i) >= 0;
+    }
+    for (size_t r = 0; r < regions.size(); r++) {
+        const RegRegion& other = regions[r];
+        if (r == regionIndex || other.begin < region.begin || other.end > region.end ||
+            (other.begin == region.begin && other.end == region.end)) {
+            continue;
+        }
+        for (size_t i = other.begin; i < other.end; i++) {
+            owned[i] = false;
+        }
+    }
+    std::vector<size_t> order;
+    std::vector<int> posOf(instrs.size(), -1);
+    for (size_t i = 0; i < instrs.size(); i++) {
+        if (owned[i]) {
+            posOf[i] = static_cast<int>(order.size());
+            order.push_back(i);
+        }
+    }
+    const int count = static_cast<int>(order.size());
+    auto next = [&](int p) { return p + 1 < count ? p + 1 : -1; };
+    auto depth = [&](int p) { return registers.depthAt(order[p]); };
+
+    std::unordered_map<std::string, size_t> labels;
+    for (size_t i = 0; i < instrs.size(); i++) {
+        if (instrs[i].opcode == IROpcode::LABEL) {
+            labels[labelKey(instrs[i].operand1)] = i;
+        }
+    }
+    auto labelPos = [&](const std::string& key) {
+        auto it = labels.find(key);
+        return it == labels.end() ? -1 : posOf[it->second];
+    };
+
+    // A condition is evaluated by the statement-level run of instructions
+    // right before the opcode that pops it
+    auto condStart = [&](int p, int after) {
+        int start = -1;
+        for (int k = p - 1; k > after; k--) {
+            if (depth(k) == 0) {
+                start = k;
+                break;
+            }
+        }
+        if (start < 0) return -1;
+        for (int k = start; k < p; k++) {
+            if (isControl(instrs[order[k]].opcode)) return -1;
+        }
+        return start;
+    };
+
+    // Structured statements: IF arms and loops
+    struct Loop {
+        int header;         // Where each iteration's test starts (pre-test loops)
+        int body;           // First instruction of the body
+        int end;            // Closing opcode
+        bool pretest;
+        std::string variable;   // FOR loop variable
+    };
+    struct Open {
+        IROpcode opcode;
+        int loop;                   // Index into loops, -1 for IF
+        std::vector<int> tests;     // IF_START and each ELSEIF_START
+        std::vector<int> arms;      // First instruction of each ELSEIF test and the ELSE
+    };
+    std::vector<Loop> loops;
+    std::vector<Open> open;
+    std::vector<int> loopOf(count, -1);
+    std::vector<int> redirect(count, -1);
+    std::vector<int> falseTarget(count, -1);
+    std::unordered_map<int, std::vector<int>> exits;
+    std::unordered_map<size_t, std::vector<std::string>> escapes;
+
+    auto openLoop = [&](int p, IROpcode opcode, int header, bool pretest) {
+        if (next(p) < 0) return fail(order[p], "loop without a body");
+        std::string variable;
+        if (opcode == IROpcode::FOR_INIT) variable = stringOperand(instrs[order[p]].operand1);
+        loops.push_back({header, next(p), -1, pretest, variable});
+        loopOf[p] = static_cast<int>(loops.size()) - 1;
+        open.push_back({opcode, loopOf[p], {}, {}});
+        return true;
+    };
+    auto closeLoop = [&](int p, IROpcode opener) {
+        if (open.empty() || open.back().opcode != opener) {
+            return fail(order[p], std::string(opcodeToString(instrs[order[p]].opcode)) +
+                        " does not close the open statement");
+        }
+        loopOf[p] = open.back().loop;
+        loops[loopOf[p]].end = p;
+        open.pop_back();
+        return true;
+    };
+
+    for (int p = 0; p < count; p++) {
+        const IRInstruction& instr = instrs[order[p]];
+        bool ok = true;
+        switch (instr.opcode) {
+            case IROpcode::IF_START:
+                open.push_back({IROpcode::IF_START, -1, {p}, {}});
+                break;
+            case IROpcode::ELSEIF_START: {
+                if (open.empty() || open.back().opcode != IROpcode::IF_START) {
+                    return fail(order[p], "ELSEIF outside IF");
+                }
+                Open& statement = open.back();
+                int last = std::max(statement.tests.back(),
+                                    statement.arms.empty() ? -1 : statement.arms.back());
+                int start = condStart(p, last);
+                if (start < 0) return fail(order[p], "ELSEIF condition not found");
+                statement.arms.push_back(start);
+                statement.tests.push_back(p);
+                break;
+            }
+            case IROpcode::ELSE_START:
+                if (open.empty() || open.back().opcode != IROpcode::IF_START) {
+                    return fail(order[p], "ELSE outside IF");
+                }
+                open.back().arms.push_back(p);
+                break;
+            case IROpcode::IF_END: {
+                if (open.empty() || open.back().opcode != IROpcode::IF_START) {
+                    return fail(order[p], "IF_END outside IF");
+                }
+                const Open& statement = open.back();
+                for (size_t t = 0; t < statement.tests.size(); t++) {
+                    falseTarget[statement.tests[t]] =
+                        t < statement.arms.size() ? statement.arms[t] : p;
+                }
+                // Each arm ends by leaving the whole statement
+                for (int arm : statement.arms) {
+                    redirect[arm - 1] = p;
+                }
+                open.pop_back();
+                break;
+            }
+
+            case IROpcode::WHILE_START: {
+                bool serialized = std::holds_alternative<std::string>(instr.operand1);
+                int header = serialized ? p : condStart(p, -1);
+                if (header < 0) return fail(order[p], "WHILE condition not found");
+                ok = openLoop(p, instr.opcode, header, true);
+                break;
+            }
+            case IROpcode::DO_WHILE_START:
+            case IROpcode::DO_UNTIL_START: {
+                int header = condStart(p, -1);
+                if (header < 0) return fail(order[p], "DO condition not found");
+                ok = openLoop(p, IROpcode::DO_START, header, true);
+                break;
+            }
+            case IROpcode::DO_START:
+                ok = openLoop(p, IROpcode::DO_START, -1, false);
+                break;
+            case IROpcode::REPEAT_START:
+            case IROpcode::FOR_INIT:
+            case IROpcode::FOR_IN_INIT:
+                ok = openLoop(p, instr.opcode == IROpcode::FOR_IN_INIT ? IROpcode::FOR_INIT
+                                                                       : instr.opcode,
+                              -1, false);
+                break;
+
+            case IROpcode::WHILE_END:
+                ok = closeLoop(p, IROpcode::WHILE_START);
+                break;
+            case IROpcode::REPEAT_END:
+                ok = closeLoop(p, IROpcode::REPEAT_START);
+                break;
+            case IROpcode::DO_LOOP_WHILE:
+            case IROpcode::DO_LOOP_UNTIL:
+            case IROpcode::DO_LOOP_END:
+                ok = closeLoop(p, IROpcode::DO_START);
+                break;
+            case IROpcode::FOR_NEXT:
+                ok = closeLoop(p, IROpcode::FOR_INIT);
+                break;
+
+            // EXIT leaves the innermost Lua loop, whichever kind it is; an
+            // edge to each enclosing exit keeps that conservative
+            case IROpcode::EXIT_FOR:
+            case IROpcode::EXIT_DO:
+            case IROpcode::EXIT_WHILE:
+            case IROpcode::EXIT_REPEAT: {
+                for (const auto& statement : open) {
+                    if (statement.loop >= 0) exits[p].push_back(statement.loop);
+                }
+                if (exits[p].empty()) return fail(order[p], "EXIT outside a loop");
+                break;
+            }
+
+            case IROpcode::FOR_CHECK:
+            case IROpcode::FOR_IN_CHECK:
+            case IROpcode::FOR_IN_NEXT:
+                return fail(order[p], std::string(opcodeToString(instr.opcode)) + " not supported");
+
+            default:
+                break;
+        }
+        if (!ok) return false;
+
+        // A native Lua FOR loop variable is a local shadowing the BASIC
+        // variable; a jump out of the body leaves the value behind
+        if (instr.opcode == IROpcode::JUMP || instr.opcode == IROpcode::JUMP_IF_TRUE ||
+            instr.opcode == IROpcode::JUMP_IF_FALSE || instr.opcode == IROpcode::ON_GOTO ||
+            exits.count(p)) {
+            for (const auto& statement : open) {
+                if (statement.loop >= 0 && !loops[statement.loop].variable.empty()) {
+                    escapes[order[p]].push_back(loops[statement.loop].variable);
+                }
+            }
+        }
+    }
+    if (!open.empty()) {
+        return fail(region.end > 0 ? region.end - 1 : 0, "unclosed IF or loop");
+    }
+
+    // Successors, as positions in order
+    auto fallthrough = [&](int p) { return redirect[p] >= 0 ? redirect[p] : next(p); };
+    auto exitOf = [&](int loop) { return fallthrough(loops[loop].end); };
+
+    std::vector<std::vector<int>> succ(count);
+    std::vector<int> roots;
+    for (int p = 0; p < count; p++) {
+        const IRInstruction& instr = instrs[order[p]];
+        auto add = [&](int target) {
+            if (target >= 0) succ[p].push_back(target);
+        };
+        auto addLabel = [&](const std::string& key) {
+            int target = labelPos(key);
+            if (target < 0) return fail(order[p], "jump to label " + key + " outside the region");
+            add(target);
+            return true;
+        };
+
+        switch (instr.opcode) {
+            case IROpcode::JUMP:
+                if (!addLabel(labelKey(instr.operand1))) return false;
+                break;
+            case IROpcode::JUMP_IF_TRUE:
+            case IROpcode::JUMP_IF_FALSE:
+                if (!addLabel(labelKey(instr.operand1))) return false;
+                add(fallthrough(p));
+                break;
+            case IROpcode::ON_GOTO:
+                for (const auto& key : labelList(instr.operand1)) {
+                    if (!addLabel(key)) return false;
+                }
+                add(fallthrough(p));
+                break;
+
+            case IROpcode::IF_START:
+            case IROpcode::ELSEIF_START:
+                add(fallthrough(p));
+                add(falseTarget[p]);
+                break;
+
+            case IROpcode::FOR_INIT:
+            case IROpcode::FOR_IN_INIT:
+            case IROpcode::WHILE_START:
+            case IROpcode::DO_WHILE_START:
+            case IROpcode::DO_UNTIL_START:
+                add(fallthrough(p));
+                add(exitOf(loopOf[p]));
+                break;
+            case IROpcode::FOR_NEXT:
+            case IROpcode::REPEAT_END:
+            case IROpcode::DO_LOOP_WHILE:
+            case IROpcode::DO_LOOP_UNTIL:
+                add(loops[loopOf[p]].body);
+                add(fallthrough(p));
+                break;
+            case IROpcode::WHILE_END:
+                add(loops[loopOf[p]].header);
+                break;
+            case IROpcode::DO_LOOP_END: {
+                const Loop& loop = loops[loopOf[p]];
+                add(loop.pretest ? loop.header : loop.body);
+                break;
+            }
+            case IROpcode::EXIT_FOR:
+            case IROpcode::EXIT_DO:
+            case IROpcode::EXIT_WHILE:
+            case IROpcode::EXIT_REPEAT:
+                for (int loop : exits[p]) {
+                    add(exitOf(loop));
+                }
+                break;
+
+            case IROpcode::END_FUNCTION:
+            case IROpcode::END_SUB:
+                break;
+
+            default:
+                if (!isTerminator(instr.opcode)) add(fallthrough(p));
+                break;
+        }
+    }
+
+    // GOSUB targets are entered from wherever the call is, possibly from
+    // another region
+    for (size_t i = 0; i < instrs.size(); i++) {
+        if (instrs[i].opcode != IROpcode::CALL_GOSUB && instrs[i].opcode != IROpcode::ON_GOSUB) {
+            continue;
+        }
+        for (const auto& key : labelList(instrs[i].operand1)) {
+            auto it = labels.find(key);
+            if (it == labels.end()) return fail(i, "GOSUB to unknown label " + key);
+            if (posOf[it->second] >= 0) roots.push_back(posOf[it->second]);
+            else if (owned[i]) return fail(i, "GOSUB target outside the region");
+        }
+    }
+
+    // Blocks start at the entry, GOSUB targets, jump targets and after
+    // every instruction that does not simply fall through
+    std::vector<bool> leader(count, false);
+    if (count > 0) leader[0] = true;
+    for (int root : roots) {
+        leader[root] = true;
+    }
+    for (int p = 0; p < count; p++) {
+        if (succ[p].size() == 1 && succ[p][0] == p + 1) continue;
+        if (p + 1 < count) leader[p + 1] = true;
+        for (int target : succ[p]) {
+            leader[target] = true;
+        }
+    }
+
+    m_blocks.push_back(SSABlock());
+    std::vector<int> blockOf(count, -1);
+    for (int p = 0; p < count; p++) {
+        if (leader[p]) m_blocks.push_back(SSABlock());
+        blockOf[p] = static_cast<int>(m_blocks.size()) - 1;
+        m_blocks.back().instructions.push_back(order[p]);
+    }
+    for (auto& block : m_blocks) {
+        block.idom = -1;
+        block.gosubEntry = false;
+        block.reachable = false;
+    }
+
+    auto addEdge = [&](int from, int to) {
+        auto& succs = m_blocks[from].succs;
+        if (std::find(succs.begin(), succs.end(), to) == succs.end()) {
+            succs.push_back(to);
+            m_blocks[to].preds.push_back(from);
+        }
+    };
+    if (count > 0) addEdge(0, blockOf[0]);
+    for (int root : roots) {
+        m_blocks[blockOf[root]].gosubEntry = true;
+        addEdge(0, blockOf[root]);
+    }
+    for (size_t b = 1; b < m_blocks.size(); b++) {
+        int last = posOf[m_blocks[b].instructions.back()];
+        for (int target : succ[last]) {
+            addEdge(static_cast<int>(b), blockOf[target]);
+        }
+    }
+
+    // Scalar variables, grouped by the Lua name they reach
+    std::vector<std::string> names;
+    std::unordered_map<std::string, int> known;
+    auto addVariable = [&](const std::string& name) {
+        if (!known.count(name)) {
+            known[name] = static_cast<int>(m_variables.size());
+            m_variables.push_back(name);
+        }
+    };
+    for (size_t i : order) {
+        const IRInstruction& instr = instrs[i];
+        if (instr.opcode == IROpcode::LOAD_VAR) {
+            addVariable(stringOperand(instr.operand1));
+        } else if (variableWrites(instr, names) == VariableWrites::Named) {
+            for (const auto& name : names) {
+                addVariable(name);
+            }
+        }
+    }
+    std::unordered_map<std::string, std::vector<int>> byLuaName;
+    for (size_t v = 0; v < m_variables.size(); v++) {
+        byLuaName[mangledName(m_variables[v])].push_back(static_cast<int>(v));
+    }
+    for (const auto& [index, variables] : escapes) {
+        for (const auto& name : variables) {
+            int v = variableIndex(name);
+            if (v >= 0) m_escapes[index].push_back(v);
+        }
+    }
+    m_aliases.assign(m_variables.size(), {});
+    for (const auto& [luaName, group] : byLuaName) {
+        for (int v : group) {
+            for (int other : group) {
+                if (other != v) m_aliases[v].push_back(other);
+            }
+        }
+    }
+
+    computeOrder();
+    computeDominators();
+    computeFrontiers();
+    placePhis(code);
+    return true;
+}
+
+void SSAForm::computeOrder() {
+    const int count = static_cast<int>(m_blocks.size());
+    std::vector<int> postorder;
+    std::vector<std::pair<int, size_t>> stack = {{0, 0}};
+    m_blocks[0].reachable = true;
+    while (!stack.empty()) {
+        int block = stack.back().first;
+        size_t edge = stack.back().second++;
+        if (edge < m_blocks[block].succs.size()) {
+            int succ = m_blocks[block].succs[edge];
+            if (!m_blocks[succ].reachable) {
+                m_blocks[succ].reachable = true;
+                stack.push_back({succ, 0});
+            }
+        } else {
+            postorder.push_back(block);
+            stack.pop_back();
+        }
+    }
+    m_order.assign(postorder.rbegin(), postorder.rend());
+    m_rpoNumber.assign(count, -1);
+    for (size_t k = 0; k < m_order.size(); k++) {
+        m_rpoNumber[m_order[k]] = static_cast<int>(k);
+    }
+
+    // Dead code never reaches a join
+    for (auto& block : m_blocks) {
+        auto& preds = block.preds;
+        preds.erase(std::remove_if(preds.begin(), preds.end(),
+                                   [this](int pred) { return !m_blocks[pred].reachable; }),
+                    preds.end());
+    }
+}
+
+void SSAForm::computeDominators() {
+    std::vector<int> idom(m_blocks.size(), -1);
+    idom[0] = 0;
+    auto intersect = [&](int a, int b) {
+        while (a != b) {
+            while (m_rpoNumber[a] > m_rpoNumber[b]) a = idom[a];
+            while (m_rpoNumber[b] > m_rpoNumber[a]) b = idom[b];
+        }
+        return a;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t k = 1; k < m_order.size(); k++) {
+            int block = m_order[k];
+            int newIdom = -1;
+            for (int pred : m_blocks[block].preds) {
+                if (idom[pred] < 0) continue;
+                newIdom = newIdom < 0 ? pred : intersect(pred, newIdom);
+            }
+            if (idom[block] != newIdom) {
+                idom[block] = newIdom;
+                changed = true;
+            }
+        }
+    }
+
+    m_children.assign(m_blocks.size(), {});
+    for (size_t k = 1; k < m_order.size(); k++) {
+        int block = m_order[k];
+        m_blocks[block].idom = idom[block];
+        m_children[idom[block]].push_back(block);
+    }
+}
+
+void SSAForm::computeFrontiers() {
+    for (int block : m_order) {
+        const auto& preds = m_blocks[block].preds;
+        if (preds.size() < 2) continue;
+        for (int pred : preds) {
+            int runner = pred;
+            while (runner >= 0 && runner != m_blocks[block].idom) {
+                auto& frontier = m_blocks[runner].frontier;
+                if (std::find(frontier.begin(), frontier.end(), block) == frontier.end()) {
+                    frontier.push_back(block);
+                }
+                runner = m_blocks[runner].idom;
+            }
+        }
+    }
+}
+
+void SSAForm::placePhis(const IRCode& code) {
+    const int variableCount = static_cast<int>(m_variables.size());
+
+    // Blocks that define a variable; the virtual entry, GOSUB targets and
+    // calls define all of them
+    std::vector<std::vector<int>> defSites(variableCount);
+    std::vector<int> definesAll = {0};
+    std::vector<std::string> names;
+    for (int block : m_order) {
+        if (block == 0) continue;
+        bool all = m_blocks[block].gosubEntry;
+        for (size_t i : m_blocks[block].instructions) {
+            VariableWrites writes = variableWrites(code.instructions[i], names);
+            if (writes == VariableWrites::All) {
+                all = true;
+            } else if (writes == VariableWrites::Named) {
+                for (const auto& name : names) {
+                    int v = variableIndex(name);
+                    if (v < 0) continue;
+                    defSites[v].push_back(block);
+                    for (int alias : m_aliases[v]) {
+                        defSites[alias].push_back(block);
+                    }
+                }
+            }
+            for (int v : getEscapes(i)) {
+                defSites[v].push_back(block);
+                for (int alias : m_aliases[v]) {
+                    defSites[alias].push_back(block);
+                }
+            }
+        }
+        if (all) definesAll.push_back(block);
+    }
+
+    std::vector<int> hasPhi(m_blocks.size(), -1);
+    std::vector<int> queued(m_blocks.size(), -1);
+    for (int v = 0; v < variableCount; v++) {
+        std::vector<int> work = definesAll;
+        work.insert(work.end(), defSites[v].begin(), defSites[v].end());
+        for (int block : work) {
+            queued[block] = v;
+        }
+        while (!work.empty()) {
+            int block = work.back();
+            work.pop_back();
+            for (int join : m_blocks[block].frontier) {
+                if (hasPhi[join] == v) continue;
+                hasPhi[join] = v;
+                if (!m_blocks[join].gosubEntry) {
+                    SSAPhi phi;
+                    phi.variable = v;
+                    phi.args.assign(m_blocks[join].preds.size(), -1);
+                    phi.value = -1;
+                    m_blocks[join].phis.push_back(phi);
+                }
+                if (queued[join] != v) {
+                    queued[join] = v;
+                    work.push_back(join);
+                }
+            }
+        }
+    }
+}
+
+bool SSAForm::dominates(int a, int b) const {
+    while (b >= 0 && b != a) {
+        b = m_blocks[b].idom;
+    }
+    return b == a;
+}
+
+std::string SSAForm::toString(const IRCode& code) const {
+    std::ostringstream oss;
+    auto list = [&](const std::vector<int>& blocks) {
+        std::string text;
+        for (int block : blocks) {
+            text += (text.empty() ? "B" : ", B") + std::to_string(block);
+        }
+        return text.empty() ? "-" : text;
+    };
+    for (int block : m_order) {
+        const SSABlock& b = m_blocks[block];
+        oss << "B" << block << (b.gosubEntry ? " (GOSUB)" : "")
+            << "  idom: " << (b.idom < 0 ? std::string("-") : "B" + std::to_string(b.idom))
+            << "  preds: " << list(b.preds)
+            << "  succs: " << list(b.succs)
+            << "  frontier: " << list(b.frontier) << "\n";
+        for (const auto& phi : b.phis) {
+            oss << "    " << m_variables[phi.variable] << " = phi(";
+            for (size_t k = 0; k < phi.args.size(); k++) {
+                oss << (k ? ", " : "") << "v" << phi.args[k];
+            }
+            oss << ") -> v" << phi.value << "\n";
+        }
+        for (size_t i : b.instructions) {
+            oss << "    " << std::setw(5) << i << ": " << code.instructions[i].toString() << "\n";
+        }
+    }
+    return oss.str();
+}
+
+// =============================================================================
+// Value Numbering
+// =============================================================================
+
+// One entry of the simulated operand stack
+struct SSAValue {
+    int value;          // Value number
+    int node;           // Root instruction of a rewritable expression, -1 if none
+};
+
+// Pure expression tree laid out contiguously, operands first
+struct SSAExpression {
+    size_t start;                   // First instruction of the tree
+    std::vector<size_t> operands;   // Roots of the operand trees, bottom of stack first
+    int value;
+    bool hasCall;                   // Contains a builtin call
+    bool literal;                   // Replace with the literal of its value
+    int holder;                     // Replace with a load of this variable, -1 if none
+};
+
+class SSAValueNumbering {
+public:
+    SSAValueNumbering(IRCode& code, const RegisterIR& registers, SSAForm& form,
+                      std::vector<bool>& removed, SSAStats& stats)
+        : m_code(code), m_registers(registers), m_form(form), m_removed(removed), m_stats(stats)
+        , m_current(form.getVariables().size(), -1)
+        , m_buffered(form.getVariables().size(), false)
+    {
+        for (const auto& instr : code.instructions) {
+            if (instr.opcode == IROpcode::MID_ASSIGN) {
+                int v = form.variableIndex(stringOperand(instr.operand1));
+                if (v >= 0) m_buffered[v] = true;
+            }
+        }
+    }
+
+    // Walk the dominator tree, undoing each subtree's definitions on the way out
+    void run() {
+        std::vector<std::pair<int, size_t>> stack;
+        std::vector<size_t> marks;
+        marks.push_back(m_log.size());
+        visit(0);
+        stack.push_back({0, 0});
+        while (!stack.empty()) {
+            int block = stack.back().first;
+            size_t child = stack.back().second++;
+            const auto& children = m_form.getChildren(block);
+            if (child < children.size()) {
+                marks.push_back(m_log.size());
+                visit(children[child]);
+                stack.push_back({children[child], 0});
+            } else {
+                undo(marks.back());
+                marks.pop_back();
+                stack.pop_back();
+            }
+        }
+        m_stats.valueNumbers += m_next;
+    }
+
+private:
+    IRCode& m_code;
+    const RegisterIR& m_registers;
+    SSAForm& m_form;
+    std::vector<bool>& m_removed;
+    SSAStats& m_stats;
+
+    std::unordered_map<std::string, int> m_table;           // Expression key → value number
+    std::unordered_map<int, IRInstruction> m_literals;      // Numeric literal of a value
+    std::unordered_map<int, std::vector<int>> m_holders;    // Variables that took a value
+    std::unordered_map<size_t, SSAExpression> m_expressions;
+    std::vector<int> m_current;                             // Value of each variable
+    std::vector<bool> m_buffered;                           // MID$ targets, read as buffers
+    std::vector<std::pair<int, int>> m_log;                 // (variable, previous value)
+    int m_next = 0;
+
+    int fresh() { return m_next++; }
+
+    int number(const std::string& key) {
+        auto it = m_table.find(key);
+        if (it != m_table.end()) return it->second;
+        int value = fresh();
+        m_table[key] = value;
+        return value;
+    }
+
+    void assign(int v, int value) {
+        m_log.push_back({v, m_current[v]});
+        m_current[v] = value;
+        m_holders[value].push_back(v);
+    }
+
+    // A write to one spelling of a Lua variable changes the others too
+    void write(int v, int value) {
+        assign(v, value);
+        for (int alias : m_form.getAliases(v)) {
+            assign(alias, fresh());
+        }
+    }
+
+    void clobberAll() {
+        for (size_t v = 0; v < m_current.size(); v++) {
+            assign(static_cast<int>(v), fresh());
+        }
+    }
+
+    void undo(size_t mark) {
+        while (m_log.size() > mark) {
+            m_current[m_log.back().first] = m_log.back().second;
+            m_log.pop_back();
+        }
+    }
+
+    // Variable currently holding a value, the latest to take it first
+    int holderOf(int value) const {
+        auto it = m_holders.find(value);
+        if (it == m_holders.end()) return -1;
+        for (auto v = it->second.rbegin(); v != it->second.rend(); ++v) {
+            if (m_current[*v] == value && !m_buffered[*v]) return *v;
+        }
+        return -1;
+    }
+
+    void visit(int block) {
+        auto& blocks = m_form.getBlocks();
+        SSABlock& b = blocks[block];
+
+        if (block == 0) {
+            clobberAll();
+        } else if (b.gosubEntry) {
+            clobberAll();
+        }
+        for (auto& phi : b.phis) {
+            bool known = std::all_of(phi.args.begin(), phi.args.end(),
+                                     [](int arg) { return arg >= 0; });
+            bool same = std::all_of(phi.args.begin(), phi.args.end(),
+                                    [&](int arg) { return arg == phi.args[0]; });
+            if (!known || phi.args.empty()) {
+                phi.value = fresh();
+            } else if (same) {
+                phi.value = phi.args[0];
+            } else {
+                std::string key = "phi:" + std::to_string(block);
+                for (int arg : phi.args) {
+                    key += ":" + std::to_string(arg);
+                }
+                phi.value = number(key);
+            }
+            assign(phi.variable, phi.value);
+        }
+
+        if (!b.instructions.empty()) {
+            numberBlock(b);
+        }
+
+        // Values leaving along each edge feed the successor's phis
+        for (int succ : b.succs) {
+            auto& target = blocks[succ];
+            for (size_t k = 0; k < target.preds.size(); k++) {
+                if (target.preds[k] != block) continue;
+                for (auto& phi : target.phis) {
+                    phi.args[k] = m_current[phi.variable];
+                }
+            }
+        }
+    }
+
+    void numberBlock(const SSABlock& block) {
+        m_expressions.clear();
+        std::vector<SSAValue> stack;
+        int entryDepth = m_registers.depthAt(block.instructions.front());
+        for (int k = 0; k < entryDepth; k++) {
+            stack.push_back({fresh(), -1});
+        }
+
+        std::vector<std::string> names;
+        for (size_t i : block.instructions) {
+            const IRInstruction instr = m_code.instructions[i];
+            StackEffect effect = stackEffect(instr);
+            while (static_cast<int>(stack.size()) < effect.pops) {
+                stack.insert(stack.begin(), {fresh(), -1});
+            }
+            std::vector<SSAValue> args(stack.end() - effect.pops, stack.end());
+            stack.resize(stack.size() - effect.pops);
+
+            if (isPureOpcode(instr)) {
+                stack.push_back(numberExpression(i, instr, args));
+                continue;
+            }
+            if (instr.opcode == IROpcode::STORE_VAR && args.size() == 1) {
+                store(i, instr, args[0]);
+                continue;
+            }
+
+            // FOR keeps its native Lua form only while start, limit and step
+            // stay call-free; leave trees with calls as they are
+            bool keepCalls = instr.opcode == IROpcode::FOR_INIT;
+            for (const auto& arg : args) {
+                finish(arg, keepCalls);
+            }
+
+            VariableWrites writes = variableWrites(instr, names);
+            if (writes == VariableWrites::All) {
+                clobberAll();
+            } else if (writes == VariableWrites::Named) {
+                for (const auto& name : names) {
+                    int v = m_form.variableIndex(name);
+                    if (v >= 0) write(v, fresh());
+                }
+            }
+            for (int v : m_form.getEscapes(i)) {
+                write(v, fresh());
+            }
+            for (int k = 0; k < effect.pushes; k++) {
+                stack.push_back({fresh(), -1});
+            }
+        }
+    }
+
+    SSAValue numberExpression(size_t i, const IRInstruction& instr, const std::vector<SSAValue>& args) {
+        int value;
+        if (instr.opcode == IROpcode::LOAD_VAR) {
+            int v = m_form.variableIndex(stringOperand(instr.operand1));
+            value = v >= 0 ? m_current[v] : fresh();
+        } else {
+            std::ostringstream key;
+            key << opcodeToString(instr.opcode);
+            if (instr.opcode == IROpcode::CALL_BUILTIN) {
+                key << ":" << stringOperand(instr.operand1);
+            }
+            for (const IROperand* operand : {&instr.operand1, &instr.operand2}) {
+                if (instr.opcode == IROpcode::CALL_BUILTIN) break;
+                if (std::holds_alternative<int>(*operand)) {
+                    key << ":i" << std::get<int>(*operand);
+                } else if (std::holds_alternative<double>(*operand)) {
+                    key << ":d" << std::setprecision(17) << std::get<double>(*operand);
+                } else if (std::holds_alternative<std::string>(*operand)) {
+                    key << ":s" << std::get<std::string>(*operand).size() << ":"
+                        << std::get<std::string>(*operand);
+                }
+            }
+            std::vector<int> values;
+            for (const auto& arg : args) {
+                values.push_back(arg.value);
+            }
+            if (isCommutative(instr.opcode)) {
+                std::sort(values.begin(), values.end());
+            }
+            for (int arg : values) {
+                key << ":v" << arg;
+            }
+            value = number(key.str());
+            if (isNumericPush(instr.opcode) && !m_literals.count(value)) {
+                m_literals[value] = instr;
+            }
+        }
+
+        // Rewritable only if the operand trees sit right before, in order
+        size_t start = i;
+        for (size_t k = args.size(); k-- > 0;) {
+            if (args[k].node < 0 || static_cast<size_t>(args[k].node) + 1 != start) {
+                for (const auto& arg : args) {
+                    finish(arg, false);
+                }
+                return {value, -1};
+            }
+            start = m_expressions[args[k].node].start;
+        }
+
+        SSAExpression expression;
+        expression.start = start;
+        expression.value = value;
+        expression.hasCall = instr.opcode == IROpcode::CALL_BUILTIN;
+        for (const auto& arg : args) {
+            expression.operands.push_back(arg.node);
+            expression.hasCall = expression.hasCall || m_expressions[arg.node].hasCall;
+        }
+        // A load is as cheap as any other variable, but not as a literal
+        expression.literal = (start != i || instr.opcode == IROpcode::LOAD_VAR) &&
+                             !isNumericPush(instr.opcode) && m_literals.count(value) > 0;
+        expression.holder = start != i && !expression.literal ? holderOf(value) : -1;
+        m_expressions[i] = expression;
+        return {value, static_cast<int>(i)};
+    }
+
+    void store(size_t i, const IRInstruction& instr, const SSAValue& arg) {
+        int v = m_form.variableIndex(stringOperand(instr.operand1));
+        if (v < 0) {
+            finish(arg, false);
+            return;
+        }
+
+        // Assigning a variable the value it already holds does nothing
+        if (arg.node >= 0 && m_current[v] == arg.value) {
+            for (size_t k = m_expressions[arg.node].start; k <= i; k++) {
+                remove(k);
+            }
+            m_stats.storesRemoved++;
+            return;
+        }
+        finish(arg, false);
+        write(v, arg.value);
+    }
+
+    // The consumer keeps its operand: rewrite the outermost trees that have
+    // a cheaper equivalent
+    void finish(const SSAValue& arg, bool keepCalls) {
+        if (arg.node < 0) return;
+        const SSAExpression& expression = m_expressions[arg.node];
+        if (keepCalls && expression.hasCall) return;
+        rewrite(static_cast<size_t>(arg.node));
+    }
+
+    void rewrite(size_t root) {
+        const SSAExpression expression = m_expressions[root];
+        if (!expression.literal && expression.holder < 0) {
+            for (size_t operand : expression.operands) {
+                rewrite(operand);
+            }
+            return;
+        }
+
+        IRInstruction replacement = expression.literal
+            ? m_literals[expression.value]
+            : IRInstruction(IROpcode::LOAD_VAR, m_form.getVariables()[expression.holder]);
+        replacement.sourceLineNumber = m_code.instructions[root].sourceLineNumber;
+        replacement.blockId = m_code.instructions[root].blockId;
+        m_code.instructions[expression.start] = replacement;
+        for (size_t k = expression.start + 1; k <= root; k++) {
+            remove(k);
+        }
+        if (expression.literal) {
+            m_stats.constantsPropagated++;
+        } else {
+            m_stats.expressionsReplaced++;
+        }
+    }
+
+    void remove(size_t index) {
+        m_code.instructions[index].opcode = IROpcode::NOP;
+        m_removed[index] = true;
+        m_stats.instructionsRemoved++;
+    }
+};
+
+// =============================================================================
+// SSA Optimizer
+// =============================================================================
+
+std::string SSAOptimizer::checkProgram(const IRCode& code) const {
+    // Strings are shared codepoint tables, not values
+    if (code.unicodeMode) return "OPTION UNICODE";
+
+    // Handlers run between statements and may change any variable
+    if (code.forceYieldEnabled) return "OPTION FORCE_YIELD";
+    if (code.eventsUsed) return "ON EVENT handlers";
+    for (const auto& instr : code.instructions) {
+        switch (instr.opcode) {
+            case IROpcode::ON_EVENT:
+                return "ON EVENT handlers";
+            case IROpcode::AFTER_TIMER:
+            case IROpcode::EVERY_TIMER:
+            case IROpcode::AFTER_FRAMES:
+            case IROpcode::EVERY_FRAMES:
+                return "timer handlers";
+            default:
+                break;
+        }
+    }
+    return "";
+}
+
+bool SSAOptimizer::optimize(IRCode& code) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    m_stats = SSAStats();
+
+    m_stats.skipReason = checkProgram(code);
+    RegisterIR registers;
+    if (m_stats.skipReason.empty() && !registers.build(code)) {
+        m_stats.skipReason = "stack depth not known: " + registers.getError();
+    }
+
+    if (m_stats.skipReason.empty()) {
+        std::vector<bool> removed(code.instructions.size(), false);
+        const auto& regions = registers.getRegions();
+        for (size_t r = 0; r < regions.size(); r++) {
+            SSAForm form;
+            if (!form.build(code, registers, r)) {
+                m_stats.regionsSkipped++;
+                m_stats.skippedRegions.push_back(regions[r].name + ": " + form.getError());
+                continue;
+            }
+            m_stats.regions++;
+            m_stats.blocks += static_cast<int>(form.getOrder().size()) - 1;
+            for (int block : form.getOrder()) {
+                m_stats.phis += static_cast<int>(form.getBlocks()[block].phis.size());
+            }
+            optimizeRegion(code, registers, form, removed);
+        }
+        compact(code, removed);
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    m_stats.executionTimeMs = duration.count() / 1000.0;
+    return m_stats.instructionsRemoved > 0 || m_stats.constantsPropagated > 0;
+}
+
+void SSAOptimizer::optimizeRegion(IRCode& code, const RegisterIR& registers, SSAForm& form,
+                                  std::vector<bool>& removed) {
+    SSAValueNumbering numbering(code, registers, form, removed, m_stats);
+    numbering.run();
+}
+
+void SSAOptimizer::compact(IRCode& code, const std::vector<bool>& removed) {
+    if (std::find(removed.begin(), removed.end(), true) == removed.end()) return;
+
+    const size_t count = code.instructions.size();
+    std::vector<int> newIndex(count + 1, 0);
+    std::vector<IRInstruction> kept;
+    kept.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        newIndex[i] = static_cast<int>(kept.size());
+        if (!removed[i]) kept.push_back(std::move(code.instructions[i]));
+    }
+    newIndex[count] = static_cast<int>(kept.size());
+    code.instructions = std::move(kept);
+
+    auto remap = [&](int address) {
+        return address >= 0 && static_cast<size_t>(address) <= count ? newIndex[address] : address;
+    };
+    for (auto& [label, address] : code.labelToAddress) {
+        address = remap(address);
+    }
+    for (auto& [line, address] : code.lineToAddress) {
+        address = remap(address);
+    }
+}
+
+std::string SSAOptimizer::generateReport() const {
+    std::ostringstream oss;
+
+    oss << "=== SSA OPTIMIZER REPORT ===\n\n";
+
+    if (!m_stats.skipReason.empty()) {
+        oss << "Skipped: " << m_stats.skipReason << "\n\n";
+    }
+
+    oss << "Summary:\n";
+    oss << "  Regions: " << m_stats.regions << " (" << m_stats.regionsSkipped << " skipped)\n";
+    oss << "  Blocks: " << m_stats.blocks << "\n";
+    oss << "  Phis: " << m_stats.phis << "\n";
+    oss << "  Value Numbers: " << m_stats.valueNumbers << "\n";
+    oss << "  Expressions Replaced: " << m_stats.expressionsReplaced << "\n";
+    oss << "  Constants Propagated: " << m_stats.constantsPropagated << "\n";
+    oss << "  Stores Removed: " << m_stats.storesRemoved << "\n";
+    oss << "  Instructions Removed: " << m_stats.instructionsRemoved << "\n";
+    oss << "  Execution Time: " << std::fixed << std::setprecision(3)
+        << m_stats.executionTimeMs << " ms\n";
+    oss << "\n";
+
+    if (!m_stats.skippedRegions.empty()) {
+        oss << "Skipped Regions:\n";
+        for (const auto& region : m_stats.skippedRegions) {
+            oss << "  - " << region << "\n";
+        }
+        oss << "\n";
+    }
+
+    oss << "=== END SSA OPTIMIZER REPORT ===\n";
+
+    return oss.str();
+}
+
+std::string SSAOptimizer::generateSummary() const {
+    std::ostringstream oss;
+
+    if (!m_stats.skipReason.empty()) {
+        oss << "SSA Optimizer: skipped (" << m_stats.skipReason << ")";
+    } else {
+        oss << "SSA Optimizer: " << m_stats.expressionsReplaced << " expression(s) reused, "
+            << m_stats.constantsPropagated << " constant(s) propagated, "
+            << m_stats.storesRemoved << " store(s) removed";
+    }
+
+    return oss.str();
+}
+
+} // namespace FasterBASIC
@@ -0,0 +1,174 @@
+//
+// fasterbasic_ssa.h
+// FasterBASIC - SSA Form and Global Value Numbering
+//
+// Puts each region of the IR (main program, FUNCTION/SUB bodies) into SSA
+// form over its scalar variables and removes redundant computation across
+// GOTO, IF and loop boundaries. The peephole passes only see a window of
+// instructions; here a value computed on every path to a point is reused
+// from the variable that already holds it.
+//
+// Blocks are split at IR level rather than taken from the ControlFlowGraph,
+// which keeps a structured IF or loop inside one block: here each arm, loop
+// body and back edge is a path of its own. Dominance frontiers place the
+// phis, and one walk of the dominator tree renames, numbers values and
+// propagates copies. Leaving SSA needs no copies: a phi only merges value
+// numbers, and every SSA name is still the BASIC variable it came from.
+//
+
+#ifndef FASTERBASIC_SSA_H
+#define FASTERBASIC_SSA_H
+
+#include "fasterbasic_ircode.h"
+#include "fasterbasic_regir.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace FasterBASIC {
+
+// =============================================================================
+// SSA Blocks
+// =============================================================================
+
+// Merge of one variable's values where paths join
+struct SSAPhi {
+    int variable;               // Index into SSAForm::getVariables()
+    std::vector<int> args;      // Value number per predecessor, -1 if unknown
+    int value;                  // Value number of the merged variable
+};
+
+// Straight-line run of IR instructions
+struct SSABlock {
+    std::vector<size_t> instructions;   // Indices into IRCode::instructions
+    std::vector<int> succs;
+    std::vector<int> preds;
+    int idom;                   // Immediate dominator, -1 for the entry or unreachable
+    std::vector<int> frontier;  // Dominance frontier
+    std::vector<SSAPhi> phis;
+    bool gosubEntry;            // GOSUB target: entered with unknown variables
+    bool reachable;
+};
+
+// =============================================================================
+// SSA Form
+// =============================================================================
+
+class SSAForm {
+public:
+    SSAForm() = default;
+
+    // Split one region into blocks, compute dominators and frontiers and
+    // place phis; false if its control flow is not understood
+    bool build(const IRCode& code, const RegisterIR& registers, size_t regionIndex);
+
+    bool isValid() const { return m_valid; }
+    const std::string& getError() const { return m_error; }
+
+    // Block 0 is a virtual entry that defines every variable and leads to
+    // the region entry and each GOSUB target
+    const std::vector<SSABlock>& getBlocks() const { return m_blocks; }
+    std::vector<SSABlock>& getBlocks() { return m_blocks; }
+
+    // Reachable blocks in reverse postorder, starting with block 0
+    const std::vector<int>& getOrder() const { return m_order; }
+
+    // Scalar variables named in the region
+    const std::vector<std::string>& getVariables() const { return m_variables; }
+    int variableIndex(const std::string& name) const;
+
+    // Other names that reach the same Lua variable (A, A% and A$ are all var_A_)
+    const std::vector<int>& getAliases(int variable) const { return m_aliases[variable]; }
+
+    // FOR loop variables a jump or EXIT at this instruction may leave: the
+    // native Lua loop variable is a local shadowing them
+    const std::vector<int>& getEscapes(size_t index) const;
+
+    // Dominator tree children of a block, in reverse postorder
+    const std::vector<int>& getChildren(int block) const { return m_children[block]; }
+
+    bool dominates(int a, int b) const;
+
+    // Listing of blocks, edges, dominators and phis
+    std::string toString(const IRCode& code) const;
+
+private:
+    std::vector<SSABlock> m_blocks;
+    std::vector<int> m_order;
+    std::vector<int> m_rpoNumber;
+    std::vector<std::vector<int>> m_children;
+    std::vector<std::string> m_variables;
+    std::vector<std::vector<int>> m_aliases;
+    std::unordered_map<size_t, std::vector<int>> m_escapes;
+    bool m_valid = false;
+    std::string m_error;
+
+    bool fail(size_t index, const std::string& message);
+    void computeOrder();
+    void computeDominators();
+    void computeFrontiers();
+    void placePhis(const IRCode& code);
+};
+
+// =============================================================================
+// SSA Optimizer
+// =============================================================================
+
+struct SSAStats {
+    int regions;                // Regions put into SSA form
+    int regionsSkipped;         // Regions whose control flow was not understood
+    int blocks;
+    int phis;
+    int valueNumbers;
+    int expressionsReplaced;    // Expressions replaced by a variable holding their value
+    int constantsPropagated;    // Variable loads replaced by the literal they hold
+    int storesRemoved;          // Assignments of the value a variable already holds
+    int instructionsRemoved;
+    double executionTimeMs;
+    std::string skipReason;     // Why the whole program was left alone
+    std::vector<std::string> skippedRegions;    // "name: reason" per region left alone
+
+    SSAStats()
+        : regions(0)
+        , regionsSkipped(0)
+        , blocks(0)
+        , phis(0)
+        , valueNumbers(0)
+        , expressionsReplaced(0)
+        , constantsPropagated(0)
+        , storesRemoved(0)
+        , instructionsRemoved(0)
+        , executionTimeMs(0.0)
+    {}
+};
+
+class SSAOptimizer {
+public:
+    SSAOptimizer() = default;
+
+    // Rewrite code in place; true if anything changed
+    bool optimize(IRCode& code);
+
+    const SSAStats& getStats() const { return m_stats; }
+
+    std::string generateReport() const;
+    std::string generateSummary() const;
+
+private:
+    SSAStats m_stats;
+
+    // Why the program cannot be optimized, empty if it can
+    std::string checkProgram(const IRCode& code) const;
+
+    // Number values in one region and mark rewrites; removed instructions
+    // become NOP and are flagged in removed
+    void optimizeRegion(IRCode& code, const RegisterIR& registers, SSAForm& form,
+                        std::vector<bool>& removed);
+
+    // Drop the removed instructions and remap the label and line tables
+    void compact(IRCode& code, const std::vector<bool>& removed);
+};
+
+} // namespace FasterBASIC
+
+#endif // FASTERBASIC_SSA_H
@@ -108,6 +108,11 @@ enum class TokenType {
     REDIM,           // REDIM (resize array)
     ERASE,           // ERASE (clear/deallocate array)
     PRESERVE,        // PRESERVE (for REDIM PRESERVE)
+    APPEND,          // APPEND (grow 1-D array; also OPEN ... FOR APPEND)
+    PUSH,            // PUSH (synonym for APPEND)
+    POP,             // POP (remove last element of 1-D array)
+    REMOVE,          // REMOVE (delete a dictionary entry)
+    KEYS,            // KEYS (copy dictionary keys into an array)
     SWAP,            // SWAP (swap two variables)
     INC,             // INC (increment variable)
     DEC,             // DEC (decrement variable)
@@ -382,6 +387,11 @@ inline const char* tokenTypeToString(TokenType type) {
         case TokenType::REDIM: return "REDIM";
         case TokenType::ERASE: return "ERASE";
         case TokenType::PRESERVE: return "PRESERVE";
+        case TokenType::APPEND: return "APPEND";
+        case TokenType::PUSH: return "PUSH";
+        case TokenType::POP: return "POP";
+        case TokenType::REMOVE: return "REMOVE";
+        case TokenType::KEYS: return "KEYS";
         case TokenType::SWAP: return "SWAP";
         case TokenType::INC: return "INC";
         case TokenType::DEC: return "DEC";
@@ -8,6 +8,7 @@
 #include "fasterbasic_semantic.h"
 #include "fasterbasic_optimizer.h"
 #include "fasterbasic_peephole.h"
+#include "fasterbasic_ssa.h"
 #include "fasterbasic_cfg.h"
 #include "fasterbasic_ircode.h"
 #include "fasterbasic_lua_codegen.h"
@@ -36,6 +37,7 @@ extern "C" {
 extern "C" void register_unicode_module(lua_State* L);
 extern "C" void register_bitwise_module(lua_State* L);
 extern "C" void register_constants_module(lua_State* L);
+extern "C" void register_runtime_preload(lua_State* L);
 extern "C" void set_constants_manager(FasterBASIC::ConstantsManager* manager);
 
 // File I/O bindings
@@ -140,7 +142,9 @@ void initializeFBCCommandRegistry() {
     CoreCommandRegistry::registerCoreCommands(registry);
     CoreCommandRegistry::registerCoreFunctions(registry);
     
-    // Load plugins from plugins/enabled directory
+    // Load plugins from plugins/enabled directory; plugins recorded in the
+    // manifest cache are only loaded once the program uses one of their commands
+    FasterBASIC::PluginSystem::getGlobalPluginLoader().setLazyLoading(true);
     FasterBASIC::PluginSystem::initializeGlobalPluginLoader(registry);
     
     // Mark registry as initialized to prevent clearing
@@ -162,10 +166,12 @@ void printUsage(const char* programName) {
     std::cerr << "  -v, --verbose  Verbose output (compilation stats)\n";
     std::cerr << "  -h, --help     Show this help message\n";
     std::cerr << "  --profile      Show detailed timing for each compilation phase\n";
+    std::cerr << "  --runtime-stats Report JIT traces, aborts, machine code and GC activity at exit\n";
     std::cerr << "\nOptimization Options:\n";
     std::cerr << "  --opt-ast      Enable AST optimizer (constant folding, dead code)\n";
     std::cerr << "  --opt-peep     Enable peephole optimizer (IR-level optimizations)\n";
-    std::cerr << "  --opt-all      Enable all optimizers (AST + peephole)\n";
+    std::cerr << "  --opt-ssa      Enable SSA optimizer (global value numbering, copy propagation)\n";
+    std::cerr << "  --opt-all      Enable all optimizers (AST + SSA + peephole)\n";
     std::cerr << "  --opt-stats    Show detailed optimization statistics\n";
     std::cerr << "\nBehavior:\n";
     std::cerr << "  Default:       Compile and run program immediately (no optimizers)\n";
@@ -194,8 +200,10 @@ int main(int argc, char** argv) {
     bool timeExecution = false;
     bool enableASTOptimizer = false;
     bool enablePeepholeOptimizer = false;
+    bool enableSSAOptimizer = false;
     bool showOptStats = false;
     bool showProfile = false;
+    bool runtimeStats = false;
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -212,14 +220,19 @@ int main(int argc, char** argv) {
             enableASTOptimizer = true;
         } else if (strcmp(argv[i], "--opt-peep") == 0) {
             enablePeepholeOptimizer = true;
+        } else if (strcmp(argv[i], "--opt-ssa") == 0) {
+            enableSSAOptimizer = true;
         } else if (strcmp(argv[i], "--opt-all") == 0) {
             enableASTOptimizer = true;
+            enableSSAOptimizer = true;
             enablePeepholeOptimizer = true;
         } else if (strcmp(argv[i], "--opt-stats") == 0) {
             showOptStats = true;
         } else if (strcmp(argv[i], "--profile") == 0) {
             showProfile = true;
             verbose = true;  // Auto-enable verbose for profiling
+        } else if (strcmp(argv[i], "--runtime-stats") == 0) {
+            runtimeStats = true;
         } else if (strcmp(argv[i], "-o") == 0) {
             if (i + 1 < argc) {
                 outputFile = argv[++i];
@@ -339,7 +352,11 @@ int main(int argc, char** argv) {
             std::cerr << "Lexing...\n";
         }
         
+        // The registry no longer changes: compile against one frozen snapshot
+        auto commandTable = getGlobalCommandRegistry().snapshot();
+        
         Lexer lexer;
+        lexer.setCommandTable(commandTable);
         lexer.tokenize(source);
         auto tokens = lexer.getTokens();
         
@@ -358,12 +375,14 @@ int main(int argc, char** argv) {
         
         // Create semantic analyzer early to get ConstantsManager
         SemanticAnalyzer semantic;
+        semantic.setCommandTable(commandTable);
         
         // Ensure constants are loaded before parsing (for fast constant lookup)
         semantic.ensureConstantsLoaded();
         
         Parser parser;
         parser.setConstantsManager(&semantic.getConstantsManager());
+        parser.setCommandTable(commandTable);
         auto ast = parser.parse(tokens, inputFile);
         
         auto parseEndTime = std::chrono::high_resolution_clock::now();
@@ -460,6 +479,30 @@ int main(int argc, char** argv) {
             std::cerr << "IR instructions: " << irCode->instructions.size() << "\n";
         }
         
+        // SSA Optimization (redundancy across GOTO, IF and loop boundaries);
+        // runs first so the peephole passes fold the constants it propagates
+        double ssaMs = 0.0;
+        if (enableSSAOptimizer) {
+            phaseStartTime = std::chrono::high_resolution_clock::now();
+            if (verbose) {
+                std::cerr << "Running SSA optimizer...\n";
+            }
+            
+            SSAOptimizer ssaOpt;
+            ssaOpt.optimize(*irCode);
+            
+            auto ssaEndTime = std::chrono::high_resolution_clock::now();
+            ssaMs = std::chrono::duration<double, std::milli>(ssaEndTime - phaseStartTime).count();
+            
+            if (verbose || showOptStats) {
+                std::cerr << ssaOpt.generateReport();
+            }
+            
+            if (verbose) {
+                std::cerr << "IR instructions after SSA: " << irCode->instructions.size() << "\n";
+            }
+        }
+        
         // Peephole Optimization (IR-level optimizations)
         double peepholeMs = 0.0;
         if (enablePeepholeOptimizer) {
@@ -492,7 +535,9 @@ int main(int argc, char** argv) {
         
         LuaCodeGenConfig config;
         config.emitComments = emitComments;
+        config.runtimeStats = runtimeStats;
         LuaCodeGenerator luaGen(config);
+        luaGen.setCommandTable(commandTable);
         std::string luaCode = luaGen.generate(*irCode);
         
         auto codegenEndTime = std::chrono::high_resolution_clock::now();
@@ -500,6 +545,14 @@ int main(int argc, char** argv) {
         
         if (verbose) {
             std::cerr << "Generated Lua size: " << luaCode.length() << " bytes\n";
+            const auto& genStats = luaGen.getStats();
+            std::cerr << "Prelude helpers: " << genStats.helpersEmitted << " emitted, "
+                      << genStats.helpersDropped << " dropped (" << genStats.helperBytesDropped << " bytes)\n";
+            if (genStats.registerFallback.empty()) {
+                std::cerr << "Stack registers: " << genStats.stackRegisters << "\n";
+            } else {
+                std::cerr << "Stack registers: runtime stack kept (" << genStats.registerFallback << ")\n";
+            }
         }
         
         auto compileEndTime = std::chrono::high_resolution_clock::now();
@@ -517,6 +570,9 @@ int main(int argc, char** argv) {
             }
             std::cerr << "  CFG Builder:       " << std::fixed << std::setprecision(3) << cfgMs << " ms\n";
             std::cerr << "  IR Generator:      " << std::fixed << std::setprecision(3) << irMs << " ms\n";
+            if (enableSSAOptimizer) {
+                std::cerr << "  SSA Opt:           " << std::fixed << std::setprecision(3) << ssaMs << " ms\n";
+            }
             if (enablePeepholeOptimizer) {
                 std::cerr << "  Peephole Opt:      " << std::fixed << std::setprecision(3) << peepholeMs << " ms\n";
             }
@@ -535,6 +591,9 @@ int main(int argc, char** argv) {
             }
             std::cerr << "  CFG Builder:       " << std::fixed << std::setprecision(1) << (cfgMs / totalCompileMs * 100) << "%\n";
             std::cerr << "  IR Generator:      " << std::fixed << std::setprecision(1) << (irMs / totalCompileMs * 100) << "%\n";
+            if (enableSSAOptimizer) {
+                std::cerr << "  SSA Opt:           " << std::fixed << std::setprecision(1) << (ssaMs / totalCompileMs * 100) << "%\n";
+            }
             if (enablePeepholeOptimizer) {
                 std::cerr << "  Peephole Opt:      " << std::fixed << std::setprecision(1) << (peepholeMs / totalCompileMs * 100) << "%\n";
             }
@@ -578,11 +637,12 @@ int main(int argc, char** argv) {
         // Open standard libraries
         luaL_openlibs(L);
         
-        // Register runtime modules (unicode, bitwise, constants, file I/O) directly in Lua state
+        // Register runtime modules (unicode, bitwise, constants, embedded Lua runtime, file I/O) directly in Lua state
         // This makes them always available without needing external shared libraries
         register_unicode_module(L);
         register_bitwise_module(L);
         register_constants_module(L);
+        register_runtime_preload(L);
         
         // Add runtime directory to Lua's package.path so modules can require() each other
         lua_getglobal(L, "package");
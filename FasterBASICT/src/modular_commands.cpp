@@ -234,6 +234,53 @@ std::string CommandDefinition::getUsage() const {
     return ss.str();
 }
 
+// C types used by native plugin bindings (see FB_SetNativeSymbolFunc)
+static const char* nativeParameterCType(ParameterType type) {
+    switch (type) {
+        case ParameterType::INT:        return "int";
+        case ParameterType::FLOAT:      return "double";
+        case ParameterType::STRING:     return "const char*";
+        case ParameterType::COLOR:      return "uint32_t";
+        case ParameterType::BOOL:       return "int";
+        default:                        return nullptr;
+    }
+}
+
+static const char* nativeReturnCType(ReturnType type) {
+    switch (type) {
+        case ReturnType::VOID:          return "void";
+        case ReturnType::INT:           return "int";
+        case ReturnType::FLOAT:         return "double";
+        case ReturnType::STRING:        return "const char*";
+        case ReturnType::BOOL:          return "int";
+        default:                        return "void";
+    }
+}
+
+bool CommandDefinition::canBindNative() const {
+    for (const auto& param : parameters) {
+        if (!nativeParameterCType(param.type)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string CommandDefinition::getNativeDeclaration(const std::string& declName) const {
+    std::ostringstream ss;
+    ss << nativeReturnCType(returnType) << " " << declName << "(";
+    if (parameters.empty()) {
+        ss << "void";
+    }
+    for (size_t i = 0; i < parameters.size(); i++) {
+        if (i > 0) ss << ", ";
+        const char* ctype = nativeParameterCType(parameters[i].type);
+        ss << (ctype ? ctype : "void*");
+    }
+    ss << ") __asm__(\"" << nativeSymbol << "\")";
+    return ss.str();
+}
+
 // =============================================================================
 // CommandRegistry Implementation
 // =============================================================================
@@ -244,17 +291,20 @@ CommandRegistry::CommandRegistry() {
 
 void CommandRegistry::registerCommand(const CommandDefinition& cmd) {
     std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_snapshot.reset();
     m_commands[cmd.commandName] = cmd;
 }
 
 void CommandRegistry::registerCommand(CommandDefinition&& cmd) {
     std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_snapshot.reset();
     std::string name = cmd.commandName;
     m_commands[name] = std::move(cmd);
 }
 
 void CommandRegistry::registerFunction(const CommandDefinition& func) {
     std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_snapshot.reset();
     m_functions[func.commandName] = func;
     
     // Automatic name mangling: if name contains $, also register _STRING variant
@@ -272,6 +322,7 @@ void CommandRegistry::registerFunction(const CommandDefinition& func) {
 
 void CommandRegistry::registerFunction(CommandDefinition&& func) {
     std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_snapshot.reset();
     std::string name = func.commandName;
     
     // Check if we need to create a mangled variant before moving
@@ -308,16 +359,38 @@ bool CommandRegistry::hasCommandOrFunction(const std::string& name) const {
     return hasCommand(name) || hasFunction(name);
 }
 
-const CommandDefinition* CommandRegistry::getCommand(const std::string& name) const {
+const CommandDefinition* CommandRegistry::lookup(const std::unordered_map<std::string, CommandDefinition>& table,
+                                                 const std::string& name) const {
+    std::string pluginFile;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = table.find(name);
+        if (it == table.end()) return nullptr;
+        if (it->second.pluginFile.empty() || !m_deferredLoadHandler) return &it->second;
+        pluginFile = it->second.pluginFile;
+    }
+    
+    loadDeferredPlugin(pluginFile);
+    
     std::shared_lock<std::shared_mutex> lock(m_mutex);
-    auto it = m_commands.find(name);
-    return (it != m_commands.end()) ? &it->second : nullptr;
+    auto it = table.find(name);
+    return (it != table.end()) ? &it->second : nullptr;
+}
+
+void CommandRegistry::loadDeferredPlugin(const std::string& pluginFile) const {
+    // The handler registers the plugin's definitions, so it runs without m_mutex
+    std::lock_guard<std::mutex> lock(m_deferredLoadMutex);
+    if (m_deferredLoadHandler) {
+        m_deferredLoadHandler(pluginFile);
+    }
+}
+
+const CommandDefinition* CommandRegistry::getCommand(const std::string& name) const {
+    return lookup(m_commands, name);
 }
 
 const CommandDefinition* CommandRegistry::getFunction(const std::string& name) const {
-    std::shared_lock<std::shared_mutex> lock(m_mutex);
-    auto it = m_functions.find(name);
-    return (it != m_functions.end()) ? &it->second : nullptr;
+    return lookup(m_functions, name);
 }
 
 const CommandDefinition* CommandRegistry::getCommandOrFunction(const std::string& name) const {
@@ -326,6 +399,49 @@ const CommandDefinition* CommandRegistry::getCommandOrFunction(const std::string
     return getFunction(name);
 }
 
+// ASCII case-insensitive ordering, so lookups need not fold into a copy
+static int compareFolded(std::string_view a, std::string_view b) {
+    size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; i++) {
+        int ca = std::toupper(static_cast<unsigned char>(a[i]));
+        int cb = std::toupper(static_cast<unsigned char>(b[i]));
+        if (ca != cb) return ca < cb ? -1 : 1;
+    }
+    return (a.size() == b.size()) ? 0 : (a.size() < b.size() ? -1 : 1);
+}
+
+std::shared_ptr<const RegistrySnapshot> CommandRegistry::snapshot() const {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (m_snapshot) return m_snapshot;
+    
+    auto snap = std::make_shared<RegistrySnapshot>();
+    snap->m_registry = this;
+    auto build = [&](const std::unordered_map<std::string, CommandDefinition>& table,
+                     std::vector<RegistrySnapshot::Entry>& entries) {
+        entries.reserve(table.size());
+        for (const auto& pair : table) {
+            if (pair.second.pluginFile.empty() || !m_deferredLoadHandler) {
+                entries.push_back({pair.first, &pair.second, nullptr});
+                continue;
+            }
+            auto deferred = std::make_unique<RegistrySnapshot::Deferred>();
+            deferred->manifest = pair.second;
+            deferred->live = &pair.second;
+            entries.push_back({pair.first, &deferred->manifest, deferred.get()});
+            snap->m_deferred.push_back(std::move(deferred));
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const RegistrySnapshot::Entry& a, const RegistrySnapshot::Entry& b) {
+                      return compareFolded(a.name, b.name) < 0;
+                  });
+    };
+    build(m_commands, snap->m_commands);
+    build(m_functions, snap->m_functions);
+    
+    m_snapshot = snap;
+    return m_snapshot;
+}
+
 std::vector<std::string> CommandRegistry::getCommandNames() const {
     std::shared_lock<std::shared_mutex> lock(m_mutex);
     std::vector<std::string> names;
@@ -394,6 +510,7 @@ std::vector<std::string> CommandRegistry::getCategories() const {
 
 void CommandRegistry::clear() {
     std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_snapshot.reset();
     m_commands.clear();
     m_functions.clear();
 }
@@ -414,6 +531,46 @@ void CommandRegistry::initializeBuiltinFunctions() {
     // basic functions and register their own specific function sets.
 }
 
+// =============================================================================
+// Registry Snapshot Implementation
+// =============================================================================
+
+const RegistrySnapshot::Entry* RegistrySnapshot::find(const std::vector<Entry>& table,
+                                                      std::string_view name) {
+    auto it = std::lower_bound(table.begin(), table.end(), name,
+                               [](const Entry& entry, std::string_view key) {
+                                   return compareFolded(entry.name, key) < 0;
+                               });
+    return (it != table.end() && compareFolded(it->name, name) == 0) ? &*it : nullptr;
+}
+
+// A deferred entry loads its plugin once through the registry, which updates
+// the registry definition in place; the snapshot's copy is never written
+const CommandDefinition* RegistrySnapshot::resolve(const Entry& entry) const {
+    if (!entry.deferred) return entry.definition;
+    Deferred* deferred = entry.deferred;
+    std::call_once(deferred->loaded, [&] {
+        m_registry->loadDeferredPlugin(deferred->manifest.pluginFile);
+    });
+    return deferred->live;
+}
+
+const CommandDefinition* RegistrySnapshot::getCommand(std::string_view name) const {
+    const Entry* entry = find(m_commands, name);
+    return entry ? resolve(*entry) : nullptr;
+}
+
+const CommandDefinition* RegistrySnapshot::getFunction(std::string_view name) const {
+    const Entry* entry = find(m_functions, name);
+    return entry ? resolve(*entry) : nullptr;
+}
+
+const CommandDefinition* RegistrySnapshot::getCommandOrFunction(std::string_view name) const {
+    const CommandDefinition* cmd = getCommand(name);
+    if (cmd) return cmd;
+    return getFunction(name);
+}
+
 // =============================================================================
 // Deprecated Command Registration Methods
 // =============================================================================
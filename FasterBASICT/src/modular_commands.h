@@ -11,10 +11,13 @@
 #define FASTERBASIC_MODULAR_COMMANDS_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <functional>
 #include <shared_mutex>
+#include <mutex>
 
 namespace FasterBASIC {
 namespace ModularCommands {
@@ -74,12 +77,16 @@ struct CommandDefinition {
     ReturnType returnType;               // Return type (VOID for commands, other types for functions)
     bool isFunction;                     // Whether this is a function (returns value) or command (statement)
     std::string usage;                   // Optional usage string (auto-generated if empty)
+    std::string nativeSymbol;            // C symbol called through the FFI (plugin API v2)
+    std::string nativeLibrary;           // Absolute path of the library exporting nativeSymbol
+    std::string pluginFile;              // Plugin to load on first lookup (registered from the manifest cache)
     
     // Default constructor for std::unordered_map
     CommandDefinition() : commandName(""), description(""), luaFunction(""), 
                          category("general"), requiresParentheses(false),
                          customCodeTemplate(""), hasCustomCodeGen(false),
-                         returnType(ReturnType::VOID), isFunction(false), usage("") {}
+                         returnType(ReturnType::VOID), isFunction(false), usage(""),
+                         nativeSymbol(""), nativeLibrary(""), pluginFile("") {}
     
     CommandDefinition(const std::string& name,
                      const std::string& desc,
@@ -90,7 +97,8 @@ struct CommandDefinition {
         : commandName(name), description(desc), luaFunction(luaFunc),
           category(cat), requiresParentheses(needParens),
           customCodeTemplate(""), hasCustomCodeGen(false),
-          returnType(retType), isFunction(retType != ReturnType::VOID), usage("") {}
+          returnType(retType), isFunction(retType != ReturnType::VOID), usage(""),
+          nativeSymbol(""), nativeLibrary(""), pluginFile("") {}
     
     // Add a parameter to this command
     CommandDefinition& addParameter(const std::string& name,
@@ -136,12 +144,78 @@ struct CommandDefinition {
         return *this;
     }
     
+    // Bind to a C symbol exported by a plugin library (plugin API v2)
+    CommandDefinition& setNativeBinding(const std::string& symbol, const std::string& library) {
+        nativeSymbol = symbol;
+        nativeLibrary = library;
+        return *this;
+    }
+    
+    // Whether calls go straight to a native symbol instead of luaFunction
+    bool isNative() const { return !nativeSymbol.empty() && !hasCustomCodeGen; }
+    
+    // Whether every parameter has a C mapping (TYPENAME parameters do not)
+    bool canBindNative() const;
+    
+    // C declaration of the native symbol for ffi.cdef, under declName
+    // Example: "int my_double_fbn(int) __asm__(\"my_double\")"
+    std::string getNativeDeclaration(const std::string& declName) const;
+    
     // Get usage string (auto-generates if not set)
     // Format: "COMMAND param1, param2 [, optional]" for commands
     //         "FUNCTION(param1, param2 [, optional])" for functions
     std::string getUsage() const;
 };
 
+// =============================================================================
+// Registry Snapshot
+// =============================================================================
+
+class CommandRegistry;
+
+// Frozen, sorted view of a registry for compilation. Built once after
+// registration (CommandRegistry::snapshot) and queried without locks:
+// lookups binary-search flat tables, folding ASCII case as they compare.
+// Definitions stay owned by the registry; a snapshot is valid until the
+// registry is cleared. Definitions of deferred plugins are copied, since
+// loading the plugin rewrites the registry's copy in place.
+class RegistrySnapshot {
+public:
+    struct Deferred {
+        CommandDefinition manifest;          // Copy taken when the snapshot was built
+        const CommandDefinition* live;       // Registry definition the plugin re-registers
+        std::once_flag loaded;
+    };
+    
+    struct Entry {
+        std::string name;                    // Registered name (uppercase)
+        const CommandDefinition* definition; // Owned by the registry, or &deferred->manifest
+        Deferred* deferred;                  // Set while the plugin was not loaded yet
+    };
+    
+    // Look up by name, in any case
+    const CommandDefinition* getCommand(std::string_view name) const;
+    const CommandDefinition* getFunction(std::string_view name) const;
+    const CommandDefinition* getCommandOrFunction(std::string_view name) const;
+    
+    // Entries sorted by name
+    const std::vector<Entry>& getCommands() const { return m_commands; }
+    const std::vector<Entry>& getFunctions() const { return m_functions; }
+    
+private:
+    friend class CommandRegistry;
+    
+    std::vector<Entry> m_commands;
+    std::vector<Entry> m_functions;
+    std::vector<std::unique_ptr<Deferred>> m_deferred;
+    const CommandRegistry* m_registry;       // Loads deferred plugin definitions
+    
+    static const Entry* find(const std::vector<Entry>& table, std::string_view name);
+    
+    // Registry definition for entry, loading its plugin once if deferred
+    const CommandDefinition* resolve(const Entry& entry) const;
+};
+
 // =============================================================================
 // Command Registry
 // =============================================================================
@@ -167,6 +241,9 @@ public:
     bool hasCommand(const std::string& name) const;
     bool hasFunction(const std::string& name) const;
     bool hasCommandOrFunction(const std::string& name) const;
+    
+    // getCommand/getFunction load the owning plugin first when the definition
+    // came from the plugin manifest cache (see setDeferredLoadHandler)
     const CommandDefinition* getCommand(const std::string& name) const;
     const CommandDefinition* getFunction(const std::string& name) const;
     const CommandDefinition* getCommandOrFunction(const std::string& name) const;
@@ -190,6 +267,20 @@ public:
     // Get command count
     size_t getCommandCount() const { return m_commands.size(); }
     
+    // Called with CommandDefinition::pluginFile the first time a deferred
+    // definition is looked up; the handler loads the plugin, whose FB_PLUGIN_INIT
+    // re-registers the definition without pluginFile
+    using DeferredLoadHandler = std::function<void(const std::string& pluginFile)>;
+    void setDeferredLoadHandler(DeferredLoadHandler handler) { m_deferredLoadHandler = std::move(handler); }
+    
+    // Run the handler for pluginFile; loads are serialized, so a plugin
+    // another thread is loading is complete when this returns
+    void loadDeferredPlugin(const std::string& pluginFile) const;
+    
+    // Frozen view for lock-free lookups during compilation; rebuilt on the
+    // first call after a registration
+    std::shared_ptr<const RegistrySnapshot> snapshot() const;
+    
     // Initialize with built-in commands and functions
     void initializeBuiltinCommands();
     void initializeBuiltinFunctions();
@@ -198,6 +289,13 @@ private:
     std::unordered_map<std::string, CommandDefinition> m_commands;
     std::unordered_map<std::string, CommandDefinition> m_functions;
     mutable std::shared_mutex m_mutex;  // Protect concurrent access
+    DeferredLoadHandler m_deferredLoadHandler;
+    mutable std::mutex m_deferredLoadMutex;  // One deferred plugin load at a time
+    mutable std::shared_ptr<const RegistrySnapshot> m_snapshot;  // Reset by every registration
+    
+    // Look up name in table, loading its plugin first if it is deferred
+    const CommandDefinition* lookup(const std::unordered_map<std::string, CommandDefinition>& table,
+                                    const std::string& name) const;
     
     // Helper methods for registering built-in command sets
     void registerTextCommands();
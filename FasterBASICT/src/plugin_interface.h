@@ -6,7 +6,12 @@
 // developers to create dynamic libraries that extend the compiler with
 // custom commands and functions.
 //
-// API Version: 1.0
+// API Version: 2.0
+//
+// Version 2 adds native bindings: a command or function can be bound to a
+// typed C symbol exported by the plugin (see setNativeSymbol below). The
+// generated Lua calls such symbols through the LuaJIT FFI, which compiles to
+// a direct native call. Version 1 plugins keep working unchanged.
 //
 
 #ifndef FASTERBASIC_PLUGIN_INTERFACE_H
@@ -94,6 +99,27 @@ extern "C" {
         int commandId,
         const char* codeTemplate
     );
+
+    // Bind a command/function to a C symbol exported by the plugin (API v2)
+    // The symbol is called directly through the LuaJIT FFI instead of the Lua
+    // function named at registration. Its C signature follows the declared
+    // parameter and return types:
+    //   FB_PARAM_INT / FB_RETURN_INT       -> int
+    //   FB_PARAM_FLOAT / FB_RETURN_FLOAT   -> double
+    //   FB_PARAM_STRING / FB_RETURN_STRING -> const char* (UTF-8)
+    //   FB_PARAM_COLOR                     -> uint32_t
+    //   FB_PARAM_BOOL / FB_RETURN_BOOL     -> int (0 or 1)
+    //   FB_RETURN_VOID                     -> void
+    // A returned string is copied immediately, so it may point to a static or
+    // per-plugin buffer that the next call overwrites. FB_PARAM_TYPENAME
+    // parameters cannot be bound natively.
+    // commandId: handle returned from BeginCommand or BeginFunction
+    // Returns: 0 on success, -1 if the symbol is not exported by the plugin
+    typedef int (*FB_SetNativeSymbolFunc)(
+        void* userData,
+        int commandId,
+        const char* symbolName
+    );
 }
 
 // =============================================================================
@@ -112,6 +138,9 @@ struct FB_PluginCallbacks {
     
     // User data (opaque pointer to CommandRegistry)
     void* userData;
+
+    // Later API versions append here so v1 plugins keep their layout
+    FB_SetNativeSymbolFunc setNativeSymbol;  // API v2 (absent for v1 plugins)
 };
 
 // =============================================================================
@@ -145,7 +174,8 @@ extern "C" {
     
     // API version constants
     #define FB_PLUGIN_API_VERSION_1 1
-    #define FB_PLUGIN_API_VERSION_CURRENT FB_PLUGIN_API_VERSION_1
+    #define FB_PLUGIN_API_VERSION_2 2
+    #define FB_PLUGIN_API_VERSION_CURRENT FB_PLUGIN_API_VERSION_2
 }
 
 // =============================================================================
@@ -224,6 +254,14 @@ public:
         return *this;
     }
 
+    // Bind to a C symbol exported by the plugin (API v2)
+    FB_CommandBuilder& setNativeSymbol(const char* symbolName) {
+        if (m_valid && m_callbacks->setNativeSymbol) {
+            m_callbacks->setNativeSymbol(m_callbacks->userData, m_commandId, symbolName);
+        }
+        return *this;
+    }
+
     // Finish command registration
     bool finish() {
         if (m_valid && m_callbacks->endCommand) {
@@ -288,9 +326,9 @@ inline FB_CommandBuilder FB_BeginFunction(FB_PluginCallbacks* callbacks, const c
 //    - Optional - can be empty if no cleanup needed
 //
 // 5. API VERSION
-//    - Must return FB_PLUGIN_API_VERSION_CURRENT
-//    - Plugin loader checks version compatibility
-//    - Incompatible versions are rejected
+//    - Should return FB_PLUGIN_API_VERSION_CURRENT
+//    - Plugin loader accepts versions 1 and 2; others are rejected
+//    - Native bindings (setNativeSymbol) require version 2
 //
 // 6. THREAD SAFETY
 //    - Init function is called single-threaded at startup
@@ -338,6 +376,43 @@ FB_PLUGIN_SHUTDOWN() {
 
 */
 
+// =============================================================================
+// Example Plugin (Native Bindings, API v2)
+// =============================================================================
+/*
+
+#include "plugin_interface.h"
+
+FB_PLUGIN_EXPORT int my_double(int value) { return value * 2; }
+
+FB_PLUGIN_EXPORT const char* my_greeting(const char* name) {
+    static std::string result;
+    result = std::string("Hello, ") + name;
+    return result.c_str();
+}
+
+FB_PLUGIN_BEGIN("Native Example", "1.0.0", "Native example plugin", "FasterBASIC Team", "")
+
+FB_PLUGIN_INIT(callbacks) {
+    // The Lua function name is unused once a native symbol is bound
+    FB_BeginFunction(callbacks, "DOUBLE", "Double a number", "my_double", FB_RETURN_INT)
+        .addParameter("value", FB_PARAM_INT, "Value to double")
+        .setNativeSymbol("my_double")
+        .finish();
+
+    FB_BeginFunction(callbacks, "GREETING", "Greet someone", "my_greeting", FB_RETURN_STRING)
+        .addParameter("name", FB_PARAM_STRING, "Name to greet")
+        .setNativeSymbol("my_greeting")
+        .finish();
+
+    return 0;
+}
+
+FB_PLUGIN_SHUTDOWN() {
+}
+
+*/
+
 // =============================================================================
 // Example Plugin (Using Raw Callbacks)
 // =============================================================================
@@ -81,6 +81,7 @@
 #include <algorithm>
 #include <map>
 #include <fstream>
+#include <sstream>
 
 // Platform-specific includes for dynamic library loading
 #ifdef _WIN32
@@ -115,6 +116,24 @@ struct CommandInProgress {
 static std::map<int, CommandInProgress> g_commandsInProgress;
 static int g_nextCommandId = 1;
 
+// Library whose FB_PLUGIN_INIT is running (for native symbol bindings)
+static void* g_initializingHandle = nullptr;
+static std::string g_initializingLibrary;
+
+// Definitions registered by the running FB_PLUGIN_INIT (for the manifest cache)
+static std::vector<ModularCommands::CommandDefinition>* g_initializingDefinitions = nullptr;
+
+// Look up an exported symbol in a loaded library
+static void* findLibrarySymbol(void* handle, const char* name) {
+    if (!handle) return nullptr;
+    
+#ifdef _WIN32
+    return (void*)GetProcAddress((HMODULE)handle, name);
+#else
+    return dlsym(handle, name);
+#endif
+}
+
 // Callback: Begin registering a command
 static int Plugin_BeginCommand(void* userData, const char* name, const char* description,
                               const char* luaFunction, const char* category) {
@@ -191,6 +210,19 @@ static int Plugin_EndCommand(void* userData, int commandId) {
     auto* registry = static_cast<ModularCommands::CommandRegistry*>(userData);
     auto* def = it->second.definition;
     
+    // Native bindings need a C type for every parameter
+    if (!def->nativeSymbol.empty() && !def->canBindNative()) {
+        std::cerr << "Plugin command " << def->commandName
+                  << ": TYPENAME parameters cannot be bound to a native symbol" << std::endl;
+        delete def;
+        g_commandsInProgress.erase(it);
+        return -1;
+    }
+    
+    if (g_initializingDefinitions) {
+        g_initializingDefinitions->push_back(*def);
+    }
+    
     // Register the command or function
     if (def->isFunction) {
         registry->registerFunction(std::move(*def));
@@ -218,6 +250,21 @@ static int Plugin_SetCustomCodeGen(void* userData, int commandId, const char* co
     return 0;
 }
 
+// Callback: Bind command/function to a native symbol exported by the plugin (API v2)
+static int Plugin_SetNativeSymbol(void* userData, int commandId, const char* symbolName) {
+    auto it = g_commandsInProgress.find(commandId);
+    if (it == g_commandsInProgress.end() || !it->second.isValid) {
+        return -1;
+    }
+    
+    if (!symbolName || !findLibrarySymbol(g_initializingHandle, symbolName)) {
+        return -1;
+    }
+    
+    it->second.definition->setNativeBinding(symbolName, g_initializingLibrary);
+    return 0;
+}
+
 // =============================================================================
 // Global Plugin Loader Instance
 // =============================================================================
@@ -249,7 +296,7 @@ void shutdownGlobalPluginLoader() {
 // =============================================================================
 
 PluginLoader::PluginLoader()
-    : m_baseDirectory("plugins") {
+    : m_lazyLoading(false), m_deferredRegistry(nullptr), m_baseDirectory("plugins") {
     // Create plugin directories if they don't exist
     createPluginDirectories();
 }
@@ -269,18 +316,27 @@ PluginLoader::~PluginLoader() {
 int PluginLoader::loadEnabledPlugins(ModularCommands::CommandRegistry& registry) {
     std::string enabledDir = getEnabledPluginsDirectory();
     
-    int loaded = loadPluginsFromDirectory(enabledDir, registry);
+    int loaded = m_lazyLoading ? loadPluginsWithManifest(enabledDir, registry)
+                               : loadPluginsFromDirectory(enabledDir, registry);
     
-    // Print consolidated plugin loading message
+    // Print consolidated plugin loading message (deferred plugins included)
     if (loaded > 0) {
+        std::vector<const PluginInfo*> available;
+        for (const auto& plugin : m_plugins) {
+            if (plugin.loadedSuccessfully) available.push_back(&plugin);
+        }
+        for (const auto& plugin : m_deferredPlugins) {
+            available.push_back(&plugin);
+        }
+        std::sort(available.begin(), available.end(),
+                  [](const PluginInfo* a, const PluginInfo* b) { return a->filePath < b->filePath; });
+        
         std::cout << "Loading plugins [";
         bool first = true;
-        for (const auto& plugin : m_plugins) {
-            if (plugin.loadedSuccessfully) {
-                if (!first) std::cout << ", ";
-                std::cout << plugin.name << " (" << plugin.commandCount << ")";
-                first = false;
-            }
+        for (const auto* plugin : available) {
+            if (!first) std::cout << ", ";
+            std::cout << plugin->name << " (" << plugin->commandCount << ")";
+            first = false;
         }
         std::cout << "]" << std::endl;
     }
@@ -314,6 +370,118 @@ int PluginLoader::loadPluginsFromDirectory(const std::string& directory,
     return loadedCount;
 }
 
+// Size and modification time identify a plugin build in the manifest cache
+static bool statPluginFile(const std::string& filepath, uintmax_t& size, int64_t& time) {
+    std::error_code ec;
+    size = fs::file_size(filepath, ec);
+    if (ec) return false;
+    auto written = fs::last_write_time(filepath, ec);
+    if (ec) return false;
+    time = static_cast<int64_t>(written.time_since_epoch().count());
+    return true;
+}
+
+int PluginLoader::loadPluginsWithManifest(const std::string& directory,
+                                          ModularCommands::CommandRegistry& registry) {
+    if (!fs::exists(directory) || !fs::is_directory(directory)) {
+        std::cerr << "Plugin directory not found: " << directory << std::endl;
+        return 0;
+    }
+    
+    std::map<std::string, PluginInfo> manifest = readManifest();
+    std::map<std::string, PluginInfo> current;
+    bool changed = false;
+    int loadedCount = 0;
+    
+    for (const auto& filepath : scanDirectoryForPlugins(directory)) {
+        std::string fileName = fs::path(filepath).filename().string();
+        uintmax_t size = 0;
+        int64_t time = 0;
+        bool statted = statPluginFile(filepath, size, time);
+        
+        // Unchanged since it was recorded: register from the manifest, load on first use
+        auto it = manifest.find(fileName);
+        if (statted && it != manifest.end() &&
+            it->second.fileSize == size && it->second.fileTime == time) {
+            PluginInfo entry = it->second;
+            entry.filePath = filepath;
+            registerDeferredPlugin(entry, registry);
+            current[fileName] = entry;
+            loadedCount++;
+            continue;
+        }
+        
+        // New or rebuilt: load it now and record what it registers
+        changed = true;
+        if (loadPlugin(filepath, registry, true)) {
+            loadedCount++;
+            if (statted) {
+                PluginInfo entry = m_plugins.back();
+                entry.fileSize = size;
+                entry.fileTime = time;
+                current[fileName] = entry;
+            }
+        }
+    }
+    
+    if (changed || current.size() != manifest.size()) {
+        writeManifest(current);
+    }
+    
+    return loadedCount;
+}
+
+void PluginLoader::registerDeferredPlugin(const PluginInfo& entry,
+                                          ModularCommands::CommandRegistry& registry) {
+    std::string library = fs::absolute(entry.filePath).string();
+    
+    for (auto def : entry.definitions) {
+        def.pluginFile = entry.filePath;
+        if (!def.nativeSymbol.empty()) {
+            def.nativeLibrary = library;
+        }
+        if (def.isFunction) {
+            registry.registerFunction(std::move(def));
+        } else {
+            registry.registerCommand(std::move(def));
+        }
+    }
+    
+    PluginInfo info = entry;
+    info.isEnabled = true;
+    info.definitions.clear();
+    m_deferredPlugins.push_back(info);
+    
+    if (!m_deferredRegistry) {
+        m_deferredRegistry = &registry;
+        registry.setDeferredLoadHandler([this](const std::string& pluginFile) {
+            loadDeferredPlugin(pluginFile);
+        });
+    }
+}
+
+bool PluginLoader::loadDeferredPlugin(const std::string& filepath) {
+    auto it = std::find_if(m_deferredPlugins.begin(), m_deferredPlugins.end(),
+                           [&](const PluginInfo& info) { return info.filePath == filepath; });
+    if (it == m_deferredPlugins.end() || !m_deferredRegistry) {
+        return false;
+    }
+    m_deferredPlugins.erase(it);
+    
+    // FB_PLUGIN_INIT re-registers the deferred definitions in place
+    if (loadPlugin(filepath, *m_deferredRegistry, true)) {
+        return true;
+    }
+    
+    const PluginInfo& failed = m_failedPlugins.back();
+    std::cerr << "Failed to load plugin " << failed.fileName << ": " << failed.loadError << std::endl;
+    
+    // The manifest no longer describes this plugin; rebuild it next run
+    std::error_code ec;
+    fs::remove(getManifestPath(), ec);
+    return false;
+}
+
 bool PluginLoader::loadPlugin(const std::string& filepath,
                               ModularCommands::CommandRegistry& registry,
                               bool isEnabled) {
@@ -348,9 +516,10 @@ bool PluginLoader::loadPlugin(const std::string& filepath,
         return false;
     }
     
-    // Check API version compatibility
-    if (info.apiVersion != FB_PLUGIN_API_VERSION_CURRENT) {
+    // Check API version compatibility (version 1 plugins are still supported)
+    if (info.apiVersion < FB_PLUGIN_API_VERSION_1 || info.apiVersion > FB_PLUGIN_API_VERSION_CURRENT) {
         info.loadError = "API version mismatch (expected " + 
+                        std::to_string(FB_PLUGIN_API_VERSION_1) + " to " +
                         std::to_string(FB_PLUGIN_API_VERSION_CURRENT) + 
                         ", got " + std::to_string(info.apiVersion) + ")";
         unloadLibrary(handle);
@@ -417,6 +586,12 @@ void PluginLoader::unloadAllPlugins() {
     
     m_plugins.clear();
     m_failedPlugins.clear();
+    m_deferredPlugins.clear();
+    
+    if (m_deferredRegistry) {
+        m_deferredRegistry->setDeferredLoadHandler(nullptr);
+        m_deferredRegistry = nullptr;
+    }
 }
 
 const std::vector<PluginInfo>& PluginLoader::getLoadedPlugins() const {
@@ -518,6 +693,10 @@ std::string PluginLoader::getDisabledPluginsDirectory() const {
     return m_baseDirectory + "/disabled";
 }
 
+std::string PluginLoader::getManifestPath() const {
+    return m_baseDirectory + "/manifest.cache";
+}
+
 bool PluginLoader::createPluginDirectories() {
     try {
         fs::create_directories(getEnabledPluginsDirectory());
@@ -542,13 +721,7 @@ void* PluginLoader::loadLibrary(const std::string& filepath) {
 }
 
 void* PluginLoader::getSymbol(void* handle, const char* name) const {
-    if (!handle) return nullptr;
-    
-#ifdef _WIN32
-    return (void*)GetProcAddress((HMODULE)handle, name);
-#else
-    return dlsym(handle, name);
-#endif
+    return findLibrarySymbol(handle, name);
 }
 
 void PluginLoader::unloadLibrary(void* handle) {
@@ -688,8 +861,21 @@ bool PluginLoader::initializePlugin(void* handle, PluginInfo& info,
     callbacks.addParameter = Plugin_AddParameter;
     callbacks.endCommand = Plugin_EndCommand;
     callbacks.setCustomCodeGen = Plugin_SetCustomCodeGen;
+    callbacks.setNativeSymbol = info.apiVersion >= FB_PLUGIN_API_VERSION_2 ? Plugin_SetNativeSymbol : nullptr;
     callbacks.userData = &registry;
     
+    // Generated code loads the library by absolute path (ffi.load)
+    g_initializingHandle = handle;
+    g_initializingLibrary = fs::absolute(info.filePath).string();
+    g_initializingDefinitions = &info.definitions;
+    struct InitScope {
+        ~InitScope() {
+            g_initializingHandle = nullptr;
+            g_initializingLibrary.clear();
+            g_initializingDefinitions = nullptr;
+        }
+    } initScope;
+    
     try {
         int result = initFunc(&callbacks);
         if (result != 0) {
@@ -757,6 +943,184 @@ bool PluginLoader::cacheRuntimeFile(const std::string& filename) {
     return true;
 }
 
+// =============================================================================
+// Plugin Manifest Cache
+// =============================================================================
+// One record per line, tab-separated; backslash, tab, newline and carriage
+// return inside fields are written as \\, \t, \n and \r:
+//
+//   FBPLUGINMANIFEST  <format>
+//   plugin   <file> <size> <mtime> <name> <version> <description> <author>
+//            <api version> <command count> <runtime files, comma-separated>
+//   command  <C|F> <name> <description> <lua function> <category> <return type>
+//            <requires parens> <custom codegen> <template> <native symbol> <usage>
+//   param    <name> <type> <description> <optional> <default>
+//
+// command records belong to the plugin above them, param records to the
+// command above them.
+
+static const char* MANIFEST_MAGIC = "FBPLUGINMANIFEST";
+// Format 2: manifests written while the v2 callback broke the v1 layout
+// could record v1 plugins with no commands; they are rebuilt
+static const int MANIFEST_FORMAT = 2;
+
+static std::string escapeManifestField(const std::string& field) {
+    std::string out;
+    out.reserve(field.size());
+    for (char c : field) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '\t': out += "\\t"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            default: out += c; break;
+        }
+    }
+    return out;
+}
+
+static std::vector<std::string> splitManifestLine(const std::string& line) {
+    std::vector<std::string> fields(1);
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (c == '\t') {
+            fields.emplace_back();
+        } else if (c == '\\' && i + 1 < line.size()) {
+            char e = line[++i];
+            fields.back() += (e == 't') ? '\t' : (e == 'n') ? '\n' : (e == 'r') ? '\r' : e;
+        } else {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+std::map<std::string, PluginInfo> PluginLoader::readManifest() const {
+    std::map<std::string, PluginInfo> entries;
+    std::ifstream file(getManifestPath());
+    if (!file.is_open()) {
+        return entries;
+    }
+    
+    std::string line;
+    if (!std::getline(file, line)) {
+        return entries;
+    }
+    std::vector<std::string> header = splitManifestLine(line);
+    if (header.size() != 2 || header[0] != MANIFEST_MAGIC ||
+        header[1] != std::to_string(MANIFEST_FORMAT)) {
+        return entries;
+    }
+    
+    // Any malformed record discards the whole manifest (it is rebuilt)
+    PluginInfo* plugin = nullptr;
+    try {
+        while (std::getline(file, line)) {
+            std::vector<std::string> f = splitManifestLine(line);
+            if (f[0] == "plugin" && f.size() == 11) {
+                PluginInfo& info = entries[f[1]];
+                info.fileName = f[1];
+                info.fileSize = std::stoull(f[2]);
+                info.fileTime = std::stoll(f[3]);
+                info.name = f[4];
+                info.version = f[5];
+                info.description = f[6];
+                info.author = f[7];
+                info.apiVersion = std::stoi(f[8]);
+                info.commandCount = std::stoull(f[9]);
+                std::stringstream runtimeFiles(f[10]);
+                std::string runtimeFile;
+                while (std::getline(runtimeFiles, runtimeFile, ',')) {
+                    if (!runtimeFile.empty()) info.runtimeFiles.push_back(runtimeFile);
+                }
+                info.loadedSuccessfully = true;
+                plugin = &info;
+            } else if (f[0] == "command" && f.size() == 12 && plugin) {
+                ModularCommands::CommandDefinition def(f[2], f[3], f[4], f[5], f[7] == "1",
+                    static_cast<ModularCommands::ReturnType>(std::stoi(f[6])));
+                def.isFunction = (f[1] == "F");
+                if (f[8] == "1") def.setCustomCodeGen(f[9]);
+                def.nativeSymbol = f[10];
+                def.usage = f[11];
+                plugin->definitions.push_back(std::move(def));
+            } else if (f[0] == "param" && f.size() == 6 && plugin && !plugin->definitions.empty()) {
+                plugin->definitions.back().addParameter(f[1],
+                    static_cast<ModularCommands::ParameterType>(std::stoi(f[2])),
+                    f[3], f[4] == "1", f[5]);
+            } else {
+                entries.clear();
+                return entries;
+            }
+        }
+    } catch (const std::exception&) {
+        entries.clear();
+    }
+    
+    return entries;
+}
+
+void PluginLoader::writeManifest(const std::map<std::string, PluginInfo>& entries) const {
+    std::ostringstream out;
+    out << MANIFEST_MAGIC << '\t' << MANIFEST_FORMAT << '\n';
+    
+    for (const auto& pair : entries) {
+        const PluginInfo& info = pair.second;
+        std::string runtimeFiles;
+        for (const auto& runtimeFile : info.runtimeFiles) {
+            if (!runtimeFiles.empty()) runtimeFiles += ',';
+            runtimeFiles += runtimeFile;
+        }
+        out << "plugin\t" << escapeManifestField(info.fileName)
+            << '\t' << info.fileSize << '\t' << info.fileTime
+            << '\t' << escapeManifestField(info.name)
+            << '\t' << escapeManifestField(info.version)
+            << '\t' << escapeManifestField(info.description)
+            << '\t' << escapeManifestField(info.author)
+            << '\t' << info.apiVersion << '\t' << info.commandCount
+            << '\t' << escapeManifestField(runtimeFiles) << '\n';
+        
+        for (const auto& def : info.definitions) {
+            out << "command\t" << (def.isFunction ? 'F' : 'C')
+                << '\t' << escapeManifestField(def.commandName)
+                << '\t' << escapeManifestField(def.description)
+                << '\t' << escapeManifestField(def.luaFunction)
+                << '\t' << escapeManifestField(def.category)
+                << '\t' << static_cast<int>(def.returnType)
+                << '\t' << (def.requiresParentheses ? 1 : 0)
+                << '\t' << (def.hasCustomCodeGen ? 1 : 0)
+                << '\t' << escapeManifestField(def.customCodeTemplate)
+                << '\t' << escapeManifestField(def.nativeSymbol)
+                << '\t' << escapeManifestField(def.usage) << '\n';
+            for (const auto& param : def.parameters) {
+                out << "param\t" << escapeManifestField(param.name)
+                    << '\t' << static_cast<int>(param.type)
+                    << '\t' << escapeManifestField(param.description)
+                    << '\t' << (param.isOptional ? 1 : 0)
+                    << '\t' << escapeManifestField(param.defaultValue) << '\n';
+            }
+        }
+    }
+    
+    // Write beside the manifest and rename, so a concurrent fbc never reads half a file
+    std::string path = getManifestPath();
+    std::string temp = path + ".tmp" + std::to_string(static_cast<long long>(
+        std::hash<std::string>{}(out.str()) & 0xffffff));
+    {
+        std::ofstream file(temp, std::ios::trunc);
+        if (!file.is_open()) return;
+        file << out.str();
+        if (!file) {
+            file.close();
+            std::error_code ec;
+            fs::remove(temp, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+    if (ec) fs::remove(temp, ec);
+}
+
 void PluginLoader::setRuntimeDirectory(const std::string& path) {
     m_runtimeDirectory = path;
 }
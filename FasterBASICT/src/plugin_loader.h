@@ -5,6 +5,11 @@
 // Provides dynamic loading of plugin libraries from the plugins/enabled directory.
 // Plugins can be disabled by moving them to plugins/disabled without deletion.
 //
+// With lazy loading enabled, the commands each plugin registers are recorded
+// in plugins/manifest.cache, keyed by file size and modification time. Later
+// runs register those definitions straight from the manifest and dlopen a
+// plugin only when the program looks up one of its commands.
+//
 
 #ifndef FASTERBASIC_PLUGIN_LOADER_H
 #define FASTERBASIC_PLUGIN_LOADER_H
@@ -13,6 +18,7 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <cstdint>
 #include "modular_commands.h"
 #include "plugin_interface.h"
 
@@ -37,6 +43,9 @@ struct PluginInfo {
     bool loadedSuccessfully;             // True if init succeeded
     std::string loadError;               // Error message if load failed
     size_t commandCount;                 // Number of commands/functions added
+    std::vector<ModularCommands::CommandDefinition> definitions; // What FB_PLUGIN_INIT registered
+    uintmax_t fileSize;                  // Manifest cache key: file size
+    int64_t fileTime;                    // Manifest cache key: modification time
     
     FB_PluginShutdownFunc shutdownFunc;  // Shutdown function pointer
     
@@ -44,7 +53,8 @@ struct PluginInfo {
         : name(""), version(""), description(""), author(""),
           filePath(""), fileName(""), libraryHandle(nullptr),
           apiVersion(0), isEnabled(false), loadedSuccessfully(false),
-          loadError(""), commandCount(0), shutdownFunc(nullptr) {}
+          loadError(""), commandCount(0), fileSize(0), fileTime(0),
+          shutdownFunc(nullptr) {}
 };
 
 // =============================================================================
@@ -74,6 +84,16 @@ public:
                    ModularCommands::CommandRegistry& registry,
                    bool isEnabled = true);
     
+    // Register plugins from the manifest cache and defer loading them until
+    // one of their commands is looked up (must be called before loading plugins)
+    void setLazyLoading(bool enabled) { m_lazyLoading = enabled; }
+    
+    // Load a plugin deferred by the manifest cache (registry lookup handler)
+    bool loadDeferredPlugin(const std::string& filepath);
+    
+    // Plugins registered from the manifest cache that are not loaded yet
+    const std::vector<PluginInfo>& getDeferredPlugins() const { return m_deferredPlugins; }
+    
     // =========================================================================
     // Plugin Management
     // =========================================================================
@@ -119,6 +139,9 @@ public:
     // Create plugin directories if they don't exist
     bool createPluginDirectories();
     
+    // Get the plugin manifest cache path
+    std::string getManifestPath() const;
+    
     // =========================================================================
     // Statistics
     // =========================================================================
@@ -154,6 +177,9 @@ private:
     
     std::vector<PluginInfo> m_plugins;        // Successfully loaded plugins
     std::vector<PluginInfo> m_failedPlugins;  // Plugins that failed to load
+    std::vector<PluginInfo> m_deferredPlugins; // Registered from the manifest, not loaded yet
+    bool m_lazyLoading;                       // Use the manifest cache
+    ModularCommands::CommandRegistry* m_deferredRegistry; // Registry holding deferred definitions
     std::string m_baseDirectory;              // Base plugins directory
     std::string m_runtimeDirectory;           // Runtime files directory
     std::map<std::string, std::string> m_cachedRuntimeContents;  // Cached Lua runtime file contents
@@ -202,6 +228,20 @@ private:
     
     // Load and cache a runtime file
     bool cacheRuntimeFile(const std::string& filename);
+    
+    // Load plugins from a directory through the manifest cache
+    int loadPluginsWithManifest(const std::string& directory,
+                                ModularCommands::CommandRegistry& registry);
+    
+    // Read the manifest cache into entries keyed by file name
+    std::map<std::string, PluginInfo> readManifest() const;
+    
+    // Write the manifest cache (errors are ignored; the next run rebuilds it)
+    void writeManifest(const std::map<std::string, PluginInfo>& entries) const;
+    
+    // Register a manifest entry's definitions and defer loading the plugin
+    void registerDeferredPlugin(const PluginInfo& entry,
+                                ModularCommands::CommandRegistry& registry);
 };
 
 // =============================================================================
@@ -176,6 +176,20 @@ g++ -std=c++17 -O2 -c \
     "$SRC_DIR/fasterbasic_peephole.cpp" \
     -o "$BUILD_DIR/fasterbasic_peephole.o"
 
+echo "  - fasterbasic_regir.cpp"
+g++ -std=c++17 -O2 -c \
+    -I"$LUAJIT_INCLUDE" \
+    -I"$SRC_DIR" \
+    "$SRC_DIR/fasterbasic_regir.cpp" \
+    -o "$BUILD_DIR/fasterbasic_regir.o"
+
+echo "  - fasterbasic_ssa.cpp"
+g++ -std=c++17 -O2 -c \
+    -I"$LUAJIT_INCLUDE" \
+    -I"$SRC_DIR" \
+    "$SRC_DIR/fasterbasic_ssa.cpp" \
+    -o "$BUILD_DIR/fasterbasic_ssa.o"
+
 echo "  - fasterbasic_cfg.cpp"
 g++ -std=c++17 -O2 -c \
     -I"$LUAJIT_INCLUDE" \
@@ -282,6 +296,26 @@ g++ -std=c++17 -O2 -c \
     "$RUNTIME_DIR/console_stubs.cpp" \
     -o "$BUILD_DIR/console_stubs.o"
 
+echo "  - runtime_preload.cpp"
+g++ -std=c++17 -O2 -c \
+    -I"$LUAJIT_INCLUDE" \
+    -I"$RUNTIME_DIR" \
+    "$RUNTIME_DIR/runtime_preload.cpp" \
+    -o "$BUILD_DIR/runtime_preload.o"
+
+# Compile the runtime Lua modules to bytecode and embed them (package.preload)
+echo "  - runtime_bytecode.cpp (embedded runtime modules)"
+g++ -std=c++17 -O2 \
+    -I"$LUAJIT_INCLUDE" \
+    "$RUNTIME_DIR/embed_runtime_bytecode.cpp" \
+    -L"$LUAJIT_LIB" -lluajit-5.1 \
+    -o "$BUILD_DIR/embed_runtime_bytecode"
+"$BUILD_DIR/embed_runtime_bytecode" "$RUNTIME_DIR" "$BUILD_DIR/runtime_bytecode.cpp"
+g++ -std=c++17 -O2 -c \
+    -I"$RUNTIME_DIR" \
+    "$BUILD_DIR/runtime_bytecode.cpp" \
+    -o "$BUILD_DIR/runtime_bytecode.o"
+
 echo ""
 echo "Linking fbc executable..."
 
@@ -297,6 +331,8 @@ g++ -std=c++17 -O2 \
     "$BUILD_DIR/fasterbasic_data_preprocessor.o" \
     "$BUILD_DIR/fasterbasic_optimizer.o" \
     "$BUILD_DIR/fasterbasic_peephole.o" \
+    "$BUILD_DIR/fasterbasic_regir.o" \
+    "$BUILD_DIR/fasterbasic_ssa.o" \
     "$BUILD_DIR/fasterbasic_cfg.o" \
     "$BUILD_DIR/ConstantsManager.o" \
     "$BUILD_DIR/constants_lua_bindings.o" \
@@ -318,6 +354,8 @@ g++ -std=c++17 -O2 \
     "$BUILD_DIR/TimerManager.o" \
     "$BUILD_DIR/timer_lua_bindings.o" \
     "$BUILD_DIR/console_stubs.o" \
+    "$BUILD_DIR/runtime_preload.o" \
+    "$BUILD_DIR/runtime_bytecode.o" \
     -L"$LUAJIT_LIB" -lluajit-5.1 \
     -lpthread \
     -framework CoreFoundation \